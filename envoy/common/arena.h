@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "envoy/common/pure.h"
+
+namespace Envoy {
+
+/**
+ * A region (bump) allocator. Storage handed out by an arena is never freed individually; all of it
+ * is released at once when the arena is destroyed. Arenas are not thread safe.
+ */
+class Arena {
+public:
+  virtual ~Arena() = default;
+
+  /**
+   * Allocate raw storage that lives as long as the arena.
+   * @param size supplies the number of bytes to allocate.
+   * @param alignment supplies the required alignment of the storage. Must be a power of two.
+   * @return void* the storage. Never nullptr.
+   */
+  virtual void* allocate(size_t size, size_t alignment) PURE;
+
+  /**
+   * Register a function to be invoked with object when the arena is destroyed. Registered
+   * functions run in the reverse order of registration, before any storage is released.
+   * @param object supplies the object to pass to destructor.
+   * @param destructor supplies the function to invoke.
+   */
+  virtual void registerDestructor(void* object, void (*destructor)(void*)) PURE;
+
+  /**
+   * Construct an object owned by the arena. The object's destructor (if not trivial) runs when the
+   * arena is destroyed, so the object must not reference anything that is torn down earlier.
+   * @return T* the constructed object. Never nullptr.
+   */
+  template <class T, class... Args> T* create(Args&&... args) {
+    T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      registerDestructor(object, [](void* p) { static_cast<T*>(p)->~T(); });
+    }
+    return object;
+  }
+
+  /**
+   * Deleter for objects constructed in arena storage whose lifetime is managed by the caller. Only
+   * the destructor runs; the storage itself is released with the arena.
+   */
+  struct Destroyer {
+    template <class T> void operator()(T* object) const { object->~T(); }
+  };
+  template <class T> using UniquePtr = std::unique_ptr<T, Destroyer>;
+
+  /**
+   * Construct an object in arena storage whose lifetime is managed by the returned pointer. The
+   * pointer must be reset before the arena is destroyed.
+   */
+  template <class T, class... Args> UniquePtr<T> makeUnique(Args&&... args) {
+    return UniquePtr<T>(new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...));
+  }
+};
+
+} // namespace Envoy
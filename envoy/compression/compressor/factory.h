@@ -2,10 +2,15 @@
 
 #include "envoy/compression/compressor/compressor.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Compression {
 namespace Compressor {
 
+class CompressorFactory;
+using CompressorFactoryPtr = std::unique_ptr<CompressorFactory>;
+
 class CompressorFactory {
 public:
   virtual ~CompressorFactory() = default;
@@ -13,9 +18,30 @@ public:
   virtual CompressorPtr createCompressor() PURE;
   virtual const std::string& statsPrefix() const PURE;
   virtual const std::string& contentEncoding() const PURE;
-};
 
-using CompressorFactoryPtr = std::unique_ptr<CompressorFactory>;
+  /**
+   * Creates a compressor for a body whose length is known in advance, which the compressor library
+   * may use to compress large bodies differently, e.g. off the calling thread.
+   * @param content_length supplies the length of the uncompressed body.
+   */
+  virtual CompressorPtr createCompressorForContentLength(uint64_t) { return createCompressor(); }
+
+  /**
+   * Creates a factory of compressors that compress against a shared dictionary, producing the
+   * dictionary-compressed content encoding of Compression Dictionary Transport (RFC 9842), e.g.
+   * "dcz" for zstd. The returned factory's contentEncoding() is that encoding. It must not outlive
+   * this factory.
+   * @param dictionary supplies the raw dictionary.
+   * @param sha256 supplies the SHA-256 digest of the dictionary, which the compressed output
+   *        begins with.
+   * @return the factory, or nullptr if this compressor library does not support shared
+   *         dictionaries.
+   */
+  virtual CompressorFactoryPtr createSharedDictionaryCompressorFactory(absl::string_view,
+                                                                       absl::string_view) {
+    return nullptr;
+  }
+};
 
 } // namespace Compressor
 } // namespace Compression
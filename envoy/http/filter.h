@@ -7,6 +7,7 @@
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/buffer/buffer.h"
+#include "envoy/common/arena.h"
 #include "envoy/common/scope_tracker.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/grpc/status.h"
@@ -841,6 +842,14 @@ public:
    * @return true if the filter should shed load based on the system pressure, typically memory.
    */
   virtual bool shouldLoadShed() const PURE;
+
+  /**
+   * @return Arena& an allocator whose storage is released in one shot when the stream is
+   * destroyed. Filters can use it for per-stream state to avoid individual heap allocations.
+   * Objects created in the arena are destroyed after the filters and the stream info of the stream
+   * have been destroyed, so their destructors must not reference either.
+   */
+  virtual Arena& streamArena() PURE;
 };
 
 /**
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/io_error.h"
@@ -444,6 +445,12 @@ public:
    */
   virtual void post(Network::UdpRecvData&& data) PURE;
 
+  /**
+   * Posts all of ``data`` to be delivered on this worker, in order, with a single cross-thread
+   * post.
+   */
+  virtual void postBatch(std::vector<Network::UdpRecvData>&& data) PURE;
+
   /**
    * An estimated number of UDP packets this callback expects to process in current read event.
    */
@@ -563,6 +570,11 @@ public:
    * or ``post()`` on one of the registered workers.
    */
   virtual void deliver(uint32_t dest_worker_index, UdpRecvData&& data) PURE;
+
+  /**
+   * Deliver all of ``data`` to the same worker by calling ``postBatch()`` on it.
+   */
+  virtual void deliverBatch(uint32_t dest_worker_index, std::vector<UdpRecvData>&& data) PURE;
 };
 
 using UdpListenerWorkerRouterPtr = std::unique_ptr<UdpListenerWorkerRouter>;
@@ -0,0 +1,83 @@
+#include "source/common/common/arena_impl.h"
+
+#include <algorithm>
+#include <new>
+
+#include "source/common/common/assert.h"
+
+namespace Envoy {
+
+namespace {
+
+uintptr_t alignUp(uintptr_t address, size_t alignment) {
+  return (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+}
+
+} // namespace
+
+ArenaImpl::ArenaImpl(size_t initial_block_size)
+    : next_block_size_(std::max<size_t>(initial_block_size, sizeof(Cleanup))) {}
+
+ArenaImpl::~ArenaImpl() {
+  // Run destructors in reverse order of registration. The cleanup records live in the arena, so
+  // they stay valid until the blocks are released below.
+  for (Cleanup* cleanup = cleanups_; cleanup != nullptr; cleanup = cleanup->next_) {
+    cleanup->destructor_(cleanup->object_);
+  }
+  while (blocks_ != nullptr) {
+    Block* next = blocks_->next_;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* ArenaImpl::allocate(size_t size, size_t alignment) {
+  ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+  bytes_allocated_ += size;
+
+  uintptr_t aligned = alignUp(cursor_, alignment);
+  if (blocks_ == nullptr || aligned + size > limit_) {
+    // Block storage is aligned to max_align_t, so slack is only needed for over-aligned types.
+    const size_t needed = size + (alignment > alignof(Block) ? alignment - alignof(Block) : 0);
+    if (blocks_ != nullptr && needed > next_block_size_) {
+      // Link a dedicated block behind the current one so that bumping continues in the current
+      // block afterwards.
+      Block* block = newBlock(needed);
+      block->next_ = blocks_->next_;
+      blocks_->next_ = block;
+      return reinterpret_cast<void*>(alignUp(reinterpret_cast<uintptr_t>(block + 1), alignment));
+    }
+
+    const size_t block_size = std::max(next_block_size_, needed);
+    Block* block = newBlock(block_size);
+    block->next_ = blocks_;
+    blocks_ = block;
+    cursor_ = reinterpret_cast<uintptr_t>(block + 1);
+    limit_ = cursor_ + block_size;
+    next_block_size_ = std::max(next_block_size_, std::min(next_block_size_ * 2, MaxBlockSize));
+    aligned = alignUp(cursor_, alignment);
+  }
+
+  cursor_ = aligned + size;
+  return reinterpret_cast<void*>(aligned);
+}
+
+void ArenaImpl::registerDestructor(void* object, void (*destructor)(void*)) {
+  Cleanup* cleanup = static_cast<Cleanup*>(allocate(sizeof(Cleanup), alignof(Cleanup)));
+  // Bookkeeping is not charged to bytesAllocated().
+  bytes_allocated_ -= sizeof(Cleanup);
+  cleanup->next_ = cleanups_;
+  cleanup->object_ = object;
+  cleanup->destructor_ = destructor;
+  cleanups_ = cleanup;
+}
+
+ArenaImpl::Block* ArenaImpl::newBlock(size_t data_size) {
+  void* storage = ::operator new(sizeof(Block) + data_size);
+  Block* block = new (storage) Block{nullptr};
+  bytes_reserved_ += sizeof(Block) + data_size;
+  block_count_++;
+  return block;
+}
+
+} // namespace Envoy
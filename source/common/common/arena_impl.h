@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "envoy/common/arena.h"
+
+#include "source/common/common/non_copyable.h"
+
+namespace Envoy {
+
+/**
+ * Bump allocator backed by a chain of heap blocks. No memory is allocated until the first
+ * allocation, so an unused arena costs only its own footprint. Each new block is twice the size of
+ * the previous one up to MaxBlockSize; requests larger than the current block get a dedicated
+ * block so that the remainder of the current block is not wasted.
+ */
+class ArenaImpl : public Arena, NonCopyable {
+public:
+  static constexpr size_t DefaultInitialBlockSize = 1024;
+  static constexpr size_t MaxBlockSize = 64 * 1024;
+
+  explicit ArenaImpl(size_t initial_block_size = DefaultInitialBlockSize);
+  ~ArenaImpl() override;
+
+  // Arena
+  void* allocate(size_t size, size_t alignment) override;
+  void registerDestructor(void* object, void (*destructor)(void*)) override;
+
+  /**
+   * @return uint64_t the number of bytes handed out by allocate(), excluding alignment padding
+   *         and destructor bookkeeping.
+   */
+  uint64_t bytesAllocated() const { return bytes_allocated_; }
+
+  /**
+   * @return uint64_t the number of bytes requested from the heap for blocks.
+   */
+  uint64_t bytesReserved() const { return bytes_reserved_; }
+
+  /**
+   * @return uint32_t the number of heap blocks backing the arena.
+   */
+  uint32_t blockCount() const { return block_count_; }
+
+private:
+  // Header placed at the start of every heap block. The usable storage follows the header.
+  struct alignas(std::max_align_t) Block {
+    Block* next_;
+  };
+
+  // Registered destructors form an intrusive stack that is itself stored in the arena.
+  struct Cleanup {
+    Cleanup* next_;
+    void* object_;
+    void (*destructor_)(void*);
+  };
+
+  Block* newBlock(size_t data_size);
+
+  size_t next_block_size_;
+  Block* blocks_{};
+  Cleanup* cleanups_{};
+  uintptr_t cursor_{};
+  uintptr_t limit_{};
+  uint64_t bytes_allocated_{};
+  uint64_t bytes_reserved_{};
+  uint32_t block_count_{};
+};
+
+} // namespace Envoy
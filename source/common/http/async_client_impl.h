@@ -33,6 +33,7 @@
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
 
+#include "source/common/common/arena_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/empty_string.h"
 #include "source/common/common/linked_object.h"
@@ -255,6 +256,7 @@ private:
     return upstream_override_host_;
   }
   bool shouldLoadShed() const override { return false; }
+  Arena& streamArena() override { return arena_; }
   absl::string_view filterConfigName() const override { return ""; }
   RequestHeaderMapOptRef requestHeaders() override { return makeOptRefFromPtr(request_headers_); }
   RequestTrailerMapOptRef requestTrailers() override {
@@ -273,6 +275,8 @@ private:
 
   AsyncClient::StreamCallbacks& stream_callbacks_;
   const uint64_t stream_id_;
+  // Declared before the router so that arena allocated filter state outlives it.
+  ArenaImpl arena_;
   Router::ProdFilter router_;
   StreamInfo::StreamInfoImpl stream_info_;
   Tracing::NullSpan active_span_;
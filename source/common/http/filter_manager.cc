@@ -474,6 +474,8 @@ const Buffer::Instance* ActiveStreamDecoderFilter::decodingBuffer() {
 
 bool ActiveStreamDecoderFilter::shouldLoadShed() const { return parent_.shouldLoadShed(); }
 
+Arena& ActiveStreamDecoderFilter::streamArena() { return parent_.arena(); }
+
 void ActiveStreamDecoderFilter::modifyDecodingBuffer(
     std::function<void(Buffer::Instance&)> callback) {
   ASSERT(parent_.state_.latest_data_decoding_filter_ == this);
@@ -14,6 +14,7 @@
 #include "envoy/protobuf/message_validator.h"
 
 #include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/arena_impl.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/linked_object.h"
 #include "source/common/common/logger.h"
@@ -37,8 +38,10 @@ class DownstreamFilterManager;
 struct ActiveStreamFilterBase;
 struct ActiveStreamDecoderFilter;
 struct ActiveStreamEncoderFilter;
-using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
-using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
+// Filter wrappers are constructed in the per-stream arena. The pointers only run the destructor;
+// the storage is released together with the arena when the filter manager is destroyed.
+using ActiveStreamDecoderFilterPtr = Arena::UniquePtr<ActiveStreamDecoderFilter>;
+using ActiveStreamEncoderFilterPtr = Arena::UniquePtr<ActiveStreamEncoderFilter>;
 
 constexpr absl::string_view LocalReplyFilterStateKey =
     "envoy.filters.network.http_connection_manager.local_reply_owner";
@@ -59,10 +62,6 @@ private:
   const std::string filter_config_name_;
 };
 
-// TODO(wbpcode): Rather than allocating every filter with an unique pointer, we could
-// construct the filter in place in the vector. This should reduce the heap allocation and
-// memory fragmentation.
-
 // HTTP decoder filters. If filters are configured in the following order (assume all three
 // filters are both decoder/encoder filters):
 //   http_filters:
@@ -301,6 +300,7 @@ struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
   absl::optional<Upstream::LoadBalancerContext::OverrideHost> upstreamOverrideHost() const override;
   bool shouldLoadShed() const override;
   void sendGoAwayAndClose() override;
+  Arena& streamArena() override;
 
   // Each decoder filter instance checks if the request passed to the filter is gRPC
   // so that we can issue gRPC local responses to gRPC requests. Filter's decodeHeaders()
@@ -897,6 +897,12 @@ public:
   uint64_t streamId() const { return stream_id_; }
   Buffer::BufferMemoryAccountSharedPtr account() const { return account_; }
 
+  /**
+   * @return ArenaImpl& the per-stream arena. It holds the filter wrappers and any state that
+   * filters allocate through StreamDecoderFilterCallbacks::streamArena().
+   */
+  ArenaImpl& arena() { return arena_; }
+
   Buffer::InstancePtr& bufferedRequestData() { return buffered_request_data_; }
 
   void contextOnContinue(ScopeTrackedObjectStack& tracked_object_stack);
@@ -986,23 +992,26 @@ private:
       manager_.filters_.push_back(filter.get());
 
       manager_.decoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, std::move(filter), context_));
+          manager_.arena_.makeUnique<ActiveStreamDecoderFilter>(manager_, std::move(filter),
+                                                                context_));
     }
 
     void addStreamEncoderFilter(Http::StreamEncoderFilterSharedPtr filter) override {
       manager_.filters_.push_back(filter.get());
 
       manager_.encoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), context_));
+          manager_.arena_.makeUnique<ActiveStreamEncoderFilter>(manager_, std::move(filter),
+                                                                context_));
     }
 
     void addStreamFilter(Http::StreamFilterSharedPtr filter) override {
       manager_.filters_.push_back(filter.get());
 
       manager_.decoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamDecoderFilter>(manager_, filter, context_));
+          manager_.arena_.makeUnique<ActiveStreamDecoderFilter>(manager_, filter, context_));
       manager_.encoder_filters_.entries_.emplace_back(
-          std::make_unique<ActiveStreamEncoderFilter>(manager_, std::move(filter), context_));
+          manager_.arena_.makeUnique<ActiveStreamEncoderFilter>(manager_, std::move(filter),
+                                                                context_));
     }
 
     void addAccessLogHandler(AccessLog::InstanceSharedPtr handler) override {
@@ -1103,6 +1112,9 @@ private:
   Buffer::BufferMemoryAccountSharedPtr account_;
   const bool proxy_100_continue_;
 
+  // Must be declared before anything that holds arena allocated objects so that it is destroyed
+  // last.
+  ArenaImpl arena_;
   StreamDecoderFilters decoder_filters_;
   StreamEncoderFilters encoder_filters_;
   std::vector<StreamFilterBase*> filters_;
@@ -1,5 +1,6 @@
 #include "source/common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -10,6 +11,7 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/dump_state_utils.h"
 #include "source/common/common/empty_string.h"
+#include "source/common/runtime/runtime_features.h"
 #include "source/common/singleton/const_singleton.h"
 
 #include "absl/strings/match.h"
@@ -24,6 +26,12 @@ namespace {
 constexpr absl::string_view DelimiterForInlineHeaders{","};
 constexpr absl::string_view DelimiterForInlineCookies{"; "};
 const static int kMinHeadersForLazyMap = 3; // Optimal hard-coded value based on benchmarks.
+// Number of nodes in the first slab of a pooled header list. A node holds two HeaderStrings with
+// their inline buffers, about 300 bytes, so the first slab is sized for the handful of headers of a
+// typical response or proxied request rather than for the largest maps, which get further slabs
+// doubling in size up to kMaxHeaderNodesPerSlab.
+constexpr uint32_t kInitialHeaderNodesPerSlab = 8;
+constexpr uint32_t kMaxHeaderNodesPerSlab = 64;
 
 absl::string_view delimiterByHeader(const LowerCaseString& key) {
   if (key == Http::Headers::get().Cookie) {
@@ -53,6 +61,64 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
+bool HeaderMapImpl::nodePoolingEnabled() {
+  static const bool enabled =
+      Runtime::runtimeFeatureEnabled("envoy.restart_features.header_map_node_pool");
+  return enabled;
+}
+
+HeaderMapImpl::HeaderNodePool::~HeaderNodePool() {
+  while (slabs_ != nullptr) {
+    Slab* next = slabs_->next_;
+    ::operator delete(slabs_);
+    slabs_ = next;
+  }
+}
+
+void* HeaderMapImpl::HeaderNodePool::allocate(size_t size) {
+  if (!enabled_ || (node_size_ != 0 && size != node_size_)) {
+    return ::operator new(size);
+  }
+  if (node_size_ == 0) {
+    node_size_ = size;
+    node_stride_ = (std::max(size, sizeof(FreeNode)) + alignof(std::max_align_t) - 1) &
+                   ~(alignof(std::max_align_t) - 1);
+    next_slab_nodes_ = kInitialHeaderNodesPerSlab;
+  }
+  if (free_list_ != nullptr) {
+    FreeNode* node = free_list_;
+    free_list_ = node->next_;
+    return node;
+  }
+  if (cursor_ == slab_end_) {
+    newSlab();
+  }
+  void* node = cursor_;
+  cursor_ += node_stride_;
+  return node;
+}
+
+void HeaderMapImpl::HeaderNodePool::deallocate(void* node, size_t size) {
+  if (!enabled_ || size != node_size_) {
+    ::operator delete(node);
+    return;
+  }
+  // The storage is only returned to the heap when the pool is destroyed.
+  FreeNode* free_node = static_cast<FreeNode*>(node);
+  free_node->next_ = free_list_;
+  free_list_ = free_node;
+}
+
+void HeaderMapImpl::HeaderNodePool::newSlab() {
+  const size_t data_size = node_stride_ * next_slab_nodes_;
+  Slab* slab = static_cast<Slab*>(::operator new(sizeof(Slab) + data_size));
+  slab->next_ = slabs_;
+  slabs_ = slab;
+  cursor_ = reinterpret_cast<char*>(slab + 1);
+  slab_end_ = cursor_ + data_size;
+  next_slab_nodes_ = std::min(next_slab_nodes_ * 2, kMaxHeaderNodesPerSlab);
+}
+
 bool HeaderMapImpl::HeaderList::maybeMakeMap() {
   if (lazy_map_.empty()) {
     if (headers_.size() < kMinHeadersForLazyMap) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -78,6 +79,13 @@ public:
   // Performs a manual byte size count for test verification.
   void verifyByteSizeInternalForTest() const;
 
+  /**
+   * @return whether header list nodes are allocated from a per-map pool. This is controlled by the
+   * envoy.restart_features.header_map_node_pool restart feature and is latched when the first
+   * header map is created.
+   */
+  static bool nodePoolingEnabled();
+
   // Note: This class does not actually implement Http::HeaderMap to avoid virtual inheritance in
   // the derived classes. Instead, it is used as a mix-in class for TypedHeaderMapImpl below. This
   // both avoid virtual inheritance and allows the concrete final header maps to use a variable
@@ -113,6 +121,66 @@ public:
   StatefulHeaderKeyFormatterOptRef formatter() { return makeOptRefFromPtr(formatter_.get()); }
 
 protected:
+  /**
+   * Fixed size node allocator for the header list. When enabled, list nodes are carved out of
+   * slabs that hold several nodes contiguously and freed nodes are recycled through a free list, so
+   * a typical header map performs one or two allocations for its entries instead of one per header.
+   * All slabs are returned to the heap when the pool is destroyed. When disabled, every call is
+   * forwarded to the global allocator.
+   */
+  class HeaderNodePool : NonCopyable {
+  public:
+    explicit HeaderNodePool(bool enabled) : enabled_(enabled) {}
+    ~HeaderNodePool();
+
+    void* allocate(size_t size);
+    void deallocate(void* node, size_t size);
+
+  private:
+    struct alignas(std::max_align_t) Slab {
+      Slab* next_;
+    };
+    struct FreeNode {
+      FreeNode* next_;
+    };
+
+    void newSlab();
+
+    const bool enabled_;
+    // The size of the nodes served by the pool. It is fixed by the first allocation.
+    size_t node_size_{};
+    size_t node_stride_{};
+    uint32_t next_slab_nodes_{};
+    Slab* slabs_{};
+    FreeNode* free_list_{};
+    char* cursor_{};
+    char* slab_end_{};
+  };
+
+  template <class T> class HeaderNodeAllocator {
+  public:
+    using value_type = T;
+
+    explicit HeaderNodeAllocator(HeaderNodePool& pool) : pool_(&pool) {}
+    template <class U>
+    HeaderNodeAllocator(const HeaderNodeAllocator<U>& other) : pool_(other.pool_) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool_->allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { pool_->deallocate(p, n * sizeof(T)); }
+
+    template <class U> bool operator==(const HeaderNodeAllocator<U>& other) const {
+      return pool_ == other.pool_;
+    }
+    template <class U> bool operator!=(const HeaderNodeAllocator<U>& other) const {
+      return pool_ != other.pool_;
+    }
+
+    HeaderNodePool* pool_;
+  };
+
+  struct HeaderEntryImpl;
+  using HeaderEntryList = std::list<HeaderEntryImpl, HeaderNodeAllocator<HeaderEntryImpl>>;
+
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
     HeaderEntryImpl(const LowerCaseString& key);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
@@ -128,9 +196,9 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderEntryList::iterator entry_;
   };
-  using HeaderNode = std::list<HeaderEntryImpl>::iterator;
+  using HeaderNode = HeaderEntryList::iterator;
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
@@ -209,7 +277,9 @@ protected:
     using HeaderNodeVector = absl::InlinedVector<HeaderNode, 1>;
     using HeaderLazyMap = absl::flat_hash_map<absl::string_view, HeaderNodeVector>;
 
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    HeaderList()
+        : pool_(nodePoolingEnabled()), headers_(HeaderNodeAllocator<HeaderEntryImpl>(pool_)),
+          pseudo_headers_end_(headers_.end()) {}
 
     template <class Key> bool isPseudoHeader(const Key& key) {
       return !key.getStringView().empty() && key.getStringView()[0] == ':';
@@ -299,12 +369,12 @@ protected:
      */
     size_t remove(absl::string_view key);
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    HeaderEntryList::iterator begin() { return headers_.begin(); }
+    HeaderEntryList::iterator end() { return headers_.end(); }
+    HeaderEntryList::const_iterator begin() const { return headers_.begin(); }
+    HeaderEntryList::const_iterator end() const { return headers_.end(); }
+    HeaderEntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    HeaderEntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     HeaderLazyMap::iterator mapFind(absl::string_view key) { return lazy_map_.find(key); }
     HeaderLazyMap::iterator mapEnd() { return lazy_map_.end(); }
     size_t size() const { return headers_.size(); }
@@ -316,7 +386,9 @@ protected:
     }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
+    // Must be declared before headers_ so that it outlives the list nodes.
+    HeaderNodePool pool_;
+    HeaderEntryList headers_;
     HeaderNode pseudo_headers_end_;
     HeaderLazyMap lazy_map_;
   };
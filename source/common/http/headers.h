@@ -66,6 +66,7 @@ public:
   const LowerCaseString Age{"age"};
   const LowerCaseString AltSvc{"alt-svc"};
   const LowerCaseString Authentication{"authentication"};
+  const LowerCaseString AvailableDictionary{"available-dictionary"};
   const LowerCaseString Authorization{"authorization"};
   const LowerCaseString CacheControl{"cache-control"};
   const LowerCaseString CacheStatus{"cache-status"};
@@ -91,6 +92,7 @@ public:
   const LowerCaseString OtSpanContext{"x-ot-span-context"};
   const LowerCaseString Pragma{"pragma"};
   const LowerCaseString Referer{"referer"};
+  const LowerCaseString UseAsDictionary{"use-as-dictionary"};
   const LowerCaseString Vary{"vary"};
 
   struct {
@@ -112,6 +114,8 @@ public:
 
   struct {
     const std::string Brotli{"br"};
+    const std::string DictionaryBrotli{"dcb"};
+    const std::string DictionaryZstd{"dcz"};
     const std::string Gzip{"gzip"};
     const std::string Zstd{"zstd"};
   } ContentEncodingValues;
@@ -126,6 +130,7 @@ public:
 
   struct {
     const std::string AcceptEncoding{"Accept-Encoding"};
+    const std::string AvailableDictionary{"Available-Dictionary"};
     const std::string Wildcard{"*"};
   } VaryValues;
 };
@@ -864,7 +864,10 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, CodecStats& stat
       per_stream_buffer_limit_(http2_options.initial_stream_window_size().value()),
       stream_error_on_invalid_http_messaging_(
           http2_options.override_stream_error_on_invalid_http_message().value()),
-      protocol_constraints_(stats, http2_options), dispatching_(false), raised_goaway_(false),
+      protocol_constraints_(stats, http2_options),
+      coalesce_writes_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http2_coalesce_writes")),
+      dispatching_(false), raised_goaway_(false),
       random_(random_generator),
       last_received_data_time_(connection_.dispatcher().timeSource().monotonicTime()) {
   if (http2_options.has_use_oghttp2_codec()) {
@@ -1377,6 +1380,11 @@ Status ConnectionImpl::trackInboundFrames(int32_t stream_id, size_t length, uint
 
 ssize_t ConnectionImpl::onSend(const uint8_t* data, size_t length) {
   ENVOY_CONN_LOG(trace, "send data: bytes={}", connection_, length);
+  if (coalescing_output_) {
+    // The frame is written together with the rest of the batch in flushPendingOutput().
+    addOutboundFrameFragment(pending_output_, data, length);
+    return length;
+  }
   Buffer::OwnedImpl buffer;
   addOutboundFrameFragment(buffer, data, length);
 
@@ -1552,7 +1560,9 @@ Status ConnectionImpl::sendPendingFrames() {
     return okStatus();
   }
 
+  coalescing_output_ = coalesce_writes_;
   const int rc = adapter_->Send();
+  flushPendingOutput();
   if (rc != 0) {
     ASSERT(rc == ERR_CALLBACK_FAILURE);
     return codecProtocolError(codecStrError(rc));
@@ -1593,6 +1603,20 @@ Status ConnectionImpl::sendPendingFrames() {
   return status;
 }
 
+void ConnectionImpl::flushPendingOutput() {
+  coalescing_output_ = false;
+  if (pending_output_.length() == 0) {
+    return;
+  }
+  ENVOY_CONN_LOG(trace, "flushing coalesced frames: bytes={}", connection_,
+                 pending_output_.length());
+  // See onSend() for the lifetime dependency between the connection's write buffer and the codec.
+  connection_.write(pending_output_, false);
+  // Like the transient buffers used without coalescing, anything left behind (for example because
+  // the connection is closing) is discarded rather than carried over to the next batch.
+  pending_output_.drain(pending_output_.length());
+}
+
 bool ConnectionImpl::sendPendingFramesAndHandleError() {
   if (!sendPendingFrames().ok()) {
     scheduleProtocolConstraintViolationCallback();
@@ -1741,7 +1765,11 @@ bool ConnectionImpl::Http2Visitor::SendDataFrame(Http2StreamId stream_id,
                    stream_id);
     return false;
   }
-  Buffer::OwnedImpl output;
+  // Without coalescing every DATA frame is written on its own. In both cases the payload slices are
+  // moved out of the stream's pending buffer without copying.
+  Buffer::OwnedImpl transient_output;
+  Buffer::OwnedImpl& output =
+      connection_->coalescing_output_ ? connection_->pending_output_ : transient_output;
   connection_->addOutboundFrameFragment(
       output, reinterpret_cast<const uint8_t*>(frame_header.data()), frame_header.size());
   if (!connection_->protocol_constraints_.checkOutboundFrameLimits().ok()) {
@@ -1752,7 +1780,9 @@ bool ConnectionImpl::Http2Visitor::SendDataFrame(Http2StreamId stream_id,
 
   connection_->stats_.pending_send_bytes_.sub(payload_length);
   output.move(*stream->pending_send_data_, payload_length);
-  connection_->connection_.write(output, false);
+  if (!connection_->coalescing_output_) {
+    connection_->connection_.write(output, false);
+  }
   return true;
 }
 
@@ -733,6 +733,14 @@ protected:
   bool is_outbound_flood_monitored_control_frame_ = 0;
   ProtocolConstraints protocol_constraints_;
 
+  // When write coalescing is enabled, frames serialized during a single sendPendingFrames() call
+  // are gathered here and handed to the underlying connection with one write. This is declared
+  // after protocol_constraints_ because the buffered fragments carry drain trackers that release
+  // outbound frames back to it.
+  Buffer::OwnedImpl pending_output_;
+  const bool coalesce_writes_;
+  bool coalescing_output_{false};
+
   // For the flood mitigation to work the onSend callback must be called once for each outbound
   // frame. This is what the nghttp2 library is doing, however this is not documented. The
   // Http2FloodMitigationTest.* tests in test/integration/http2_integration_test.cc will break if
@@ -782,6 +790,8 @@ private:
 
   // Adds buffer fragment for a new outbound frame to the supplied Buffer::OwnedImpl.
   void addOutboundFrameFragment(Buffer::OwnedImpl& output, const uint8_t* data, size_t length);
+  // Writes the frames gathered in pending_output_ to the underlying connection.
+  void flushPendingOutput();
   Status trackInboundFrames(int32_t stream_id, size_t length, uint8_t type, uint8_t flags,
                             uint32_t padding_length);
   void onKeepaliveResponse();
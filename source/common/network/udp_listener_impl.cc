@@ -202,5 +202,17 @@ void UdpListenerWorkerRouterImpl::deliver(uint32_t dest_worker_index, UdpRecvDat
   }
 }
 
+void UdpListenerWorkerRouterImpl::deliverBatch(uint32_t dest_worker_index,
+                                               std::vector<UdpRecvData>&& data) {
+  absl::ReaderMutexLock lock(mutex_);
+
+  ASSERT(dest_worker_index < workers_.size(),
+         "UdpListenerCallbacks::destination returned out-of-range value");
+  auto* worker = workers_[dest_worker_index];
+  if (worker != nullptr) {
+    worker->postBatch(std::move(data));
+  }
+}
+
 } // namespace Network
 } // namespace Envoy
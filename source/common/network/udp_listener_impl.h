@@ -84,6 +84,7 @@ public:
   void registerWorkerForListener(UdpListenerCallbacks& listener) override;
   void unregisterWorkerForListener(UdpListenerCallbacks& listener) override;
   void deliver(uint32_t dest_worker_index, UdpRecvData&& data) override;
+  void deliverBatch(uint32_t dest_worker_index, std::vector<UdpRecvData>&& data) override;
 
 private:
   absl::Mutex mutex_;
@@ -53,7 +53,9 @@ ActiveQuicListener::ActiveQuicListener(
       packets_to_read_to_connection_count_ratio_(packets_to_read_to_connection_count_ratio),
       crypto_server_stream_factory_(crypto_server_stream_factory),
       connection_id_generator_(std::move(cid_generator)),
-      select_connection_id_worker_(std::move(worker_selector)) {
+      select_connection_id_worker_(std::move(worker_selector)),
+      batch_stats_({ALL_QUIC_LISTENER_BATCH_STATS(
+          POOL_HISTOGRAM_PREFIX(listener_config.listenerScope(), "udp"))}) {
   ASSERT(!GetQuicFlag(quic_header_size_limit_includes_overhead));
   ASSERT(select_connection_id_worker_ != nullptr);
 
@@ -113,6 +115,12 @@ ActiveQuicListener::ActiveQuicListener(
   } else {
     quic_dispatcher_->InitializeWithWriter(new EnvoyQuicPacketWriter(std::move(udp_packet_writer)));
   }
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.quic_listener_write_batching")) {
+    gso_batch_writer_ = dynamic_cast<UdpGsoBatchWriter*>(udp_packet_writer_);
+  }
+#endif
+  flush_write_batch_cb_ = dispatcher_.createSchedulableCallback([this]() { flushWriteBatch(); });
 
   if (listener_config.udpListenerConfig()) {
     const auto& save_cmsg_configs =
@@ -135,6 +143,8 @@ ActiveQuicListener::~ActiveQuicListener() { onListenerShutdown(); }
 
 void ActiveQuicListener::onListenerShutdown() {
   ENVOY_LOG(info, "Quic listener {} shutdown.", config_->name());
+  // Send anything buffered by the current batch before the sessions are closed.
+  flushWriteBatch();
   quic_dispatcher_->Shutdown();
   udp_listener_.reset();
 }
@@ -143,6 +153,9 @@ void ActiveQuicListener::onDataWorker(Network::UdpRecvData&& data) {
   if ((enabled_.has_value() && !enabled_.value().enabled()) || reject_all_) {
     return;
   }
+  if (write_batch_open_) {
+    ++packets_received_in_batch_;
+  }
 
   quic::QuicSocketAddress peer_address(
       envoyIpAddressToQuicSocketAddress(data.addresses_.peer_->ip()));
@@ -194,6 +207,8 @@ void ActiveQuicListener::onReadReady() {
     return;
   }
 
+  startWriteBatch();
+
   if (quic_dispatcher_->HasChlosBuffered()) {
     event_loops_with_buffered_chlo_for_test_++;
   }
@@ -208,6 +223,40 @@ void ActiveQuicListener::onReadReady() {
 
 void ActiveQuicListener::onWriteReady(const Network::Socket& /*socket*/) {
   quic_dispatcher_->OnCanWrite();
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  // A batch which was blocked when it was flushed stays buffered in the writer and no session is
+  // waiting for it to be written, so send it now.
+  if (gso_batch_writer_ != nullptr && !write_batch_open_ && !gso_batch_writer_->IsWriteBlocked()) {
+    gso_batch_writer_->Flush();
+  }
+#endif
+}
+
+void ActiveQuicListener::startWriteBatch() {
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  if (gso_batch_writer_ == nullptr || write_batch_open_) {
+    return;
+  }
+  write_batch_open_ = true;
+  gso_batch_writer_->setFlushDeferred(true);
+  // Runs after the packets read in this event have been dispatched to the sessions, and after any
+  // other events of this iteration which write on the same socket.
+  flush_write_batch_cb_->scheduleCallbackCurrentIteration();
+#endif
+}
+
+void ActiveQuicListener::flushWriteBatch() {
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  if (!write_batch_open_) {
+    return;
+  }
+  write_batch_open_ = false;
+  batch_stats_.pkts_received_per_batch_.recordValue(packets_received_in_batch_);
+  packets_received_in_batch_ = 0;
+  gso_batch_writer_->setFlushDeferred(false);
+  // If the socket is blocked, the remaining packets are sent from onWriteReady().
+  gso_batch_writer_->Flush();
+#endif
 }
 
 void ActiveQuicListener::pauseListening() { quic_dispatcher_->StopAcceptingNewConnections(); }
@@ -226,6 +275,7 @@ uint32_t ActiveQuicListener::destination(const Network::UdpRecvData& data) const
   if (kernel_worker_routing_) {
     uint32_t expected_worker_index = select_connection_id_worker_(*data.buffer_, worker_index_);
     if (expected_worker_index != worker_index_) {
+      udp_stats_.downstream_rx_datagram_steering_mismatch_.inc();
       ENVOY_LOG_EVERY_POW_2(error, "Mismacthed worker index. expected {}, actual {}",
                             expected_worker_index, worker_index_);
     }
@@ -13,6 +13,7 @@
 #include "source/common/quic/envoy_quic_dispatcher.h"
 #include "source/common/quic/envoy_quic_proof_source_factory_interface.h"
 #include "source/common/quic/envoy_quic_server_preferred_address_config_factory.h"
+#include "source/common/quic/udp_gso_batch_writer.h"
 #include "source/common/runtime/runtime_protos.h"
 #include "source/server/active_udp_listener.h"
 
@@ -21,6 +22,19 @@
 namespace Envoy {
 namespace Quic {
 
+/**
+ * All stats for the listener wide packet batching. @see stats_macros.h
+ */
+#define ALL_QUIC_LISTENER_BATCH_STATS(HISTOGRAM)                                                   \
+  HISTOGRAM(pkts_received_per_batch, Unspecified)
+
+/**
+ * Struct definition for the listener wide packet batching stats. @see stats_macros.h
+ */
+struct QuicListenerBatchStats {
+  ALL_QUIC_LISTENER_BATCH_STATS(GENERATE_HISTOGRAM_STRUCT)
+};
+
 // QUIC specific UdpListenerCallbacks implementation which delegates incoming
 // packets, write signals and listener errors to QuicDispatcher.
 class ActiveQuicListener : public Envoy::Server::ActiveUdpListenerBase,
@@ -80,6 +94,9 @@ private:
   friend class ActiveQuicListenerPeer;
 
   void closeConnectionsWithFilterChain(const Network::FilterChain* filter_chain);
+  // Opens a listener wide write batch which is flushed later in the current event loop iteration.
+  void startWriteBatch();
+  void flushWriteBatch();
 
   uint8_t random_seed_[16];
   std::unique_ptr<quic::QuicCryptoServerConfig> crypto_config_;
@@ -102,6 +119,16 @@ private:
   // During hot restart, an optional handler for packets that weren't for existing connections.
   OptRef<Network::NonDispatchedUdpPacketHandler> non_dispatched_udp_packet_handler_;
   Network::IoHandle::UdpSaveCmsgConfig udp_save_cmsg_config_;
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  // Set if envoy.reloadable_features.quic_listener_write_batching is enabled and the listener uses
+  // the GSO batch writer. While a batch is open, packets written by all sessions in response to
+  // the packets read in this event loop iteration are buffered and sent together.
+  UdpGsoBatchWriter* gso_batch_writer_{};
+#endif
+  QuicListenerBatchStats batch_stats_;
+  Event::SchedulableCallbackPtr flush_write_batch_cb_;
+  bool write_batch_open_{false};
+  uint64_t packets_received_in_batch_{0};
 };
 
 using ActiveQuicListenerPtr = std::unique_ptr<ActiveQuicListener>;
@@ -57,8 +57,6 @@ UdpGsoBatchWriter::writePacket(const Buffer::Instance& buffer, const Network::Ad
   quic::WriteResult quic_result = WritePacket(static_cast<char*>(buffer.frontSlice().mem_),
                                               payload_len, self_addr.host(), peer_addr,
                                               /*quic::PerPacketOptions=*/nullptr, params);
-  updateUdpGsoBatchWriterStats(quic_result);
-
   return convertQuicWriteResult(quic_result, payload_len);
 }
 
@@ -78,10 +76,28 @@ UdpGsoBatchWriter::getNextWriteLocation(const Network::Address::Ip* local_ip,
 }
 
 Api::IoCallUint64Result UdpGsoBatchWriter::flush() {
-  quic::WriteResult quic_result = Flush();
+  return convertQuicWriteResult(Flush(), /*payload_len=*/0);
+}
+
+quic::WriteResult UdpGsoBatchWriter::WritePacket(const char* buffer, size_t buf_len,
+                                                 const quic::QuicIpAddress& self_address,
+                                                 const quic::QuicSocketAddress& peer_address,
+                                                 quic::PerPacketOptions* options,
+                                                 const quic::QuicPacketWriterParams& params) {
+  quic::WriteResult quic_result = quic::QuicGsoBatchWriter::WritePacket(
+      buffer, buf_len, self_address, peer_address, options, params);
   updateUdpGsoBatchWriterStats(quic_result);
+  return quic_result;
+}
 
-  return convertQuicWriteResult(quic_result, /*payload_len=*/0);
+quic::WriteResult UdpGsoBatchWriter::Flush() {
+  if (flush_deferred_ && !IsWriteBlocked()) {
+    stats_.flushes_deferred_.inc();
+    return {quic::WRITE_STATUS_OK, 0};
+  }
+  quic::WriteResult quic_result = quic::QuicGsoBatchWriter::Flush();
+  updateUdpGsoBatchWriterStats(quic_result);
+  return quic_result;
 }
 
 void UdpGsoBatchWriter::updateUdpGsoBatchWriterStats(quic::WriteResult quic_result) {
@@ -33,11 +33,15 @@ namespace Quic {
  * Provides summary count of batch-sizes within bucketed range,
  * and also provides sum and count stats.
  *
+ * @flushes_deferred: Count of flush requests from QUIC connections
+ * which were absorbed into a listener wide batch, see setFlushDeferred().
+ *
  * TODO(danzh): Add writer stats to QUIC Documentation when it is
  * created for QUIC/HTTP3 docs. Also specify in the documentation
  * that user has to compile in QUICHE to use UdpGsoBatchWriter.
  */
 #define UDP_GSO_BATCH_WRITER_STATS(COUNTER, GAUGE, HISTOGRAM)                                      \
+  COUNTER(flushes_deferred)                                                                        \
   COUNTER(total_bytes_sent)                                                                        \
   GAUGE(internal_buffer_size, NeverImport)                                                         \
   HISTOGRAM(pkts_sent_per_batch, Unspecified)
@@ -73,6 +77,22 @@ public:
                        const Network::Address::Instance& peer_address) override;
   Api::IoCallUint64Result flush() override;
 
+  // quic::QuicPacketWriter
+  quic::WriteResult WritePacket(const char* buffer, size_t buf_len,
+                                const quic::QuicIpAddress& self_address,
+                                const quic::QuicSocketAddress& peer_address,
+                                quic::PerPacketOptions* options,
+                                const quic::QuicPacketWriterParams& params) override;
+  quic::WriteResult Flush() override;
+
+  /**
+   * While set, Flush() calls are ignored unless the writer is write blocked, so that packets
+   * written by different connections accumulate in the batch buffer. The batch is still sent
+   * whenever the next packet cannot be appended to it. The owner is responsible for calling
+   * Flush() after clearing this.
+   */
+  void setFlushDeferred(bool deferred) { flush_deferred_ = deferred; }
+
 private:
   /**
    * @brief Update stats_ field for the udp packet writer
@@ -88,6 +108,7 @@ private:
   UdpGsoBatchWriterStats generateStats(Stats::Scope& scope);
   UdpGsoBatchWriterStats stats_;
   uint64_t gso_size_;
+  bool flush_deferred_{false};
 };
 
 class UdpGsoBatchWriterFactory : public Network::UdpPacketWriterFactory {
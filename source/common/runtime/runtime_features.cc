@@ -35,6 +35,7 @@
 // ASAP by filing a bug on github. Overriding non-buggy code is strongly discouraged to avoid the
 // problem of the bugs being found after the old code path has been removed.
 RUNTIME_GUARD(envoy_reloadable_features_async_host_selection);
+RUNTIME_GUARD(envoy_reloadable_features_cel_specialized_expressions);
 RUNTIME_GUARD(envoy_reloadable_features_decouple_explicit_drain_pools_and_dns_refresh);
 RUNTIME_GUARD(envoy_reloadable_features_dfp_cluster_resolves_hosts);
 RUNTIME_GUARD(envoy_reloadable_features_disallow_quic_client_udp_mmsg);
@@ -43,6 +44,7 @@ RUNTIME_GUARD(envoy_reloadable_features_enable_compression_bomb_protection);
 RUNTIME_GUARD(envoy_reloadable_features_enable_new_query_param_present_match_behavior);
 RUNTIME_GUARD(envoy_reloadable_features_ext_proc_fail_close_spurious_resp);
 RUNTIME_GUARD(envoy_reloadable_features_generic_proxy_codec_buffer_limit);
+RUNTIME_GUARD(envoy_reloadable_features_grpc_json_transcoder_stream_http_body_request);
 RUNTIME_GUARD(envoy_reloadable_features_grpc_side_stream_flow_control);
 RUNTIME_GUARD(envoy_reloadable_features_http1_balsa_allow_cr_or_lf_at_request_start);
 RUNTIME_GUARD(envoy_reloadable_features_http1_balsa_delay_reset);
@@ -53,7 +55,9 @@ RUNTIME_GUARD(envoy_reloadable_features_http2_use_oghttp2);
 RUNTIME_GUARD(envoy_reloadable_features_http3_remove_empty_cookie);
 // Delay deprecation and decommission until UHV is enabled.
 RUNTIME_GUARD(envoy_reloadable_features_http_reject_path_with_fragment);
+RUNTIME_GUARD(envoy_reloadable_features_jwt_authn_shared_jwt_cache);
 RUNTIME_GUARD(envoy_reloadable_features_jwt_fetcher_use_scheme_from_uri);
+RUNTIME_GUARD(envoy_reloadable_features_lua_reuse_coroutines);
 RUNTIME_GUARD(envoy_reloadable_features_no_extension_lookup_by_name);
 RUNTIME_GUARD(envoy_reloadable_features_oauth2_cleanup_cookies);
 RUNTIME_GUARD(envoy_reloadable_features_oauth2_encrypt_tokens);
@@ -69,6 +73,7 @@ RUNTIME_GUARD(envoy_reloadable_features_quic_send_server_preferred_address_to_al
 RUNTIME_GUARD(envoy_reloadable_features_quic_signal_headers_only_to_http1_backend);
 RUNTIME_GUARD(envoy_reloadable_features_quic_upstream_reads_fixed_number_packets);
 RUNTIME_GUARD(envoy_reloadable_features_quic_upstream_socket_use_address_cache_for_read);
+RUNTIME_GUARD(envoy_reloadable_features_rbac_policy_prefilter);
 RUNTIME_GUARD(envoy_reloadable_features_reject_empty_trusted_ca_file);
 RUNTIME_GUARD(envoy_reloadable_features_report_load_with_rq_issued);
 RUNTIME_GUARD(envoy_reloadable_features_router_filter_resetall_on_local_reply);
@@ -185,6 +190,20 @@ FALSE_RUNTIME_GUARD(envoy_reloadable_features_abort_when_accessing_dead_decoder)
 // TODO(pradeepcrao): Create a config option to enable this instead after
 // testing.
 FALSE_RUNTIME_GUARD(envoy_restart_features_use_cached_grpc_client_for_xds);
+// Allocates header map entries from per-map slabs instead of one heap allocation per header.
+// Flip to true once the memory impact has been evaluated in production.
+FALSE_RUNTIME_GUARD(envoy_restart_features_header_map_node_pool);
+// Gathers all HTTP/2 frames produced by one send pass into a single connection write. Flood
+// accounting is unaffected, as each frame keeps its own drain tracker. Off by default, so that
+// connections keep writing one frame at a time unless coalescing is opted into.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_http2_coalesce_writes);
+// Defers flushing of the QUIC listener's GSO batch writer to the end of each event loop iteration
+// in which packets were read, so that packets from all sessions are sent in as few batches as
+// possible.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_quic_listener_write_batching);
+// Hands UDP datagrams that belong to other workers over with one cross-thread post per
+// destination worker per event loop iteration, instead of one post per datagram.
+FALSE_RUNTIME_GUARD(envoy_reloadable_features_udp_listener_batch_worker_forwarding);
 // Block of non-boolean flags. Use of int flags is deprecated. Do not add more.
 ABSL_FLAG(uint64_t, re2_max_program_size_error_level, 100, ""); // NOLINT
 ABSL_FLAG(uint64_t, re2_max_program_size_warn_level,            // NOLINT
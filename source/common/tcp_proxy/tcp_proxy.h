@@ -25,6 +25,7 @@
 #include "envoy/upstream/upstream.h"
 
 #include "source/common/buffer/buffer_impl.h"
+#include "source/common/common/arena_impl.h"
 #include "source/common/common/assert.h"
 #include "source/common/common/logger.h"
 #include "source/common/formatter/substitution_format_string.h"
@@ -593,6 +594,7 @@ public:
       return absl::nullopt;
     }
     bool shouldLoadShed() const override { return false; }
+    Arena& streamArena() override { return arena_; }
     void restoreContextOnContinue(ScopeTrackedObjectStack& tracked_object_stack) override {
       tracked_object_stack.add(*this);
     }
@@ -614,6 +616,7 @@ public:
     Filter* parent_{};
     Http::RequestTrailerMapPtr request_trailer_map_;
     std::shared_ptr<Http::NullRouteImpl> route_;
+    ArenaImpl arena_;
   };
   Tracing::NullSpan active_span_;
   const Tracing::Config& tracing_config_;
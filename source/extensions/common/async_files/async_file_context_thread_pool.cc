@@ -1,6 +1,8 @@
 #include "source/extensions/common/async_files/async_file_context_thread_pool.h"
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include <memory>
 #include <string>
@@ -172,6 +174,52 @@ private:
   const off_t offset_;
 };
 
+class ActionMapFile : public AsyncFileActionThreadPool<absl::StatusOr<MappedFileRegionSharedPtr>> {
+public:
+  ActionMapFile(AsyncFileHandle handle, off_t offset, size_t length,
+                absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete)
+      : AsyncFileActionThreadPool<absl::StatusOr<MappedFileRegionSharedPtr>>(
+            handle, std::move(on_complete)),
+        offset_(offset), length_(length) {}
+
+  absl::StatusOr<MappedFileRegionSharedPtr> executeImpl() override {
+    ASSERT(fileDescriptor() != -1);
+    if (length_ == 0) {
+      return absl::InvalidArgumentError("cannot map an empty range of a file");
+    }
+    // Accessing a mapping beyond the end of the file raises SIGBUS, so that must be ruled out
+    // before mapping.
+    struct stat stat_result;
+    auto stat_status = posix().fstat(fileDescriptor(), &stat_result);
+    if (stat_status.return_value_ != 0) {
+      return statusAfterFileError(stat_status);
+    }
+    if (static_cast<uint64_t>(stat_result.st_size) < offset_ + length_) {
+      return absl::OutOfRangeError("mapped range extends beyond the end of the file");
+    }
+    // The offset of a mapping must be a multiple of the page size.
+    static const off_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t page_offset = offset_ % page_size;
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the mapped pages in here, on the file thread, so that a worker reading a cold file
+    // through the mapping doesn't block on disk reads.
+    flags |= MAP_POPULATE;
+#endif
+    auto result = posix().mmap(nullptr, length_ + page_offset, PROT_READ, flags,
+                               fileDescriptor(), offset_ - page_offset);
+    if (result.return_value_ == MAP_FAILED) {
+      return statusAfterFileError(result);
+    }
+    return std::make_shared<const MappedFileRegion>(result.return_value_, length_ + page_offset,
+                                                    page_offset, length_);
+  }
+
+private:
+  const off_t offset_;
+  const size_t length_;
+};
+
 class ActionTruncateFile : public AsyncFileActionThreadPool<absl::Status> {
 public:
   ActionTruncateFile(AsyncFileHandle handle, size_t length,
@@ -256,6 +304,13 @@ AsyncFileContextThreadPool::write(Event::Dispatcher* dispatcher, Buffer::Instanc
                                              handle(), contents, offset, std::move(on_complete)));
 }
 
+absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::mmap(
+    Event::Dispatcher* dispatcher, off_t offset, size_t length,
+    absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete) {
+  return checkFileAndEnqueue(dispatcher, std::make_unique<ActionMapFile>(handle(), offset, length,
+                                                                         std::move(on_complete)));
+}
+
 absl::StatusOr<CancelFunction> AsyncFileContextThreadPool::duplicate(
     Event::Dispatcher* dispatcher,
     absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) {
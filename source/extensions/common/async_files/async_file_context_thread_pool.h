@@ -40,6 +40,9 @@ public:
   write(Event::Dispatcher* dispatcher, Buffer::Instance& contents, off_t offset,
         absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete) override;
   absl::StatusOr<CancelFunction>
+  mmap(Event::Dispatcher* dispatcher, off_t offset, size_t length,
+       absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete) override;
+  absl::StatusOr<CancelFunction>
   duplicate(Event::Dispatcher* dispatcher,
             absl::AnyInvocable<void(absl::StatusOr<AsyncFileHandle>)> on_complete) override;
   absl::StatusOr<CancelFunction>
@@ -7,6 +7,7 @@
 
 #include "source/common/buffer/buffer_impl.h"
 #include "source/extensions/common/async_files/async_file_action.h"
+#include "source/extensions/common/async_files/mapped_file_region.h"
 
 #include "absl/status/statusor.h"
 
@@ -65,6 +66,14 @@ public:
   write(Event::Dispatcher* dispatcher, Buffer::Instance& contents, off_t offset,
         absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete) PURE;
 
+  // Enqueues an action to memory-map, read-only, length bytes of the currently open file
+  // starting at position offset. It is an error for the file to be shorter than offset + length.
+  // The mapped part of the file must not be truncated or rewritten while the mapping exists, as
+  // reading a truncated part of a mapping raises SIGBUS.
+  virtual absl::StatusOr<CancelFunction>
+  mmap(Event::Dispatcher* dispatcher, off_t offset, size_t length,
+       absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete) PURE;
+
   // Creates a new AsyncFileHandle referencing the same file.
   // Note that a file handle duplicated in this way shares positioning and permissions
   // with the original. Since AsyncFileContext functions are all position-explicit, this should not
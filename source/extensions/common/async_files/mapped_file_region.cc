@@ -0,0 +1,19 @@
+#include "source/extensions/common/async_files/mapped_file_region.h"
+
+#include <sys/mman.h>
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+MappedFileRegion::MappedFileRegion(void* map_address, size_t map_length, size_t offset,
+                                   size_t length)
+    : map_address_(map_address), map_length_(map_length), offset_(offset), length_(length) {}
+
+MappedFileRegion::~MappedFileRegion() { ::munmap(map_address_, map_length_); }
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Common {
+namespace AsyncFiles {
+
+// A read-only memory mapping of part of a file, unmapped when destroyed. The mapping remains
+// valid after the file it was mapped from is closed or unlinked.
+class MappedFileRegion {
+public:
+  // Takes ownership of the mapping of map_length bytes at map_address; the region's contents
+  // are the length bytes starting offset bytes into the mapping.
+  MappedFileRegion(void* map_address, size_t map_length, size_t offset, size_t length);
+  ~MappedFileRegion();
+  MappedFileRegion(const MappedFileRegion&) = delete;
+  MappedFileRegion& operator=(const MappedFileRegion&) = delete;
+
+  absl::string_view contents() const {
+    return {static_cast<const char*>(map_address_) + offset_, length_};
+  }
+
+private:
+  void* const map_address_;
+  const size_t map_length_;
+  const size_t offset_;
+  const size_t length_;
+};
+
+using MappedFileRegionSharedPtr = std::shared_ptr<const MappedFileRegion>;
+
+} // namespace AsyncFiles
+} // namespace Common
+} // namespace Extensions
+} // namespace Envoy
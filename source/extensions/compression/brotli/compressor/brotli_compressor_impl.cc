@@ -11,9 +11,12 @@ namespace Compressor {
 BrotliCompressorImpl::BrotliCompressorImpl(const uint32_t quality, const uint32_t window_bits,
                                            const uint32_t input_block_bits,
                                            const bool disable_literal_context_modeling,
-                                           const EncoderMode mode, const uint32_t chunk_size)
-    : chunk_size_{chunk_size}, state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr),
-                                      &BrotliEncoderDestroyInstance) {
+                                           const EncoderMode mode, const uint32_t chunk_size,
+                                           const BrotliEncoderPreparedDictionary* dictionary,
+                                           absl::string_view header)
+    : chunk_size_{chunk_size},
+      state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr), &BrotliEncoderDestroyInstance),
+      header_(header) {
   RELEASE_ASSERT(quality <= BROTLI_MAX_QUALITY, "");
   BROTLI_BOOL result = BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_QUALITY, quality);
   RELEASE_ASSERT(result == BROTLI_TRUE, "");
@@ -35,6 +38,11 @@ BrotliCompressorImpl::BrotliCompressorImpl(const uint32_t quality, const uint32_
 
   result = BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_MODE, static_cast<uint32_t>(mode));
   RELEASE_ASSERT(result == BROTLI_TRUE, "");
+
+  if (dictionary != nullptr) {
+    result = BrotliEncoderAttachPreparedDictionary(state_.get(), dictionary);
+    RELEASE_ASSERT(result == BROTLI_TRUE, "");
+  }
 }
 
 void BrotliCompressorImpl::compress(Buffer::Instance& buffer,
@@ -54,6 +62,10 @@ void BrotliCompressorImpl::compress(Buffer::Instance& buffer,
   }
 
   ASSERT(buffer.length() == 0);
+  if (!header_.empty()) {
+    buffer.add(header_);
+    header_ = {};
+  }
   buffer.move(accumulation_buffer);
 
   // The encoder's internal buffer can still hold data not flushed to the
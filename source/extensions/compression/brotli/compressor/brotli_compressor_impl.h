@@ -4,6 +4,7 @@
 
 #include "source/extensions/compression/brotli/common/base.h"
 
+#include "absl/strings/string_view.h"
 #include "brotli/encode.h"
 
 namespace Envoy {
@@ -44,10 +45,15 @@ public:
    * feature. This flag is a "decoding-speed vs compression ratio" trade-off.
    * @param mode tunes encoder for specific input. @see EncoderMode enum.
    * @param chunk_size amount of memory reserved for the compressor output.
+   * @param dictionary optional shared dictionary to compress against, which must outlive the
+   * compressor.
+   * @param header data written before the compressed output, which must outlive the compressor.
    */
   BrotliCompressorImpl(const uint32_t quality, const uint32_t window_bits,
                        const uint32_t input_block_bits, const bool disable_literal_context_modeling,
-                       const EncoderMode mode, const uint32_t chunk_size);
+                       const EncoderMode mode, const uint32_t chunk_size,
+                       const BrotliEncoderPreparedDictionary* dictionary = nullptr,
+                       absl::string_view header = {});
 
   // Compression::Compressor::Compressor
   void compress(Buffer::Instance& buffer, Envoy::Compression::Compressor::State state) override;
@@ -58,6 +64,7 @@ private:
 
   const uint32_t chunk_size_;
   std::unique_ptr<BrotliEncoderState, decltype(&BrotliEncoderDestroyInstance)> state_;
+  absl::string_view header_;
 };
 
 } // namespace Compressor
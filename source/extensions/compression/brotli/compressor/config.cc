@@ -1,11 +1,20 @@
 #include "source/extensions/compression/brotli/compressor/config.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
 namespace Brotli {
 namespace Compressor {
 
+namespace {
+
+// The "dcb" header that precedes the SHA-256 digest of the dictionary, per RFC 9842.
+constexpr char DcbMagic[] = {'\xff', '\x44', '\x43', '\x42'};
+
+} // namespace
+
 BrotliCompressorFactory::BrotliCompressorFactory(
     const envoy::extensions::compression::brotli::compressor::v3::Brotli& brotli)
     : chunk_size_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, chunk_size, DefaultChunkSize)),
@@ -22,6 +31,14 @@ Envoy::Compression::Compressor::CompressorPtr BrotliCompressorFactory::createCom
                                                 chunk_size_);
 }
 
+Envoy::Compression::Compressor::CompressorFactoryPtr
+BrotliCompressorFactory::createSharedDictionaryCompressorFactory(absl::string_view dictionary,
+                                                                 absl::string_view sha256) {
+  return std::make_unique<BrotliSharedDictionaryCompressorFactory>(
+      quality_, window_bits_, input_block_bits_, disable_literal_context_modeling_, encoder_mode_,
+      chunk_size_, dictionary, sha256);
+}
+
 BrotliCompressorImpl::EncoderMode BrotliCompressorFactory::encoderModeEnum(
     envoy::extensions::compression::brotli::compressor::v3::Brotli::EncoderMode encoder_mode) {
   switch (encoder_mode) {
@@ -36,6 +53,30 @@ BrotliCompressorImpl::EncoderMode BrotliCompressorFactory::encoderModeEnum(
   }
 }
 
+BrotliSharedDictionaryCompressorFactory::BrotliSharedDictionaryCompressorFactory(
+    uint32_t quality, uint32_t window_bits, uint32_t input_block_bits,
+    bool disable_literal_context_modeling, BrotliCompressorImpl::EncoderMode encoder_mode,
+    uint32_t chunk_size, absl::string_view dictionary, absl::string_view sha256)
+    : quality_(quality), window_bits_(window_bits), input_block_bits_(input_block_bits),
+      disable_literal_context_modeling_(disable_literal_context_modeling),
+      encoder_mode_(encoder_mode), chunk_size_(chunk_size),
+      header_(absl::StrCat(absl::string_view(DcbMagic, sizeof(DcbMagic)), sha256)),
+      dictionary_(dictionary),
+      prepared_dictionary_(BrotliEncoderPrepareDictionary(
+                               BROTLI_SHARED_DICTIONARY_RAW, dictionary_.size(),
+                               reinterpret_cast<const uint8_t*>(dictionary_.data()), quality,
+                               nullptr, nullptr, nullptr),
+                           &BrotliEncoderDestroyPreparedDictionary) {
+  RELEASE_ASSERT(prepared_dictionary_ != nullptr, "");
+}
+
+Envoy::Compression::Compressor::CompressorPtr
+BrotliSharedDictionaryCompressorFactory::createCompressor() {
+  return std::make_unique<BrotliCompressorImpl>(
+      quality_, window_bits_, input_block_bits_, disable_literal_context_modeling_, encoder_mode_,
+      chunk_size_, prepared_dictionary_.get(), header_);
+}
+
 Envoy::Compression::Compressor::CompressorFactoryPtr
 BrotliCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::brotli::compressor::v3::Brotli& proto_config,
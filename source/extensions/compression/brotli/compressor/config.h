@@ -46,6 +46,9 @@ public:
   const std::string& contentEncoding() const override {
     return Http::CustomHeaders::get().ContentEncodingValues.Brotli;
   }
+  Envoy::Compression::Compressor::CompressorFactoryPtr
+  createSharedDictionaryCompressorFactory(absl::string_view dictionary,
+                                          absl::string_view sha256) override;
 
 private:
   static BrotliCompressorImpl::EncoderMode encoderModeEnum(
@@ -58,6 +61,41 @@ private:
   const uint32_t window_bits_;
 };
 
+/**
+ * Creates compressors producing the "dcb" content encoding against a raw dictionary.
+ */
+class BrotliSharedDictionaryCompressorFactory
+    : public Envoy::Compression::Compressor::CompressorFactory {
+public:
+  BrotliSharedDictionaryCompressorFactory(uint32_t quality, uint32_t window_bits,
+                                          uint32_t input_block_bits,
+                                          bool disable_literal_context_modeling,
+                                          BrotliCompressorImpl::EncoderMode encoder_mode,
+                                          uint32_t chunk_size, absl::string_view dictionary,
+                                          absl::string_view sha256);
+
+  // Envoy::Compression::Compressor::CompressorFactory
+  Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
+  const std::string& statsPrefix() const override { return brotliStatsPrefix(); }
+  const std::string& contentEncoding() const override {
+    return Http::CustomHeaders::get().ContentEncodingValues.DictionaryBrotli;
+  }
+
+private:
+  const uint32_t quality_;
+  const uint32_t window_bits_;
+  const uint32_t input_block_bits_;
+  const bool disable_literal_context_modeling_;
+  const BrotliCompressorImpl::EncoderMode encoder_mode_;
+  const uint32_t chunk_size_;
+  const std::string header_;
+  // The prepared dictionary refers to the raw one.
+  const std::string dictionary_;
+  std::unique_ptr<BrotliEncoderPreparedDictionary,
+                  decltype(&BrotliEncoderDestroyPreparedDictionary)>
+      prepared_dictionary_;
+};
+
 class BrotliCompressorLibraryFactory
     : public Compression::Common::Compressor::CompressorLibraryFactoryBase<
           envoy::extensions::compression::brotli::compressor::v3::Brotli> {
@@ -1,11 +1,33 @@
 #include "source/extensions/compression/zstd/compressor/config.h"
 
+#include <algorithm>
+
+#include "absl/numeric/bits.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
 namespace Zstd {
 namespace Compressor {
 
+namespace {
+
+// The "dcz" header that precedes the SHA-256 digest of the dictionary, per RFC 9842. It is a
+// skippable zstd frame that the digest is the content of.
+constexpr char DczMagic[] = {'\x5e', '\x2a', '\x4d', '\x18', '\x20', '\x00', '\x00', '\x00'};
+// The magic number that trained zstd dictionaries begin with.
+constexpr char DictionaryMagic[] = {'\x37', '\xa4', '\x30', '\xec'};
+// Compression levels above this one default to windows larger than 8MiB.
+constexpr uint32_t UltraCompressionLevel = 19;
+// The largest window that zstd decoders accept by default.
+constexpr uint32_t MaxWindowLog = 27;
+// Default minimum length of the bodies compressed in parallel.
+constexpr uint64_t DefaultParallelMinContentLength = 8 * 1024 * 1024;
+
+} // namespace
+
 ZstdCompressorFactory::ZstdCompressorFactory(
     const envoy::extensions::compression::zstd::compressor::v3::Zstd& zstd,
     Event::Dispatcher& dispatcher, Api::Api& api, ThreadLocal::SlotAllocator& tls)
@@ -22,6 +44,15 @@ ZstdCompressorFactory::ZstdCompressorFactory(
           return ZSTD_createCDict(dict_buffer, dict_size, compression_level_);
         });
   }
+  if (zstd.has_parallel_compression()) {
+    if (!ZstdThreadPool::isSupported()) {
+      throw EnvoyException("zstd was built without multithreading support, which "
+                           "parallel_compression requires");
+    }
+    thread_pool_ = std::make_unique<ZstdThreadPool>(zstd.parallel_compression().threads());
+    parallel_min_content_length_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+        zstd.parallel_compression(), min_content_length, DefaultParallelMinContentLength);
+  }
 }
 
 Envoy::Compression::Compressor::CompressorPtr ZstdCompressorFactory::createCompressor() {
@@ -29,6 +60,51 @@ Envoy::Compression::Compressor::CompressorPtr ZstdCompressorFactory::createCompr
                                               cdict_manager_, chunk_size_);
 }
 
+Envoy::Compression::Compressor::CompressorPtr
+ZstdCompressorFactory::createCompressorForContentLength(uint64_t content_length) {
+  if (thread_pool_ == nullptr || content_length < parallel_min_content_length_) {
+    return createCompressor();
+  }
+  return std::make_unique<ZstdCompressorImpl>(compression_level_, enable_checksum_, strategy_,
+                                              cdict_manager_, chunk_size_, thread_pool_.get());
+}
+
+Envoy::Compression::Compressor::CompressorFactoryPtr
+ZstdCompressorFactory::createSharedDictionaryCompressorFactory(absl::string_view dictionary,
+                                                               absl::string_view sha256) {
+  // Content starting with the magic number would be loaded as a trained zstd dictionary, which
+  // clients of "dcz" do not do.
+  if (absl::StartsWith(dictionary, absl::string_view(DictionaryMagic, sizeof(DictionaryMagic)))) {
+    return nullptr;
+  }
+  return std::make_unique<ZstdSharedDictionaryCompressorFactory>(
+      compression_level_, enable_checksum_, strategy_, chunk_size_, dictionary, sha256);
+}
+
+ZstdSharedDictionaryCompressorFactory::ZstdSharedDictionaryCompressorFactory(
+    uint32_t compression_level, bool enable_checksum, uint32_t strategy, uint32_t chunk_size,
+    absl::string_view dictionary, absl::string_view sha256)
+    : compression_level_(compression_level), enable_checksum_(enable_checksum),
+      strategy_(strategy), chunk_size_(chunk_size),
+      header_(absl::StrCat(absl::string_view(DczMagic, sizeof(DczMagic)), sha256)),
+      cdict_(ZSTD_createCDict(dictionary.data(), dictionary.size(), compression_level),
+             &ZSTD_freeCDict) {
+  RELEASE_ASSERT(cdict_ != nullptr, "");
+  // Clients only have to accept windows of up to the larger of 8MiB and 1.25 times the
+  // dictionary size, which only the "ultra" compression levels exceed by default.
+  if (compression_level > UltraCompressionLevel) {
+    const uint64_t max_window_size =
+        std::max<uint64_t>(8 << 20, dictionary.size() + dictionary.size() / 4);
+    window_log_ = std::min<uint32_t>(absl::bit_width(max_window_size) - 1, MaxWindowLog);
+  }
+}
+
+Envoy::Compression::Compressor::CompressorPtr
+ZstdSharedDictionaryCompressorFactory::createCompressor() {
+  return std::make_unique<ZstdSharedDictionaryCompressorImpl>(
+      compression_level_, enable_checksum_, strategy_, *cdict_, window_log_, header_, chunk_size_);
+}
+
 Envoy::Compression::Compressor::CompressorFactoryPtr
 ZstdCompressorLibraryFactory::createCompressorFactoryFromProtoTyped(
     const envoy::extensions::compression::zstd::compressor::v3::Zstd& proto_config,
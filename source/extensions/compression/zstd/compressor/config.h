@@ -31,10 +31,15 @@ public:
 
   // Envoy::Compression::Compressor::CompressorFactory
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
+  Envoy::Compression::Compressor::CompressorPtr
+  createCompressorForContentLength(uint64_t content_length) override;
   const std::string& statsPrefix() const override { return zstdStatsPrefix(); }
   const std::string& contentEncoding() const override {
     return Http::CustomHeaders::get().ContentEncodingValues.Zstd;
   }
+  Envoy::Compression::Compressor::CompressorFactoryPtr
+  createSharedDictionaryCompressorFactory(absl::string_view dictionary,
+                                          absl::string_view sha256) override;
 
 private:
   const uint32_t compression_level_;
@@ -42,6 +47,36 @@ private:
   const uint32_t strategy_;
   const uint32_t chunk_size_;
   ZstdCDictManagerPtr cdict_manager_{nullptr};
+  // Set if large bodies are compressed in parallel.
+  ZstdThreadPoolPtr thread_pool_;
+  uint64_t parallel_min_content_length_{0};
+};
+
+/**
+ * Creates compressors producing the "dcz" content encoding against a raw dictionary.
+ */
+class ZstdSharedDictionaryCompressorFactory
+    : public Envoy::Compression::Compressor::CompressorFactory {
+public:
+  ZstdSharedDictionaryCompressorFactory(uint32_t compression_level, bool enable_checksum,
+                                        uint32_t strategy, uint32_t chunk_size,
+                                        absl::string_view dictionary, absl::string_view sha256);
+
+  // Envoy::Compression::Compressor::CompressorFactory
+  Envoy::Compression::Compressor::CompressorPtr createCompressor() override;
+  const std::string& statsPrefix() const override { return zstdStatsPrefix(); }
+  const std::string& contentEncoding() const override {
+    return Http::CustomHeaders::get().ContentEncodingValues.DictionaryZstd;
+  }
+
+private:
+  const uint32_t compression_level_;
+  const bool enable_checksum_;
+  const uint32_t strategy_;
+  const uint32_t chunk_size_;
+  uint32_t window_log_{0};
+  std::string header_;
+  std::unique_ptr<ZSTD_CDict, decltype(&ZSTD_freeCDict)> cdict_;
 };
 
 class ZstdCompressorLibraryFactory
@@ -1,14 +1,45 @@
 #include "source/extensions/compression/zstd/compressor/zstd_compressor_impl.h"
 
+// For the thread pool API.
+#define ZSTD_STATIC_LINKING_ONLY
+#include "zstd.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
 namespace Zstd {
 namespace Compressor {
 
+class ZstdThreadPool::Impl {
+public:
+  explicit Impl(uint32_t threads) : pool_(ZSTD_createThreadPool(threads), &ZSTD_freeThreadPool) {
+    RELEASE_ASSERT(pool_ != nullptr, "");
+  }
+
+  std::unique_ptr<ZSTD_threadPool, decltype(&ZSTD_freeThreadPool)> pool_;
+};
+
+ZstdThreadPool::ZstdThreadPool(uint32_t threads)
+    : threads_(threads), impl_(std::make_unique<Impl>(threads)) {}
+
+ZstdThreadPool::~ZstdThreadPool() = default;
+
+void ZstdThreadPool::attach(ZSTD_CCtx& cctx) const {
+  size_t result = ZSTD_CCtx_setParameter(&cctx, ZSTD_c_nbWorkers, threads_);
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+  // Without a pool of its own, the context would start as many threads.
+  result = ZSTD_CCtx_refThreadPool(&cctx, impl_->pool_.get());
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+}
+
+bool ZstdThreadPool::isSupported() {
+  // The parameter only accepts 0 if the library is single-threaded.
+  return ZSTD_cParam_getBounds(ZSTD_c_nbWorkers).upperBound > 0;
+}
+
 ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum,
                                        uint32_t strategy, const ZstdCDictManagerPtr& cdict_manager,
-                                       uint32_t chunk_size)
+                                       uint32_t chunk_size, const ZstdThreadPool* thread_pool)
     : ZstdCompressorImplBase(compression_level, enable_checksum, strategy, chunk_size),
       cdict_manager_(cdict_manager) {
   size_t result;
@@ -19,6 +50,9 @@ ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_c
     result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel, compression_level_);
   }
   RELEASE_ASSERT(!ZSTD_isError(result), "");
+  if (thread_pool != nullptr) {
+    thread_pool->attach(*cctx_);
+  }
 }
 
 void ZstdCompressorImpl::compressPreprocess(Buffer::Instance&,
@@ -33,6 +67,36 @@ void ZstdCompressorImpl::compressProcess(const Buffer::Instance&,
 
 void ZstdCompressorImpl::compressPostprocess(Buffer::Instance&) {}
 
+ZstdSharedDictionaryCompressorImpl::ZstdSharedDictionaryCompressorImpl(
+    uint32_t compression_level, bool enable_checksum, uint32_t strategy, const ZSTD_CDict& cdict,
+    uint32_t window_log, absl::string_view header, uint32_t chunk_size)
+    : ZstdCompressorImplBase(compression_level, enable_checksum, strategy, chunk_size),
+      header_(header) {
+  size_t result = ZSTD_CCtx_refCDict(cctx_.get(), &cdict);
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+  // Parameters set explicitly take precedence over those of the dictionary.
+  result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_windowLog, window_log);
+  RELEASE_ASSERT(!ZSTD_isError(result), "");
+}
+
+void ZstdSharedDictionaryCompressorImpl::compressPreprocess(
+    Buffer::Instance&, Envoy::Compression::Compressor::State) {}
+
+void ZstdSharedDictionaryCompressorImpl::compressProcess(const Buffer::Instance&,
+                                                         const Buffer::RawSlice& input_slice,
+                                                         Buffer::Instance& accumulation_buffer) {
+  setInput(input_slice);
+  process(accumulation_buffer, ZSTD_e_continue);
+}
+
+void ZstdSharedDictionaryCompressorImpl::compressPostprocess(
+    Buffer::Instance& accumulation_buffer) {
+  if (!header_written_) {
+    accumulation_buffer.prepend(header_);
+    header_written_ = true;
+  }
+}
+
 } // namespace Compressor
 } // namespace Zstd
 } // namespace Compression
@@ -6,6 +6,8 @@
 #include "source/common/compression/zstd/compressor/zstd_compressor_impl_base.h"
 #include "source/extensions/compression/zstd/common/dictionary_manager.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Compression {
@@ -16,13 +18,46 @@ using ZstdCDictManager =
     Common::DictionaryManager<ZSTD_CDict, ZSTD_freeCDict, ZSTD_getDictID_fromCDict>;
 using ZstdCDictManagerPtr = std::unique_ptr<ZstdCDictManager>;
 
+/**
+ * A pool of threads that compressors run the jobs of zstd's multithreaded compression on.
+ */
+class ZstdThreadPool : NonCopyable {
+public:
+  explicit ZstdThreadPool(uint32_t threads);
+  ~ZstdThreadPool();
+
+  /**
+   * Makes a compression context compress in up to threads() parallel jobs on the pool.
+   */
+  void attach(ZSTD_CCtx& cctx) const;
+
+  uint32_t threads() const { return threads_; }
+
+  /**
+   * @return whether the zstd library was built with multithreading support.
+   */
+  static bool isSupported();
+
+private:
+  class Impl;
+
+  const uint32_t threads_;
+  const std::unique_ptr<Impl> impl_;
+};
+using ZstdThreadPoolPtr = std::unique_ptr<ZstdThreadPool>;
+
 /**
  * Implementation of compressor's interface.
  */
 class ZstdCompressorImpl : public Envoy::Compression::Zstd::Compressor::ZstdCompressorImplBase {
 public:
+  /**
+   * @param thread_pool optionally supplies a pool to compress in parallel on, which must outlive
+   *        the compressor.
+   */
   ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum, uint32_t strategy,
-                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size);
+                     const ZstdCDictManagerPtr& cdict_manager, uint32_t chunk_size,
+                     const ZstdThreadPool* thread_pool = nullptr);
 
 private:
   void compressPreprocess(Buffer::Instance& buffer,
@@ -36,6 +71,38 @@ private:
   const ZstdCDictManagerPtr& cdict_manager_;
 };
 
+/**
+ * Implementation of compressor's interface producing the "dcz" content encoding of Compression
+ * Dictionary Transport (RFC 9842): a header identifying the dictionary by its SHA-256 digest,
+ * followed by a zstd frame compressed against the dictionary's raw content.
+ */
+class ZstdSharedDictionaryCompressorImpl
+    : public Envoy::Compression::Zstd::Compressor::ZstdCompressorImplBase {
+public:
+  /**
+   * @param cdict supplies the dictionary, which must outlive the compressor.
+   * @param window_log supplies the base 2 logarithm of the window size to use, or 0 for the
+   *        compression level's default.
+   * @param header supplies the "dcz" header, which must outlive the compressor.
+   */
+  ZstdSharedDictionaryCompressorImpl(uint32_t compression_level, bool enable_checksum,
+                                     uint32_t strategy, const ZSTD_CDict& cdict,
+                                     uint32_t window_log, absl::string_view header,
+                                     uint32_t chunk_size);
+
+private:
+  void compressPreprocess(Buffer::Instance& buffer,
+                          Envoy::Compression::Compressor::State state) override;
+
+  void compressProcess(const Buffer::Instance& buffer, const Buffer::RawSlice& input_slice,
+                       Buffer::Instance& accumulation_buffer) override;
+
+  void compressPostprocess(Buffer::Instance& accumulation_buffer) override;
+
+  const absl::string_view header_;
+  bool header_written_{false};
+};
+
 } // namespace Compressor
 } // namespace Zstd
 } // namespace Compression
@@ -1282,6 +1282,50 @@ bool envoy_dynamic_module_callback_http_set_response_trailer(
     envoy_dynamic_module_type_buffer_module_ptr key, size_t key_length,
     envoy_dynamic_module_type_buffer_module_ptr value, size_t value_length);
 
+/**
+ * envoy_dynamic_module_callback_http_update_request_headers is called by the module to set or
+ * remove many request headers at once. This is equivalent to calling
+ * envoy_dynamic_module_callback_http_set_request_header for each header in the given order, but
+ * in a single call.
+ *
+ * @param filter_envoy_ptr is the pointer to the DynamicModuleHttpFilter object of the
+ * corresponding HTTP filter.
+ * @param headers is the array of envoy_dynamic_module_type_module_http_header to set. A header
+ * whose value_ptr is null is removed.
+ * @param headers_length is the number of headers in the array.
+ * @return true if the operation is successful, false if the headers are not available.
+ */
+bool envoy_dynamic_module_callback_http_update_request_headers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length);
+
+/**
+ * envoy_dynamic_module_callback_http_update_request_trailers is exactly the same as the
+ * envoy_dynamic_module_callback_http_update_request_headers, but for the request trailers.
+ * See the comments on envoy_dynamic_module_callback_http_update_request_headers for more details.
+ */
+bool envoy_dynamic_module_callback_http_update_request_trailers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length);
+
+/**
+ * envoy_dynamic_module_callback_http_update_response_headers is exactly the same as the
+ * envoy_dynamic_module_callback_http_update_request_headers, but for the response headers.
+ * See the comments on envoy_dynamic_module_callback_http_update_request_headers for more details.
+ */
+bool envoy_dynamic_module_callback_http_update_response_headers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length);
+
+/**
+ * envoy_dynamic_module_callback_http_update_response_trailers is exactly the same as the
+ * envoy_dynamic_module_callback_http_update_request_headers, but for the response trailers.
+ * See the comments on envoy_dynamic_module_callback_http_update_request_headers for more details.
+ */
+bool envoy_dynamic_module_callback_http_update_response_trailers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length);
+
 /**
  * envoy_dynamic_module_callback_http_send_response is called by the module to send the response
  * to the downstream.
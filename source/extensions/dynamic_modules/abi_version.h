@@ -6,7 +6,7 @@ namespace DynamicModules {
 #endif
 // This is the ABI version calculated as a sha256 hash of the ABI header files. When the ABI
 // changes, this value must change, and the correctness of this value is checked by the test.
-const char* kAbiVersion = "f2712929b605772d35c34d9ac8ccd7e168197a50951e9c96b64e03256bf80265";
+const char* kAbiVersion = "162fc580349d5eec832239c9e21fce2458bc5cd1a5046893c626782c75819757";
 
 #ifdef __cplusplus
 } // namespace DynamicModules
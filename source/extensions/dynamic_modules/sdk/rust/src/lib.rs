@@ -698,6 +698,24 @@ pub trait EnvoyHttpFilter {
   /// Returns true if the trailer is removed successfully.
   fn remove_response_trailer(&mut self, key: &str) -> bool;
 
+  /// Set or remove many request headers at once, in the given order.
+  ///
+  /// The headers are passed as a list of key-value pairs, where a `None` value removes the
+  /// header. This is equivalent to calling [`EnvoyHttpFilter::set_request_header`] or
+  /// [`EnvoyHttpFilter::remove_request_header`] for each of them, but in a single call to Envoy.
+  ///
+  /// Returns true if the headers are updated successfully.
+  fn update_request_headers<'a>(&mut self, headers: Vec<(&'a str, Option<&'a [u8]>)>) -> bool;
+
+  /// Same as [`EnvoyHttpFilter::update_request_headers`], but for the request trailers.
+  fn update_request_trailers<'a>(&mut self, trailers: Vec<(&'a str, Option<&'a [u8]>)>) -> bool;
+
+  /// Same as [`EnvoyHttpFilter::update_request_headers`], but for the response headers.
+  fn update_response_headers<'a>(&mut self, headers: Vec<(&'a str, Option<&'a [u8]>)>) -> bool;
+
+  /// Same as [`EnvoyHttpFilter::update_request_headers`], but for the response trailers.
+  fn update_response_trailers<'a>(&mut self, trailers: Vec<(&'a str, Option<&'a [u8]>)>) -> bool;
+
   /// Send a response to the downstream with the given status code, headers, and body.
   ///
   /// The headers are passed as a list of key-value pairs.
@@ -1535,6 +1553,34 @@ impl EnvoyHttpFilter for EnvoyHttpFilterImpl {
     }
   }
 
+  fn update_request_headers(&mut self, headers: Vec<(&str, Option<&[u8]>)>) -> bool {
+    self.update_headers_impl(
+      headers,
+      abi::envoy_dynamic_module_callback_http_update_request_headers,
+    )
+  }
+
+  fn update_request_trailers(&mut self, trailers: Vec<(&str, Option<&[u8]>)>) -> bool {
+    self.update_headers_impl(
+      trailers,
+      abi::envoy_dynamic_module_callback_http_update_request_trailers,
+    )
+  }
+
+  fn update_response_headers(&mut self, headers: Vec<(&str, Option<&[u8]>)>) -> bool {
+    self.update_headers_impl(
+      headers,
+      abi::envoy_dynamic_module_callback_http_update_response_headers,
+    )
+  }
+
+  fn update_response_trailers(&mut self, trailers: Vec<(&str, Option<&[u8]>)>) -> bool {
+    self.update_headers_impl(
+      trailers,
+      abi::envoy_dynamic_module_callback_http_update_response_trailers,
+    )
+  }
+
   fn get_attribute_string(
     &self,
     attribute_id: abi::envoy_dynamic_module_type_attribute_id,
@@ -1854,6 +1900,36 @@ impl EnvoyHttpFilterImpl {
     }
   }
 
+  /// Implement the common logic for setting or removing many headers/trailers at once.
+  fn update_headers_impl(
+    &mut self,
+    headers: Vec<(&str, Option<&[u8]>)>,
+    callback: unsafe extern "C" fn(
+      filter_envoy_ptr: abi::envoy_dynamic_module_type_http_filter_envoy_ptr,
+      headers: *mut abi::envoy_dynamic_module_type_module_http_header,
+      headers_length: usize,
+    ) -> bool,
+  ) -> bool {
+    let mut module_headers: Vec<abi::envoy_dynamic_module_type_module_http_header> = headers
+      .iter()
+      .map(
+        |(key, value)| abi::envoy_dynamic_module_type_module_http_header {
+          key_ptr: key.as_ptr() as *mut _,
+          key_length: key.len(),
+          value_ptr: value.map_or(std::ptr::null_mut(), |v| v.as_ptr() as *mut _),
+          value_length: value.map_or(0, |v| v.len()),
+        },
+      )
+      .collect();
+    unsafe {
+      callback(
+        self.raw_ptr,
+        module_headers.as_mut_ptr(),
+        module_headers.len(),
+      )
+    }
+  }
+
   /// This implements the common logic for getting the header/trailer values.
   fn get_header_value_impl(
     &self,
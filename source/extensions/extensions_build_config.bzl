@@ -350,7 +350,9 @@ EXTENSIONS = {
     "envoy.extensions.http.cache.file_system_http_cache":    "//source/extensions/http/cache/file_system_http_cache:config",
     "envoy.extensions.http.cache.simple":                    "//source/extensions/http/cache/simple_http_cache:config",
     "envoy.extensions.http.cache_v2.file_system_http_cache": "//source/extensions/http/cache_v2/file_system_http_cache:config",
+    "envoy.extensions.http.cache_v2.memory_http_cache":      "//source/extensions/http/cache_v2/memory_http_cache:config",
     "envoy.extensions.http.cache_v2.simple":                 "//source/extensions/http/cache_v2/simple_http_cache:config",
+    "envoy.extensions.http.cache_v2.tiered_http_cache":      "//source/extensions/http/cache_v2/tiered_http_cache:config",
 
     #
     # Internal redirect predicates
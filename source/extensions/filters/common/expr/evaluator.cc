@@ -159,6 +159,9 @@ CompiledExpression::Create(const BuilderInstanceSharedConstPtr& builder,
     return cel_expression_status.status();
   }
   out.expr_ = std::move(cel_expression_status.value());
+  if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.cel_specialized_expressions")) {
+    out.specialized_expr_ = SpecializedExpression::create(out.source_expr_);
+  }
   return out;
 }
 
@@ -203,6 +206,12 @@ absl::optional<CelValue> CompiledExpression::evaluate(
     const StreamInfo::StreamInfo& info, const ::Envoy::Http::RequestHeaderMap* request_headers,
     const ::Envoy::Http::ResponseHeaderMap* response_headers,
     const ::Envoy::Http::ResponseTrailerMap* response_trailers) const {
+  if (specialized_expr_ != nullptr) {
+    auto result = specialized_expr_->evaluate(arena, info, request_headers);
+    if (result.has_value()) {
+      return result;
+    }
+  }
   auto activation =
       createActivation(local_info, info, request_headers, response_headers, response_trailers);
   auto eval_status = expr_->Evaluate(*activation, &arena);
@@ -221,6 +230,12 @@ absl::StatusOr<CelValue> CompiledExpression::evaluate(const Activation& activati
 bool CompiledExpression::matches(const StreamInfo::StreamInfo& info,
                                  const Http::RequestHeaderMap& headers) const {
   Protobuf::Arena arena;
+  if (specialized_expr_ != nullptr) {
+    const absl::optional<bool> result = specialized_expr_->matches(arena, info, &headers);
+    if (result.has_value()) {
+      return result.value();
+    }
+  }
   auto eval_status = evaluate(arena, nullptr, info, &headers, nullptr, nullptr);
   if (!eval_status.has_value()) {
     return false;
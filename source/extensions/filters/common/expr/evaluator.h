@@ -5,6 +5,7 @@
 #include "source/common/http/headers.h"
 #include "source/common/protobuf/protobuf.h"
 #include "source/extensions/filters/common/expr/context.h"
+#include "source/extensions/filters/common/expr/specialized_expression.h"
 
 // CEL-CPP does not enforce unused parameter checks consistently, so we relax it here.
 
@@ -134,6 +135,8 @@ private:
   const BuilderInstanceSharedConstPtr builder_;
   const cel::expr::Expr source_expr_;
   ExpressionPtr expr_;
+  // Set if the expression only uses the subset the interpreter can be bypassed for.
+  SpecializedExpressionConstPtr specialized_expr_;
 };
 
 // Returns a string for a CelValue.
@@ -0,0 +1,645 @@
+#include "source/extensions/filters/common/expr/specialized_expression.h"
+
+#include "source/common/common/macros.h"
+#include "source/common/http/header_utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace Expr {
+
+namespace {
+
+// What a request is evaluated with.
+struct Context {
+  Protobuf::Arena& arena_;
+  const StreamInfo::StreamInfo& info_;
+  const Http::RequestHeaderMap* request_headers_;
+};
+
+// The result of evaluating a subexpression: a value, a CEL error, or a fallback to the
+// interpreter.
+struct Result {
+  enum class Type { Value, Error, Fallback };
+
+  static Result value(CelValue cel_value) { return {Type::Value, cel_value}; }
+  static Result boolean(bool boolean_value) { return value(CelValue::CreateBool(boolean_value)); }
+  static Result error() { return {Type::Error, CelValue::CreateNull()}; }
+  static Result fallback() { return {Type::Fallback, CelValue::CreateNull()}; }
+  // The attribute lookups return absl::nullopt when the interpreter fails with "no such key".
+  static Result lookup(const absl::optional<CelValue>& found) {
+    return found.has_value() ? value(found.value()) : error();
+  }
+
+  bool isBool(bool expected) const {
+    return type_ == Type::Value && value_.IsBool() && value_.BoolOrDie() == expected;
+  }
+
+  Type type_;
+  CelValue value_;
+};
+
+// Returns the result of a strict function if any of its arguments is not a value.
+absl::optional<Result> strictArguments(const Result& left, const Result& right) {
+  if (left.type_ == Result::Type::Fallback || right.type_ == Result::Type::Fallback) {
+    return Result::fallback();
+  }
+  if (left.type_ == Result::Type::Error || right.type_ == Result::Type::Error) {
+    return Result::error();
+  }
+  return absl::nullopt;
+}
+
+enum class Comparison { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+
+using Comparisons = absl::flat_hash_map<absl::string_view, Comparison>;
+
+const Comparisons& getComparisons() {
+  CONSTRUCT_ON_FIRST_USE(Comparisons, {{"_==_", Comparison::Equal},
+                                       {"_!=_", Comparison::NotEqual},
+                                       {"_<_", Comparison::Less},
+                                       {"_<=_", Comparison::LessEqual},
+                                       {"_>_", Comparison::Greater},
+                                       {"_>=_", Comparison::GreaterEqual}});
+}
+
+template <class T> Result compare(Comparison comparison, const T& left, const T& right) {
+  switch (comparison) {
+  case Comparison::Equal:
+    return Result::boolean(left == right);
+  case Comparison::NotEqual:
+    return Result::boolean(left != right);
+  case Comparison::Less:
+    return Result::boolean(left < right);
+  case Comparison::LessEqual:
+    return Result::boolean(left <= right);
+  case Comparison::Greater:
+    return Result::boolean(left > right);
+  case Comparison::GreaterEqual:
+    return Result::boolean(left >= right);
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+Result compare(Comparison comparison, const Result& left, const Result& right) {
+  if (const auto result = strictArguments(left, right); result.has_value()) {
+    return result.value();
+  }
+  // Comparing values of different types depends on the heterogeneous equality option.
+  if (left.value_.type() != right.value_.type()) {
+    return Result::fallback();
+  }
+  switch (left.value_.type()) {
+  case CelValue::Type::kBool:
+    return compare(comparison, left.value_.BoolOrDie(), right.value_.BoolOrDie());
+  case CelValue::Type::kInt64:
+    return compare(comparison, left.value_.Int64OrDie(), right.value_.Int64OrDie());
+  case CelValue::Type::kDouble:
+    return compare(comparison, left.value_.DoubleOrDie(), right.value_.DoubleOrDie());
+  case CelValue::Type::kString:
+    return compare(comparison, left.value_.StringOrDie().value(),
+                   right.value_.StringOrDie().value());
+  default:
+    return Result::fallback();
+  }
+}
+
+enum class StringFunction { StartsWith, EndsWith, Contains };
+
+Result callStringFunction(StringFunction function, const Result& target, const Result& argument) {
+  if (const auto result = strictArguments(target, argument); result.has_value()) {
+    return result.value();
+  }
+  if (!target.value_.IsString() || !argument.value_.IsString()) {
+    return Result::fallback();
+  }
+  const absl::string_view string = target.value_.StringOrDie().value();
+  const absl::string_view substring = argument.value_.StringOrDie().value();
+  switch (function) {
+  case StringFunction::StartsWith:
+    return Result::boolean(absl::StartsWith(string, substring));
+  case StringFunction::EndsWith:
+    return Result::boolean(absl::EndsWith(string, substring));
+  case StringFunction::Contains:
+    return Result::boolean(absl::StrContains(string, substring));
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+// Combines the sides of `&&` if absorbing is false, or `||` if it is true. As in CEL, either side
+// evaluating to the absorbing value decides the result, even if the other one is an error.
+Result logical(bool absorbing, const Result& left, const Result& right) {
+  if (left.isBool(absorbing) || right.isBool(absorbing)) {
+    return Result::boolean(absorbing);
+  }
+  const auto non_bool = [](const Result& result) {
+    return result.type_ == Result::Type::Fallback ||
+           (result.type_ == Result::Type::Value && !result.value_.IsBool());
+  };
+  if (non_bool(left) || non_bool(right)) {
+    return Result::fallback();
+  }
+  if (left.type_ == Result::Type::Error || right.type_ == Result::Type::Error) {
+    return Result::error();
+  }
+  return Result::boolean(!absorbing);
+}
+
+Result logicalNot(const Result& operand) {
+  if (operand.type_ != Result::Type::Value) {
+    return operand;
+  }
+  if (!operand.value_.IsBool()) {
+    return Result::fallback();
+  }
+  return Result::boolean(!operand.value_.BoolOrDie());
+}
+
+} // namespace
+
+class SpecializedExpression::Node {
+public:
+  virtual ~Node() = default;
+
+  virtual Result evaluate(const Context& context) const PURE;
+
+  // Whether the node only evaluates to booleans, besides errors and fallbacks.
+  virtual bool boolean() const { return true; }
+
+  // Returns the value of the node if it is a constant.
+  virtual const CelValue* constant() const { return nullptr; }
+};
+
+namespace {
+
+using Node = SpecializedExpression::Node;
+using NodeConstPtr = SpecializedExpression::NodeConstPtr;
+
+class ConstantNode : public Node {
+public:
+  explicit ConstantNode(bool value) : value_(CelValue::CreateBool(value)) {}
+  explicit ConstantNode(int64_t value) : value_(CelValue::CreateInt64(value)) {}
+  explicit ConstantNode(double value) : value_(CelValue::CreateDouble(value)) {}
+  explicit ConstantNode(std::string value)
+      : string_(std::move(value)), value_(CelValue::CreateStringView(string_)) {}
+
+  Result evaluate(const Context&) const override { return Result::value(value_); }
+  bool boolean() const override { return value_.IsBool(); }
+  const CelValue* constant() const override { return &value_; }
+
+private:
+  const std::string string_;
+  const CelValue value_;
+};
+
+// Folds the result of a node with constant operands. Returns nullptr if the result is not a value,
+// which the interpreter evaluates instead.
+NodeConstPtr fold(const Result& result) {
+  if (result.type_ != Result::Type::Value || !result.value_.IsBool()) {
+    return nullptr;
+  }
+  return std::make_unique<ConstantNode>(result.value_.BoolOrDie());
+}
+
+class ComparisonNode : public Node {
+public:
+  ComparisonNode(Comparison comparison, NodeConstPtr left, NodeConstPtr right)
+      : comparison_(comparison), left_(std::move(left)), right_(std::move(right)) {}
+
+  Result evaluate(const Context& context) const override {
+    return compare(comparison_, left_->evaluate(context), right_->evaluate(context));
+  }
+
+private:
+  const Comparison comparison_;
+  const NodeConstPtr left_;
+  const NodeConstPtr right_;
+};
+
+class StringFunctionNode : public Node {
+public:
+  StringFunctionNode(StringFunction function, NodeConstPtr target, NodeConstPtr argument)
+      : function_(function), target_(std::move(target)), argument_(std::move(argument)) {}
+
+  Result evaluate(const Context& context) const override {
+    return callStringFunction(function_, target_->evaluate(context), argument_->evaluate(context));
+  }
+
+private:
+  const StringFunction function_;
+  const NodeConstPtr target_;
+  const NodeConstPtr argument_;
+};
+
+class LogicalNode : public Node {
+public:
+  LogicalNode(bool absorbing, NodeConstPtr left, NodeConstPtr right)
+      : absorbing_(absorbing), left_(std::move(left)), right_(std::move(right)) {}
+
+  Result evaluate(const Context& context) const override {
+    const Result left = left_->evaluate(context);
+    if (left.isBool(absorbing_)) {
+      return left;
+    }
+    return logical(absorbing_, left, right_->evaluate(context));
+  }
+
+private:
+  const bool absorbing_;
+  const NodeConstPtr left_;
+  const NodeConstPtr right_;
+};
+
+class NotNode : public Node {
+public:
+  explicit NotNode(NodeConstPtr operand) : operand_(std::move(operand)) {}
+
+  Result evaluate(const Context& context) const override {
+    return logicalNot(operand_->evaluate(context));
+  }
+
+private:
+  const NodeConstPtr operand_;
+};
+
+// The attribute nodes look up the same values as the activation wrappers, with the lookup tables
+// resolved when the expression is compiled.
+class AttributeNode : public Node {
+public:
+  bool boolean() const override { return false; }
+};
+
+class RequestNode : public AttributeNode {
+public:
+  explicit RequestNode(CelValueExtractor extractor) : extractor_(std::move(extractor)) {}
+
+  Result evaluate(const Context& context) const override {
+    const RequestWrapper wrapper(context.arena_, context.request_headers_, context.info_);
+    return Result::lookup(extractor_(wrapper));
+  }
+
+private:
+  const CelValueExtractor extractor_;
+};
+
+class RequestHeaderNode : public AttributeNode {
+public:
+  explicit RequestHeaderNode(absl::string_view name) : name_(name) {}
+
+  Result evaluate(const Context& context) const override {
+    if (context.request_headers_ == nullptr) {
+      return Result::error();
+    }
+    return Result::lookup(convertHeaderEntry(
+        context.arena_,
+        Http::HeaderUtility::getAllOfHeaderAsString(*context.request_headers_, name_)));
+  }
+
+private:
+  const Http::LowerCaseString name_;
+};
+
+class PeerNode : public AttributeNode {
+public:
+  PeerNode(bool local, absl::string_view field) : local_(local), field_(field) {}
+
+  Result evaluate(const Context& context) const override {
+    const PeerWrapper wrapper(context.arena_, context.info_, local_);
+    return Result::lookup(wrapper[CelValue::CreateStringView(field_)]);
+  }
+
+private:
+  const bool local_;
+  const std::string field_;
+};
+
+class ConnectionNode : public AttributeNode {
+public:
+  explicit ConnectionNode(ConnectionValueExtractor extractor) : extractor_(std::move(extractor)) {}
+
+  Result evaluate(const Context& context) const override {
+    const ConnectionWrapper wrapper(context.arena_, context.info_);
+    return Result::lookup(extractor_(wrapper));
+  }
+
+private:
+  const ConnectionValueExtractor extractor_;
+};
+
+class DownstreamSslNode : public AttributeNode {
+public:
+  explicit DownstreamSslNode(SslExtractor extractor) : extractor_(std::move(extractor)) {}
+
+  Result evaluate(const Context& context) const override {
+    const auto ssl = context.info_.downstreamAddressProvider().sslConnection();
+    if (ssl == nullptr) {
+      return Result::error();
+    }
+    return Result::lookup(extractor_(*ssl));
+  }
+
+private:
+  const SslExtractor extractor_;
+};
+
+// A value in the dynamic metadata of a filter, at a path of struct fields.
+class MetadataNode : public AttributeNode {
+public:
+  MetadataNode(std::string filter, std::vector<std::string> path)
+      : filter_(std::move(filter)), path_(std::move(path)) {}
+
+  Result evaluate(const Context& context) const override {
+    const auto& filter_metadata = context.info_.dynamicMetadata().filter_metadata();
+    const auto it = filter_metadata.find(filter_);
+    if (it == filter_metadata.end()) {
+      return Result::error();
+    }
+    const Protobuf::Struct* fields = &it->second;
+    const Protobuf::Value* value = nullptr;
+    for (const std::string& key : path_) {
+      if (value != nullptr) {
+        if (value->kind_case() != Protobuf::Value::kStructValue) {
+          return Result::fallback();
+        }
+        fields = &value->struct_value();
+      }
+      const auto field = fields->fields().find(key);
+      if (field == fields->fields().end()) {
+        return Result::error();
+      }
+      value = &field->second;
+    }
+    switch (value->kind_case()) {
+    case Protobuf::Value::kStringValue:
+      return Result::value(CelValue::CreateStringView(value->string_value()));
+    case Protobuf::Value::kNumberValue:
+      return Result::value(CelValue::CreateDouble(value->number_value()));
+    case Protobuf::Value::kBoolValue:
+      return Result::value(CelValue::CreateBool(value->bool_value()));
+    default:
+      // Nulls, lists and structs are left to the interpreter.
+      return Result::fallback();
+    }
+  }
+
+private:
+  const std::string filter_;
+  const std::vector<std::string> path_;
+};
+
+// Collects the identifier, fields and constant keys an attribute is selected with, e.g.
+// ["request", "headers", "x-tenant"] for `request.headers['x-tenant']`.
+bool attributePath(const cel::expr::Expr& expr, std::vector<std::string>& path) {
+  switch (expr.expr_kind_case()) {
+  case cel::expr::Expr::ExprKindCase::kIdentExpr:
+    path.push_back(expr.ident_expr().name());
+    return true;
+  case cel::expr::Expr::ExprKindCase::kSelectExpr:
+    if (expr.select_expr().test_only() || !attributePath(expr.select_expr().operand(), path)) {
+      return false;
+    }
+    path.push_back(expr.select_expr().field());
+    return true;
+  case cel::expr::Expr::ExprKindCase::kCallExpr: {
+    const cel::expr::Expr::Call& call = expr.call_expr();
+    if (call.function() != "_[_]" || call.has_target() || call.args_size() != 2 ||
+        call.args(1).const_expr().constant_kind_case() !=
+            cel::expr::Constant::ConstantKindCase::kStringValue ||
+        !attributePath(call.args(0), path)) {
+      return false;
+    }
+    path.push_back(call.args(1).const_expr().string_value());
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+NodeConstPtr compileAttribute(std::vector<std::string>&& path) {
+  if (path.size() < 2) {
+    return nullptr;
+  }
+  const std::string& root = path[0];
+  const std::string& field = path[1];
+  if (root == Request) {
+    if (field == Headers) {
+      if (path.size() != 3 || !Http::HeaderUtility::headerNameIsValid(path[2])) {
+        return nullptr;
+      }
+      return std::make_unique<RequestHeaderNode>(path[2]);
+    }
+    const auto& lookup = RequestLookupValues::get().request_lookup_;
+    const auto it = lookup.find(field);
+    if (path.size() != 2 || it == lookup.end()) {
+      return nullptr;
+    }
+    return std::make_unique<RequestNode>(it->second);
+  }
+  if (root == Source || root == Destination) {
+    if (path.size() != 2 || (field != Address && field != Port)) {
+      return nullptr;
+    }
+    return std::make_unique<PeerNode>(root == Destination, field);
+  }
+  if (root == Connection) {
+    if (path.size() != 2) {
+      return nullptr;
+    }
+    const auto& lookup = ConnectionLookupValues::get().connection_lookup_;
+    if (const auto it = lookup.find(field); it != lookup.end()) {
+      return std::make_unique<ConnectionNode>(it->second);
+    }
+    const auto& extractors = SslExtractorsValues::get().extractors_;
+    if (const auto it = extractors.find(field); it != extractors.end()) {
+      return std::make_unique<DownstreamSslNode>(it->second);
+    }
+    return nullptr;
+  }
+  // Values of the metadata structs, rather than the structs.
+  if (root == Metadata && field == "filter_metadata" && path.size() >= 4) {
+    std::vector<std::string> keys(std::make_move_iterator(path.begin() + 3),
+                                  std::make_move_iterator(path.end()));
+    return std::make_unique<MetadataNode>(std::move(path[2]), std::move(keys));
+  }
+  return nullptr;
+}
+
+NodeConstPtr compileConstant(const cel::expr::Constant& constant) {
+  switch (constant.constant_kind_case()) {
+  case cel::expr::Constant::ConstantKindCase::kBoolValue:
+    return std::make_unique<ConstantNode>(constant.bool_value());
+  case cel::expr::Constant::ConstantKindCase::kInt64Value:
+    return std::make_unique<ConstantNode>(static_cast<int64_t>(constant.int64_value()));
+  case cel::expr::Constant::ConstantKindCase::kDoubleValue:
+    return std::make_unique<ConstantNode>(constant.double_value());
+  case cel::expr::Constant::ConstantKindCase::kStringValue:
+    return std::make_unique<ConstantNode>(constant.string_value());
+  default:
+    return nullptr;
+  }
+}
+
+NodeConstPtr compile(const cel::expr::Expr& expr);
+
+NodeConstPtr compileComparison(Comparison comparison, const cel::expr::Expr::Call& call) {
+  NodeConstPtr left = compile(call.args(0));
+  NodeConstPtr right = compile(call.args(1));
+  if (left == nullptr || right == nullptr) {
+    return nullptr;
+  }
+  if (left->constant() != nullptr && right->constant() != nullptr) {
+    return fold(compare(comparison, Result::value(*left->constant()),
+                        Result::value(*right->constant())));
+  }
+  return std::make_unique<ComparisonNode>(comparison, std::move(left), std::move(right));
+}
+
+NodeConstPtr compileStringFunction(StringFunction function, const cel::expr::Expr::Call& call) {
+  NodeConstPtr target = compile(call.target());
+  NodeConstPtr argument = compile(call.args(0));
+  if (target == nullptr || argument == nullptr) {
+    return nullptr;
+  }
+  if (target->constant() != nullptr && argument->constant() != nullptr) {
+    return fold(callStringFunction(function, Result::value(*target->constant()),
+                                   Result::value(*argument->constant())));
+  }
+  return std::make_unique<StringFunctionNode>(function, std::move(target), std::move(argument));
+}
+
+NodeConstPtr compileLogical(bool absorbing, const cel::expr::Expr::Call& call) {
+  NodeConstPtr left = compile(call.args(0));
+  NodeConstPtr right = compile(call.args(1));
+  if (left == nullptr || right == nullptr) {
+    return nullptr;
+  }
+  const CelValue* left_constant = left->constant();
+  const CelValue* right_constant = right->constant();
+  if (left_constant != nullptr && right_constant != nullptr) {
+    return fold(logical(absorbing, Result::value(*left_constant), Result::value(*right_constant)));
+  }
+  // `false && x` is false and `true && x` is x, for any boolean x.
+  for (auto [constant, other] : {std::make_pair(left_constant, &right),
+                                 std::make_pair(right_constant, &left)}) {
+    if (constant == nullptr || !constant->IsBool()) {
+      continue;
+    }
+    if (constant->BoolOrDie() == absorbing) {
+      return std::make_unique<ConstantNode>(absorbing);
+    }
+    if ((*other)->boolean()) {
+      return std::move(*other);
+    }
+  }
+  return std::make_unique<LogicalNode>(absorbing, std::move(left), std::move(right));
+}
+
+NodeConstPtr compileCall(const cel::expr::Expr::Call& call) {
+  const std::string& function = call.function();
+  if (call.has_target()) {
+    if (call.args_size() != 1) {
+      return nullptr;
+    }
+    if (function == "startsWith") {
+      return compileStringFunction(StringFunction::StartsWith, call);
+    }
+    if (function == "endsWith") {
+      return compileStringFunction(StringFunction::EndsWith, call);
+    }
+    if (function == "contains") {
+      return compileStringFunction(StringFunction::Contains, call);
+    }
+    return nullptr;
+  }
+  if (function == "!_" && call.args_size() == 1) {
+    NodeConstPtr operand = compile(call.args(0));
+    if (operand == nullptr) {
+      return nullptr;
+    }
+    if (operand->constant() != nullptr) {
+      return fold(logicalNot(Result::value(*operand->constant())));
+    }
+    return std::make_unique<NotNode>(std::move(operand));
+  }
+  if (call.args_size() != 2) {
+    return nullptr;
+  }
+  if (function == "_&&_") {
+    return compileLogical(false, call);
+  }
+  if (function == "_||_") {
+    return compileLogical(true, call);
+  }
+  const Comparisons& comparisons = getComparisons();
+  if (const auto it = comparisons.find(function); it != comparisons.end()) {
+    return compileComparison(it->second, call);
+  }
+  return nullptr;
+}
+
+NodeConstPtr compile(const cel::expr::Expr& expr) {
+  if (expr.has_const_expr()) {
+    return compileConstant(expr.const_expr());
+  }
+  if (expr.has_call_expr() && expr.call_expr().function() != "_[_]") {
+    return compileCall(expr.call_expr());
+  }
+  std::vector<std::string> path;
+  if (!attributePath(expr, path)) {
+    return nullptr;
+  }
+  return compileAttribute(std::move(path));
+}
+
+} // namespace
+
+SpecializedExpression::SpecializedExpression(NodeConstPtr root) : root_(std::move(root)) {}
+
+SpecializedExpression::~SpecializedExpression() = default;
+
+std::unique_ptr<const SpecializedExpression>
+SpecializedExpression::create(const cel::expr::Expr& expr) {
+  NodeConstPtr root = compile(expr);
+  if (root == nullptr) {
+    return nullptr;
+  }
+  return absl::WrapUnique(new SpecializedExpression(std::move(root)));
+}
+
+absl::optional<CelValue>
+SpecializedExpression::evaluate(Protobuf::Arena& arena, const StreamInfo::StreamInfo& info,
+                                const Http::RequestHeaderMap* request_headers) const {
+  const Result result = root_->evaluate(Context{arena, info, request_headers});
+  if (result.type_ != Result::Type::Value) {
+    // The interpreter reports the error.
+    return absl::nullopt;
+  }
+  return result.value_;
+}
+
+absl::optional<bool>
+SpecializedExpression::matches(Protobuf::Arena& arena, const StreamInfo::StreamInfo& info,
+                               const Http::RequestHeaderMap* request_headers) const {
+  const Result result = root_->evaluate(Context{arena, info, request_headers});
+  switch (result.type_) {
+  case Result::Type::Value:
+    return result.value_.IsBool() && result.value_.BoolOrDie();
+  case Result::Type::Error:
+    return false;
+  case Result::Type::Fallback:
+    return absl::nullopt;
+  }
+  PANIC_DUE_TO_CORRUPT_ENUM;
+}
+
+} // namespace Expr
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "envoy/http/header_map.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "source/common/protobuf/protobuf.h"
+#include "source/extensions/filters/common/expr/context.h"
+
+#include "cel/expr/syntax.pb.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace Expr {
+
+// A CEL expression over the common request, peer, connection and dynamic metadata attributes,
+// compiled ahead of time into a tree that looks the attributes up directly and compares them
+// without the interpreter, nor the arena-allocated activation wrappers. Constant subexpressions
+// are folded when it is created.
+//
+// Only the comparisons, string functions and logical operators whose CEL semantics do not depend
+// on the interpreter options are supported. An evaluation producing an error, or values of other
+// types, is left to the interpreter.
+class SpecializedExpression {
+public:
+  ~SpecializedExpression();
+
+  // Returns nullptr if the expression uses anything else than the supported subset.
+  static std::unique_ptr<const SpecializedExpression> create(const cel::expr::Expr& expr);
+
+  // Evaluates the expression for a request. Returns absl::nullopt if the interpreter must evaluate
+  // the expression instead. The arena only holds the values of headers present more than once.
+  absl::optional<CelValue> evaluate(Protobuf::Arena& arena, const StreamInfo::StreamInfo& info,
+                                    const Http::RequestHeaderMap* request_headers) const;
+
+  // Returns whether the expression evaluates to "true" for a request, or absl::nullopt if the
+  // interpreter must evaluate the expression instead.
+  absl::optional<bool> matches(Protobuf::Arena& arena, const StreamInfo::StreamInfo& info,
+                               const Http::RequestHeaderMap* request_headers) const;
+
+  class Node;
+  using NodeConstPtr = std::unique_ptr<const Node>;
+
+private:
+  explicit SpecializedExpression(NodeConstPtr root);
+
+  const NodeConstPtr root_;
+};
+
+using SpecializedExpressionConstPtr = std::unique_ptr<const SpecializedExpression>;
+
+} // namespace Expr
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
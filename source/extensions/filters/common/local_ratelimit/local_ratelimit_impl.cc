@@ -1,7 +1,9 @@
 #include "source/extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <limits>
 #include <memory>
 
 #include "envoy/runtime/runtime.h"
@@ -9,6 +11,8 @@
 #include "source/common/protobuf/utility.h"
 #include "source/common/runtime/runtime_features.h"
 
+#include "absl/numeric/bits.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
@@ -17,6 +21,19 @@ namespace LocalRateLimit {
 
 SINGLETON_MANAGER_REGISTRATION(local_ratelimit_share_provider_manager);
 
+namespace {
+
+// When the number of shards of dynamic descriptors is not configured, each shard keeps at least
+// this many values, up to the max shards.
+constexpr uint32_t DefaultShardSize = 64;
+constexpr uint32_t MaxDefaultShards = 16;
+// The number of counts per row of the request counts sketch, of which there are a few per value.
+constexpr uint64_t SketchCountsPerValue = 8;
+constexpr uint64_t MinSketchWidth = 256;
+constexpr uint64_t MaxSketchWidth = 1 << 14;
+
+} // namespace
+
 class DefaultEvenShareMonitor : public ShareProviderManager::ShareMonitor {
 public:
   double getTokensShareFactor() const override { return share_factor_.load(); }
@@ -76,16 +93,79 @@ ShareProviderManagerSharedPtr ShareProviderManager::singleton(Event::Dispatcher&
 
 RateLimitTokenBucket::RateLimitTokenBucket(uint64_t max_tokens, uint64_t tokens_per_fill,
                                            std::chrono::milliseconds fill_interval,
-                                           TimeSource& time_source)
-    : token_bucket_(max_tokens, time_source,
-                    // Calculate the fill rate in tokens per second.
-                    tokens_per_fill / std::chrono::duration<double>(fill_interval).count()),
-      fill_interval_(fill_interval) {}
+                                           TimeSource& time_source,
+                                           OptRef<const TokenBucketSharding> sharding)
+    : token_bucket_(std::make_shared<AtomicTokenBucketImpl>(
+          max_tokens, time_source,
+          // Calculate the fill rate in tokens per second.
+          tokens_per_fill / std::chrono::duration<double>(fill_interval).count())),
+      fill_interval_(fill_interval) {
+  if (!sharding.has_value()) {
+    return;
+  }
+  // A worker takes at least one token at a time.
+  worker_batch_ = std::max(1.0, max_tokens * sharding->worker_batch_percent_ / 100);
+  const std::chrono::milliseconds rebalance_interval = sharding->rebalance_interval_;
+  worker_tokens_ = ThreadLocal::TypedSlot<WorkerTokens>::makeUnique(sharding->tls_);
+  worker_tokens_->set(
+      [token_bucket = token_bucket_, rebalance_interval](Event::Dispatcher& dispatcher) {
+        return std::make_shared<WorkerTokens>(token_bucket, dispatcher, rebalance_interval);
+      });
+}
 
 bool RateLimitTokenBucket::consume(double factor, uint64_t to_consume) {
   ASSERT(!(factor <= 0.0 || factor > 1.0));
+  if (worker_tokens_ != nullptr) {
+    return (*worker_tokens_)->consume(to_consume / factor, worker_batch_);
+  }
   auto cb = [tokens = to_consume / factor](double total) { return total < tokens ? 0.0 : tokens; };
-  return token_bucket_.consume(cb) != 0.0;
+  return token_bucket_->consume(cb) != 0.0;
+}
+
+uint64_t RateLimitTokenBucket::remainingTokens() const {
+  double remaining = token_bucket_->remainingTokens();
+  if (worker_tokens_ != nullptr) {
+    // Tokens held by other workers are not available to this one.
+    remaining += (*worker_tokens_)->tokens();
+  }
+  return static_cast<uint64_t>(remaining);
+}
+
+RateLimitTokenBucket::WorkerTokens::WorkerTokens(
+    std::shared_ptr<AtomicTokenBucketImpl> token_bucket, Event::Dispatcher& dispatcher,
+    std::chrono::milliseconds rebalance_interval)
+    : token_bucket_(std::move(token_bucket)), rebalance_interval_(rebalance_interval),
+      rebalance_timer_(dispatcher.createTimer([this]() { returnTokens(); })) {}
+
+bool RateLimitTokenBucket::WorkerTokens::consume(double tokens, double batch) {
+  if (tokens_ < tokens) {
+    // Take what is missing, or a whole batch if the bucket has one, in a single update of the
+    // shared bucket.
+    const double missing = tokens - tokens_;
+    const double taken = token_bucket_->consume([missing, batch](double total) {
+      return total < missing ? 0.0 : std::min(total, std::max(missing, batch));
+    });
+    if (taken == 0.0) {
+      return false;
+    }
+    tokens_ += taken;
+    if (!rebalance_timer_->enabled()) {
+      rebalance_timer_->enableTimer(rebalance_interval_);
+    }
+  }
+  tokens_ -= tokens;
+  return true;
+}
+
+void RateLimitTokenBucket::WorkerTokens::returnTokens() {
+  if (tokens_ <= 0.0) {
+    return;
+  }
+  // Tokens returned to a full bucket are dropped, as they would have been had the worker not
+  // taken them.
+  token_bucket_->consume([returned = tokens_, max_tokens = token_bucket_->maxTokens()](
+                             double total) { return -std::min(returned, max_tokens - total); });
+  tokens_ = 0.0;
 }
 
 LocalRateLimiterImpl::LocalRateLimiterImpl(
@@ -94,7 +174,8 @@ LocalRateLimiterImpl::LocalRateLimiterImpl(
     const Protobuf::RepeatedPtrField<
         envoy::extensions::common::ratelimit::v3::LocalRateLimitDescriptor>& descriptors,
     bool always_consume_default_token_bucket, ShareProviderSharedPtr shared_provider,
-    uint32_t lru_size)
+    uint32_t lru_size, OptRef<const TokenBucketSharding> sharding,
+    const DynamicDescriptorOptions& dynamic_descriptor_options)
     : time_source_(dispatcher.timeSource()), share_provider_(std::move(shared_provider)),
       always_consume_default_token_bucket_(always_consume_default_token_bucket) {
   // Ignore the default token bucket if fill_interval is 0 because 0 fill_interval means nothing
@@ -103,8 +184,8 @@ LocalRateLimiterImpl::LocalRateLimiterImpl(
     if (fill_interval < std::chrono::milliseconds(50)) {
       throw EnvoyException("local rate limit token bucket fill timer must be >= 50ms");
     }
-    default_token_bucket_ = std::make_shared<RateLimitTokenBucket>(max_tokens, tokens_per_fill,
-                                                                   fill_interval, time_source_);
+    default_token_bucket_ = std::make_shared<RateLimitTokenBucket>(
+        max_tokens, tokens_per_fill, fill_interval, time_source_, sharding);
   }
 
   for (const auto& descriptor : descriptors) {
@@ -133,14 +214,14 @@ LocalRateLimiterImpl::LocalRateLimiterImpl(
     if (wildcard_found) {
       DynamicDescriptorSharedPtr dynamic_descriptor = std::make_shared<DynamicDescriptor>(
           per_descriptor_max_tokens, per_descriptor_tokens_per_fill, per_descriptor_fill_interval,
-          lru_size, dispatcher.timeSource());
+          lru_size, dispatcher.timeSource(), dynamic_descriptor_options);
       dynamic_descriptors_.addDescriptor(std::move(new_descriptor), std::move(dynamic_descriptor));
       continue;
     }
     RateLimitTokenBucketSharedPtr per_descriptor_token_bucket =
-        std::make_shared<RateLimitTokenBucket>(per_descriptor_max_tokens,
-                                               per_descriptor_tokens_per_fill,
-                                               per_descriptor_fill_interval, time_source_);
+        std::make_shared<RateLimitTokenBucket>(
+            per_descriptor_max_tokens, per_descriptor_tokens_per_fill,
+            per_descriptor_fill_interval, time_source_, sharding);
     auto result =
         descriptors_.emplace(std::move(new_descriptor), std::move(per_descriptor_token_bucket));
     if (!result.second) {
@@ -266,9 +347,9 @@ void DynamicDescriptorMap::addDescriptor(const RateLimit::LocalDescriptor& confi
 }
 
 RateLimitTokenBucketSharedPtr
-DynamicDescriptorMap::getBucket(const RateLimit::Descriptor request_descriptor) {
+DynamicDescriptorMap::getBucket(const RateLimit::Descriptor& request_descriptor) {
   for (const auto& pair : config_descriptors_) {
-    auto config_descriptor = pair.first;
+    const auto& config_descriptor = pair.first;
     if (!matchDescriptorEntries(request_descriptor.entries_, config_descriptor.entries_)) {
       continue;
     }
@@ -282,45 +363,157 @@ DynamicDescriptorMap::getBucket(const RateLimit::Descriptor request_descriptor)
 DynamicDescriptor::DynamicDescriptor(uint64_t per_descriptor_max_tokens,
                                      uint64_t per_descriptor_tokens_per_fill,
                                      std::chrono::milliseconds per_descriptor_fill_interval,
-                                     uint32_t lru_size, TimeSource& time_source)
+                                     uint32_t lru_size, TimeSource& time_source,
+                                     const DynamicDescriptorOptions& options)
     : max_tokens_(per_descriptor_max_tokens), tokens_per_fill_(per_descriptor_tokens_per_fill),
-      fill_interval_(per_descriptor_fill_interval), lru_size_(lru_size), time_source_(time_source) {
+      fill_interval_(per_descriptor_fill_interval), min_requests_(options.min_requests_),
+      stats_(options.stats_), time_source_(time_source) {
+  // Each shard keeps at least one value.
+  const uint32_t max_values = std::max(lru_size, 1u);
+  const uint32_t shards = std::min(
+      options.shards_ != 0 ? options.shards_
+                           : std::clamp(max_values / DefaultShardSize, 1u, MaxDefaultShards),
+      max_values);
+  shard_size_ = (max_values + shards - 1) / shards;
+  shards_.reserve(shards);
+  for (uint32_t i = 0; i < shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+
+  if (min_requests_ > 0) {
+    const uint64_t width = absl::bit_ceil(
+        std::clamp(max_values * SketchCountsPerValue, MinSketchWidth, MaxSketchWidth));
+    request_counts_ =
+        std::make_unique<RequestCounts>(static_cast<uint32_t>(width), options.window_, time_source);
+  }
+}
+
+DynamicDescriptor::~DynamicDescriptor() {
+  if (stats_.has_value()) {
+    stats_->dynamic_descriptors_active_.sub(size());
+  }
+}
+
+size_t DynamicDescriptor::size() const {
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    absl::ReaderMutexLock lock(&shard->lock_);
+    size += shard->entries_.size();
+  }
+  return size;
 }
 
 RateLimitTokenBucketSharedPtr
 DynamicDescriptor::addOrGetDescriptor(const RateLimit::Descriptor& request_descriptor) {
-  absl::WriterMutexLock lock(&dyn_desc_lock_);
-  auto iter = dynamic_descriptors_.find(request_descriptor);
-  if (iter != dynamic_descriptors_.end()) {
-    if (iter->second.second != lru_list_.begin()) {
-      lru_list_.splice(lru_list_.begin(), lru_list_, iter->second.second);
+  const uint64_t hash = RateLimit::Descriptor::Hash()(request_descriptor);
+  // The low bits of the hash pick the slots of the shards' tables.
+  Shard& shard = *shards_[(hash >> 32) % shards_.size()];
+  {
+    absl::ReaderMutexLock lock(&shard.lock_);
+    auto iter = shard.entries_.find(request_descriptor);
+    if (iter != shard.entries_.end()) {
+      // Only write the flag when it changes, so that workers looking up the same value do not
+      // contend on it.
+      if (!iter->second.referenced_.load(std::memory_order_relaxed)) {
+        iter->second.referenced_.store(true, std::memory_order_relaxed);
+      }
+      return iter->second.token_bucket_;
     }
-    return iter->second.first;
   }
+
+  if (request_counts_ != nullptr && request_counts_->add(hash) < min_requests_) {
+    if (stats_.has_value()) {
+      stats_->dynamic_descriptors_filtered_.inc();
+    }
+    return nullptr;
+  }
+  return addDescriptor(shard, request_descriptor);
+}
+
+RateLimitTokenBucketSharedPtr
+DynamicDescriptor::addDescriptor(Shard& shard, const RateLimit::Descriptor& request_descriptor) {
+  absl::WriterMutexLock lock(&shard.lock_);
+  // Another worker may have added the value since it was looked up.
+  auto iter = shard.entries_.find(request_descriptor);
+  if (iter != shard.entries_.end()) {
+    return iter->second.token_bucket_;
+  }
+
   // add a new descriptor to the set along with its token bucket
-  RateLimitTokenBucketSharedPtr per_descriptor_token_bucket;
   ENVOY_LOG(trace, "creating atomic token bucket for dynamic descriptor");
   ENVOY_LOG(trace, "max_tokens: {}, tokens_per_fill: {}, fill_interval: {}", max_tokens_,
             tokens_per_fill_, std::chrono::duration<double>(fill_interval_).count());
-  per_descriptor_token_bucket = std::make_shared<RateLimitTokenBucket>(
-      max_tokens_, tokens_per_fill_, fill_interval_, time_source_);
+  RateLimitTokenBucketSharedPtr per_descriptor_token_bucket =
+      std::make_shared<RateLimitTokenBucket>(max_tokens_, tokens_per_fill_, fill_interval_,
+                                             time_source_);
 
   ENVOY_LOG(trace, "DynamicDescriptor::addorGetDescriptor: adding dynamic descriptor: {}",
             request_descriptor.toString());
-  lru_list_.emplace_front(request_descriptor);
-  auto result = dynamic_descriptors_.emplace(
-      request_descriptor, std::pair(per_descriptor_token_bucket, lru_list_.begin()));
-  auto token_bucket = result.first->second.first;
-  if (lru_list_.size() > lru_size_) {
-    ENVOY_LOG(trace,
-              "DynamicDescriptor::addorGetDescriptor: lru_size({}) overflow. Removing dynamic "
-              "descriptor: {}",
-              lru_size_, lru_list_.back().toString());
-    dynamic_descriptors_.erase(lru_list_.back());
-    lru_list_.pop_back();
+  if (shard.clock_.size() < shard_size_) {
+    auto result = shard.entries_.try_emplace(request_descriptor, per_descriptor_token_bucket);
+    shard.clock_.push_back(&*result.first);
+    if (stats_.has_value()) {
+      stats_->dynamic_descriptors_active_.inc();
+    }
+    return per_descriptor_token_bucket;
+  }
+
+  // Evict the first value not looked up since the hand last passed it. If all were, the hand
+  // comes back to where it started, having cleared their flags.
+  while (shard.clock_[shard.hand_]->second.referenced_.exchange(false,
+                                                                std::memory_order_relaxed)) {
+    shard.hand_ = (shard.hand_ + 1) % shard.clock_.size();
+  }
+  ENVOY_LOG(trace,
+            "DynamicDescriptor::addorGetDescriptor: shard size({}) overflow. Removing dynamic "
+            "descriptor: {}",
+            shard_size_, shard.clock_[shard.hand_]->first.toString());
+  shard.entries_.erase(shard.entries_.find(shard.clock_[shard.hand_]->first));
+  auto result = shard.entries_.try_emplace(request_descriptor, per_descriptor_token_bucket);
+  shard.clock_[shard.hand_] = &*result.first;
+  shard.hand_ = (shard.hand_ + 1) % shard.clock_.size();
+  if (stats_.has_value()) {
+    stats_->dynamic_descriptors_evicted_.inc();
+  }
+  ASSERT(shard.clock_.size() == shard.entries_.size());
+  return per_descriptor_token_bucket;
+}
+
+DynamicDescriptor::RequestCounts::RequestCounts(uint32_t width, std::chrono::milliseconds window,
+                                                TimeSource& time_source)
+    : mask_(width - 1), window_(window), time_source_(time_source),
+      counts_(std::make_unique<std::atomic<uint32_t>[]>(Depth * width)),
+      window_end_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      (time_source_.monotonicTime() + window_).time_since_epoch())
+                      .count()) {
+  ASSERT(absl::has_single_bit(width));
+}
+
+uint32_t DynamicDescriptor::RequestCounts::add(size_t hash) {
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          time_source_.monotonicTime().time_since_epoch())
+                          .count();
+  int64_t window_end = window_end_.load(std::memory_order_relaxed);
+  if (now >= window_end &&
+      window_end_.compare_exchange_strong(
+          window_end, now + std::chrono::nanoseconds(window_).count(), std::memory_order_relaxed)) {
+    // Requests counted by other workers meanwhile may be lost, which only delays tracking their
+    // values.
+    const uint32_t size = Depth * (mask_ + 1);
+    for (uint32_t i = 0; i < size; ++i) {
+      counts_[i].store(counts_[i].load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+    }
+  }
+
+  // Each row picks a count with a different combination of the halves of the hash.
+  const uint32_t low = static_cast<uint32_t>(hash);
+  const uint32_t high = static_cast<uint32_t>(static_cast<uint64_t>(hash) >> 32) | 1;
+  uint32_t estimate = std::numeric_limits<uint32_t>::max();
+  for (uint32_t row = 0; row < Depth; ++row) {
+    std::atomic<uint32_t>& count = counts_[row * (mask_ + 1) + ((low + row * high) & mask_)];
+    estimate = std::min(estimate, count.fetch_add(1, std::memory_order_relaxed) + 1);
   }
-  ASSERT(lru_list_.size() == dynamic_descriptors_.size());
-  return token_bucket;
+  return estimate;
 }
 
 } // namespace LocalRateLimit
@@ -3,17 +3,23 @@
 #include <chrono>
 #include <ratio>
 
+#include "envoy/common/optref.h"
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/extensions/common/ratelimit/v3/ratelimit.pb.h"
 #include "envoy/ratelimit/ratelimit.h"
 #include "envoy/singleton/instance.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "source/common/common/thread_synchronizer.h"
 #include "source/common/common/token_bucket_impl.h"
 #include "source/common/protobuf/protobuf.h"
 
+#include "absl/container/node_hash_map.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
@@ -25,26 +31,109 @@ class RateLimitTokenBucket;
 using RateLimitTokenBucketSharedPtr = std::shared_ptr<RateLimitTokenBucket>;
 using ProtoLocalClusterRateLimit = envoy::extensions::common::ratelimit::v3::LocalClusterRateLimit;
 
+/**
+ * All stats of the buckets of wildcard descriptors. @see stats_macros.h
+ */
+#define ALL_DYNAMIC_DESCRIPTOR_STATS(COUNTER, GAUGE)                                               \
+  COUNTER(dynamic_descriptors_evicted)                                                             \
+  COUNTER(dynamic_descriptors_filtered)                                                            \
+  GAUGE(dynamic_descriptors_active, Accumulate)
+
+/**
+ * Struct definition for all stats of the buckets of wildcard descriptors. @see stats_macros.h
+ */
+struct DynamicDescriptorStats {
+  ALL_DYNAMIC_DESCRIPTOR_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * Configuration of how the values of wildcard descriptors get their own token buckets.
+ */
+struct DynamicDescriptorOptions {
+  // The number of independently locked shards the values are split into, each keeping an equal
+  // share of the max values. Zero picks a number from the max values.
+  uint32_t shards_{};
+  // If not zero, a value only gets its own bucket once it has been seen this many times in the
+  // current window, as estimated by a count-min sketch. Until then, its requests are handled as if
+  // they matched no descriptor.
+  uint32_t min_requests_{};
+  std::chrono::milliseconds window_{1000};
+  absl::optional<DynamicDescriptorStats> stats_;
+};
+
+/**
+ * The token buckets of the values matching a wildcard descriptor. The values are split into
+ * shards by hash, each under its own lock and evicting values with the CLOCK algorithm, so that
+ * looking up a tracked value only takes a shared lock of its shard.
+ */
 class DynamicDescriptor : public Logger::Loggable<Logger::Id::rate_limit_quota> {
 public:
   DynamicDescriptor(uint64_t max_tokens, uint64_t tokens_per_fill,
-                    std::chrono::milliseconds fill_interval, uint32_t lru_size, TimeSource&);
-  // add a new user configured descriptor to the set.
+                    std::chrono::milliseconds fill_interval, uint32_t lru_size, TimeSource&,
+                    const DynamicDescriptorOptions& options = {});
+  ~DynamicDescriptor();
+
+  // Returns the bucket of a request descriptor matching the wildcard descriptor, adding it if
+  // needed, or nullptr if its value is not tracked yet.
   RateLimitTokenBucketSharedPtr addOrGetDescriptor(const RateLimit::Descriptor& request_descriptor);
 
+  // The number of values that have a bucket.
+  size_t size() const;
+
 private:
-  using LruList = std::list<RateLimit::Descriptor>;
+  struct Entry {
+    explicit Entry(RateLimitTokenBucketSharedPtr token_bucket)
+        : token_bucket_(std::move(token_bucket)) {}
+
+    const RateLimitTokenBucketSharedPtr token_bucket_;
+    // Set when the value is looked up, and cleared when the clock hand passes it.
+    std::atomic<bool> referenced_{};
+  };
+  using EntryMap = absl::node_hash_map<RateLimit::Descriptor, Entry, RateLimit::Descriptor::Hash,
+                                       RateLimit::Descriptor::Equal>;
+
+  struct Shard {
+    mutable absl::Mutex lock_;
+    EntryMap entries_ ABSL_GUARDED_BY(lock_);
+    // The entries in the order of their slots, which the clock hand goes around to find one
+    // not referenced since it last passed to evict.
+    std::vector<EntryMap::value_type*> clock_ ABSL_GUARDED_BY(lock_);
+    size_t hand_ ABSL_GUARDED_BY(lock_){};
+  };
 
-  mutable absl::Mutex dyn_desc_lock_;
-  RateLimit::Descriptor::Map<std::pair<RateLimitTokenBucketSharedPtr, LruList::iterator>>
-      dynamic_descriptors_ ABSL_GUARDED_BY(dyn_desc_lock_);
+  // A count-min sketch of the number of times values were seen in the current window, which
+  // never under-estimates. Counts are halved when a window ends, so that values seen in the
+  // previous windows still count for part.
+  class RequestCounts {
+  public:
+    RequestCounts(uint32_t width, std::chrono::milliseconds window, TimeSource& time_source);
+
+    // Counts a request with a value of the given hash, returning the estimated count of the value.
+    uint32_t add(size_t hash);
+
+  private:
+    static constexpr uint32_t Depth = 4;
+
+    const uint32_t mask_;
+    const std::chrono::milliseconds window_;
+    TimeSource& time_source_;
+    const std::unique_ptr<std::atomic<uint32_t>[]> counts_;
+    // The monotonic time the current window ends at, in nanoseconds.
+    std::atomic<int64_t> window_end_;
+  };
+
+  RateLimitTokenBucketSharedPtr addDescriptor(Shard& shard,
+                                              const RateLimit::Descriptor& request_descriptor);
 
   uint64_t max_tokens_;
   uint64_t tokens_per_fill_;
   const std::chrono::milliseconds fill_interval_;
-  LruList lru_list_;
-  uint32_t lru_size_;
+  const uint32_t min_requests_;
+  const absl::optional<DynamicDescriptorStats> stats_;
   TimeSource& time_source_;
+  uint32_t shard_size_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::unique_ptr<RequestCounts> request_counts_;
 };
 
 using DynamicDescriptorSharedPtr = std::shared_ptr<DynamicDescriptor>;
@@ -55,7 +144,7 @@ public:
   void addDescriptor(const RateLimit::LocalDescriptor& descriptor,
                      DynamicDescriptorSharedPtr dynamic_descriptor);
   // pass request_descriptors to the dynamic descriptor set to get the token bucket.
-  RateLimitTokenBucketSharedPtr getBucket(const RateLimit::Descriptor);
+  RateLimitTokenBucketSharedPtr getBucket(const RateLimit::Descriptor& request_descriptor);
 
 private:
   bool matchDescriptorEntries(const std::vector<RateLimit::DescriptorEntry>& request_entries,
@@ -108,28 +197,66 @@ public:
   virtual uint64_t resetSeconds() const PURE;
 };
 
+/**
+ * Configuration of token buckets sharded across workers. Each worker takes tokens from the
+ * shared bucket in batches and consumes them locally, returning those it has not used after the
+ * rebalance interval.
+ */
+struct TokenBucketSharding {
+  ThreadLocal::SlotAllocator& tls_;
+  // The percentage of a bucket's max tokens taken at a time.
+  double worker_batch_percent_;
+  std::chrono::milliseconds rebalance_interval_;
+};
+
 class RateLimitTokenBucket : public TokenBucketContext,
                              public Logger::Loggable<Logger::Id::local_rate_limit> {
 public:
   RateLimitTokenBucket(uint64_t max_tokens, uint64_t tokens_per_fill,
-                       std::chrono::milliseconds fill_interval, TimeSource& time_source);
+                       std::chrono::milliseconds fill_interval, TimeSource& time_source,
+                       OptRef<const TokenBucketSharding> sharding = {});
 
   // RateLimitTokenBucket
   bool consume(double factor = 1.0, uint64_t tokens = 1);
-  double fillRate() const { return token_bucket_.fillRate(); }
+  double fillRate() const { return token_bucket_->fillRate(); }
   std::chrono::milliseconds fillInterval() const { return fill_interval_; }
 
-  uint64_t maxTokens() const override { return static_cast<uint64_t>(token_bucket_.maxTokens()); }
-  uint64_t remainingTokens() const override {
-    return static_cast<uint64_t>(token_bucket_.remainingTokens());
+  uint64_t maxTokens() const override {
+    return static_cast<uint64_t>(token_bucket_->maxTokens());
   }
+  uint64_t remainingTokens() const override;
   uint64_t resetSeconds() const override {
-    return static_cast<uint64_t>(std::ceil(token_bucket_.nextTokenAvailable().count() / 1000));
+    return static_cast<uint64_t>(std::ceil(token_bucket_->nextTokenAvailable().count() / 1000));
   }
 
 private:
-  AtomicTokenBucketImpl token_bucket_;
+  // The tokens a worker has taken from the shared bucket and not used yet.
+  class WorkerTokens : public ThreadLocal::ThreadLocalObject {
+  public:
+    WorkerTokens(std::shared_ptr<AtomicTokenBucketImpl> token_bucket,
+                 Event::Dispatcher& dispatcher, std::chrono::milliseconds rebalance_interval);
+    ~WorkerTokens() override { returnTokens(); }
+
+    // Consumes tokens, taking at least batch tokens from the shared bucket if there are not
+    // enough left.
+    bool consume(double tokens, double batch);
+    double tokens() const { return tokens_; }
+
+  private:
+    void returnTokens();
+
+    // Shared with the bucket, which may be destroyed before the worker's tokens are.
+    const std::shared_ptr<AtomicTokenBucketImpl> token_bucket_;
+    const std::chrono::milliseconds rebalance_interval_;
+    double tokens_{};
+    const Event::TimerPtr rebalance_timer_;
+  };
+
+  const std::shared_ptr<AtomicTokenBucketImpl> token_bucket_;
   const std::chrono::milliseconds fill_interval_;
+  // Only set if the bucket is sharded across workers.
+  double worker_batch_{};
+  ThreadLocal::TypedSlotPtr<WorkerTokens> worker_tokens_;
 };
 using RateLimitTokenBucketSharedPtr = std::shared_ptr<RateLimitTokenBucket>;
 
@@ -146,7 +273,9 @@ public:
       const Protobuf::RepeatedPtrField<
           envoy::extensions::common::ratelimit::v3::LocalRateLimitDescriptor>& descriptors,
       bool always_consume_default_token_bucket = true,
-      ShareProviderSharedPtr shared_provider = nullptr, const uint32_t lru_size = 20);
+      ShareProviderSharedPtr shared_provider = nullptr, const uint32_t lru_size = 20,
+      OptRef<const TokenBucketSharding> sharding = {},
+      const DynamicDescriptorOptions& dynamic_descriptor_options = {});
   ~LocalRateLimiterImpl();
 
   Result requestAllowed(absl::Span<const RateLimit::Descriptor> request_descriptors);
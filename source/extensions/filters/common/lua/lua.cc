@@ -7,12 +7,24 @@
 #include "source/common/common/assert.h"
 #include "source/common/common/lock_guard.h"
 #include "source/common/common/thread.h"
+#include "source/common/runtime/runtime_features.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace Lua {
+namespace {
+
+// The maximum number of idle threads kept for reuse by each worker's Lua state.
+constexpr size_t MaxIdleThreads = 256;
+
+int appendToString(lua_State*, const void* data, size_t size, void* output) {
+  static_cast<std::string*>(output)->append(static_cast<const char*>(data), size);
+  return 0;
+}
+
+} // namespace
 
 void LuaLoggable::scriptLog(spdlog::level::level_enum level, absl::string_view message) {
   switch (level) {
@@ -45,6 +57,19 @@ void LuaLoggable::scriptLog(spdlog::level::level_enum level, absl::string_view m
 Coroutine::Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state)
     : coroutine_state_(new_thread_state, false) {}
 
+Coroutine::Coroutine(LuaRef<lua_State>&& thread, ThreadPool& pool)
+    : coroutine_state_(std::move(thread)), pool_(&pool) {}
+
+Coroutine::~Coroutine() {
+  // A thread that errored is dead, and one that is still yielded may not be resumed for another
+  // function.
+  if (pool_ == nullptr || !returned_ || pool_->size() >= MaxIdleThreads) {
+    return;
+  }
+  lua_settop(coroutine_state_.get(), 0);
+  pool_->push_back(std::move(coroutine_state_));
+}
+
 void Coroutine::start(int function_ref, int num_args, const std::function<void()>& yield_callback) {
   ASSERT(state_ == State::NotStarted);
 
@@ -64,6 +89,7 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
 
   if (0 == rc) {
     state_ = State::Finished;
+    returned_ = true;
     ENVOY_LOG(debug, "coroutine finished");
   } else if (LUA_YIELD == rc) {
     state_ = State::Yielded;
@@ -80,19 +106,29 @@ void Coroutine::resume(int num_args, const std::function<void()>& yield_callback
 }
 
 ThreadLocalState::ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls)
-    : tls_slot_(ThreadLocal::TypedSlot<LuaThreadLocal>::makeUnique(tls)) {
+    : tls_slot_(ThreadLocal::TypedSlot<LuaThreadLocal>::makeUnique(tls)),
+      reuse_coroutines_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.lua_reuse_coroutines")) {
 
   // First verify that the supplied code can be parsed.
   CSmartPtr<lua_State, lua_close> state(luaL_newstate());
   RELEASE_ASSERT(state.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state.get());
 
-  if (0 != luaL_dostring(state.get(), code.c_str())) {
+  // The code is compiled only once, and the workers load its bytecode. The bytecode keeps the
+  // chunk name, so that errors are reported as when loading the code itself.
+  std::string bytecode;
+  if (0 == luaL_loadstring(state.get(), code.c_str())) {
+    const int rc = lua_dump(state.get(), appendToString, &bytecode);
+    RELEASE_ASSERT(rc == 0, "unable to dump Lua bytecode");
+  }
+  if (bytecode.empty() || 0 != lua_pcall(state.get(), 0, LUA_MULTRET, 0)) {
     throw LuaException(fmt::format("script load error: {}", lua_tostring(state.get(), -1)));
   }
 
   // Now initialize on all threads.
-  tls_slot_->set([code](Event::Dispatcher&) { return std::make_shared<LuaThreadLocal>(code); });
+  tls_slot_->set(
+      [bytecode](Event::Dispatcher&) { return std::make_shared<LuaThreadLocal>(bytecode); });
 }
 
 int ThreadLocalState::getGlobalRef(uint64_t slot) {
@@ -122,15 +158,34 @@ uint64_t ThreadLocalState::registerGlobal(const std::string& global,
 
 CoroutinePtr ThreadLocalState::createCoroutine() {
   lua_State* state = tlsState().get();
-  return std::make_unique<Coroutine>(std::make_pair(lua_newthread(state), state));
+  if (!reuse_coroutines_) {
+    return std::make_unique<Coroutine>(std::make_pair(lua_newthread(state), state));
+  }
+
+  Coroutine::ThreadPool& pool = (*tls_slot_)->thread_pool_;
+  if (pool.empty()) {
+    return std::make_unique<Coroutine>(
+        LuaRef<lua_State>(std::make_pair(lua_newthread(state), state), false), pool);
+  }
+
+  LuaRef<lua_State> thread = std::move(pool.back());
+  pool.pop_back();
+  // Restore the globals of the thread, which a script may have replaced with setfenv(0, ...).
+  lua_pushvalue(state, LUA_GLOBALSINDEX);
+  lua_xmove(state, thread.get(), 1);
+  lua_replace(thread.get(), LUA_GLOBALSINDEX);
+  return std::make_unique<Coroutine>(std::move(thread), pool);
 }
 
-ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& code)
+ThreadLocalState::LuaThreadLocal::LuaThreadLocal(const std::string& bytecode)
     : state_(luaL_newstate()) {
 
   RELEASE_ASSERT(state_.get() != nullptr, "unable to create new Lua state object");
   luaL_openlibs(state_.get());
-  int rc = luaL_dostring(state_.get(), code.c_str());
+  int rc = luaL_loadbuffer(state_.get(), bytecode.data(), bytecode.size(), "bytecode");
+  if (rc == 0) {
+    rc = lua_pcall(state_.get(), 0, 0, 0);
+  }
   ASSERT(rc == 0);
 }
 
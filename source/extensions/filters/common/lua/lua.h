@@ -431,7 +431,21 @@ class Coroutine : Logger::Loggable<Logger::Id::lua> {
 public:
   enum class State { NotStarted, Yielded, Finished };
 
+  /**
+   * Idle threads of a Lua state, to be reused by later coroutines instead of creating new ones.
+   */
+  using ThreadPool = std::vector<LuaRef<lua_State>>;
+
   Coroutine(const std::pair<lua_State*, lua_State*>& new_thread_state);
+
+  /**
+   * Create a coroutine running on a thread that is returned to a pool, if it finished without
+   * errors, when the coroutine is destroyed.
+   * @param thread supplies the thread, referenced from the main state.
+   * @param pool supplies the pool to return the thread to. It must outlive the coroutine.
+   */
+  Coroutine(LuaRef<lua_State>&& thread, ThreadPool& pool);
+  ~Coroutine();
   lua_State* luaState() { return coroutine_state_.get(); }
   State state() { return state_; }
 
@@ -456,6 +470,9 @@ public:
 private:
   LuaRef<lua_State> coroutine_state_;
   State state_{State::NotStarted};
+  ThreadPool* pool_{};
+  // Whether the last run of the coroutine returned normally, which leaves its thread reusable.
+  bool returned_{};
 };
 
 using CoroutinePtr = std::unique_ptr<Coroutine>;
@@ -472,7 +489,8 @@ public:
   ThreadLocalState(const std::string& code, ThreadLocal::SlotAllocator& tls);
 
   /**
-   * @return CoroutinePtr a new coroutine.
+   * @return CoroutinePtr a new coroutine. It reuses the thread of a previously destroyed one that
+   *         finished without errors, if any.
    */
   CoroutinePtr createCoroutine();
 
@@ -516,16 +534,19 @@ public:
 
 private:
   struct LuaThreadLocal : public ThreadLocal::ThreadLocalObject {
-    LuaThreadLocal(const std::string& code);
+    LuaThreadLocal(const std::string& bytecode);
 
     CSmartPtr<lua_State, lua_close> state_;
     std::vector<int> global_slots_;
+    // Declared after the state, which the threads are unreferenced from when they are destroyed.
+    Coroutine::ThreadPool thread_pool_;
   };
 
   CSmartPtr<lua_State, lua_close>& tlsState() { return (*tls_slot_)->state_; }
 
   ThreadLocal::TypedSlotPtr<LuaThreadLocal> tls_slot_;
   uint64_t current_global_slot_{};
+  const bool reuse_coroutines_;
 };
 
 using ThreadLocalStatePtr = std::unique_ptr<ThreadLocalState>;
@@ -4,6 +4,7 @@
 #include "envoy/config/rbac/v3/rbac.pb.validate.h"
 
 #include "source/common/http/header_map_impl.h"
+#include "source/common/runtime/runtime_features.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -61,6 +62,24 @@ RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     policies_.emplace(policy.first, std::make_unique<PolicyMatcher>(policy.second, builder,
                                                                     validation_visitor, context));
   }
+
+  if (!Runtime::runtimeFeatureEnabled("envoy.reloadable_features.rbac_policy_prefilter")) {
+    return;
+  }
+  std::vector<const envoy::config::rbac::v3::Policy*> ordered_configs;
+  ordered_configs.reserve(policies_.size());
+  for (const auto& [name, matcher] : policies_) {
+    ordered_configs.push_back(&rules.policies().at(name));
+  }
+  auto index = std::make_unique<const PolicyIndex>(ordered_configs);
+  if (index->indexedPolicies() == 0) {
+    return;
+  }
+  policy_index_ = std::move(index);
+  ordered_policies_.reserve(policies_.size());
+  for (const auto& [name, matcher] : policies_) {
+    ordered_policies_.emplace_back(&name, matcher.get());
+  }
 }
 
 bool RoleBasedAccessControlEngineImpl::handleAction(const Network::Connection& connection,
@@ -96,6 +115,21 @@ bool RoleBasedAccessControlEngineImpl::checkPolicyMatch(
     const Envoy::Http::RequestHeaderMap& headers, std::string* effective_policy_id) const {
   bool matched = false;
 
+  if (policy_index_ != nullptr) {
+    // Candidates are in evaluation order, so the first one matching is the same policy that
+    // evaluating all of them would have found.
+    for (const uint32_t position : policy_index_->candidates(connection, headers, info)) {
+      const auto& [name, matcher] = ordered_policies_[position];
+      if (matcher->matches(connection, headers, info)) {
+        if (effective_policy_id != nullptr) {
+          *effective_policy_id = *name;
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
   for (const auto& policy : policies_) {
     if (policy.second->matches(connection, headers, info)) {
       matched = true;
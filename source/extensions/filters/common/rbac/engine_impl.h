@@ -6,6 +6,7 @@
 #include "source/common/matcher/matcher.h"
 #include "source/extensions/filters/common/rbac/engine.h"
 #include "source/extensions/filters/common/rbac/matchers.h"
+#include "source/extensions/filters/common/rbac/policy_index.h"
 
 #include "xds/type/matcher/v3/matcher.pb.h"
 
@@ -87,6 +88,10 @@ private:
   const EnforcementMode mode_;
 
   std::map<std::string, std::unique_ptr<PolicyMatcher>> policies_;
+  // The policies in evaluation order, and an index of the positions of those that may match a
+  // request. Only built if the index can skip some of the policies.
+  std::vector<std::pair<const std::string*, const PolicyMatcher*>> ordered_policies_;
+  PolicyIndexConstPtr policy_index_;
 
   // Encapsulated the CEL expression builder with the arena, that will only be
   // allocated if CEL is configured.
@@ -248,9 +248,9 @@ IPMatcher::IPMatcher(std::unique_ptr<Network::LcTrie::LcTrie<bool>> trie, Type t
     : trie_(std::move(trie)), type_(type) {}
 
 const Network::Address::InstanceConstSharedPtr&
-IPMatcher::extractIpAddress(const Network::Connection& connection,
-                            const StreamInfo::StreamInfo& info) const {
-  switch (type_) {
+IPMatcher::extractIpAddress(Type type, const Network::Connection& connection,
+                            const StreamInfo::StreamInfo& info) {
+  switch (type) {
   case ConnectionRemote:
     return connection.connectionInfoProvider().remoteAddress();
   case DownstreamLocal:
@@ -266,7 +266,7 @@ IPMatcher::extractIpAddress(const Network::Connection& connection,
 bool IPMatcher::matches(const Network::Connection& connection, const Envoy::Http::RequestHeaderMap&,
                         const StreamInfo::StreamInfo& info) const {
   // Extract IP address using reference to avoid shared_ptr copies.
-  const auto& address = extractIpAddress(connection, info);
+  const auto& address = extractIpAddress(type_, connection, info);
   // Guard against non-IP addresses (e.g., pipe) or missing address.
   if (!address) {
     return false;
@@ -133,14 +133,15 @@ public:
   bool matches(const Network::Connection& connection, const Envoy::Http::RequestHeaderMap& headers,
                const StreamInfo::StreamInfo& info) const override;
 
+  // Helper method to extract IP address based on type, returning a reference to avoid copies.
+  static const Network::Address::InstanceConstSharedPtr&
+  extractIpAddress(Type type, const Network::Connection& connection,
+                   const StreamInfo::StreamInfo& info);
+
 private:
   // Private constructor for LC Trie-based matcher.
   IPMatcher(std::unique_ptr<Network::LcTrie::LcTrie<bool>> trie, Type type);
 
-  // Helper method to extract IP address based on type, returning a reference to avoid copies.
-  const Network::Address::InstanceConstSharedPtr&
-  extractIpAddress(const Network::Connection& connection, const StreamInfo::StreamInfo& info) const;
-
   std::unique_ptr<Network::LcTrie::LcTrie<bool>> trie_;
 
   const Type type_;
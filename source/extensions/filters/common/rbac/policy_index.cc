@@ -0,0 +1,337 @@
+#include "source/extensions/filters/common/rbac/policy_index.h"
+
+#include <algorithm>
+
+#include "source/common/http/header_utility.h"
+#include "source/common/network/cidr_range.h"
+
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+namespace {
+
+using Principal = envoy::config::rbac::v3::Principal;
+using Permission = envoy::config::rbac::v3::Permission;
+
+enum class Attribute { PrincipalName, Ip, Header, PathPrefix };
+
+// The values of a single request attribute, one of which a rule requires to match.
+struct Keys {
+  bool sameAttribute(const Keys& other) const {
+    return attribute_ == other.attribute_ && ip_type_ == other.ip_type_ &&
+           header_ == other.header_;
+  }
+
+  void merge(Keys&& other) {
+    std::move(other.values_.begin(), other.values_.end(), std::back_inserter(values_));
+    std::move(other.ranges_.begin(), other.ranges_.end(), std::back_inserter(ranges_));
+  }
+
+  Attribute attribute_;
+  // Only set for Attribute::Ip.
+  IPMatcher::Type ip_type_{IPMatcher::Type::ConnectionRemote};
+  // Only set for Attribute::Header.
+  std::string header_;
+  std::vector<std::string> values_;
+  std::vector<Network::Address::CidrRange> ranges_;
+};
+using OptKeys = absl::optional<Keys>;
+
+OptKeys stringKeys(Attribute attribute, std::string value) {
+  Keys keys{attribute};
+  keys.values_.push_back(std::move(value));
+  return keys;
+}
+
+// Returns the string a matcher requires a value to equal, or to start with if allow_prefix.
+absl::optional<std::string> exactOrPrefix(const envoy::type::matcher::v3::StringMatcher& matcher,
+                                          bool allow_prefix) {
+  if (matcher.ignore_case()) {
+    return absl::nullopt;
+  }
+  switch (matcher.match_pattern_case()) {
+  case envoy::type::matcher::v3::StringMatcher::MatchPatternCase::kExact:
+    return matcher.exact();
+  case envoy::type::matcher::v3::StringMatcher::MatchPatternCase::kPrefix:
+    if (allow_prefix) {
+      return matcher.prefix();
+    }
+    return absl::nullopt;
+  default:
+    return absl::nullopt;
+  }
+}
+
+OptKeys ipKeys(IPMatcher::Type type, const envoy::config::core::v3::CidrRange& proto_range) {
+  auto range = Network::Address::CidrRange::create(proto_range);
+  if (!range.ok()) {
+    return absl::nullopt;
+  }
+  Keys keys{Attribute::Ip, type};
+  keys.ranges_.push_back(std::move(range.value()));
+  return keys;
+}
+
+OptKeys headerKeys(const envoy::config::route::v3::HeaderMatcher& matcher) {
+  // A missing header must not match, so that a request only matches the values it has.
+  if (matcher.invert_match() || matcher.treat_missing_header_as_empty()) {
+    return absl::nullopt;
+  }
+  absl::optional<std::string> value;
+  switch (matcher.header_match_specifier_case()) {
+  case envoy::config::route::v3::HeaderMatcher::HeaderMatchSpecifierCase::kExactMatch:
+    value = matcher.exact_match();
+    break;
+  case envoy::config::route::v3::HeaderMatcher::HeaderMatchSpecifierCase::kStringMatch:
+    value = exactOrPrefix(matcher.string_match(), false);
+    break;
+  default:
+    break;
+  }
+  if (!value.has_value()) {
+    return absl::nullopt;
+  }
+  OptKeys keys = stringKeys(Attribute::Header, std::move(*value));
+  keys->header_ = Envoy::Http::LowerCaseString(matcher.name()).get();
+  return keys;
+}
+
+OptKeys pathKeys(const envoy::type::matcher::v3::PathMatcher& matcher) {
+  if (!matcher.has_path()) {
+    return absl::nullopt;
+  }
+  // A path equal to a value also starts with it.
+  absl::optional<std::string> value = exactOrPrefix(matcher.path(), true);
+  if (!value.has_value() || value->empty()) {
+    return absl::nullopt;
+  }
+  return stringKeys(Attribute::PathPrefix, std::move(*value));
+}
+
+// The keys of a rule matching if any of its rules does, which all need keys of the same attribute.
+template <class Rules, class KeysOf> OptKeys anyOfKeys(const Rules& rules, KeysOf keys_of) {
+  OptKeys result;
+  for (const auto& rule : rules) {
+    OptKeys keys = keys_of(rule);
+    if (!keys.has_value() || (result.has_value() && !result->sameAttribute(*keys))) {
+      return absl::nullopt;
+    }
+    if (result.has_value()) {
+      result->merge(std::move(*keys));
+    } else {
+      result = std::move(keys);
+    }
+  }
+  return result;
+}
+
+// The keys of a rule matching if all of its rules do, for which the keys of any rule will do.
+template <class Rules, class KeysOf> OptKeys allOfKeys(const Rules& rules, KeysOf keys_of) {
+  for (const auto& rule : rules) {
+    OptKeys keys = keys_of(rule);
+    if (keys.has_value()) {
+      return keys;
+    }
+  }
+  return absl::nullopt;
+}
+
+OptKeys principalKeys(const Principal& principal) {
+  switch (principal.identifier_case()) {
+  case Principal::IdentifierCase::kAndIds:
+    return allOfKeys(principal.and_ids().ids(), principalKeys);
+  case Principal::IdentifierCase::kOrIds:
+    return anyOfKeys(principal.or_ids().ids(), principalKeys);
+  case Principal::IdentifierCase::kAuthenticated: {
+    if (!principal.authenticated().has_principal_name()) {
+      return absl::nullopt;
+    }
+    absl::optional<std::string> name = exactOrPrefix(principal.authenticated().principal_name(),
+                                                     false);
+    return name.has_value() ? stringKeys(Attribute::PrincipalName, std::move(*name))
+                            : absl::nullopt;
+  }
+  case Principal::IdentifierCase::kSourceIp:
+    return ipKeys(IPMatcher::Type::ConnectionRemote, principal.source_ip());
+  case Principal::IdentifierCase::kDirectRemoteIp:
+    return ipKeys(IPMatcher::Type::DownstreamDirectRemote, principal.direct_remote_ip());
+  case Principal::IdentifierCase::kRemoteIp:
+    return ipKeys(IPMatcher::Type::DownstreamRemote, principal.remote_ip());
+  case Principal::IdentifierCase::kHeader:
+    return headerKeys(principal.header());
+  case Principal::IdentifierCase::kUrlPath:
+    return pathKeys(principal.url_path());
+  default:
+    return absl::nullopt;
+  }
+}
+
+OptKeys permissionKeys(const Permission& permission) {
+  switch (permission.rule_case()) {
+  case Permission::RuleCase::kAndRules:
+    return allOfKeys(permission.and_rules().rules(), permissionKeys);
+  case Permission::RuleCase::kOrRules:
+    return anyOfKeys(permission.or_rules().rules(), permissionKeys);
+  case Permission::RuleCase::kHeader:
+    return headerKeys(permission.header());
+  case Permission::RuleCase::kDestinationIp:
+    return ipKeys(IPMatcher::Type::DownstreamLocal, permission.destination_ip());
+  case Permission::RuleCase::kUrlPath:
+    return pathKeys(permission.url_path());
+  default:
+    return absl::nullopt;
+  }
+}
+
+void addPosition(std::vector<uint32_t>& positions, uint32_t position) {
+  // A policy may list the same value more than once.
+  if (positions.empty() || positions.back() != position) {
+    positions.push_back(position);
+  }
+}
+
+} // namespace
+
+PolicyIndex::PolicyIndex(const std::vector<const envoy::config::rbac::v3::Policy*>& policies) {
+  std::array<std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>>, IpTypes>
+      ip_ranges;
+  std::array<size_t, IpTypes> ip_range_counts{};
+  for (uint32_t position = 0; position < policies.size(); ++position) {
+    const envoy::config::rbac::v3::Policy& policy = *policies[position];
+    // Policies match requests matching any of their principals and any of their permissions.
+    OptKeys keys = anyOfKeys(policy.principals(), principalKeys);
+    if (!keys.has_value()) {
+      keys = anyOfKeys(policy.permissions(), permissionKeys);
+    }
+    if (!keys.has_value()) {
+      unindexed_.push_back(position);
+      continue;
+    }
+
+    ++indexed_policies_;
+    switch (keys->attribute_) {
+    case Attribute::PrincipalName:
+      for (std::string& name : keys->values_) {
+        addPosition(principal_names_[std::move(name)], position);
+      }
+      break;
+    case Attribute::Ip:
+      ip_range_counts[keys->ip_type_] += keys->ranges_.size();
+      ip_ranges[keys->ip_type_].emplace_back(position, std::move(keys->ranges_));
+      break;
+    case Attribute::Header: {
+      auto it = std::find_if(headers_.begin(), headers_.end(), [&keys](const HeaderIndex& index) {
+        return index.name_.get() == keys->header_;
+      });
+      if (it == headers_.end()) {
+        it = headers_.insert(headers_.end(),
+                             HeaderIndex{Envoy::Http::LowerCaseString(keys->header_), {}});
+      }
+      for (std::string& value : keys->values_) {
+        addPosition(it->values_[std::move(value)], position);
+      }
+      break;
+    }
+    case Attribute::PathPrefix:
+      for (std::string& prefix : keys->values_) {
+        addPosition(path_prefix_positions_[std::move(prefix)], position);
+      }
+      break;
+    }
+  }
+
+  // An LC-trie may need up to four nodes per range with the default fill factor, past which its
+  // capacity runs out and the policies are not indexed.
+  constexpr size_t MaxIpRanges = Network::LcTrie::MaxLcTrieNodes / 8;
+  bool unindexed_added = false;
+  for (size_t type = 0; type < IpTypes; ++type) {
+    if (ip_ranges[type].empty()) {
+      continue;
+    }
+    if (ip_range_counts[type] > MaxIpRanges) {
+      for (const auto& [position, ranges] : ip_ranges[type]) {
+        unindexed_.push_back(position);
+        --indexed_policies_;
+      }
+      unindexed_added = true;
+      continue;
+    }
+    ip_tries_[type] = std::make_unique<Network::LcTrie::LcTrie<uint32_t>>(ip_ranges[type]);
+  }
+  if (unindexed_added) {
+    std::sort(unindexed_.begin(), unindexed_.end());
+  }
+
+  for (const auto& [prefix, positions] : path_prefix_positions_) {
+    path_prefixes_.add(prefix, &positions);
+  }
+}
+
+std::vector<uint32_t> PolicyIndex::candidates(const Network::Connection& connection,
+                                              const Envoy::Http::RequestHeaderMap& headers,
+                                              const StreamInfo::StreamInfo& info) const {
+  Positions result = unindexed_;
+  const auto add = [&result](const Positions& positions) {
+    result.insert(result.end(), positions.begin(), positions.end());
+  };
+  const auto add_string = [&add](const StringIndex& index, absl::string_view value) {
+    const auto it = index.find(value);
+    if (it != index.end()) {
+      add(it->second);
+    }
+  };
+
+  if (!principal_names_.empty()) {
+    // The same names as AuthenticatedMatcher matches.
+    const auto& ssl = connection.ssl();
+    if (ssl != nullptr) {
+      for (const std::string& uri : ssl->uriSanPeerCertificate()) {
+        add_string(principal_names_, uri);
+      }
+      for (const std::string& dns : ssl->dnsSansPeerCertificate()) {
+        add_string(principal_names_, dns);
+      }
+      add_string(principal_names_, ssl->subjectPeerCertificate());
+    }
+  }
+
+  for (size_t type = 0; type < IpTypes; ++type) {
+    if (ip_tries_[type] == nullptr) {
+      continue;
+    }
+    const auto& address =
+        IPMatcher::extractIpAddress(static_cast<IPMatcher::Type>(type), connection, info);
+    if (address != nullptr && address->ip() != nullptr) {
+      add(ip_tries_[type]->getData(address));
+    }
+  }
+
+  for (const HeaderIndex& header : headers_) {
+    // The same value as the header matchers match.
+    const auto value = Envoy::Http::HeaderUtility::getAllOfHeaderAsString(headers, header.name_);
+    if (value.result().has_value()) {
+      add_string(header.values_, value.result().value());
+    }
+  }
+
+  if (!path_prefix_positions_.empty()) {
+    for (const Positions* positions : path_prefixes_.findMatchingPrefixes(headers.getPathValue())) {
+      add(*positions);
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/network/connection.h"
+#include "envoy/stream_info/stream_info.h"
+
+#include "source/common/common/non_copyable.h"
+#include "source/common/common/radix_tree.h"
+#include "source/common/network/lc_trie.h"
+#include "source/extensions/filters/common/rbac/matchers.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+/**
+ * Prefiltering indexes over the policies of an RBAC engine, built at config load. A policy can
+ * only match requests having one of a set of values of a single attribute, when all of its
+ * principals, or all of its permissions, require one of:
+ * - an exact authenticated principal name,
+ * - a source, direct remote, remote or destination IP in a CIDR range,
+ * - an exact request header value,
+ * - a path prefix or exact path.
+ * The index of such a policy is looked up by the attribute of a request, in a hash map, an
+ * LC-trie or a radix tree, and only the policies it returns, along with those that could not be
+ * indexed, are candidates to match the request. Candidates must still be evaluated in full.
+ */
+class PolicyIndex : NonCopyable {
+public:
+  /**
+   * @param policies the policies, in evaluation order, whose positions the index returns.
+   */
+  explicit PolicyIndex(const std::vector<const envoy::config::rbac::v3::Policy*>& policies);
+
+  /**
+   * @return the positions, in ascending order, of the policies that may match a request.
+   */
+  std::vector<uint32_t> candidates(const Network::Connection& connection,
+                                   const Envoy::Http::RequestHeaderMap& headers,
+                                   const StreamInfo::StreamInfo& info) const;
+
+  /**
+   * @return the number of policies that are looked up by a request attribute.
+   */
+  uint32_t indexedPolicies() const { return indexed_policies_; }
+
+private:
+  using Positions = std::vector<uint32_t>;
+  using StringIndex = absl::flat_hash_map<std::string, Positions>;
+
+  struct HeaderIndex {
+    Envoy::Http::LowerCaseString name_;
+    StringIndex values_;
+  };
+
+  static constexpr size_t IpTypes = IPMatcher::Type::DownstreamRemote + 1;
+
+  uint32_t indexed_policies_{0};
+  // Policies that can match any request, in ascending order.
+  Positions unindexed_;
+  StringIndex principal_names_;
+  // By IPMatcher::Type.
+  std::array<std::unique_ptr<Network::LcTrie::LcTrie<uint32_t>>, IpTypes> ip_tries_;
+  std::vector<HeaderIndex> headers_;
+  StringIndex path_prefix_positions_;
+  // Points into path_prefix_positions_, which is not modified once the tree is built.
+  RadixTree<const Positions*> path_prefixes_;
+};
+
+using PolicyIndexConstPtr = std::unique_ptr<const PolicyIndex>;
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
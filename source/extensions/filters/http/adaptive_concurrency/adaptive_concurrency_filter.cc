@@ -8,6 +8,7 @@
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
 
 #include "source/common/common/assert.h"
+#include "source/common/http/utility.h"
 #include "source/common/protobuf/utility.h"
 #include "source/extensions/filters/http/adaptive_concurrency/controller/controller.h"
 
@@ -47,7 +48,12 @@ Http::FilterHeadersStatus AdaptiveConcurrencyFilter::decodeHeaders(Http::Request
     return Http::FilterHeadersStatus::Continue;
   }
 
-  if (controller_->forwardingDecision() == Controller::RequestForwardingAction::Block) {
+  const auto* route_config =
+      Http::Utility::resolveMostSpecificPerFilterConfig<AdaptiveConcurrencyRouteConfig>(
+          decoder_callbacks_);
+  request_controller_ = route_config != nullptr ? route_config->controller() : controller_;
+
+  if (request_controller_->forwardingDecision() == Controller::RequestForwardingAction::Block) {
     decoder_callbacks_->sendLocalReply(config_->concurrencyLimitExceededStatus(),
                                        "reached concurrency limit", nullptr, absl::nullopt,
                                        "reached_concurrency_limit");
@@ -58,7 +64,7 @@ Http::FilterHeadersStatus AdaptiveConcurrencyFilter::decodeHeaders(Http::Request
   // occurs either when encoding is complete or during destruction of this filter object.
   const auto now = config_->timeSource().monotonicTime();
   deferred_sample_task_ =
-      std::make_unique<Cleanup>([this, now]() { controller_->recordLatencySample(now); });
+      std::make_unique<Cleanup>([this, now]() { request_controller_->recordLatencySample(now); });
 
   return Http::FilterHeadersStatus::Continue;
 }
@@ -73,7 +79,7 @@ void AdaptiveConcurrencyFilter::onDestroy() {
     // TODO (tonya11en): Return some RAII handle from the concurrency controller that performs this
     // logic as part of its lifecycle.
     deferred_sample_task_->cancel();
-    controller_->cancelLatencySample();
+    request_controller_->cancelLatencySample();
   }
 }
 
@@ -7,6 +7,7 @@
 #include "envoy/common/time.h"
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
 #include "envoy/http/filter.h"
+#include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
@@ -47,6 +48,21 @@ using AdaptiveConcurrencyFilterConfigSharedPtr =
     std::shared_ptr<const AdaptiveConcurrencyFilterConfig>;
 using ConcurrencyControllerSharedPtr = std::shared_ptr<Controller::ConcurrencyController>;
 
+/**
+ * Per-route configuration for the adaptive concurrency limit filter, holding the concurrency
+ * controller of the requests to the route.
+ */
+class AdaptiveConcurrencyRouteConfig : public Router::RouteSpecificFilterConfig {
+public:
+  explicit AdaptiveConcurrencyRouteConfig(ConcurrencyControllerSharedPtr controller)
+      : controller_(std::move(controller)) {}
+
+  const ConcurrencyControllerSharedPtr& controller() const { return controller_; }
+
+private:
+  const ConcurrencyControllerSharedPtr controller_;
+};
+
 /**
  * A filter that samples request latencies and dynamically adjusts the request
  * concurrency window.
@@ -67,6 +83,8 @@ public:
 private:
   AdaptiveConcurrencyFilterConfigSharedPtr config_;
   const ConcurrencyControllerSharedPtr controller_;
+  // The controller of the route if it has one, or the filter's, which the request was admitted by.
+  ConcurrencyControllerSharedPtr request_controller_;
   std::unique_ptr<Cleanup> deferred_sample_task_;
 };
 
@@ -2,16 +2,114 @@
 
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
 #include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.validate.h"
+#include "envoy/event/dispatcher_thread_deletable.h"
 #include "envoy/registry/registry.h"
+#include "envoy/singleton/manager.h"
 
 #include "source/extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
 #include "source/extensions/filters/http/adaptive_concurrency/controller/gradient_controller.h"
+#include "source/extensions/filters/http/adaptive_concurrency/controller/vegas_controller.h"
+
+#include "source/common/protobuf/utility.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
 namespace AdaptiveConcurrency {
 
+namespace {
+
+using PerRouteProto =
+    envoy::extensions::filters::http::adaptive_concurrency::v3::AdaptiveConcurrencyPerRoute;
+
+// Creates the controller configured in either the filter or the per-route configuration.
+template <class ProtoConfig>
+std::unique_ptr<Controller::ConcurrencyController>
+createController(const ProtoConfig& config, const std::string& stats_prefix, Stats::Scope& scope,
+                 Server::Configuration::ServerFactoryContext& server_context) {
+  if (config.has_vegas_controller_config()) {
+    return std::make_unique<Controller::VegasController>(
+        Controller::VegasControllerConfig(config.vegas_controller_config()),
+        server_context.mainThreadDispatcher(), stats_prefix + "vegas_controller.", scope,
+        server_context.timeSource());
+  }
+  ASSERT(config.has_gradient_controller_config());
+  auto gradient_controller_config = Controller::GradientControllerConfig(
+      config.gradient_controller_config(), server_context.runtime());
+  return std::make_unique<Controller::GradientController>(
+      std::move(gradient_controller_config), server_context.mainThreadDispatcher(),
+      server_context.runtime(), stats_prefix + "gradient_controller.", scope,
+      server_context.api().randomGenerator(), server_context.timeSource());
+}
+
+/**
+ * Holds a per-route controller until the main thread deletes it. The last reference to a route's
+ * controller may be dropped by a worker's request, but the controller's timers belong to the main
+ * thread.
+ */
+class MainThreadDeletableController : public Event::DispatcherThreadDeletable {
+public:
+  explicit MainThreadDeletableController(Controller::ConcurrencyController* controller)
+      : controller_(controller) {}
+
+private:
+  const std::unique_ptr<Controller::ConcurrencyController> controller_;
+};
+
+/**
+ * A singleton that hands out one controller per per-route stat_prefix, so that the routes
+ * configuring a stat_prefix, and the route configuration updates keeping it, share the controller
+ * that emits its stats. If given configs with the same stat_prefix but a different controller, an
+ * error status is returned.
+ */
+class RouteControllerSingleton : public Singleton::Instance {
+public:
+  absl::StatusOr<ConcurrencyControllerSharedPtr>
+  get(const PerRouteProto& config, Server::Configuration::ServerFactoryContext& context) {
+    absl::MutexLock lock(&mu_);
+    auto& entry = controllers_[config.stat_prefix()];
+    ConcurrencyControllerSharedPtr controller = entry.controller.lock();
+    if (controller != nullptr) {
+      if (!Protobuf::util::MessageDifferencer::Equals(entry.config, config)) {
+        return absl::InvalidArgumentError(
+            fmt::format("mismatched AdaptiveConcurrencyPerRoute with same stat_prefix\n{}\nvs.\n{}",
+                        entry.config.DebugString(), config.DebugString()));
+      }
+      return controller;
+    }
+    Event::Dispatcher& dispatcher = context.mainThreadDispatcher();
+    controller = ConcurrencyControllerSharedPtr(
+        createController(config, absl::StrCat("adaptive_concurrency.", config.stat_prefix(), "."),
+                         context.scope(), context)
+            .release(),
+        [&dispatcher](Controller::ConcurrencyController* self) {
+          dispatcher.deleteInDispatcherThread(
+              std::make_unique<const MainThreadDeletableController>(self));
+        });
+    entry.config = config;
+    entry.controller = controller;
+    return controller;
+  }
+
+private:
+  struct Entry {
+    PerRouteProto config;
+    std::weak_ptr<Controller::ConcurrencyController> controller;
+  };
+
+  absl::Mutex mu_;
+  // Controllers are destroyed once no route configuration or request refers to them any more.
+  absl::flat_hash_map<std::string, Entry> controllers_ ABSL_GUARDED_BY(mu_);
+};
+
+SINGLETON_MANAGER_REGISTRATION(adaptive_concurrency_route_controller_singleton);
+
+} // namespace
+
 Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromProtoTyped(
     const envoy::extensions::filters::http::adaptive_concurrency::v3::AdaptiveConcurrency& config,
     const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
@@ -19,16 +117,8 @@ Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromP
 
   auto acc_stats_prefix = stats_prefix + "adaptive_concurrency.";
 
-  std::shared_ptr<Controller::ConcurrencyController> controller;
-  using Proto = envoy::extensions::filters::http::adaptive_concurrency::v3::AdaptiveConcurrency;
-  ASSERT(config.concurrency_controller_config_case() ==
-         Proto::ConcurrencyControllerConfigCase::kGradientControllerConfig);
-  auto gradient_controller_config = Controller::GradientControllerConfig(
-      config.gradient_controller_config(), server_context.runtime());
-  controller = std::make_shared<Controller::GradientController>(
-      std::move(gradient_controller_config), server_context.mainThreadDispatcher(),
-      server_context.runtime(), acc_stats_prefix + "gradient_controller.", context.scope(),
-      server_context.api().randomGenerator(), server_context.timeSource());
+  ConcurrencyControllerSharedPtr controller =
+      createController(config, acc_stats_prefix, context.scope(), server_context);
 
   AdaptiveConcurrencyFilterConfigSharedPtr filter_config(new AdaptiveConcurrencyFilterConfig(
       config, server_context.runtime(), std::move(acc_stats_prefix), context.scope(),
@@ -40,6 +130,19 @@ Http::FilterFactoryCb AdaptiveConcurrencyFilterFactory::createFilterFactoryFromP
   };
 }
 
+absl::StatusOr<Router::RouteSpecificFilterConfigConstSharedPtr>
+AdaptiveConcurrencyFilterFactory::createRouteSpecificFilterConfigTyped(
+    const PerRouteProto& config, Server::Configuration::ServerFactoryContext& context,
+    ProtobufMessage::ValidationVisitor&) {
+  std::shared_ptr<RouteControllerSingleton> controllers =
+      context.singletonManager().getTyped<RouteControllerSingleton>(
+          SINGLETON_MANAGER_REGISTERED_NAME(adaptive_concurrency_route_controller_singleton),
+          [] { return std::make_shared<RouteControllerSingleton>(); }, /*pin=*/true);
+  absl::StatusOr<ConcurrencyControllerSharedPtr> controller = controllers->get(config, context);
+  RETURN_IF_NOT_OK(controller.status());
+  return std::make_shared<const AdaptiveConcurrencyRouteConfig>(*std::move(controller));
+}
+
 /**
  * Static registration for the adaptive_concurrency filter. @see RegisterFactory.
  */
@@ -120,6 +120,7 @@ void GradientController::enterMinRTTSamplingWindow() {
 
   // Throw away any latency samples from before the recalculation window as it may not represent
   // the minRTT.
+  latency_samples_.clear();
   hist_clear(latency_sample_hist_.get());
 
   min_rtt_epoch_ = time_source_.monotonicTime();
@@ -132,8 +133,11 @@ void GradientController::updateMinRTT() {
 
   // Only update minRTT when it is in minRTT sampling window and
   // number of samples is greater than or equal to the minRTTAggregateRequestCount.
-  if (!inMinRTTSamplingWindow() ||
-      hist_sample_count(latency_sample_hist_.get()) < config_.minRTTAggregateRequestCount()) {
+  if (!inMinRTTSamplingWindow()) {
+    return;
+  }
+  latency_samples_.mergeInto(latency_sample_hist_.get());
+  if (hist_sample_count(latency_sample_hist_.get()) < config_.minRTTAggregateRequestCount()) {
     return;
   }
 
@@ -163,6 +167,7 @@ void GradientController::resetSampleWindow() {
   // The sampling window must not be reset while sampling for the new minRTT value.
   ASSERT(!inMinRTTSamplingWindow());
 
+  latency_samples_.mergeInto(latency_sample_hist_.get());
   if (hist_sample_count(latency_sample_hist_.get()) == 0) {
     return;
   }
@@ -235,9 +240,10 @@ void GradientController::recordLatencySample(MonotonicTime rq_send_time) {
       std::chrono::duration_cast<std::chrono::microseconds>(time_source_.monotonicTime() -
                                                             rq_send_time);
   synchronizer_.syncPoint("pre_hist_insert");
-  {
+  latency_samples_.insert(rq_latency);
+  if (inMinRTTSamplingWindow() &&
+      latency_samples_.sampleCount() >= config_.minRTTAggregateRequestCount()) {
     absl::MutexLock ml(&sample_mutation_mtx_);
-    hist_insert(latency_sample_hist_.get(), rq_latency.count(), 1);
     updateMinRTT();
   }
 }
@@ -12,6 +12,7 @@
 
 #include "source/common/common/thread_synchronizer.h"
 #include "source/extensions/filters/http/adaptive_concurrency/controller/controller.h"
+#include "source/extensions/filters/http/adaptive_concurrency/controller/sharded_latency_histogram.h"
 
 #include "absl/base/thread_annotations.h"
 #include "absl/strings/numbers.h"
@@ -213,6 +214,10 @@ using GradientControllerConfigSharedPtr = std::shared_ptr<GradientControllerConf
  * prevent the overlap of these windows. It is necessary for a worker thread to know specifically if
  * the controller is inside of a minRTT recalculation window during the recording of a latency
  * sample, so this extra bit of information is stored in inMinRTTSamplingWindow().
+ *
+ * The latency samples are recorded into histograms sharded by worker thread without holding the
+ * sample mutation mutex, which is only taken by a worker once enough samples were recorded to
+ * complete a minRTT calculation. The shards are merged when the samples of a window are processed.
  */
 class GradientController : public ConcurrencyController {
 public:
@@ -283,10 +288,12 @@ private:
   // make the forwarding decision without locking.
   std::atomic<uint32_t> concurrency_limit_;
 
-  // Stores all sampled latencies and provides percentile estimations when using the sampled data to
-  // calculate a new concurrency limit.
-  std::unique_ptr<histogram_t, decltype(&hist_free)>
-      latency_sample_hist_ ABSL_GUARDED_BY(sample_mutation_mtx_);
+  // Stores the sampled latencies merged from latency_samples_ and provides percentile estimations
+  // when using the sampled data to calculate a new concurrency limit.
+  LatencyHistogramPtr latency_sample_hist_ ABSL_GUARDED_BY(sample_mutation_mtx_);
+
+  // Stores the latencies sampled by the workers until they are merged.
+  ShardedLatencyHistogram latency_samples_;
 
   // Tracks the number of consecutive times that the concurrency limit is set to the minimum. This
   // is used to determine whether the controller should trigger an additional minRTT measurement
@@ -0,0 +1,45 @@
+#include "source/extensions/filters/http/adaptive_concurrency/controller/sharded_latency_histogram.h"
+
+#include <functional>
+#include <thread>
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+
+void ShardedLatencyHistogram::insert(std::chrono::microseconds latency) {
+  Shard& shard = shards_[std::hash<std::thread::id>()(std::this_thread::get_id()) % NumShards];
+  absl::MutexLock ml(&shard.mutex_);
+  hist_insert(shard.histogram_.get(), latency.count(), 1);
+  ++sample_count_;
+}
+
+void ShardedLatencyHistogram::mergeInto(histogram_t* histogram) {
+  for (Shard& shard : shards_) {
+    absl::MutexLock ml(&shard.mutex_);
+    const uint64_t count = hist_sample_count(shard.histogram_.get());
+    if (count == 0) {
+      continue;
+    }
+    const histogram_t* source = shard.histogram_.get();
+    hist_accumulate(histogram, &source, 1);
+    hist_clear(shard.histogram_.get());
+    sample_count_ -= count;
+  }
+}
+
+void ShardedLatencyHistogram::clear() {
+  for (Shard& shard : shards_) {
+    absl::MutexLock ml(&shard.mutex_);
+    sample_count_ -= hist_sample_count(shard.histogram_.get());
+    hist_clear(shard.histogram_.get());
+  }
+}
+
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "circllhist.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+
+using LatencyHistogramPtr = std::unique_ptr<histogram_t, decltype(&hist_free)>;
+
+/**
+ * Latency samples recorded by the workers into histograms sharded by thread, so that recording a
+ * sample does not contend with the other workers, and merged once a calculation window is over.
+ */
+class ShardedLatencyHistogram {
+public:
+  /**
+   * Records a latency sample into the shard of the calling thread.
+   */
+  void insert(std::chrono::microseconds latency);
+
+  /**
+   * Returns the number of samples recorded since they were last merged or cleared.
+   */
+  uint64_t sampleCount() const { return sample_count_.load(); }
+
+  /**
+   * Moves the samples of all the shards into a histogram.
+   */
+  void mergeInto(histogram_t* histogram);
+
+  /**
+   * Discards the samples of all the shards.
+   */
+  void clear();
+
+private:
+  // Enough for the workers of most hosts to each record into a shard of their own.
+  static constexpr size_t NumShards = 16;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    LatencyHistogramPtr histogram_ ABSL_GUARDED_BY(mutex_){hist_fast_alloc(), hist_free};
+  };
+
+  // Updated under the lock of the shard the samples are recorded into or removed from, so that it
+  // never counts samples which are not in the shards.
+  std::atomic<uint64_t> sample_count_{0};
+  std::array<Shard, NumShards> shards_;
+};
+
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
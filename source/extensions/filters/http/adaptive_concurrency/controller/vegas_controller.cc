@@ -0,0 +1,152 @@
+#include "source/extensions/filters/http/adaptive_concurrency/controller/vegas_controller.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "envoy/common/exception.h"
+
+#include "source/common/common/assert.h"
+#include "source/common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+
+VegasControllerConfig::VegasControllerConfig(
+    const envoy::extensions::filters::http::adaptive_concurrency::v3::VegasControllerConfig&
+        proto_config)
+    : sample_rtt_calc_interval_(std::chrono::milliseconds(
+          DurationUtil::durationToMilliseconds(proto_config.concurrency_update_interval()))),
+      initial_concurrency_limit_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, initial_concurrency_limit, 20)),
+      min_concurrency_limit_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, min_concurrency_limit, 3)),
+      max_concurrency_limit_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(proto_config, max_concurrency_limit, 1000)),
+      sample_aggregate_percentile_(
+          PROTOBUF_PERCENT_TO_DOUBLE_OR_DEFAULT(proto_config, sample_aggregate_percentile, 50) /
+          100.0),
+      min_rtt_reset_interval_(
+          PROTOBUF_GET_MS_OR_DEFAULT(proto_config, min_rtt_reset_interval, 60000)) {
+  if (sample_rtt_calc_interval_ < std::chrono::milliseconds(1)) {
+    throw EnvoyException(
+        "adaptive_concurrency: `concurrency_update_interval` must be at least 1ms");
+  }
+  if (min_concurrency_limit_ > max_concurrency_limit_) {
+    throw EnvoyException("adaptive_concurrency: `min_concurrency_limit` is greater than "
+                         "`max_concurrency_limit`");
+  }
+}
+
+VegasController::VegasController(VegasControllerConfig config, Event::Dispatcher& dispatcher,
+                                 const std::string& stats_prefix, Stats::Scope& scope,
+                                 TimeSource& time_source)
+    : config_(std::move(config)), stats_(generateStats(scope, stats_prefix)),
+      time_source_(time_source),
+      concurrency_limit_(std::clamp(config_.initialConcurrencyLimit(),
+                                    config_.minConcurrencyLimit(), config_.maxConcurrencyLimit())),
+      latency_sample_hist_(hist_fast_alloc(), hist_free) {
+  sample_reset_timer_ = dispatcher.createTimer([this]() -> void {
+    updateConcurrencyLimit();
+    sample_reset_timer_->enableTimer(config_.sampleRTTCalcInterval());
+  });
+  sample_reset_timer_->enableTimer(config_.sampleRTTCalcInterval());
+  stats_.concurrency_limit_.set(concurrency_limit_.load());
+}
+
+VegasControllerStats VegasController::generateStats(Stats::Scope& scope,
+                                                    const std::string& stats_prefix) {
+  return {ALL_VEGAS_CONTROLLER_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                     POOL_GAUGE_PREFIX(scope, stats_prefix))};
+}
+
+void VegasController::updateConcurrencyLimit() {
+  // The requests still outstanding carry over into the next interval.
+  const uint32_t peak_rq_outstanding = peak_rq_outstanding_.exchange(num_rq_outstanding_.load());
+  latency_samples_.mergeInto(latency_sample_hist_.get());
+  if (hist_sample_count(latency_sample_hist_.get()) == 0) {
+    return;
+  }
+
+  const std::array<double, 1> quantile{config_.sampleAggregatePercentile()};
+  std::array<double, 1> calculated_quantile;
+  hist_approx_quantile(latency_sample_hist_.get(), quantile.data(), 1, calculated_quantile.data());
+  hist_clear(latency_sample_hist_.get());
+  const std::chrono::microseconds sample_rtt(
+      std::max<int64_t>(1, static_cast<int64_t>(calculated_quantile[0])));
+  stats_.sample_rtt_msecs_.set(
+      std::chrono::duration_cast<std::chrono::milliseconds>(sample_rtt).count());
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (min_rtt_.count() == 0 || now >= min_rtt_reset_time_) {
+    min_rtt_ = sample_rtt;
+    min_rtt_reset_time_ = now + config_.minRTTResetInterval();
+  } else {
+    min_rtt_ = std::min(min_rtt_, sample_rtt);
+  }
+  stats_.min_rtt_msecs_.set(
+      std::chrono::duration_cast<std::chrono::milliseconds>(min_rtt_).count());
+
+  concurrency_limit_.store(calculateNewLimit(sample_rtt, peak_rq_outstanding));
+  stats_.concurrency_limit_.set(concurrency_limit_.load());
+}
+
+uint32_t VegasController::calculateNewLimit(std::chrono::microseconds sample_rtt,
+                                            uint32_t peak_rq_outstanding) {
+  const uint32_t limit = concurrencyLimit();
+  const double queue_size =
+      limit * (1.0 - static_cast<double>(min_rtt_.count()) / sample_rtt.count());
+  stats_.queue_size_.set(std::ceil(queue_size));
+
+  // Both the bounds of the queue size and the change of the limit grow with the logarithm of the
+  // limit, so that small limits converge quickly while large ones remain stable.
+  const double log_limit = std::max(1.0, std::log10(limit));
+  double new_limit = limit;
+  if (queue_size < 3 * log_limit) {
+    // Without enough load to fill the limit, the limit is not what keeps the queue short.
+    if (2 * static_cast<uint64_t>(peak_rq_outstanding) >= limit) {
+      new_limit += log_limit;
+    }
+  } else if (queue_size > 6 * log_limit) {
+    new_limit -= log_limit;
+  }
+
+  return std::clamp(static_cast<uint32_t>(std::max(0.0, new_limit)),
+                    config_.minConcurrencyLimit(), config_.maxConcurrencyLimit());
+}
+
+RequestForwardingAction VegasController::forwardingDecision() {
+  // As in the gradient controller, concurrent decisions may allow up to one more outstanding
+  // request than the limit per worker thread.
+  if (num_rq_outstanding_.load() < concurrencyLimit()) {
+    const uint32_t outstanding = ++num_rq_outstanding_;
+    uint32_t peak = peak_rq_outstanding_.load();
+    while (outstanding > peak && !peak_rq_outstanding_.compare_exchange_weak(peak, outstanding)) {
+    }
+    return RequestForwardingAction::Forward;
+  }
+  stats_.rq_blocked_.inc();
+  return RequestForwardingAction::Block;
+}
+
+void VegasController::recordLatencySample(MonotonicTime rq_send_time) {
+  ASSERT(num_rq_outstanding_.load() > 0);
+  --num_rq_outstanding_;
+
+  latency_samples_.insert(std::chrono::duration_cast<std::chrono::microseconds>(
+      time_source_.monotonicTime() - rq_send_time));
+}
+
+void VegasController::cancelLatencySample() {
+  ASSERT(num_rq_outstanding_.load() > 0);
+  --num_rq_outstanding_;
+}
+
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
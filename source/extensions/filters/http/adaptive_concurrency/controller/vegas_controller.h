@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/extensions/filters/http/adaptive_concurrency/controller/controller.h"
+#include "source/extensions/filters/http/adaptive_concurrency/controller/sharded_latency_histogram.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+
+/**
+ * All stats for the Vegas controller.
+ */
+#define ALL_VEGAS_CONTROLLER_STATS(COUNTER, GAUGE)                                                 \
+  COUNTER(rq_blocked)                                                                              \
+  GAUGE(concurrency_limit, NeverImport)                                                            \
+  GAUGE(min_rtt_msecs, NeverImport)                                                                \
+  GAUGE(queue_size, NeverImport)                                                                   \
+  GAUGE(sample_rtt_msecs, NeverImport)
+
+/**
+ * Wrapper struct for Vegas controller stats. @see stats_macros.h
+ */
+struct VegasControllerStats {
+  ALL_VEGAS_CONTROLLER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class VegasControllerConfig {
+public:
+  explicit VegasControllerConfig(
+      const envoy::extensions::filters::http::adaptive_concurrency::v3::VegasControllerConfig&
+          proto_config);
+
+  std::chrono::milliseconds sampleRTTCalcInterval() const { return sample_rtt_calc_interval_; }
+  uint32_t initialConcurrencyLimit() const { return initial_concurrency_limit_; }
+  uint32_t minConcurrencyLimit() const { return min_concurrency_limit_; }
+  uint32_t maxConcurrencyLimit() const { return max_concurrency_limit_; }
+  // The percentage is normalized to the range [0.0, 1.0].
+  double sampleAggregatePercentile() const { return sample_aggregate_percentile_; }
+  std::chrono::milliseconds minRTTResetInterval() const { return min_rtt_reset_interval_; }
+
+private:
+  const std::chrono::milliseconds sample_rtt_calc_interval_;
+  const uint32_t initial_concurrency_limit_;
+  const uint32_t min_concurrency_limit_;
+  const uint32_t max_concurrency_limit_;
+  const double sample_aggregate_percentile_;
+  const std::chrono::milliseconds min_rtt_reset_interval_;
+};
+
+/**
+ * A concurrency controller that implements a variation of the TCP Vegas congestion avoidance
+ * algorithm, as described in:
+ *
+ * https://github.com/Netflix/concurrency-limits
+ *
+ * The algorithm:
+ * ==============
+ * The latencies sampled over each interval are summarized into a percentile (sampleRTT), and the
+ * lowest one seen so far is the latency of the upstream without queueing (minRTT). The number of
+ * requests queued upstream, rather than being processed, is then estimated as:
+ *
+ *     queue_size = limit * (1 - minRTT / sampleRTT)
+ *
+ * The concurrency limit is increased while the queue is shorter than alpha, and decreased once it
+ * is longer than beta, by a step which, as both bounds, grows with the logarithm of the limit:
+ *
+ *     alpha = 3 * log10(limit)
+ *     beta = 6 * log10(limit)
+ *
+ * A short queue under light load says nothing about the upstream's capacity, so the limit is only
+ * increased if the peak number of outstanding requests during the interval reached half of it.
+ *
+ * Unlike the gradient controller, the minRTT is not measured in a window with a pinned concurrency
+ * limit. It is forgotten periodically instead, and set to the sampleRTT of the next interval, so
+ * that the controller follows lasting changes of the upstream latency.
+ *
+ * Threading:
+ * ==========
+ * The workers record their latency samples into histograms sharded by thread, and the forwarding
+ * decision only uses atomics. The samples are merged and the concurrency limit is updated on the
+ * main thread, when the interval timer fires.
+ */
+class VegasController : public ConcurrencyController {
+public:
+  VegasController(VegasControllerConfig config, Event::Dispatcher& dispatcher,
+                  const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source);
+
+  // ConcurrencyController.
+  RequestForwardingAction forwardingDecision() override;
+  void recordLatencySample(MonotonicTime rq_send_time) override;
+  void cancelLatencySample() override;
+  uint32_t concurrencyLimit() const override { return concurrency_limit_.load(); }
+
+private:
+  static VegasControllerStats generateStats(Stats::Scope& scope, const std::string& stats_prefix);
+  void updateConcurrencyLimit();
+  uint32_t calculateNewLimit(std::chrono::microseconds sample_rtt, uint32_t peak_rq_outstanding);
+
+  const VegasControllerConfig config_;
+  VegasControllerStats stats_;
+  TimeSource& time_source_;
+
+  // Tracks the count of requests that have been forwarded whose replies have not been sampled yet.
+  std::atomic<uint32_t> num_rq_outstanding_{0};
+
+  // The highest num_rq_outstanding_ since the start of the interval.
+  std::atomic<uint32_t> peak_rq_outstanding_{0};
+
+  // Stores the current concurrency limit.
+  std::atomic<uint32_t> concurrency_limit_;
+
+  // Stores the latencies sampled by the workers until the end of the interval.
+  ShardedLatencyHistogram latency_samples_;
+
+  // The following are only accessed on the main thread.
+  LatencyHistogramPtr latency_sample_hist_;
+  std::chrono::microseconds min_rtt_{};
+  MonotonicTime min_rtt_reset_time_;
+  Event::TimerPtr sample_reset_timer_;
+};
+
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
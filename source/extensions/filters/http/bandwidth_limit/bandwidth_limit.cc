@@ -29,17 +29,18 @@ const Http::LowerCaseString DefaultResponseFilterDelayTrailer =
 
 absl::StatusOr<std::shared_ptr<FilterConfig>> FilterConfig::create(
     const envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit& config,
-    Stats::Scope& scope, Runtime::Loader& runtime, TimeSource& time_source, bool per_route) {
+    Stats::Scope& scope, Runtime::Loader& runtime, TimeSource& time_source, bool per_route,
+    ThreadLocal::SlotAllocator* tls) {
   auto status = absl::OkStatus();
   auto filter_config = std::shared_ptr<FilterConfig>(
-      new FilterConfig(config, scope, runtime, time_source, per_route, status));
+      new FilterConfig(config, scope, runtime, time_source, per_route, tls, status));
   RETURN_IF_NOT_OK_REF(status);
   return filter_config;
 }
 
 FilterConfig::FilterConfig(const BandwidthLimit& config, Stats::Scope& scope,
                            Runtime::Loader& runtime, TimeSource& time_source, bool per_route,
-                           absl::Status& creation_status)
+                           ThreadLocal::SlotAllocator* tls, absl::Status& creation_status)
     : runtime_(runtime), time_source_(time_source), enable_mode_(config.enable_mode()),
       limit_kbps_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, limit_kbps, 0)),
       fill_interval_(std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(
@@ -66,13 +67,25 @@ FilterConfig::FilterConfig(const BandwidthLimit& config, Stats::Scope& scope,
               ? DefaultResponseFilterDelayTrailer
               : Http::LowerCaseString(absl::StrCat(config.response_trailer_prefix(), "-",
                                                    DefaultResponseFilterDelayTrailer.get()))),
-      enable_response_trailers_(config.enable_response_trailers()) {
+      enable_response_trailers_(config.enable_response_trailers()),
+      per_connection_limit_kbps_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_limit_kbps, 0)) {
   creation_status = absl::OkStatus();
 
   if (per_route && !config.has_limit_kbps()) {
     creation_status = absl::InvalidArgumentError("limit must be set for per route filter config");
     return;
   }
+  if (per_route && (config.fair_queuing() || config.has_per_connection_limit_kbps())) {
+    creation_status = absl::InvalidArgumentError(
+        "fair_queuing and per_connection_limit_kbps can not be set for per route filter config");
+    return;
+  }
+  if (config.has_per_connection_limit_kbps() && !config.fair_queuing()) {
+    creation_status =
+        absl::InvalidArgumentError("per_connection_limit_kbps requires fair_queuing to be set");
+    return;
+  }
 
   // The token bucket is configured with a max token count of the number of
   // bytes per second, and refills at the same rate, so that we have a per
@@ -80,6 +93,22 @@ FilterConfig::FilterConfig(const BandwidthLimit& config, Stats::Scope& scope,
   token_bucket_ = std::make_shared<SharedTokenBucketImpl>(
       StreamRateLimiter::kiloBytesToBytes(limit_kbps_), time_source,
       StreamRateLimiter::kiloBytesToBytes(limit_kbps_));
+
+  // The shaper consumes the tokens of all the levels of the hierarchy at once, and returns those
+  // another worker got first, which requires the atomic token bucket. Routes create it too, as
+  // they do not know whether the filter they override shapes the streams.
+  if (limit_kbps_ > 0) {
+    shaper_token_bucket_ = createShaperTokenBucket(limit_kbps_, fill_interval_, time_source);
+  }
+  if (config.fair_queuing()) {
+    ASSERT(tls != nullptr);
+    const uint64_t bytes_per_fill =
+        StreamRateLimiter::kiloBytesToBytes(limit_kbps_) * fill_interval_.count() / 1000;
+    shapers_ = ThreadLocal::TypedSlot<BandwidthShaper>::makeUnique(*tls);
+    shapers_->set([fill_interval = fill_interval_, bytes_per_fill](Event::Dispatcher& dispatcher) {
+      return std::make_shared<BandwidthShaper>(dispatcher, fill_interval, bytes_per_fill);
+    });
+  }
 }
 
 BandwidthLimitStats FilterConfig::generateStats(const std::string& prefix, Stats::Scope& scope) {
@@ -96,37 +125,53 @@ Http::FilterHeadersStatus BandwidthLimiter::decodeHeaders(Http::RequestHeaderMap
 
   if (config.enabled() && (config.enableMode() & BandwidthLimit::REQUEST)) {
     config.stats().request_enabled_.inc();
-    request_limiter_ = std::make_unique<StreamRateLimiter>(
-        config.limit(), decoder_callbacks_->decoderBufferLimit(),
-        [this] { decoder_callbacks_->onDecoderFilterAboveWriteBufferHighWatermark(); },
-        [this] { decoder_callbacks_->onDecoderFilterBelowWriteBufferLowWatermark(); },
-        [this](Buffer::Instance& data, bool end_stream) {
-          if (end_stream) {
-            updateStatsOnDecodeFinish();
-          }
-          decoder_callbacks_->injectDecodedDataToFilterChain(data, end_stream);
-        },
-        [this] {
-          updateStatsOnDecodeFinish();
-          decoder_callbacks_->continueDecoding();
-        },
-        [&config, this](uint64_t len, bool limit_enforced, std::chrono::milliseconds delay) {
-          config.stats().request_allowed_size_.set(len);
-          config.stats().request_allowed_total_size_.add(len);
-          if (limit_enforced) {
-            config.stats().request_enforced_.inc();
-            request_delay_ += delay;
-          }
-        },
-        const_cast<FilterConfig*>(&config)->timeSource(), decoder_callbacks_->dispatcher(),
-        decoder_callbacks_->scope(), config.tokenBucket(), config.fillInterval());
+    auto pause_data_cb = [this] {
+      decoder_callbacks_->onDecoderFilterAboveWriteBufferHighWatermark();
+    };
+    auto resume_data_cb = [this] {
+      decoder_callbacks_->onDecoderFilterBelowWriteBufferLowWatermark();
+    };
+    auto write_data_cb = [this](Buffer::Instance& data, bool end_stream) {
+      if (end_stream) {
+        updateStatsOnDecodeFinish();
+      }
+      decoder_callbacks_->injectDecodedDataToFilterChain(data, end_stream);
+    };
+    auto continue_cb = [this] {
+      updateStatsOnDecodeFinish();
+      decoder_callbacks_->continueDecoding();
+    };
+    auto write_stats_cb = [&config, this](uint64_t len, bool limit_enforced,
+                                          std::chrono::milliseconds delay) {
+      config.stats().request_allowed_size_.set(len);
+      config.stats().request_allowed_total_size_.add(len);
+      if (limit_enforced) {
+        config.stats().request_enforced_.inc();
+        request_delay_ += delay;
+      }
+    };
+
+    if (config_->fairQueuing()) {
+      request_shaped_stream_ = std::make_unique<ShapedStream>(
+          config_->shaper(), shaperTokenBuckets(config), decoder_callbacks_->decoderBufferLimit(),
+          std::move(pause_data_cb), std::move(resume_data_cb), std::move(write_data_cb),
+          std::move(continue_cb), std::move(write_stats_cb), config.stats().request_queue_delay_,
+          config_->timeSource());
+    } else {
+      request_limiter_ = std::make_unique<StreamRateLimiter>(
+          config.limit(), decoder_callbacks_->decoderBufferLimit(), std::move(pause_data_cb),
+          std::move(resume_data_cb), std::move(write_data_cb), std::move(continue_cb),
+          std::move(write_stats_cb), const_cast<FilterConfig*>(&config)->timeSource(),
+          decoder_callbacks_->dispatcher(), decoder_callbacks_->scope(), config.tokenBucket(),
+          config.fillInterval());
+    }
   }
 
   return Http::FilterHeadersStatus::Continue;
 }
 
 Http::FilterDataStatus BandwidthLimiter::decodeData(Buffer::Instance& data, bool end_stream) {
-  if (request_limiter_ != nullptr) {
+  if (request_limiter_ != nullptr || request_shaped_stream_ != nullptr) {
     const auto& config = getConfig();
 
     if (!request_latency_) {
@@ -138,7 +183,11 @@ Http::FilterDataStatus BandwidthLimiter::decodeData(Buffer::Instance& data, bool
     config.stats().request_incoming_size_.set(data.length());
     config.stats().request_incoming_total_size_.add(data.length());
 
-    request_limiter_->writeData(data, end_stream);
+    if (request_shaped_stream_ != nullptr) {
+      request_shaped_stream_->writeData(data, end_stream);
+    } else {
+      request_limiter_->writeData(data, end_stream);
+    }
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
   ENVOY_LOG(debug, "BandwidthLimiter <decode data>: request_limiter not set.");
@@ -146,8 +195,10 @@ Http::FilterDataStatus BandwidthLimiter::decodeData(Buffer::Instance& data, bool
 }
 
 Http::FilterTrailersStatus BandwidthLimiter::decodeTrailers(Http::RequestTrailerMap&) {
-  if (request_limiter_ != nullptr) {
-    if (request_limiter_->onTrailers()) {
+  if (request_limiter_ != nullptr || request_shaped_stream_ != nullptr) {
+    const bool buffered = request_shaped_stream_ != nullptr ? request_shaped_stream_->onTrailers()
+                                                            : request_limiter_->onTrailers();
+    if (buffered) {
       return Http::FilterTrailersStatus::StopIteration;
     } else {
       updateStatsOnDecodeFinish();
@@ -162,38 +213,53 @@ Http::FilterHeadersStatus BandwidthLimiter::encodeHeaders(Http::ResponseHeaderMa
 
   if (config.enabled() && (config.enableMode() & BandwidthLimit::RESPONSE)) {
     config.stats().response_enabled_.inc();
-
-    response_limiter_ = std::make_unique<StreamRateLimiter>(
-        config.limit(), encoder_callbacks_->encoderBufferLimit(),
-        [this] { encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark(); },
-        [this] { encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark(); },
-        [this](Buffer::Instance& data, bool end_stream) {
-          if (end_stream) {
-            updateStatsOnEncodeFinish();
-          }
-          encoder_callbacks_->injectEncodedDataToFilterChain(data, end_stream);
-        },
-        [this] {
-          updateStatsOnEncodeFinish();
-          encoder_callbacks_->continueEncoding();
-        },
-        [&config, this](uint64_t len, bool limit_enforced, std::chrono::milliseconds delay) {
-          config.stats().response_allowed_size_.set(len);
-          config.stats().response_allowed_total_size_.add(len);
-          if (limit_enforced) {
-            config.stats().response_enforced_.inc();
-            response_delay_ += delay;
-          }
-        },
-        const_cast<FilterConfig*>(&config)->timeSource(), encoder_callbacks_->dispatcher(),
-        encoder_callbacks_->scope(), config.tokenBucket(), config.fillInterval());
+    auto pause_data_cb = [this] {
+      encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark();
+    };
+    auto resume_data_cb = [this] {
+      encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark();
+    };
+    auto write_data_cb = [this](Buffer::Instance& data, bool end_stream) {
+      if (end_stream) {
+        updateStatsOnEncodeFinish();
+      }
+      encoder_callbacks_->injectEncodedDataToFilterChain(data, end_stream);
+    };
+    auto continue_cb = [this] {
+      updateStatsOnEncodeFinish();
+      encoder_callbacks_->continueEncoding();
+    };
+    auto write_stats_cb = [&config, this](uint64_t len, bool limit_enforced,
+                                          std::chrono::milliseconds delay) {
+      config.stats().response_allowed_size_.set(len);
+      config.stats().response_allowed_total_size_.add(len);
+      if (limit_enforced) {
+        config.stats().response_enforced_.inc();
+        response_delay_ += delay;
+      }
+    };
+
+    if (config_->fairQueuing()) {
+      response_shaped_stream_ = std::make_unique<ShapedStream>(
+          config_->shaper(), shaperTokenBuckets(config), encoder_callbacks_->encoderBufferLimit(),
+          std::move(pause_data_cb), std::move(resume_data_cb), std::move(write_data_cb),
+          std::move(continue_cb), std::move(write_stats_cb), config.stats().response_queue_delay_,
+          config_->timeSource());
+    } else {
+      response_limiter_ = std::make_unique<StreamRateLimiter>(
+          config.limit(), encoder_callbacks_->encoderBufferLimit(), std::move(pause_data_cb),
+          std::move(resume_data_cb), std::move(write_data_cb), std::move(continue_cb),
+          std::move(write_stats_cb), const_cast<FilterConfig*>(&config)->timeSource(),
+          encoder_callbacks_->dispatcher(), encoder_callbacks_->scope(), config.tokenBucket(),
+          config.fillInterval());
+    }
   }
 
   return Http::FilterHeadersStatus::Continue;
 }
 
 Http::FilterDataStatus BandwidthLimiter::encodeData(Buffer::Instance& data, bool end_stream) {
-  if (response_limiter_ != nullptr) {
+  if (response_limiter_ != nullptr || response_shaped_stream_ != nullptr) {
     const auto& config = getConfig();
 
     // Adds encoded trailers. May only be called in encodeData when end_stream is set to true.
@@ -213,7 +279,11 @@ Http::FilterDataStatus BandwidthLimiter::encodeData(Buffer::Instance& data, bool
     config.stats().response_incoming_size_.set(data.length());
     config.stats().response_incoming_total_size_.add(data.length());
 
-    response_limiter_->writeData(data, end_stream, trailer_added);
+    if (response_shaped_stream_ != nullptr) {
+      response_shaped_stream_->writeData(data, end_stream, trailer_added);
+    } else {
+      response_limiter_->writeData(data, end_stream, trailer_added);
+    }
     return Http::FilterDataStatus::StopIterationNoBuffer;
   }
   ENVOY_LOG(debug, "BandwidthLimiter <encode data>: response_limiter not set");
@@ -222,10 +292,13 @@ Http::FilterDataStatus BandwidthLimiter::encodeData(Buffer::Instance& data, bool
 
 Http::FilterTrailersStatus
 BandwidthLimiter::encodeTrailers(Http::ResponseTrailerMap& response_trailers) {
-  if (response_limiter_ != nullptr) {
+  if (response_limiter_ != nullptr || response_shaped_stream_ != nullptr) {
     trailers_ = &response_trailers;
 
-    if (response_limiter_->onTrailers()) {
+    const bool buffered = response_shaped_stream_ != nullptr
+                              ? response_shaped_stream_->onTrailers()
+                              : response_limiter_->onTrailers();
+    if (buffered) {
       return Http::FilterTrailersStatus::StopIteration;
     } else {
       updateStatsOnEncodeFinish();
@@ -275,6 +348,37 @@ void BandwidthLimiter::updateStatsOnEncodeFinish() {
   }
 }
 
+std::vector<ShaperTokenBucketSharedPtr>
+BandwidthLimiter::shaperTokenBuckets(const FilterConfig& config) {
+  std::vector<ShaperTokenBucketSharedPtr> token_buckets;
+  if (config_->perConnectionLimit() > 0) {
+    token_buckets.push_back(perConnectionTokenBucket());
+  }
+  if (&config != config_.get() && config.shaperTokenBucket() != nullptr) {
+    token_buckets.push_back(config.shaperTokenBucket());
+  }
+  if (config_->shaperTokenBucket() != nullptr) {
+    token_buckets.push_back(config_->shaperTokenBucket());
+  }
+  return token_buckets;
+}
+
+ShaperTokenBucketSharedPtr BandwidthLimiter::perConnectionTokenBucket() {
+  const auto* typed_state =
+      decoder_callbacks_->streamInfo().filterState()->getDataReadOnly<PerConnectionTokenBucket>(
+          PerConnectionTokenBucket::key());
+  if (typed_state != nullptr) {
+    return typed_state->value();
+  }
+
+  auto token_bucket = std::make_shared<PerConnectionTokenBucket>(createShaperTokenBucket(
+      config_->perConnectionLimit(), config_->fillInterval(), config_->timeSource()));
+  decoder_callbacks_->streamInfo().filterState()->setData(
+      PerConnectionTokenBucket::key(), token_bucket, StreamInfo::FilterState::StateType::ReadOnly,
+      StreamInfo::FilterState::LifeSpan::Connection);
+  return token_bucket->value();
+}
+
 const FilterConfig& BandwidthLimiter::getConfig() const {
   const auto* config =
       Http::Utility::resolveMostSpecificPerFilterConfig<FilterConfig>(decoder_callbacks_);
@@ -291,6 +395,12 @@ void BandwidthLimiter::onDestroy() {
   if (response_limiter_ != nullptr) {
     response_limiter_->destroy();
   }
+  if (request_shaped_stream_ != nullptr) {
+    request_shaped_stream_->destroy();
+  }
+  if (response_shaped_stream_ != nullptr) {
+    response_shaped_stream_->destroy();
+  }
 }
 
 } // namespace BandwidthLimitFilter
@@ -11,12 +11,14 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/stats/timespan.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "source/common/common/assert.h"
 #include "source/common/common/shared_token_bucket_impl.h"
 #include "source/common/http/header_map_impl.h"
 #include "source/common/router/header_parser.h"
 #include "source/common/runtime/runtime_protos.h"
+#include "source/extensions/filters/http/bandwidth_limit/bandwidth_shaper.h"
 #include "source/extensions/filters/http/common/stream_rate_limiter.h"
 
 #include "absl/synchronization/mutex.h"
@@ -45,7 +47,9 @@ namespace BandwidthLimitFilter {
   COUNTER(request_allowed_total_size)                                                              \
   COUNTER(response_allowed_total_size)                                                             \
   HISTOGRAM(request_transfer_duration, Milliseconds)                                               \
-  HISTOGRAM(response_transfer_duration, Milliseconds)
+  HISTOGRAM(response_transfer_duration, Milliseconds)                                              \
+  HISTOGRAM(request_queue_delay, Milliseconds)                                                     \
+  HISTOGRAM(response_queue_delay, Milliseconds)
 
 /**
  * Struct definition for all bandwidth limit stats. @see stats_macros.h
@@ -65,7 +69,7 @@ public:
   static absl::StatusOr<std::shared_ptr<FilterConfig>>
   create(const envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit& config,
          Stats::Scope& scope, Runtime::Loader& runtime, TimeSource& time_source,
-         bool per_route = false);
+         bool per_route = false, ThreadLocal::SlotAllocator* tls = nullptr);
 
   ~FilterConfig() override = default;
   Runtime::Loader& runtime() { return runtime_; }
@@ -86,13 +90,20 @@ public:
     return response_filter_delay_trailer_;
   }
   bool enableResponseTrailers() const { return enable_response_trailers_; }
+  bool fairQueuing() const { return shapers_ != nullptr; }
+  // Returns 0 if the connections are not limited.
+  uint64_t perConnectionLimit() const { return per_connection_limit_kbps_; }
+  // Returns nullptr if the limit is not set.
+  const ShaperTokenBucketSharedPtr& shaperTokenBucket() const { return shaper_token_bucket_; }
+  // Must only be called if fairQueuing() is true.
+  BandwidthShaper& shaper() { return *shapers_->get(); }
 
 private:
   friend class FilterTest;
 
   FilterConfig(const envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit& config,
                Stats::Scope& scope, Runtime::Loader& runtime, TimeSource& time_source,
-               bool per_route, absl::Status& creation_status);
+               bool per_route, ThreadLocal::SlotAllocator* tls, absl::Status& creation_status);
 
   static BandwidthLimitStats generateStats(const std::string& prefix, Stats::Scope& scope);
 
@@ -110,6 +121,11 @@ private:
   const Http::LowerCaseString request_filter_delay_trailer_;
   const Http::LowerCaseString response_filter_delay_trailer_;
   const bool enable_response_trailers_;
+  const uint64_t per_connection_limit_kbps_;
+  // The token bucket of the limit when the streams are shaped with fair queuing.
+  ShaperTokenBucketSharedPtr shaper_token_bucket_;
+  // The shaper of each worker, if the streams are shaped with fair queuing.
+  ThreadLocal::TypedSlotPtr<BandwidthShaper> shapers_;
 };
 
 using FilterConfigSharedPtr = std::shared_ptr<FilterConfig>;
@@ -159,12 +175,19 @@ private:
 
   void updateStatsOnDecodeFinish();
   void updateStatsOnEncodeFinish();
+  // Returns the token buckets of the levels of the hierarchy the stream belongs to, from the
+  // innermost to the outermost one.
+  std::vector<ShaperTokenBucketSharedPtr> shaperTokenBuckets(const FilterConfig& config);
+  ShaperTokenBucketSharedPtr perConnectionTokenBucket();
 
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
   FilterConfigSharedPtr config_;
   std::unique_ptr<Envoy::Extensions::HttpFilters::Common::StreamRateLimiter> request_limiter_;
   std::unique_ptr<Envoy::Extensions::HttpFilters::Common::StreamRateLimiter> response_limiter_;
+  // Set instead of the limiters if the streams are shaped with fair queuing.
+  std::unique_ptr<ShapedStream> request_shaped_stream_;
+  std::unique_ptr<ShapedStream> response_shaped_stream_;
   Stats::TimespanPtr request_latency_;
   Stats::TimespanPtr response_latency_;
   std::chrono::milliseconds request_duration_ = zero_milliseconds_;
@@ -0,0 +1,212 @@
+#include "source/extensions/filters/http/bandwidth_limit/bandwidth_shaper.h"
+
+#include <algorithm>
+
+#include "source/common/common/assert.h"
+#include "source/common/common/macros.h"
+#include "source/extensions/filters/http/common/stream_rate_limiter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace BandwidthLimitFilter {
+
+const std::string& PerConnectionTokenBucket::key() {
+  CONSTRUCT_ON_FIRST_USE(std::string, "per_connection_bandwidth_limit");
+}
+
+ShaperTokenBucketSharedPtr createShaperTokenBucket(uint64_t limit_kbps,
+                                                   std::chrono::milliseconds fill_interval,
+                                                   TimeSource& time_source) {
+  const uint64_t max_tokens = Common::StreamRateLimiter::kiloBytesToBytes(limit_kbps);
+  const uint64_t initial_tokens = max_tokens * fill_interval.count() / 1000;
+  return std::make_shared<AtomicTokenBucketImpl>(max_tokens, time_source, max_tokens,
+                                                 initial_tokens);
+}
+
+ShapedStream::ShapedStream(
+    BandwidthShaper& shaper, std::vector<ShaperTokenBucketSharedPtr> token_buckets,
+    uint64_t max_buffered_data, std::function<void()> pause_data_cb,
+    std::function<void()> resume_data_cb,
+    std::function<void(Buffer::Instance&, bool)> write_data_cb, std::function<void()> continue_cb,
+    std::function<void(uint64_t, bool, std::chrono::milliseconds)> write_stats_cb,
+    Stats::Histogram& queue_delay, TimeSource& time_source)
+    : shaper_(shaper), token_buckets_(std::move(token_buckets)),
+      write_data_cb_(std::move(write_data_cb)), continue_cb_(std::move(continue_cb)),
+      write_stats_cb_(std::move(write_stats_cb)), queue_delay_(queue_delay),
+      time_source_(time_source),
+      // The pause callback already stops the stream from reading more data once the buffer is
+      // over its high watermark, so nothing more is done on overflow.
+      buffer_(std::move(resume_data_cb), std::move(pause_data_cb), []() -> void {}) {
+  ASSERT(max_buffered_data > 0);
+  buffer_.setWatermarks(max_buffered_data);
+}
+
+ShapedStream::~ShapedStream() { destroy(); }
+
+void ShapedStream::writeData(Buffer::Instance& incoming_buffer, bool end_stream,
+                             bool trailer_added) {
+  if (buffer_.length() == 0) {
+    queued_time_ = last_write_time_ = time_source_.monotonicTime();
+  }
+  const uint64_t len = incoming_buffer.length();
+  buffer_.move(incoming_buffer);
+  saw_end_stream_ = end_stream;
+  // As in the stream rate limiter, saw_trailers_ is set after the data is buffered so that the
+  // trailers are not continued before the data of the last frame is written.
+  if (trailer_added) {
+    saw_trailers_ = true;
+  }
+
+  ENVOY_LOG(debug, "ShapedStream <writeData>: got new {} bytes of data, {} buffered.", len,
+            buffer_.length());
+  shaper_.enqueue(*this);
+}
+
+bool ShapedStream::onTrailers() {
+  saw_end_stream_ = true;
+  saw_trailers_ = true;
+  return buffer_.length() > 0;
+}
+
+void ShapedStream::destroy() {
+  if (!destroyed_) {
+    destroyed_ = true;
+    shaper_.remove(*this);
+  }
+}
+
+bool ShapedStream::serve(uint64_t quantum) {
+  // A stream carries over at most one quantum that it could not use for lack of tokens, so that it
+  // does not build up a burst while the other streams are served.
+  deficit_ = std::min(deficit_, quantum) + quantum;
+  const uint64_t bytes_to_write = consumeTokens(std::min<uint64_t>(deficit_, buffer_.length()));
+  const bool drained = bytes_to_write == buffer_.length();
+  if (bytes_to_write == 0 && !drained) {
+    return false;
+  }
+  deficit_ = drained ? 0 : deficit_ - bytes_to_write;
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_write_time_);
+  last_write_time_ = now;
+  if (drained) {
+    queue_delay_.recordValue(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - queued_time_).count());
+  }
+  ENVOY_LOG(debug, "ShapedStream <serve>: deficit={} to_write={} buffered={}", deficit_,
+            bytes_to_write, buffer_.length());
+
+  Buffer::OwnedImpl data_to_write;
+  data_to_write.move(buffer_, bytes_to_write);
+  write_stats_cb_(bytes_to_write, delay.count() > 0, delay);
+
+  // Write the data out, indicating end stream if we saw end stream, there is no further data to
+  // send, and there are no trailers.
+  write_data_cb_(data_to_write, saw_end_stream_ && drained && !saw_trailers_);
+
+  // If there is no more data to send and we saw trailers, we need to continue iteration to release
+  // the trailers to further filters.
+  if (drained && saw_trailers_) {
+    continue_cb_();
+  }
+  return true;
+}
+
+uint64_t ShapedStream::consumeTokens(uint64_t tokens) {
+  for (const ShaperTokenBucketSharedPtr& token_bucket : token_buckets_) {
+    tokens = std::min<uint64_t>(tokens, token_bucket->remainingTokens());
+  }
+
+  // The outer token buckets are shared with the other workers, which may consume their tokens in
+  // the meantime. If a token bucket yields fewer tokens than the inner ones, the excess is returned
+  // to those.
+  for (size_t i = 0; i < token_buckets_.size() && tokens > 0; ++i) {
+    const uint64_t consumed = token_buckets_[i]->consume(tokens, true);
+    if (consumed < tokens) {
+      const double excess = tokens - consumed;
+      for (size_t j = 0; j < i; ++j) {
+        token_buckets_[j]->consume([excess](double) { return -excess; });
+      }
+      tokens = consumed;
+    }
+  }
+  return tokens;
+}
+
+BandwidthShaper::BandwidthShaper(Event::Dispatcher& dispatcher,
+                                 std::chrono::milliseconds fill_interval, uint64_t bytes_per_fill)
+    : fill_interval_(fill_interval), bytes_per_fill_(bytes_per_fill),
+      fill_timer_(dispatcher.createTimer([this] { onFillTimer(); })), first_served_(queue_.end()) {}
+
+void BandwidthShaper::enqueue(ShapedStream& stream) {
+  if (stream.queued_) {
+    return;
+  }
+  stream.queue_entry_ = queue_.insert(queue_.end(), &stream);
+  stream.queued_ = true;
+
+  if (!fill_timer_->enabled()) {
+    // As in the stream rate limiter, the data is written right after the stack is unwound if no
+    // stream is waiting for tokens.
+    fill_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void BandwidthShaper::remove(ShapedStream& stream) {
+  if (stream.queued_) {
+    if (first_served_ == stream.queue_entry_) {
+      ++first_served_;
+    }
+    queue_.erase(stream.queue_entry_);
+    stream.queued_ = false;
+  }
+  if (in_service_ == &stream) {
+    in_service_ = nullptr;
+  }
+  if (queue_.empty()) {
+    fill_timer_->disableTimer();
+  }
+}
+
+void BandwidthShaper::onFillTimer() {
+  bool progress = true;
+  while (progress && !queue_.empty()) {
+    progress = false;
+    const uint64_t quantum = std::max(MinQuantum, bytes_per_fill_ / queue_.size());
+
+    // Serve each of the streams queued at the start of the round once. Those which still have data
+    // are queued again, the ones which got no tokens ahead of the ones which did, so that they are
+    // served first on the next round and on the next fill interval.
+    first_served_ = queue_.end();
+    for (size_t remaining = queue_.size(); remaining > 0 && !queue_.empty(); --remaining) {
+      ShapedStream* stream = queue_.front();
+      queue_.pop_front();
+      stream->queued_ = false;
+
+      in_service_ = stream;
+      const bool served = stream->serve(quantum);
+      progress |= served;
+      if (in_service_ != nullptr && !stream->queued_ && stream->buffer_.length() > 0) {
+        stream->queue_entry_ = queue_.insert(served ? queue_.end() : first_served_, stream);
+        stream->queued_ = true;
+        if (served && first_served_ == queue_.end()) {
+          first_served_ = stream->queue_entry_;
+        }
+      }
+      in_service_ = nullptr;
+    }
+  }
+  first_served_ = queue_.end();
+
+  if (!queue_.empty()) {
+    ENVOY_LOG(debug, "BandwidthShaper <onFillTimer>: {} streams waiting for {}ms", queue_.size(),
+              fill_interval_.count());
+    fill_timer_->enableTimer(fill_interval_);
+  }
+}
+
+} // namespace BandwidthLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/stats/stats.h"
+#include "envoy/stream_info/filter_state.h"
+#include "envoy/thread_local/thread_local_object.h"
+
+#include "source/common/buffer/watermark_buffer.h"
+#include "source/common/common/logger.h"
+#include "source/common/common/token_bucket_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace BandwidthLimitFilter {
+
+using ShaperTokenBucketSharedPtr = std::shared_ptr<AtomicTokenBucketImpl>;
+
+/**
+ * The token bucket of a downstream connection, shared by all of its streams.
+ */
+class PerConnectionTokenBucket : public StreamInfo::FilterState::Object {
+public:
+  explicit PerConnectionTokenBucket(ShaperTokenBucketSharedPtr token_bucket)
+      : token_bucket_(std::move(token_bucket)) {}
+  static const std::string& key();
+  const ShaperTokenBucketSharedPtr& value() const { return token_bucket_; }
+
+private:
+  const ShaperTokenBucketSharedPtr token_bucket_;
+};
+
+/**
+ * Creates a token bucket for the shaper holding a fill interval worth of tokens, with a burst of
+ * up to one second of data like the token buckets of the stream rate limiter.
+ */
+ShaperTokenBucketSharedPtr createShaperTokenBucket(uint64_t limit_kbps,
+                                                   std::chrono::milliseconds fill_interval,
+                                                   TimeSource& time_source);
+
+class BandwidthShaper;
+
+/**
+ * One direction of a stream whose data is queued in a worker's BandwidthShaper until all the token
+ * buckets of the hierarchy it belongs to allow it to be written. It offers the same interface and
+ * callbacks as the stream rate limiter.
+ */
+class ShapedStream : Logger::Loggable<Logger::Id::filter> {
+public:
+  /**
+   * @param shaper the shaper of the worker the stream runs on.
+   * @param token_buckets the token buckets of the levels of the hierarchy the stream belongs to,
+   *                      from the innermost to the outermost one.
+   * @param max_buffered_data maximum data to buffer before invoking the pause callback.
+   * @param pause_data_cb callback invoked when the stream has buffered too much data.
+   * @param resume_data_cb callback invoked when the stream has gone under the buffer limit.
+   * @param write_data_cb callback invoked to write data to the stream.
+   * @param continue_cb callback invoked to continue the stream. This is only used to continue
+   *                    trailers that have been paused during body flush.
+   * @param write_stats_cb callback invoked with the size of each write, whether the data had to
+   *                       wait for bandwidth, and how long it waited since the previous write.
+   * @param queue_delay histogram recording how long the stream waited for its queued data to be
+   *                    written.
+   * @param time_source the time source to measure the queue delay with.
+   */
+  ShapedStream(BandwidthShaper& shaper, std::vector<ShaperTokenBucketSharedPtr> token_buckets,
+               uint64_t max_buffered_data, std::function<void()> pause_data_cb,
+               std::function<void()> resume_data_cb,
+               std::function<void(Buffer::Instance&, bool)> write_data_cb,
+               std::function<void()> continue_cb,
+               std::function<void(uint64_t, bool, std::chrono::milliseconds)> write_stats_cb,
+               Stats::Histogram& queue_delay, TimeSource& time_source);
+  ~ShapedStream();
+
+  /**
+   * Called by the stream to write data. All data writes happen asynchronously, the stream should
+   * be stopped after this call (all data will be drained from incoming_buffer).
+   */
+  void writeData(Buffer::Instance& incoming_buffer, bool end_stream, bool trailer_added = false);
+
+  /**
+   * Called if the stream receives trailers.
+   * Returns true if the read buffer is not completely drained yet.
+   */
+  bool onTrailers();
+
+  /**
+   * Like the owning filter, we must handle inline destruction, so we have a destroy() method which
+   * removes the stream from the shaper so that no callback is invoked anymore.
+   */
+  void destroy();
+
+private:
+  friend class BandwidthShaper;
+
+  // Adds a quantum to the deficit of the stream and writes as much of the queued data as the
+  // deficit and the token buckets allow. Returns whether the stream made progress.
+  bool serve(uint64_t quantum);
+  // Consumes up to the given number of tokens from all the token buckets, and returns how many.
+  uint64_t consumeTokens(uint64_t tokens);
+
+  BandwidthShaper& shaper_;
+  const std::vector<ShaperTokenBucketSharedPtr> token_buckets_;
+  const std::function<void(Buffer::Instance&, bool)> write_data_cb_;
+  const std::function<void()> continue_cb_;
+  const std::function<void(uint64_t, bool, std::chrono::milliseconds)> write_stats_cb_;
+  Stats::Histogram& queue_delay_;
+  TimeSource& time_source_;
+  Buffer::WatermarkBuffer buffer_;
+  uint64_t deficit_{};
+  // The time the queued data started waiting, and the time of the last write since.
+  MonotonicTime queued_time_;
+  MonotonicTime last_write_time_;
+  std::list<ShapedStream*>::iterator queue_entry_;
+  bool queued_{};
+  bool destroyed_{};
+  bool saw_end_stream_{};
+  bool saw_trailers_{};
+};
+
+/**
+ * Schedules the writes of the streams of a worker that wait for bandwidth by deficit round robin.
+ * On each fill interval, the queued streams are served in turn, each one a quantum at a time, until
+ * they are drained or none of them can get tokens anymore. The streams which got no tokens are
+ * served first on the next fill interval.
+ */
+class BandwidthShaper : public ThreadLocal::ThreadLocalObject,
+                        Logger::Loggable<Logger::Id::filter> {
+public:
+  // The minimum quantum, which bounds the number of rounds per fill interval.
+  static constexpr uint64_t MinQuantum = 16 * 1024;
+
+  /**
+   * @param dispatcher the dispatcher of the worker.
+   * @param fill_interval the interval the queued streams are served at.
+   * @param bytes_per_fill the number of bytes the outermost limit allows on each fill interval, or
+   *                       0 if it is unlimited. It is shared among the queued streams to size
+   *                       the quantum.
+   */
+  BandwidthShaper(Event::Dispatcher& dispatcher, std::chrono::milliseconds fill_interval,
+                  uint64_t bytes_per_fill);
+
+  /**
+   * Queues a stream until its data is written, if it isn't queued already.
+   */
+  void enqueue(ShapedStream& stream);
+
+  /**
+   * Removes a stream from the queue.
+   */
+  void remove(ShapedStream& stream);
+
+private:
+  void onFillTimer();
+
+  const std::chrono::milliseconds fill_interval_;
+  const uint64_t bytes_per_fill_;
+  const Event::TimerPtr fill_timer_;
+  std::list<ShapedStream*> queue_;
+  // The first stream of the current round which got tokens and was queued again.
+  std::list<ShapedStream*>::iterator first_served_;
+  // The stream being served, unset if it is removed while writing its data.
+  ShapedStream* in_service_{};
+};
+
+using BandwidthShaperSharedPtr = std::shared_ptr<BandwidthShaper>;
+
+} // namespace BandwidthLimitFilter
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -17,8 +17,9 @@ absl::StatusOr<Http::FilterFactoryCb> BandwidthLimitFilterConfig::createFilterFa
     const std::string&, Server::Configuration::FactoryContext& context) {
   auto& server_context = context.serverFactoryContext();
 
-  absl::StatusOr<FilterConfigSharedPtr> filter_config = FilterConfig::create(
-      proto_config, context.scope(), server_context.runtime(), server_context.timeSource());
+  absl::StatusOr<FilterConfigSharedPtr> filter_config =
+      FilterConfig::create(proto_config, context.scope(), server_context.runtime(),
+                           server_context.timeSource(), false, &server_context.threadLocal());
   RETURN_IF_NOT_OK_REF(filter_config.status());
   return [filter_config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
     callbacks.addStreamFilter(std::make_shared<BandwidthLimiter>(*filter_config));
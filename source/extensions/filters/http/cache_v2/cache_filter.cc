@@ -49,7 +49,8 @@ CacheFilterConfig::CacheFilterConfig(
     : vary_allow_list_(config.allowed_vary_headers(), context), time_source_(context.timeSource()),
       ignore_request_cache_control_header_(config.ignore_request_cache_control_header()),
       cluster_manager_(context.clusterManager()), cache_sessions_(std::move(cache_sessions)),
-      override_upstream_cluster_(config.override_upstream_cluster()) {}
+      override_upstream_cluster_(config.override_upstream_cluster()),
+      slice_size_bytes_(config.slice_size_bytes()) {}
 
 bool CacheFilterConfig::isCacheableResponse(const Http::ResponseHeaderMap& headers) const {
   return CacheabilityUtils::isCacheableResponse(headers, vary_allow_list_);
@@ -151,7 +152,7 @@ Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::RequestHeaderMap& hea
   auto lookup_request = std::make_unique<ActiveLookupRequest>(
       headers, std::move(upstream_request_factory), *original_cluster_name,
       decoder_callbacks_->dispatcher(), config_->timeSource().systemTime(), config_, config_,
-      config_->ignoreRequestCacheControlHeader());
+      config_->ignoreRequestCacheControlHeader(), config_->sliceSizeBytes());
   is_head_request_ = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
   ENVOY_STREAM_LOG(debug, "CacheFilter::decodeHeaders starting lookup", *decoder_callbacks_);
   config_->cacheSessions().lookup(
@@ -34,6 +34,7 @@ public:
   Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
   const std::string& overrideUpstreamCluster() const { return override_upstream_cluster_; }
   bool ignoreRequestCacheControlHeader() const { return ignore_request_cache_control_header_; }
+  uint64_t sliceSizeBytes() const { return slice_size_bytes_; }
   CacheSessions& cacheSessions() const { return *cache_sessions_; }
   bool hasCache() const { return cache_sessions_ != nullptr; }
   CacheFilterStats& stats() const override { return cache_sessions_->stats(); }
@@ -47,6 +48,7 @@ private:
   std::shared_ptr<CacheSessions> cache_sessions_;
   CacheFilterStatsPtr stats_;
   std::string override_upstream_cluster_;
+  const uint64_t slice_size_bytes_;
 };
 
 /**
@@ -17,17 +17,53 @@ ActiveLookupRequest::ActiveLookupRequest(
     Event::Dispatcher& dispatcher, SystemTime timestamp,
     const std::shared_ptr<const CacheableResponseChecker> cacheable_response_checker,
     const std::shared_ptr<const CacheFilterStatsProvider> stats_provider,
-    bool ignore_request_cache_control_header)
+    bool ignore_request_cache_control_header, uint64_t slice_size)
     : upstream_request_factory_(std::move(upstream_request_factory)), dispatcher_(dispatcher),
       key_(CacheHeadersUtils::makeKey(request_headers, cluster_name)),
       request_headers_(Http::createHeaderMap<Http::RequestHeaderMapImpl>(request_headers)),
       cacheable_response_checker_(std::move(cacheable_response_checker)),
-      stats_provider_(std::move(stats_provider)), timestamp_(timestamp) {
+      stats_provider_(std::move(stats_provider)), timestamp_(timestamp), slice_size_(slice_size) {
   if (!ignore_request_cache_control_header) {
     initializeRequestCacheControl(request_headers);
   }
 }
 
+ActiveLookupRequest::ActiveLookupRequest(const ActiveLookupRequest& parent,
+                                         AdjustedByteRange slice)
+    : upstream_request_factory_(parent.upstream_request_factory_), dispatcher_(parent.dispatcher_),
+      key_(parent.key_),
+      request_headers_(Http::createHeaderMap<Http::RequestHeaderMapImpl>(*parent.request_headers_)),
+      cacheable_response_checker_(parent.cacheable_response_checker_),
+      stats_provider_(parent.stats_provider_), timestamp_(parent.timestamp_),
+      request_cache_control_(parent.request_cache_control_), slice_size_(parent.slice_size_),
+      slice_(slice) {
+  request_headers_->remove(Http::Headers::get().Range);
+  key_.set_slice_begin(slice.begin());
+  key_.set_slice_length(slice.length());
+}
+
+std::unique_ptr<ActiveLookupRequest> ActiveLookupRequest::forSlice(AdjustedByteRange slice) const {
+  ASSERT(!slice_.has_value(), "slices are not sliced further");
+  // The constructor is private, so make_unique can't be used.
+  return std::unique_ptr<ActiveLookupRequest>(new ActiveLookupRequest(*this, slice));
+}
+
+bool ActiveLookupRequest::wantsSlices() const {
+  if (slice_size_ == 0 || slice_.has_value() ||
+      request_headers_->getMethodValue() != Http::Headers::get().MethodValues.Get) {
+    return false;
+  }
+  absl::optional<std::vector<RawByteRange>> ranges = parseRange();
+  return ranges.has_value() && ranges->size() == 1 && !ranges->front().isSuffix();
+}
+
+void ActiveLookupRequest::addSliceRange(Http::RequestHeaderMap& headers) const {
+  if (slice_.has_value()) {
+    headers.setReferenceKey(Http::Headers::get().Range,
+                            fmt::format("bytes={}-{}", slice_->begin(), slice_->end() - 1));
+  }
+}
+
 absl::optional<std::vector<RawByteRange>> ActiveLookupRequest::parseRange() const {
   auto range_header = RangeUtils::getRangeHeader(*request_headers_);
   if (!range_header) {
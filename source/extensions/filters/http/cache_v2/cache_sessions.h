@@ -23,7 +23,7 @@ public:
       Event::Dispatcher& dispatcher, SystemTime timestamp,
       const std::shared_ptr<const CacheableResponseChecker> cacheable_response_checker_,
       const std::shared_ptr<const CacheFilterStatsProvider> stats_provider_,
-      bool ignore_request_cache_control_header);
+      bool ignore_request_cache_control_header, uint64_t slice_size = 0);
 
   // Caches may modify the key according to local needs, though care must be
   // taken to ensure that meaningfully distinct responses have distinct keys.
@@ -50,10 +50,25 @@ public:
   absl::optional<std::vector<RawByteRange>> parseRange() const;
   bool isRangeRequest() const;
 
+  // The size of the slices in which range requests are filled, or 0 if they are not.
+  uint64_t sliceSize() const { return slice_size_; }
+  // True if this request should be served by looking up and stitching together slices:
+  // a single, non-suffix range GET request, when a slice size is configured.
+  bool wantsSlices() const;
+  // For a lookup of a single slice, the byte range of the response body it covers.
+  const absl::optional<AdjustedByteRange>& slice() const { return slice_; }
+  // Creates a lookup for one slice of the response to this request. The new lookup has no
+  // range header, and its key identifies the slice.
+  std::unique_ptr<ActiveLookupRequest> forSlice(AdjustedByteRange slice) const;
+  // Adds a range header requesting the slice, if this is a lookup of a slice.
+  void addSliceRange(Http::RequestHeaderMap& headers) const;
+
 private:
+  ActiveLookupRequest(const ActiveLookupRequest& parent, AdjustedByteRange slice);
   void initializeRequestCacheControl(const Http::RequestHeaderMap& request_headers);
 
-  UpstreamRequestFactoryPtr upstream_request_factory_;
+  // Shared with the lookups of slices of this request.
+  std::shared_ptr<UpstreamRequestFactory> upstream_request_factory_;
   Event::Dispatcher& dispatcher_;
   Key key_;
   std::vector<RawByteRange> request_range_spec_;
@@ -63,6 +78,8 @@ private:
   // Time when this LookupRequest was created (in response to an HTTP request).
   SystemTime timestamp_;
   RequestCacheControl request_cache_control_;
+  const uint64_t slice_size_;
+  const absl::optional<AdjustedByteRange> slice_;
 };
 using ActiveLookupRequestPtr = std::unique_ptr<ActiveLookupRequest>;
 
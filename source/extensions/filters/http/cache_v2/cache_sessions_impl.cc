@@ -8,6 +8,7 @@
 #include "source/extensions/filters/http/cache_v2/cache_headers_utils.h"
 #include "source/extensions/filters/http/cache_v2/cacheability_utils.h"
 #include "source/extensions/filters/http/cache_v2/range_utils.h"
+#include "source/extensions/filters/http/cache_v2/sliced_lookup.h"
 #include "source/extensions/filters/http/cache_v2/upstream_request.h"
 
 namespace Envoy {
@@ -78,6 +79,18 @@ requestHeadersWithRangeRemoved(const Http::RequestHeaderMap& original_headers) {
   return headers;
 }
 
+// A slice may only be cached from a partial response starting at the beginning of the slice
+// and not extending past its end; the last slice of a response may be shorter.
+static bool isResponseForSlice(const Http::ResponseHeaderMap& headers,
+                               const AdjustedByteRange& slice) {
+  if (Http::Utility::getResponseStatus(headers) != enumToInt(Http::Code::PartialContent)) {
+    return false;
+  }
+  absl::optional<ContentRange> content_range = RangeUtils::parseContentRange(headers);
+  return content_range.has_value() && content_range->range_.begin() == slice.begin() &&
+         content_range->range_.end() <= slice.end();
+}
+
 static Http::ResponseHeaderMapPtr notSatisfiableHeaders() {
   static const std::string not_satisfiable =
       std::to_string(enumToInt(Http::Code::RangeNotSatisfiable));
@@ -325,9 +338,12 @@ static void postUpstreamPassThrough(CacheSession::LookupSubscriber&& sub, CacheE
   Event::Dispatcher& dispatcher = sub.dispatcher();
   dispatcher.post([sub = std::move(sub), status]() mutable {
     auto result = std::make_unique<ActiveLookupResult>();
-    auto upstream = sub.context_->lookup().createUpstreamRequest();
-    upstream->sendHeaders(
-        Http::createHeaderMap<Http::RequestHeaderMapImpl>(sub.context_->lookup().requestHeaders()));
+    const ActiveLookupRequest& lookup = sub.context_->lookup();
+    auto upstream = lookup.createUpstreamRequest();
+    Http::RequestHeaderMapPtr request_headers =
+        Http::createHeaderMap<Http::RequestHeaderMapImpl>(lookup.requestHeaders());
+    lookup.addSliceRange(*request_headers);
+    upstream->sendHeaders(std::move(request_headers));
     result->http_source_ = std::move(upstream);
     result->status_ = status;
     sub.callback_(std::move(result));
@@ -339,11 +355,14 @@ static void postUpstreamPassThroughWithReset(CacheSession::LookupSubscriber&& su
   Event::Dispatcher& dispatcher = sub.dispatcher();
   dispatcher.post([sub = std::move(sub), entry = std::move(entry)]() mutable {
     auto result = std::make_unique<ActiveLookupResult>();
-    auto upstream = sub.context_->lookup().createUpstreamRequest();
-    upstream->sendHeaders(
-        Http::createHeaderMap<Http::RequestHeaderMapImpl>(sub.context_->lookup().requestHeaders()));
+    const ActiveLookupRequest& lookup = sub.context_->lookup();
+    auto upstream = lookup.createUpstreamRequest();
+    Http::RequestHeaderMapPtr request_headers =
+        Http::createHeaderMap<Http::RequestHeaderMapImpl>(lookup.requestHeaders());
+    lookup.addSliceRange(*request_headers);
+    upstream->sendHeaders(std::move(request_headers));
     result->http_source_ = std::make_unique<UpstreamRequestWithCacheabilityReset>(
-        sub.context_->lookup().cacheableResponseChecker(), std::move(upstream), entry);
+        lookup.cacheableResponseChecker(), std::move(upstream), entry);
     result->status_ = CacheEntryStatus::Uncacheable;
     sub.callback_(std::move(result));
   });
@@ -658,6 +677,7 @@ void CacheSession::performUpstreamRequest() {
   } else {
     request_headers = Http::createHeaderMap<Http::RequestHeaderMapImpl>(lookup.requestHeaders());
   }
+  lookup.addSliceRange(*request_headers);
   upstream_request_ = lookup.createUpstreamRequest();
   first_sub.dispatcher().post([upstream_request = upstream_request_.get(),
                                request_headers = std::move(request_headers), this,
@@ -816,7 +836,12 @@ void CacheSession::onUpstreamHeaders(Http::ResponseHeaderMapPtr headers, EndStre
   if (!cl.empty()) {
     absl::SimpleAtoi(cl, &content_length_header_) || (content_length_header_ = 0);
   }
-  if (!lookup_subscribers_.front().context_->lookup().isCacheableResponse(*headers)) {
+  const ActiveLookupRequest& first_lookup = lookup_subscribers_.front().context_->lookup();
+  if (first_lookup.slice().has_value() && !isResponseForSlice(*headers, *first_lookup.slice())) {
+    ENVOY_LOG(debug, "upstream response is not the requested slice, treating as not cacheable");
+    return onUncacheable(std::move(headers), end_stream, range_header_was_stripped);
+  }
+  if (!first_lookup.isCacheableResponse(*headers)) {
     return onUncacheable(std::move(headers), end_stream, range_header_was_stripped);
   }
   if (VaryHeaderUtils::hasVary(*headers)) {
@@ -854,6 +879,9 @@ void CacheSession::onUpstreamHeaders(Http::ResponseHeaderMapPtr headers, EndStre
 void CacheSessionsImpl::lookup(ActiveLookupRequestPtr request, ActiveLookupResultCallback&& cb) {
   ASSERT(request);
   ASSERT(cb);
+  if (request->wantsSlices()) {
+    return SlicedLookup::start(shared_from_this(), std::move(request), std::move(cb));
+  }
   std::shared_ptr<CacheSession> entry = getEntry(request->key());
   entry->getLookupResult(std::move(request), std::move(cb));
 }
@@ -872,6 +900,7 @@ void CacheSession::performValidation() {
   LookupSubscriber& first_sub = lookup_subscribers_.front();
   const ActiveLookupRequest& lookup = first_sub.context_->lookup();
   Http::RequestHeaderMapPtr req = requestHeadersWithRangeRemoved(lookup.requestHeaders());
+  lookup.addSliceRange(*req);
   CacheHeadersUtils::injectValidationHeaders(*req, *entry_.response_headers_);
   upstream_request_ = lookup.createUpstreamRequest();
   first_sub.dispatcher().post([upstream_request = upstream_request_.get(), req = std::move(req),
@@ -165,6 +165,37 @@ RangeUtils::parseRangeHeader(absl::string_view range_header, uint64_t max_byte_r
   return parsed_ranges;
 }
 
+absl::optional<ContentRange> RangeUtils::parseContentRange(absl::string_view content_range) {
+  if (!absl::ConsumePrefix(&content_range, "bytes ")) {
+    return absl::nullopt;
+  }
+  absl::optional<uint64_t> first = CacheHeadersUtils::readAndRemoveLeadingDigits(content_range);
+  if (!first || !absl::ConsumePrefix(&content_range, "-")) {
+    return absl::nullopt;
+  }
+  absl::optional<uint64_t> last = CacheHeadersUtils::readAndRemoveLeadingDigits(content_range);
+  if (!last || !absl::ConsumePrefix(&content_range, "/")) {
+    return absl::nullopt;
+  }
+  absl::optional<uint64_t> complete_length =
+      CacheHeadersUtils::readAndRemoveLeadingDigits(content_range);
+  if (!complete_length || !content_range.empty() || first > last ||
+      last >= complete_length) {
+    return absl::nullopt;
+  }
+  return ContentRange{AdjustedByteRange(first.value(), last.value() + 1), complete_length.value()};
+}
+
+absl::optional<ContentRange>
+RangeUtils::parseContentRange(const Envoy::Http::ResponseHeaderMap& headers) {
+  const Envoy::Http::HeaderMap::GetResult content_range =
+      headers.get(Envoy::Http::Headers::get().ContentRange);
+  if (content_range.size() != 1) {
+    return absl::nullopt;
+  }
+  return parseContentRange(content_range[0]->value().getStringView());
+}
+
 } // namespace CacheV2
 } // namespace HttpFilters
 } // namespace Extensions
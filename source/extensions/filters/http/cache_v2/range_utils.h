@@ -94,6 +94,14 @@ inline bool operator==(const AdjustedByteRange& lhs, const AdjustedByteRange& rh
 
 std::ostream& operator<<(std::ostream& os, const AdjustedByteRange& range);
 
+// The byte range of a partial response, from its content-range header.
+struct ContentRange {
+  // The range of the complete response body that the partial response holds.
+  AdjustedByteRange range_;
+  // The length of the complete response body.
+  uint64_t complete_length_;
+};
+
 // Contains details about whether the ranges requested can be satisfied and, if
 // so, what those ranges are after being adjusted to fit the content.
 struct RangeDetails {
@@ -130,6 +138,14 @@ RangeDetails createAdjustedRangeDetails(const std::vector<RawByteRange>& request
 // max_byte_range_specs, returns nullopt.
 absl::optional<std::vector<RawByteRange>> parseRangeHeader(absl::string_view range_header,
                                                            uint64_t max_byte_range_specs);
+
+// Parses a content-range header value of the form "bytes first-last/complete-length". Returns
+// nullopt if the value is malformed, or is of any other form, e.g. has an unknown ("*")
+// complete length, or is for an unsatisfied range.
+absl::optional<ContentRange> parseContentRange(absl::string_view content_range);
+// As above, for the content-range header of the response headers. Returns nullopt if there is
+// not exactly one content-range header.
+absl::optional<ContentRange> parseContentRange(const Envoy::Http::ResponseHeaderMap& headers);
 } // namespace RangeUtils
 } // namespace CacheV2
 } // namespace HttpFilters
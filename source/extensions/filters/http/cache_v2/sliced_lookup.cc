@@ -0,0 +1,305 @@
+#include "source/extensions/filters/http/cache_v2/sliced_lookup.h"
+
+#include <algorithm>
+
+#include "source/common/common/enum_to_int.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/http/headers.h"
+#include "source/common/http/utility.h"
+#include "source/extensions/filters/http/cache_v2/cache_custom_headers.h"
+
+#include "absl/strings/numbers.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+
+using CancelWrapper::cancelWrapped;
+
+namespace {
+
+// Sources for these statuses are upstream responses, which can only be read in order from
+// the start of their body; other sources are cache entries, which can be read at any offset.
+bool isStream(CacheEntryStatus status) {
+  return status == CacheEntryStatus::Uncacheable || status == CacheEntryStatus::LookupError;
+}
+
+} // namespace
+
+SlicedLookup::SlicedLookup(std::shared_ptr<CacheSessions> sessions, ActiveLookupRequestPtr request)
+    : sessions_(std::move(sessions)), request_(std::move(request)),
+      slice_size_(request_->sliceSize()) {}
+
+SlicedLookup::~SlicedLookup() {
+  if (cancel_in_flight_callback_) {
+    cancel_in_flight_callback_();
+  }
+}
+
+void SlicedLookup::start(std::shared_ptr<CacheSessions> sessions, ActiveLookupRequestPtr request,
+                         ActiveLookupResultCallback&& cb) {
+  ASSERT(request->wantsSlices());
+  const uint64_t index = request->parseRange()->front().firstBytePos() / request->sliceSize();
+  // The constructor is private, so make_unique can't be used.
+  std::unique_ptr<SlicedLookup> self(new SlicedLookup(std::move(sessions), std::move(request)));
+  SlicedLookup& lookup = *self;
+  // Until the first slice's headers arrive, the lookup is owned by its own callback.
+  lookup.lookupSlice(index, [self = std::move(self), cb = std::move(cb), index](
+                                ActiveLookupResultPtr result, Http::ResponseHeaderMapPtr headers,
+                                EndStream end_stream) mutable {
+    onFirstSlice(std::move(self), std::move(cb), index, std::move(result), std::move(headers),
+                 end_stream);
+  });
+}
+
+void SlicedLookup::lookupSlice(uint64_t index, SliceCallback&& cb) {
+  sessions_->lookup(
+      request_->forSlice(AdjustedByteRange(index * slice_size_, (index + 1) * slice_size_)),
+      [cb = std::move(cb)](ActiveLookupResultPtr result) mutable {
+        if (!result->http_source_) {
+          return cb(std::move(result), nullptr, EndStream::Reset);
+        }
+        HttpSource& source = *result->http_source_;
+        source.getHeaders([result = std::move(result), cb = std::move(cb)](
+                              Http::ResponseHeaderMapPtr headers, EndStream end_stream) mutable {
+          cb(std::move(result), std::move(headers), end_stream);
+        });
+      });
+}
+
+void SlicedLookup::onFirstSlice(std::unique_ptr<SlicedLookup> self,
+                                ActiveLookupResultCallback&& cb, uint64_t index,
+                                ActiveLookupResultPtr result, Http::ResponseHeaderMapPtr headers,
+                                EndStream end_stream) {
+  if (end_stream == EndStream::Reset || headers == nullptr) {
+    // Let the filter handle the failed lookup as it would any other.
+    result->http_source_ = nullptr;
+    return cb(std::move(result));
+  }
+  absl::optional<ContentRange> content_range;
+  if (Http::Utility::getResponseStatus(*headers) == enumToInt(Http::Code::PartialContent)) {
+    content_range = RangeUtils::parseContentRange(*headers);
+  }
+  const uint64_t slice_begin = index * self->slice_size_;
+  if (!content_range.has_value() || end_stream != EndStream::More ||
+      content_range->range_.begin() != slice_begin ||
+      (content_range->range_.end() != slice_begin + self->slice_size_ &&
+       content_range->range_.end() != content_range->complete_length_)) {
+    // The upstream didn't respond with the requested slice, e.g. because it doesn't support
+    // range requests, so its response is served as is.
+    ENVOY_LOG(debug, "response to slice request is not a slice, passing it through");
+    self->passthrough_ = true;
+    self->slice_is_stream_ = isStream(result->status_);
+    self->slice_source_ = std::move(result->http_source_);
+    self->end_stream_after_headers_ = end_stream;
+    self->setPassthroughHeaders(std::move(headers), content_range);
+    result->http_source_ = std::move(self);
+    return cb(std::move(result));
+  }
+  self->complete_length_ = content_range->complete_length_;
+  self->etag_ = std::string(headers->getInlineValue(CacheCustomHeaders::etag()));
+  self->last_modified_ = std::string(headers->getInlineValue(CacheCustomHeaders::lastModified()));
+  self->setHeadersFromFirstSlice(std::move(headers));
+  self->useSlice(index, *result);
+  result->http_source_ = std::move(self);
+  cb(std::move(result));
+}
+
+void SlicedLookup::setHeadersFromFirstSlice(Http::ResponseHeaderMapPtr headers) {
+  RangeDetails range_details =
+      RangeUtils::createAdjustedRangeDetails(request_->parseRange().value(), complete_length_);
+  // The first requested byte is within the first slice, so the range is satisfiable.
+  ASSERT(range_details.satisfiable_);
+  if (range_details.ranges_.empty()) {
+    // The whole body was requested.
+    static const std::string ok = std::to_string(enumToInt(Http::Code::OK));
+    headers->setStatus(ok);
+    headers->remove(Http::Headers::get().ContentRange);
+    headers->setContentLength(complete_length_);
+  } else {
+    const AdjustedByteRange& range = range_details.ranges_[0];
+    headers->setReferenceKey(
+        Http::Headers::get().ContentRange,
+        fmt::format("bytes {}-{}/{}", range.begin(), range.end() - 1, complete_length_));
+    headers->setContentLength(range.length());
+  }
+  headers_ = std::move(headers);
+}
+
+void SlicedLookup::setPassthroughHeaders(Http::ResponseHeaderMapPtr headers,
+                                         const absl::optional<ContentRange>& content_range) {
+  // The part of the complete response body that the response holds, if known.
+  absl::optional<AdjustedByteRange> available;
+  uint64_t complete_length = 0;
+  if (content_range.has_value()) {
+    available = content_range->range_;
+    complete_length = content_range->complete_length_;
+    passthrough_offset_ = content_range->range_.begin();
+  } else if (Http::Utility::getResponseStatus(*headers) == enumToInt(Http::Code::OK) &&
+             absl::SimpleAtoi(headers->getContentLengthValue(), &complete_length) &&
+             complete_length > 0) {
+    available.emplace(0, complete_length);
+  }
+  headers_ = std::move(headers);
+  if (!available.has_value() || end_stream_after_headers_ != EndStream::More) {
+    return;
+  }
+  RangeDetails range_details =
+      RangeUtils::createAdjustedRangeDetails(request_->parseRange().value(), complete_length);
+  if (!range_details.satisfiable_ || range_details.ranges_.size() != 1) {
+    return;
+  }
+  const AdjustedByteRange& range = range_details.ranges_[0];
+  if (range.begin() < available->begin() || range.end() > available->end()) {
+    return;
+  }
+  // The response holds the whole requested range, so only that is served, as it would have
+  // been had the upstream responded with exactly the requested range.
+  static const std::string partial_content = std::to_string(enumToInt(Http::Code::PartialContent));
+  headers_->setStatus(partial_content);
+  headers_->setReferenceKey(
+      Http::Headers::get().ContentRange,
+      fmt::format("bytes {}-{}/{}", range.begin(), range.end() - 1, complete_length));
+  headers_->setContentLength(range.length());
+}
+
+bool SlicedLookup::isExpectedSlice(uint64_t index, const Http::ResponseHeaderMap* headers,
+                                   EndStream end_stream) const {
+  if (end_stream != EndStream::More || headers == nullptr ||
+      Http::Utility::getResponseStatus(*headers) != enumToInt(Http::Code::PartialContent)) {
+    return false;
+  }
+  absl::optional<ContentRange> content_range = RangeUtils::parseContentRange(*headers);
+  const uint64_t slice_begin = index * slice_size_;
+  return content_range.has_value() && content_range->range_.begin() == slice_begin &&
+         content_range->range_.end() ==
+             std::min(slice_begin + slice_size_, content_range->complete_length_) &&
+         content_range->complete_length_ == complete_length_ &&
+         headers->getInlineValue(CacheCustomHeaders::etag()) == etag_ &&
+         headers->getInlineValue(CacheCustomHeaders::lastModified()) == last_modified_;
+}
+
+void SlicedLookup::useSlice(uint64_t index, ActiveLookupResult& result) {
+  slice_index_ = index;
+  slice_source_ = std::move(result.http_source_);
+  slice_is_stream_ = isStream(result.status_);
+  slice_read_pos_ = 0;
+}
+
+void SlicedLookup::getHeaders(GetHeadersCallback&& cb) {
+  ASSERT(headers_);
+  cb(std::move(headers_), end_stream_after_headers_);
+}
+
+void SlicedLookup::getBody(AdjustedByteRange range, GetBodyCallback&& cb) {
+  if (passthrough_) {
+    return readPassthrough(std::move(range), std::move(cb));
+  }
+  if (range.begin() >= complete_length_) {
+    return cb(nullptr, EndStream::End);
+  }
+  const uint64_t index = range.begin() / slice_size_;
+  if (index == slice_index_ && slice_source_) {
+    return readSlice(std::move(range), std::move(cb));
+  }
+  // Done with the previous slice; release it before looking up the next.
+  slice_source_ = nullptr;
+  lookupSlice(index, cancelWrapped(
+                         [this, index, range = std::move(range), cb = std::move(cb)](
+                             ActiveLookupResultPtr result, Http::ResponseHeaderMapPtr headers,
+                             EndStream end_stream) mutable {
+                           if (!isExpectedSlice(index, headers.get(), end_stream)) {
+                             // The response changed, or the upstream failed, part way through.
+                             ENVOY_LOG(debug, "slice {} does not match the first slice", index);
+                             return cb(nullptr, EndStream::Reset);
+                           }
+                           useSlice(index, *result);
+                           readSlice(std::move(range), std::move(cb));
+                         },
+                         &cancel_in_flight_callback_));
+}
+
+void SlicedLookup::readSlice(AdjustedByteRange range, GetBodyCallback&& cb) {
+  const uint64_t slice_begin = slice_index_ * slice_size_;
+  const uint64_t local_begin = range.begin() - slice_begin;
+  const uint64_t local_end =
+      std::min({range.end(), slice_begin + slice_size_, complete_length_}) - slice_begin;
+  if (slice_is_stream_ && slice_read_pos_ < local_begin) {
+    // A streamed slice can't skip ahead, so read and discard the bytes before the range.
+    return slice_source_->getBody(
+        AdjustedByteRange(slice_read_pos_, local_begin),
+        cancelWrapped(
+            [this, range = std::move(range), cb = std::move(cb)](Buffer::InstancePtr buffer,
+                                                                 EndStream end_stream) mutable {
+              if (end_stream == EndStream::Reset || buffer == nullptr || buffer->length() == 0) {
+                return cb(nullptr, EndStream::Reset);
+              }
+              slice_read_pos_ += buffer->length();
+              readSlice(std::move(range), std::move(cb));
+            },
+            &cancel_in_flight_callback_));
+  }
+  slice_source_->getBody(
+      AdjustedByteRange(local_begin, local_end),
+      cancelWrapped(
+          [this, local_begin, cb = std::move(cb)](Buffer::InstancePtr buffer,
+                                                  EndStream end_stream) mutable {
+            if (end_stream == EndStream::Reset || buffer == nullptr || buffer->length() == 0) {
+              // The slice was shorter than its content-range said.
+              return cb(nullptr, EndStream::Reset);
+            }
+            slice_read_pos_ = local_begin + buffer->length();
+            const bool complete =
+                slice_index_ * slice_size_ + slice_read_pos_ >= complete_length_;
+            cb(std::move(buffer), complete ? EndStream::End : EndStream::More);
+          },
+          &cancel_in_flight_callback_));
+}
+
+void SlicedLookup::readPassthrough(AdjustedByteRange range, GetBodyCallback&& cb) {
+  ASSERT(range.begin() >= passthrough_offset_);
+  const uint64_t local_begin = range.begin() - passthrough_offset_;
+  const uint64_t local_end = range.end() - passthrough_offset_;
+  if (slice_is_stream_ && slice_read_pos_ < local_begin) {
+    // A streamed response can't skip ahead, so read and discard the bytes before the range.
+    return slice_source_->getBody(
+        AdjustedByteRange(slice_read_pos_, local_begin),
+        cancelWrapped(
+            [this, range = std::move(range), cb = std::move(cb)](Buffer::InstancePtr buffer,
+                                                                 EndStream end_stream) mutable {
+              if (end_stream == EndStream::Reset || buffer == nullptr || buffer->length() == 0) {
+                return cb(nullptr, EndStream::Reset);
+              }
+              slice_read_pos_ += buffer->length();
+              readPassthrough(std::move(range), std::move(cb));
+            },
+            &cancel_in_flight_callback_));
+  }
+  slice_source_->getBody(
+      AdjustedByteRange(local_begin, local_end),
+      cancelWrapped(
+          [this, local_begin, cb = std::move(cb)](Buffer::InstancePtr buffer,
+                                                  EndStream end_stream) mutable {
+            if (buffer != nullptr) {
+              slice_read_pos_ = local_begin + buffer->length();
+            }
+            cb(std::move(buffer), end_stream);
+          },
+          &cancel_in_flight_callback_));
+}
+
+void SlicedLookup::getTrailers(GetTrailersCallback&& cb) {
+  if (passthrough_) {
+    return slice_source_->getTrailers(std::move(cb));
+  }
+  // The end of the body of a sliced response is always reported with EndStream::End, as
+  // partial responses can't carry trailers of the complete response.
+  IS_ENVOY_BUG("getTrailers called on a sliced response");
+  cb(nullptr, EndStream::Reset);
+}
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
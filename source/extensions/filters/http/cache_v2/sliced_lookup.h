@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "source/common/common/cancel_wrapper.h"
+#include "source/common/common/logger.h"
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/filters/http/cache_v2/http_source.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+
+// Serves a single-range request from a response that is filled and cached in
+// fixed-size, aligned slices. Each slice is looked up through CacheSessions as
+// an independent cache entry, so concurrent requests for overlapping ranges
+// share slice lookups and upstream fills, and a request for a few bytes of a
+// large response only fetches the slices containing them. The bodies of the
+// slices overlapping the requested range are stitched into one response body.
+//
+// Slices are looked up one at a time, as the body is read; only the slice
+// being read is held open.
+class SlicedLookup : public HttpSource, public Logger::Loggable<Logger::Id::cache_filter> {
+public:
+  // Looks up the slice containing the first requested byte, and calls cb with a
+  // result whose source serves the requested range. If the upstream did not
+  // respond to the slice request with a matching partial response, the source
+  // serves that response, narrowed to the requested range if it holds all of it.
+  // Prereq: request->wantsSlices().
+  static void start(std::shared_ptr<CacheSessions> sessions, ActiveLookupRequestPtr request,
+                    ActiveLookupResultCallback&& cb);
+  ~SlicedLookup() override;
+
+  // HttpSource
+  void getHeaders(GetHeadersCallback&& cb) override;
+  void getBody(AdjustedByteRange range, GetBodyCallback&& cb) override;
+  void getTrailers(GetTrailersCallback&& cb) override;
+
+private:
+  using SliceCallback = absl::AnyInvocable<void(ActiveLookupResultPtr result,
+                                                Http::ResponseHeaderMapPtr headers,
+                                                EndStream end_stream)>;
+
+  SlicedLookup(std::shared_ptr<CacheSessions> sessions, ActiveLookupRequestPtr request);
+
+  // Looks up the slice with the given index and gets its headers.
+  void lookupSlice(uint64_t index, SliceCallback&& cb);
+  static void onFirstSlice(std::unique_ptr<SlicedLookup> self, ActiveLookupResultCallback&& cb,
+                           uint64_t index, ActiveLookupResultPtr result,
+                           Http::ResponseHeaderMapPtr headers, EndStream end_stream);
+  // Builds the response headers for the requested range from the first slice's headers.
+  void setHeadersFromFirstSlice(Http::ResponseHeaderMapPtr headers);
+  // Sets the response headers for a response that is passed through rather than sliced,
+  // narrowing its range to the requested range when it holds all of it.
+  void setPassthroughHeaders(Http::ResponseHeaderMapPtr headers,
+                             const absl::optional<ContentRange>& content_range);
+  // Returns true if the headers are those of the slice with the given index, of
+  // the same response as the first slice.
+  bool isExpectedSlice(uint64_t index, const Http::ResponseHeaderMap* headers,
+                       EndStream end_stream) const;
+  // Makes the slice with the given index, whose source is taken from the result, current.
+  void useSlice(uint64_t index, ActiveLookupResult& result);
+  // Reads the part of the range that is within the current slice.
+  void readSlice(AdjustedByteRange range, GetBodyCallback&& cb);
+  // Reads the range from a passed through response.
+  void readPassthrough(AdjustedByteRange range, GetBodyCallback&& cb);
+
+  const std::shared_ptr<CacheSessions> sessions_;
+  const ActiveLookupRequestPtr request_;
+  const uint64_t slice_size_;
+
+  // Set if the first slice's response was passed through as is, rather than
+  // sliced. A passed through partial response is a stream starting at
+  // passthrough_offset_ in the coordinates of its content-range. The slice
+  // members below then refer to the passed through response.
+  bool passthrough_ = false;
+  uint64_t passthrough_offset_ = 0;
+  Http::ResponseHeaderMapPtr headers_;
+  EndStream end_stream_after_headers_ = EndStream::More;
+
+  // The length of the complete response body, and its validators, from the
+  // first slice. Every other slice must be of the same response.
+  uint64_t complete_length_ = 0;
+  std::string etag_;
+  std::string last_modified_;
+
+  // The slice currently being read.
+  uint64_t slice_index_ = 0;
+  HttpSourcePtr slice_source_;
+  // True if the slice source is an upstream response rather than a cache entry,
+  // in which case it can only be read in order.
+  bool slice_is_stream_ = false;
+  // The offset within the slice up to which a streamed slice has been read.
+  uint64_t slice_read_pos_ = 0;
+
+  CancelWrapper::CancelFunction cancel_in_flight_callback_;
+};
+
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
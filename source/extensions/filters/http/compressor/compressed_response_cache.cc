@@ -0,0 +1,168 @@
+#include "source/extensions/filters/http/compressor/compressed_response_cache.h"
+
+#include "envoy/http/codes.h"
+
+#include "source/common/common/enum_to_int.h"
+#include "source/common/common/utility.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/http/headers.h"
+#include "source/common/http/utility.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+namespace {
+
+Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::ResponseHeaders>
+    cache_control_handle(Http::CustomHeaders::get().CacheControl);
+Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::ResponseHeaders>
+    etag_handle(Http::CustomHeaders::get().Etag);
+Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::ResponseHeaders>
+    vary_handle(Http::CustomHeaders::get().Vary);
+
+constexpr uint64_t DefaultMaxCacheSizeBytes = 32 * 1024 * 1024;
+constexpr uint64_t DefaultMaxEntrySizeBytes = 1024 * 1024;
+
+// Holds a reference to a cache entry for as long as a buffer refers to its body.
+class EntryFragment : public Buffer::BufferFragment {
+public:
+  explicit EntryFragment(CompressedResponseCache::EntryConstSharedPtr entry)
+      : entry_(std::move(entry)) {}
+  // Buffer::BufferFragment
+  const void* data() const override { return entry_->compressed_body_.data(); }
+  size_t size() const override { return entry_->compressed_body_.size(); }
+  void done() override { delete this; }
+
+private:
+  const CompressedResponseCache::EntryConstSharedPtr entry_;
+};
+
+absl::string_view headerValue(const Http::HeaderEntry* entry) {
+  return entry != nullptr ? entry->value().getStringView() : absl::string_view();
+}
+
+bool isStrongEtag(absl::string_view etag) {
+  return !etag.empty() && !absl::StartsWithIgnoreCase(etag, "W/");
+}
+
+} // namespace
+
+CompressedResponseCache::CompressedResponseCache(const Config& config,
+                                                 const std::string& stats_prefix,
+                                                 Stats::Scope& scope)
+    : max_cache_size_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_size_bytes, DefaultMaxCacheSizeBytes)),
+      max_entry_size_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entry_size_bytes, DefaultMaxEntrySizeBytes)),
+      stats_{COMPRESSED_RESPONSE_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix),
+                                             POOL_GAUGE_PREFIX(scope, stats_prefix))} {}
+
+absl::optional<std::string>
+CompressedResponseCache::requestIdentity(const Http::RequestHeaderMap& headers) {
+  // An upstream may answer an authenticated request with a body for that user alone, even
+  // without marking the response private.
+  if (!headers.get(Http::CustomHeaders::get().Authorization).empty() ||
+      !headers.get(Http::Headers::get().Cookie).empty()) {
+    return absl::nullopt;
+  }
+  return absl::StrCat(headers.getHostValue(), "\n", headers.getPathValue());
+}
+
+absl::optional<std::string>
+CompressedResponseCache::makeKey(absl::string_view request_identity,
+                                 const Http::ResponseHeaderMap& headers) {
+  // A partial response carries only a range of the body, which the ETag does not identify.
+  if (Http::Utility::getResponseStatusOrNullopt(headers) != enumToInt(Http::Code::OK) ||
+      !headers.get(Http::Headers::get().ContentRange).empty()) {
+    return absl::nullopt;
+  }
+  const absl::string_view cache_control =
+      headerValue(headers.getInline(cache_control_handle.handle()));
+  if (StringUtil::caseFindToken(cache_control, ",", "no-store") ||
+      StringUtil::caseFindToken(cache_control, ",",
+                                Http::CustomHeaders::get().CacheControlValues.Private)) {
+    return absl::nullopt;
+  }
+  // The compressed body depends only on the uncompressed one, but a response that varies on
+  // other request headers may have several bodies under one ETag.
+  for (absl::string_view token :
+       StringUtil::splitToken(headerValue(headers.getInline(vary_handle.handle())), ",")) {
+    if (!absl::EqualsIgnoreCase(StringUtil::trim(token),
+                                Http::CustomHeaders::get().VaryValues.AcceptEncoding)) {
+      return absl::nullopt;
+    }
+  }
+  // Only a strong ETag identifies the body's bytes. A weak ETag only promises semantic
+  // equivalence, and Last-Modified has a granularity of a second, within which the body may change.
+  const absl::string_view etag = headerValue(headers.getInline(etag_handle.handle()));
+  if (!isStrongEtag(etag)) {
+    return absl::nullopt;
+  }
+  return absl::StrCat(request_identity, "\n", etag, "\n", headers.getContentLengthValue());
+}
+
+CompressedResponseCache::EntryConstSharedPtr
+CompressedResponseCache::lookup(const std::string& key) {
+  Thread::LockGuard lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  stats_.hit_.inc();
+  return it->second->entry_;
+}
+
+void CompressedResponseCache::insert(const std::string& key, std::string&& compressed_body) {
+  const uint64_t size = compressed_body.size();
+  if (size > max_entry_size_bytes_ || size > max_cache_size_bytes_) {
+    stats_.insert_rejected_.inc();
+    return;
+  }
+  auto entry = std::make_shared<const Entry>(std::move(compressed_body));
+  Thread::LockGuard lock(mutex_);
+  // Concurrent misses on the same body each compress it; the first to finish is kept.
+  if (index_.contains(key)) {
+    return;
+  }
+  while (size_bytes_ + size > max_cache_size_bytes_) {
+    evictLeastRecentlyUsed();
+  }
+  lru_.push_front(LruItem{key, std::move(entry)});
+  index_.emplace(key, lru_.begin());
+  size_bytes_ += size;
+  stats_.insert_.inc();
+  stats_.size_bytes_.add(size);
+  stats_.size_count_.inc();
+}
+
+void CompressedResponseCache::evictLeastRecentlyUsed() {
+  ASSERT(!lru_.empty());
+  const LruItem& victim = lru_.back();
+  const uint64_t size = victim.entry_->compressed_body_.size();
+  index_.erase(victim.key_);
+  lru_.pop_back();
+  size_bytes_ -= size;
+  stats_.eviction_.inc();
+  stats_.size_bytes_.sub(size);
+  stats_.size_count_.dec();
+}
+
+void CompressedResponseCache::addToBuffer(const EntryConstSharedPtr& entry,
+                                          Buffer::Instance& buffer) {
+  if (entry->compressed_body_.empty()) {
+    return;
+  }
+  buffer.addBufferFragment(*new EntryFragment(entry));
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
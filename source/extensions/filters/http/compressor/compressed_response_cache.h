@@ -0,0 +1,124 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/common/thread.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * Compressed response cache stats. @see stats_macros.h
+ * "uncompressed_bytes_saved" counts the upstream body bytes of cache hits, which the filter would
+ * otherwise have compressed.
+ */
+#define COMPRESSED_RESPONSE_CACHE_STATS(COUNTER, GAUGE)                                            \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(insert)                                                                                  \
+  COUNTER(insert_rejected)                                                                         \
+  COUNTER(eviction)                                                                                \
+  COUNTER(uncompressed_bytes_saved)                                                                \
+  GAUGE(size_bytes, Accumulate)                                                                    \
+  GAUGE(size_count, Accumulate)
+
+/**
+ * Struct definition for compressed response cache stats. @see stats_macros.h
+ */
+struct CompressedResponseCacheStats {
+  COMPRESSED_RESPONSE_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A bounded, least-recently-used cache of compressed response bodies, keyed by the identity of
+ * the uncompressed body. It is shared by all the workers using a filter configuration.
+ */
+class CompressedResponseCache {
+public:
+  using Config =
+      envoy::extensions::filters::http::compressor::v3::Compressor::CompressedResponseCache;
+
+  // The compressed body of a response. Entries are immutable, and remain valid for as long as
+  // they are referenced, even after they are evicted.
+  struct Entry {
+    Entry(std::string&& compressed_body) : compressed_body_(std::move(compressed_body)) {}
+    const std::string compressed_body_;
+  };
+  using EntryConstSharedPtr = std::shared_ptr<const Entry>;
+
+  CompressedResponseCache(const Config& config, const std::string& stats_prefix,
+                          Stats::Scope& scope);
+
+  /**
+   * @param request_identity the request's host and path, as captured by requestIdentity().
+   * @param headers the upstream response headers, before the filter modifies them.
+   * @return the cache key for the response body, or nullopt if the response does not identify
+   *         its body well enough for it to be cached.
+   */
+  static absl::optional<std::string> makeKey(absl::string_view request_identity,
+                                             const Http::ResponseHeaderMap& headers);
+
+  /**
+   * @return the part of a cache key identifying the resource requested, or nullopt if the
+   *         request carries credentials, whose response must not be served to other requests.
+   */
+  static absl::optional<std::string> requestIdentity(const Http::RequestHeaderMap& headers);
+
+  /**
+   * @return the cached entry for key, or nullptr on a miss.
+   */
+  EntryConstSharedPtr lookup(const std::string& key);
+
+  /**
+   * Caches compressed_body under key, evicting least recently used entries as needed. A body
+   * larger than the configured maximum entry size is not cached.
+   */
+  void insert(const std::string& key, std::string&& compressed_body);
+
+  /**
+   * Appends the body of entry to buffer without copying it. The entry is kept alive until
+   * buffer no longer refers to it.
+   */
+  static void addToBuffer(const EntryConstSharedPtr& entry, Buffer::Instance& buffer);
+
+  uint64_t maxEntrySizeBytes() const { return max_entry_size_bytes_; }
+  const CompressedResponseCacheStats& stats() const { return stats_; }
+
+private:
+  struct LruItem {
+    std::string key_;
+    EntryConstSharedPtr entry_;
+  };
+  using LruList = std::list<LruItem>;
+
+  void evictLeastRecentlyUsed() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const uint64_t max_cache_size_bytes_;
+  const uint64_t max_entry_size_bytes_;
+  CompressedResponseCacheStats stats_;
+
+  Thread::MutexBasicLockable mutex_;
+  // Most recently used entries are at the front.
+  LruList lru_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, LruList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+  uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_){0};
+};
+using CompressedResponseCachePtr = std::unique_ptr<CompressedResponseCache>;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
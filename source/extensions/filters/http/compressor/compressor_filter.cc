@@ -8,6 +8,7 @@
 #include "source/common/buffer/buffer_impl.h"
 #include "source/common/config/utility.h"
 #include "source/common/http/header_map_impl.h"
+#include "source/common/http/path_utility.h"
 #include "source/common/http/utility.h"
 #include "source/common/protobuf/protobuf.h"
 
@@ -81,6 +82,50 @@ void compressAndUpdateStats(const Compression::Compressor::CompressorPtr& compre
   stats.total_compressed_bytes_.add(data.length());
 }
 
+// Creates a compressor for the body of a request or response, before its Content-Length header is
+// removed, so that the compressor library may compress large bodies differently.
+Compression::Compressor::CompressorPtr
+createCompressor(Compression::Compressor::CompressorFactory& factory,
+                 const Http::RequestOrResponseHeaderMap& headers) {
+  uint64_t content_length;
+  if (absl::SimpleAtoi(headers.getContentLengthValue(), &content_length)) {
+    return factory.createCompressorForContentLength(content_length);
+  }
+  return factory.createCompressor();
+}
+
+// Returns whether an Accept-Encoding header value accepts encoding with a non-zero q-value.
+bool isEncodingAccepted(absl::string_view accept_encoding, absl::string_view encoding) {
+  for (absl::string_view token : StringUtil::splitToken(accept_encoding, ",", false)) {
+    if (!absl::EqualsIgnoreCase(StringUtil::trim(StringUtil::cropRight(token, ";")), encoding)) {
+      continue;
+    }
+    const absl::string_view params = StringUtil::cropLeft(token, ";");
+    const absl::string_view q_value = StringUtil::cropLeft(params, "=");
+    float q = 1;
+    if (params != token && q_value != params &&
+        absl::EqualsIgnoreCase("q", StringUtil::trim(StringUtil::cropRight(params, "="))) &&
+        !absl::SimpleAtof(StringUtil::trim(q_value), &q)) {
+      return false;
+    }
+    return q > 0;
+  }
+  return false;
+}
+
+void appendVaryValue(Http::ResponseHeaderMap& headers, const std::string& value) {
+  const Http::HeaderEntry* vary = headers.getInline(vary_handle.handle());
+  if (vary != nullptr) {
+    if (!StringUtil::findToken(vary->value().getStringView(), ",", value, true)) {
+      std::string new_header;
+      absl::StrAppend(&new_header, vary->value().getStringView(), ", ", value);
+      headers.setInline(vary_handle.handle(), new_header);
+    }
+  } else {
+    headers.setReferenceInline(vary_handle.handle(), value);
+  }
+}
+
 } // namespace
 
 CompressorFilterConfig::DirectionConfig::DirectionConfig(
@@ -95,7 +140,7 @@ CompressorFilterConfig::DirectionConfig::DirectionConfig(
 CompressorFilterConfig::CompressorFilterConfig(
     const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
     const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-    Compression::Compressor::CompressorFactoryPtr compressor_factory)
+    Api::Api& api, Compression::Compressor::CompressorFactoryPtr compressor_factory)
     : common_stats_prefix_(fmt::format("{}compressor.{}.{}", stats_prefix,
                                        proto_config.compressor_library().name(),
                                        compressor_factory->statsPrefix())),
@@ -103,6 +148,12 @@ CompressorFilterConfig::CompressorFilterConfig(
       response_direction_config_(proto_config, common_stats_prefix_, scope, runtime),
       content_encoding_(compressor_factory->contentEncoding()),
       compressor_factory_(std::move(compressor_factory)),
+      shared_dictionaries_(
+          proto_config.response_direction_config().shared_dictionaries().empty()
+              ? nullptr
+              : std::make_unique<SharedDictionaries>(
+                    proto_config.response_direction_config().shared_dictionaries(), api,
+                    *compressor_factory_)),
       choose_first_(proto_config.choose_first()) {}
 
 StringUtil::CaseUnorderedSet CompressorFilterConfig::DirectionConfig::contentTypeSet(
@@ -146,7 +197,13 @@ CompressorFilterConfig::ResponseDirectionConfig::ResponseDirectionConfig(
               : proto_config.remove_accept_encoding_header()),
       uncompressible_response_codes_(uncompressibleResponseCodesSet(
           proto_config.response_direction_config().uncompressible_response_codes())),
-      response_stats_{generateResponseStats(stats_prefix, scope)} {}
+      response_stats_{generateResponseStats(stats_prefix, scope)},
+      compressed_response_cache_(
+          proto_config.response_direction_config().has_compressed_response_cache()
+              ? std::make_unique<CompressedResponseCache>(
+                    proto_config.response_direction_config().compressed_response_cache(),
+                    stats_prefix + "response.cache.", scope)
+              : nullptr) {}
 
 const envoy::extensions::filters::http::compressor::v3::Compressor::CommonDirectionConfig
 CompressorFilterConfig::ResponseDirectionConfig::commonConfig(
@@ -243,6 +300,30 @@ Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap
     accept_encoding_ = std::make_unique<std::string>(accept_encoding->value().getStringView());
   }
 
+  if (config_->responseDirectionConfig().compressedResponseCache() != nullptr) {
+    cache_request_identity_ = CompressedResponseCache::requestIdentity(headers);
+  }
+
+  if (const SharedDictionaries* dictionaries = config_->sharedDictionaries();
+      dictionaries != nullptr) {
+    const SharedDictionary* dictionary =
+        dictionaries->findByPath(Http::PathUtil::removeQueryAndFragment(headers.getPathValue()));
+    const bool head_request = headers.getMethodValue() == Http::Headers::get().MethodValues.Head;
+    if (dictionary != nullptr &&
+        (head_request || headers.getMethodValue() == Http::Headers::get().MethodValues.Get)) {
+      sendSharedDictionary(*dictionary, head_request);
+      return Http::FilterHeadersStatus::StopIteration;
+    }
+    const auto available_dictionary = headers.get(Http::CustomHeaders::get().AvailableDictionary);
+    if (!available_dictionary.empty()) {
+      shared_dictionary_ = dictionaries->findByAvailableDictionary(
+          StringUtil::trim(available_dictionary[0]->value().getStringView()));
+      if (shared_dictionary_ == nullptr) {
+        config_->responseDirectionConfig().responseStats().shared_dictionary_unknown_.inc();
+      }
+    }
+  }
+
   // Ensure per-route configuration is initialized only once for this stream.
   if (per_route_config_ == nullptr) {
     initPerRouteConfig();
@@ -261,10 +342,10 @@ Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::RequestHeaderMap
       request_config.isContentTypeAllowed(headers) &&
       !headers.getInline(request_content_encoding_handle.handle()) &&
       isTransferEncodingAllowed(headers)) {
+    request_compressor_ = createCompressor(getCompressorFactory(), headers);
     headers.removeContentLength();
     headers.setInline(request_content_encoding_handle.handle(), getContentEncoding());
     request_config.stats().compressed_.inc();
-    request_compressor_ = getCompressorFactory().createCompressor();
   } else {
     request_config.stats().not_compressed_.inc();
   }
@@ -348,12 +429,24 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
       isResponseCodeCompressible(headers, config);
   if (!end_stream && isAcceptEncodingAllowed(isEnabledAndContentLengthBigEnough, headers) &&
       isCompressible && isTransferEncodingAllowed(headers)) {
+    Envoy::Compression::Compressor::CompressorFactory* compressor_factory =
+        sharedDictionaryCompressorFactory();
+    if (compressor_factory != nullptr) {
+      config.responseStats().shared_dictionary_used_.inc();
+    } else {
+      compressor_factory = &getCompressorFactory();
+      // The cache is keyed by the upstream's headers, so it must be consulted before they change.
+      lookupCompressedResponse(headers);
+    }
+    // Instantiate the compressor, unless the compressed body is already at hand.
+    if (cached_response_ == nullptr) {
+      response_compressor_ = createCompressor(*compressor_factory, headers);
+    }
     sanitizeEtagHeader(headers);
     headers.removeContentLength();
-    headers.setInline(response_content_encoding_handle.handle(), getContentEncoding());
+    headers.setInline(response_content_encoding_handle.handle(),
+                      compressor_factory->contentEncoding());
     config.stats().compressed_.inc();
-    // Finally instantiate the compressor.
-    response_compressor_ = getCompressorFactory().createCompressor();
   } else {
     config.stats().not_compressed_.inc();
   }
@@ -369,26 +462,89 @@ Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::ResponseHeaderMa
 }
 
 Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
-  if (response_compressor_ != nullptr) {
+  if (cached_response_ != nullptr) {
+    encodeCachedResponse(data);
+  } else if (response_compressor_ != nullptr) {
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(), data,
                            end_stream);
+    fillCompressedResponseCache(data, end_stream);
   }
   return Http::FilterDataStatus::Continue;
 }
 
 Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::ResponseTrailerMap&) {
-  if (response_compressor_ != nullptr) {
+  if (cached_response_ != nullptr) {
+    if (!cached_response_sent_) {
+      Buffer::OwnedImpl cached_buffer;
+      encodeCachedResponse(cached_buffer);
+      encoder_callbacks_->addEncodedData(cached_buffer, true);
+    }
+  } else if (response_compressor_ != nullptr) {
     Buffer::OwnedImpl empty_buffer;
     // The presence of trailers means the stream is ended, but encodeData()
     // is never called with end_stream=true, thus let the compression library know
     // that the stream is ended.
     compressAndUpdateStats(response_compressor_, config_->responseDirectionConfig().stats(),
                            empty_buffer, true);
+    fillCompressedResponseCache(empty_buffer, true);
     encoder_callbacks_->addEncodedData(empty_buffer, true);
   }
   return Http::FilterTrailersStatus::Continue;
 }
 
+void CompressorFilter::lookupCompressedResponse(const Http::ResponseHeaderMap& headers) {
+  CompressedResponseCache* cache = config_->responseDirectionConfig().compressedResponseCache();
+  // A per-route compressor library may compress differently under the same content encoding.
+  if (cache == nullptr || !cache_request_identity_.has_value() ||
+      (per_route_config_ && per_route_config_->compressorFactory())) {
+    return;
+  }
+  absl::optional<std::string> key =
+      CompressedResponseCache::makeKey(*cache_request_identity_, headers);
+  if (!key.has_value()) {
+    return;
+  }
+  cached_response_ = cache->lookup(*key);
+  if (cached_response_ == nullptr) {
+    cache_fill_key_ = std::move(*key);
+    cache_fill_ = std::make_unique<Buffer::OwnedImpl>();
+  }
+}
+
+void CompressorFilter::encodeCachedResponse(Buffer::Instance& data) {
+  // The upstream body is identified by the cache key, so it need not be compressed again; the
+  // cached compressed body is sent whole in place of its first chunk.
+  const CompressedResponseCache& cache =
+      *config_->responseDirectionConfig().compressedResponseCache();
+  cache.stats().uncompressed_bytes_saved_.add(data.length());
+  data.drain(data.length());
+  if (!cached_response_sent_) {
+    CompressedResponseCache::addToBuffer(cached_response_, data);
+    cached_response_sent_ = true;
+  }
+}
+
+void CompressorFilter::fillCompressedResponseCache(const Buffer::Instance& compressed_data,
+                                                   bool end_stream) {
+  if (cache_fill_ == nullptr) {
+    return;
+  }
+  CompressedResponseCache* cache = config_->responseDirectionConfig().compressedResponseCache();
+  if (cache_fill_->length() + compressed_data.length() > cache->maxEntrySizeBytes()) {
+    cache->stats().insert_rejected_.inc();
+    cache_fill_.reset();
+    return;
+  }
+  // The compressed data itself continues downstream, so the cache keeps a copy.
+  for (const Buffer::RawSlice& slice : compressed_data.getRawSlices()) {
+    cache_fill_->add(slice.mem_, slice.len_);
+  }
+  if (end_stream) {
+    cache->insert(cache_fill_key_, cache_fill_->toString());
+    cache_fill_.reset();
+  }
+}
+
 bool CompressorFilter::hasCacheControlNoTransform(Http::ResponseHeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.getInline(cache_control_handle.handle());
   if (cache_control) {
@@ -686,19 +842,41 @@ bool CompressorFilter::isTransferEncodingAllowed(Http::RequestOrResponseHeaderMa
 }
 
 void CompressorFilter::insertVaryHeader(Http::ResponseHeaderMap& headers) {
-  const Http::HeaderEntry* vary = headers.getInline(vary_handle.handle());
-  if (vary != nullptr) {
-    if (!StringUtil::findToken(vary->value().getStringView(), ",",
-                               Http::CustomHeaders::get().VaryValues.AcceptEncoding, true)) {
-      std::string new_header;
-      absl::StrAppend(&new_header, vary->value().getStringView(), ", ",
-                      Http::CustomHeaders::get().VaryValues.AcceptEncoding);
-      headers.setInline(vary_handle.handle(), new_header);
-    }
-  } else {
-    headers.setReferenceInline(vary_handle.handle(),
-                               Http::CustomHeaders::get().VaryValues.AcceptEncoding);
-  }
+  appendVaryValue(headers, Http::CustomHeaders::get().VaryValues.AcceptEncoding);
+  // The response may also be compressed against a dictionary the client holds.
+  if (config_->sharedDictionaries() != nullptr) {
+    appendVaryValue(headers, Http::CustomHeaders::get().VaryValues.AvailableDictionary);
+  }
+}
+
+void CompressorFilter::sendSharedDictionary(const SharedDictionary& dictionary,
+                                            bool head_request) {
+  config_->responseDirectionConfig().responseStats().shared_dictionary_served_.inc();
+  Http::ResponseHeaderMapPtr headers = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(
+      {{Http::Headers::get().Status, std::to_string(enumToInt(Http::Code::OK))},
+       {Http::Headers::get().ContentType, "application/octet-stream"}});
+  headers->setContentLength(dictionary.content().size());
+  headers->setInline(cache_control_handle.handle(), dictionary.cacheControl());
+  headers->addReferenceKey(Http::CustomHeaders::get().UseAsDictionary,
+                           dictionary.useAsDictionary());
+  decoder_callbacks_->encodeHeaders(std::move(headers), head_request,
+                                    "compressor_shared_dictionary");
+  if (!head_request) {
+    Buffer::OwnedImpl body(dictionary.content());
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+Envoy::Compression::Compressor::CompressorFactory*
+CompressorFilter::sharedDictionaryCompressorFactory() const {
+  // A per-route compressor library does not compress against the filter's dictionaries.
+  if (shared_dictionary_ == nullptr || accept_encoding_ == nullptr ||
+      (per_route_config_ && per_route_config_->compressorFactory())) {
+    return nullptr;
+  }
+  Envoy::Compression::Compressor::CompressorFactory& factory =
+      shared_dictionary_->compressorFactory();
+  return isEncodingAccepted(*accept_encoding_, factory.contentEncoding()) ? &factory : nullptr;
 }
 
 // TODO(gsagula): It seems that every proxy has a different opinion how to handle Etag. Some
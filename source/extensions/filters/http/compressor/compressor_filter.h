@@ -1,13 +1,17 @@
 #pragma once
 
+#include "envoy/api/api.h"
 #include "envoy/compression/compressor/factory.h"
 #include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
 #include "envoy/server/factory_context.h"
 #include "envoy/stats/stats_macros.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/common/common/logger.h"
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/runtime/runtime_protos.h"
+#include "source/extensions/filters/http/compressor/compressed_response_cache.h"
+#include "source/extensions/filters/http/compressor/shared_dictionary.h"
 #include "source/extensions/filters/http/common/pass_through_filter.h"
 
 #include "absl/types/optional.h"
@@ -41,6 +45,11 @@ namespace Compressor {
  *
  * "header_gzip" is specific to the gzip filter and is deprecated since it duplicates
  * "header_compressor_used".
+ *
+ * "shared_dictionary_served" is a number of shared dictionaries sent to clients,
+ * "shared_dictionary_used" a number of responses compressed against a shared dictionary the
+ * client holds, and "shared_dictionary_unknown" a number of requests advertising a dictionary this
+ * filter instance does not have.
  */
 #define RESPONSE_COMPRESSOR_STATS(COUNTER)                                                         \
   COUNTER(no_accept_header)                                                                        \
@@ -49,7 +58,10 @@ namespace Compressor {
   COUNTER(header_compressor_overshadowed)                                                          \
   COUNTER(header_wildcard)                                                                         \
   COUNTER(header_not_valid)                                                                        \
-  COUNTER(not_compressed_etag)
+  COUNTER(not_compressed_etag)                                                                     \
+  COUNTER(shared_dictionary_served)                                                                \
+  COUNTER(shared_dictionary_used)                                                                  \
+  COUNTER(shared_dictionary_unknown)
 
 /**
  * Struct definitions for compressor stats. @see stats_macros.h
@@ -125,6 +137,10 @@ public:
     bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
     bool areAllResponseCodesCompressible() const;
     bool isResponseCodeCompressible(uint32_t response_code) const;
+    // Returns the cache of compressed response bodies, or nullptr if none is configured.
+    CompressedResponseCache* compressedResponseCache() const {
+      return compressed_response_cache_.get();
+    }
 
   private:
     static ResponseCompressorStats generateResponseStats(const std::string& prefix,
@@ -141,13 +157,14 @@ public:
     const bool remove_accept_encoding_header_;
     const absl::flat_hash_set<uint32_t> uncompressible_response_codes_;
     const ResponseCompressorStats response_stats_;
+    const CompressedResponseCachePtr compressed_response_cache_;
   };
 
   CompressorFilterConfig() = delete;
   CompressorFilterConfig(
       const envoy::extensions::filters::http::compressor::v3::Compressor& proto_config,
       const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
-      Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
+      Api::Api& api, Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory);
 
   Envoy::Compression::Compressor::CompressorPtr makeCompressor();
 
@@ -158,6 +175,8 @@ public:
   const Envoy::Compression::Compressor::CompressorFactory& compressorFactory() const {
     return *compressor_factory_;
   }
+  // Returns the shared dictionaries, or nullptr if none are configured.
+  const SharedDictionaries* sharedDictionaries() const { return shared_dictionaries_.get(); }
 
 private:
   const std::string common_stats_prefix_;
@@ -166,6 +185,8 @@ private:
 
   const std::string content_encoding_;
   const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+  // Refers to compressor_factory_, so must be destroyed first.
+  const SharedDictionariesPtr shared_dictionaries_;
   const bool choose_first_;
 };
 using CompressorFilterConfigSharedPtr = std::shared_ptr<CompressorFilterConfig>;
@@ -239,7 +260,17 @@ private:
   bool isTransferEncodingAllowed(Http::RequestOrResponseHeaderMap& headers) const;
 
   void sanitizeEtagHeader(Http::ResponseHeaderMap& headers);
+  // Looks the response body up in the compressed response cache. On a hit, sets
+  // cached_response_; on a miss, prepares to fill the cache with the compressed body.
+  void lookupCompressedResponse(const Http::ResponseHeaderMap& headers);
+  void encodeCachedResponse(Buffer::Instance& data);
+  void fillCompressedResponseCache(const Buffer::Instance& compressed_data, bool end_stream);
   void insertVaryHeader(Http::ResponseHeaderMap& headers);
+  // Responds to the request with the shared dictionary.
+  void sendSharedDictionary(const SharedDictionary& dictionary, bool head_request);
+  // Returns the factory of compressors against the shared dictionary the client holds, if the
+  // client accepts its content encoding, and nullptr otherwise.
+  Envoy::Compression::Compressor::CompressorFactory* sharedDictionaryCompressorFactory() const;
 
   class EncodingDecision : public StreamInfo::FilterState::Object {
   public:
@@ -273,6 +304,17 @@ private:
   Envoy::Compression::Compressor::CompressorPtr request_compressor_;
   const CompressorFilterConfigSharedPtr config_;
   std::unique_ptr<std::string> accept_encoding_;
+  // The request's host and path, captured only if a compressed response cache is configured and
+  // the request may be served from it.
+  absl::optional<std::string> cache_request_identity_;
+  // The cached compressed body sent in place of the upstream body, on a cache hit.
+  CompressedResponseCache::EntryConstSharedPtr cached_response_;
+  bool cached_response_sent_{};
+  // The key and the compressed body accumulated so far, on a cache miss.
+  std::string cache_fill_key_;
+  std::unique_ptr<Buffer::OwnedImpl> cache_fill_;
+  // The shared dictionary named by the request's Available-Dictionary header, if known.
+  const SharedDictionary* shared_dictionary_{};
   // Cached per-route configuration pointer, initialized once per stream.
   const CompressorPerRouteFilterConfig* per_route_config_{};
 };
@@ -0,0 +1,91 @@
+#include "source/extensions/filters/http/compressor/shared_dictionary.h"
+
+#include <openssl/sha.h>
+
+#include "source/common/common/base64.h"
+#include "source/common/config/datasource.h"
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+namespace {
+
+constexpr uint64_t DefaultMaxAgeSeconds = 24 * 60 * 60;
+
+std::string sha256(absl::string_view content) {
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(content.data()), content.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return digest;
+}
+
+// Formats value as a structured field string (RFC 8941).
+std::string sfString(absl::string_view value) {
+  return absl::StrCat("\"", absl::StrReplaceAll(value, {{"\\", "\\\\"}, {"\"", "\\\""}}), "\"");
+}
+
+std::string useAsDictionary(const SharedDictionary::Config& config) {
+  std::string value = absl::StrCat("match=", sfString(config.match()));
+  if (!config.id().empty()) {
+    absl::StrAppend(&value, ", id=", sfString(config.id()));
+  }
+  return value;
+}
+
+} // namespace
+
+SharedDictionary::SharedDictionary(
+    const Config& config, std::string&& content,
+    Envoy::Compression::Compressor::CompressorFactory& compressor_factory)
+    : content_(std::move(content)), sha256_(sha256(content_)), path_(config.path()),
+      use_as_dictionary_(useAsDictionary(config)),
+      available_dictionary_(absl::StrCat(":", Base64::encode(sha256_.data(), sha256_.size()), ":")),
+      cache_control_(absl::StrCat(
+          "max-age=", PROTOBUF_GET_SECONDS_OR_DEFAULT(config, max_age, DefaultMaxAgeSeconds))),
+      compressor_factory_(
+          compressor_factory.createSharedDictionaryCompressorFactory(content_, sha256_)) {
+  if (compressor_factory_ == nullptr) {
+    throw EnvoyException(fmt::format("compressor library '{}' cannot compress against the "
+                                     "shared dictionary served at '{}'",
+                                     compressor_factory.contentEncoding(), path_));
+  }
+}
+
+SharedDictionaries::SharedDictionaries(
+    const Protobuf::RepeatedPtrField<SharedDictionary::Config>& config, Api::Api& api,
+    Envoy::Compression::Compressor::CompressorFactory& compressor_factory) {
+  for (const SharedDictionary::Config& dictionary_config : config) {
+    std::string content = THROW_OR_RETURN_VALUE(
+        Config::DataSource::read(dictionary_config.dictionary(), false, api), std::string);
+    auto dictionary = std::make_unique<const SharedDictionary>(
+        dictionary_config, std::move(content), compressor_factory);
+    if (!by_path_.emplace(dictionary->path(), dictionary.get()).second) {
+      throw EnvoyException(
+          fmt::format("more than one shared dictionary is served at '{}'", dictionary->path()));
+    }
+    by_available_dictionary_.emplace(dictionary->availableDictionary(), dictionary.get());
+    dictionaries_.push_back(std::move(dictionary));
+  }
+}
+
+const SharedDictionary* SharedDictionaries::findByPath(absl::string_view path) const {
+  auto it = by_path_.find(path);
+  return it != by_path_.end() ? it->second : nullptr;
+}
+
+const SharedDictionary*
+SharedDictionaries::findByAvailableDictionary(absl::string_view available_dictionary) const {
+  auto it = by_available_dictionary_.find(available_dictionary);
+  return it != by_available_dictionary_.end() ? it->second : nullptr;
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/compression/compressor/factory.h"
+#include "envoy/extensions/filters/http/compressor/v3/compressor.pb.h"
+
+#include "source/common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * A dictionary served to clients and compressed against once they hold it, per Compression
+ * Dictionary Transport (RFC 9842).
+ */
+class SharedDictionary {
+public:
+  using Config = envoy::extensions::filters::http::compressor::v3::Compressor::SharedDictionary;
+
+  /**
+   * @param config supplies the dictionary configuration.
+   * @param content supplies the raw dictionary.
+   * @param compressor_factory supplies the filter's compressor factory, which must outlive the
+   *        dictionary.
+   */
+  SharedDictionary(const Config& config, std::string&& content,
+                   Envoy::Compression::Compressor::CompressorFactory& compressor_factory);
+
+  const std::string& content() const { return content_; }
+  const std::string& path() const { return path_; }
+  // The value of the Use-As-Dictionary header sent along with the dictionary.
+  const std::string& useAsDictionary() const { return use_as_dictionary_; }
+  // The value of the Available-Dictionary header of clients holding the dictionary.
+  const std::string& availableDictionary() const { return available_dictionary_; }
+  // The value of the Cache-Control header sent along with the dictionary.
+  const std::string& cacheControl() const { return cache_control_; }
+  // The factory of compressors compressing against the dictionary.
+  Envoy::Compression::Compressor::CompressorFactory& compressorFactory() const {
+    return *compressor_factory_;
+  }
+
+private:
+  const std::string content_;
+  const std::string sha256_;
+  const std::string path_;
+  const std::string use_as_dictionary_;
+  const std::string available_dictionary_;
+  const std::string cache_control_;
+  const Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory_;
+};
+
+/**
+ * The shared dictionaries of a filter configuration, indexed by the path they are served at and
+ * by the Available-Dictionary header identifying them.
+ */
+class SharedDictionaries {
+public:
+  /**
+   * @throw EnvoyException if a dictionary cannot be read, or if the compressor library does not
+   *        support shared dictionaries.
+   */
+  SharedDictionaries(const Protobuf::RepeatedPtrField<SharedDictionary::Config>& config,
+                     Api::Api& api,
+                     Envoy::Compression::Compressor::CompressorFactory& compressor_factory);
+
+  /**
+   * @return the dictionary served at path, or nullptr if there is none.
+   */
+  const SharedDictionary* findByPath(absl::string_view path) const;
+
+  /**
+   * @return the dictionary identified by the value of an Available-Dictionary header, or nullptr
+   *         if there is none.
+   */
+  const SharedDictionary* findByAvailableDictionary(absl::string_view available_dictionary) const;
+
+private:
+  std::vector<std::unique_ptr<const SharedDictionary>> dictionaries_;
+  absl::flat_hash_map<std::string, const SharedDictionary*> by_path_;
+  absl::flat_hash_map<std::string, const SharedDictionary*> by_available_dictionary_;
+};
+using SharedDictionariesPtr = std::unique_ptr<SharedDictionaries>;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
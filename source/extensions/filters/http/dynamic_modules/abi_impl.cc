@@ -446,6 +446,46 @@ bool envoy_dynamic_module_callback_http_set_response_trailer(
   return setHeaderValueImpl(filter->responseTrailers(), key, key_length, value, value_length);
 }
 
+bool updateHeadersImpl(HeadersMapOptRef map, envoy_dynamic_module_type_module_http_header* headers,
+                       size_t headers_length) {
+  if (!map.has_value()) {
+    return false;
+  }
+  for (size_t i = 0; i < headers_length; i++) {
+    setHeaderValueImpl(map, headers[i].key_ptr, headers[i].key_length, headers[i].value_ptr,
+                       headers[i].value_length);
+  }
+  return true;
+}
+
+bool envoy_dynamic_module_callback_http_update_request_headers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length) {
+  DynamicModuleHttpFilter* filter = static_cast<DynamicModuleHttpFilter*>(filter_envoy_ptr);
+  return updateHeadersImpl(filter->requestHeaders(), headers, headers_length);
+}
+
+bool envoy_dynamic_module_callback_http_update_request_trailers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length) {
+  DynamicModuleHttpFilter* filter = static_cast<DynamicModuleHttpFilter*>(filter_envoy_ptr);
+  return updateHeadersImpl(filter->requestTrailers(), headers, headers_length);
+}
+
+bool envoy_dynamic_module_callback_http_update_response_headers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length) {
+  DynamicModuleHttpFilter* filter = static_cast<DynamicModuleHttpFilter*>(filter_envoy_ptr);
+  return updateHeadersImpl(filter->responseHeaders(), headers, headers_length);
+}
+
+bool envoy_dynamic_module_callback_http_update_response_trailers(
+    envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr,
+    envoy_dynamic_module_type_module_http_header* headers, size_t headers_length) {
+  DynamicModuleHttpFilter* filter = static_cast<DynamicModuleHttpFilter*>(filter_envoy_ptr);
+  return updateHeadersImpl(filter->responseTrailers(), headers, headers_length);
+}
+
 size_t envoy_dynamic_module_callback_http_get_request_headers_count(
     envoy_dynamic_module_type_http_filter_envoy_ptr filter_envoy_ptr) {
   DynamicModuleHttpFilter* filter = static_cast<DynamicModuleHttpFilter*>(filter_envoy_ptr);
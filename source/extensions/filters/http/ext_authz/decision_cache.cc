@@ -0,0 +1,212 @@
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
+
+#include <algorithm>
+
+#include "source/common/protobuf/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+namespace {
+
+constexpr uint32_t DefaultMaxEntries = 10000;
+// The longest time an authorization response may ask for its decision to be cached.
+constexpr std::chrono::seconds MaxTtl = std::chrono::hours(24 * 365);
+
+// Parts are length-prefixed, so that keys made of different parts never collide.
+void appendKeyPart(std::string& key, absl::string_view part) {
+  absl::StrAppend(&key, part.size(), ":", part);
+}
+
+std::vector<Http::LowerCaseString>
+lowerCaseStrings(const Protobuf::RepeatedPtrField<std::string>& strings) {
+  std::vector<Http::LowerCaseString> result;
+  result.reserve(strings.size());
+  for (const std::string& string : strings) {
+    result.emplace_back(string);
+  }
+  return result;
+}
+
+} // namespace
+
+DecisionCache::DecisionCache(const Config& config, const std::string& stats_prefix,
+                             Stats::Scope& scope, ThreadLocal::SlotAllocator& tls,
+                             TimeSource& time_source)
+    : key_headers_(lowerCaseStrings(config.key_headers())),
+      ttl_(PROTOBUF_GET_MS_REQUIRED(config, ttl)),
+      denied_ttl_(PROTOBUF_GET_OPTIONAL_MS(config, denied_ttl)),
+      ttl_header_(config.ttl_header().empty()
+                      ? absl::nullopt
+                      : absl::make_optional<Http::LowerCaseString>(config.ttl_header())),
+      ttl_metadata_field_(config.ttl_metadata_field()), time_source_(time_source),
+      stats_({ALL_DECISION_CACHE_STATS(POOL_COUNTER_PREFIX(scope, stats_prefix))}),
+      shared_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, DefaultMaxEntries)) {
+  const uint32_t per_worker_max_entries = config.per_worker_max_entries();
+  if (per_worker_max_entries > 0) {
+    tls_ = ThreadLocal::TypedSlot<ThreadLocalCache>::makeUnique(tls);
+    tls_->set([per_worker_max_entries](Event::Dispatcher&) {
+      return std::make_shared<ThreadLocalCache>(per_worker_max_entries);
+    });
+  }
+}
+
+std::string DecisionCache::makeKey(const Http::RequestHeaderMap& headers,
+                                   const Router::Route* route,
+                                   const ContextExtensionsMap& context_extensions) const {
+  std::string key;
+  appendKeyPart(key, headers.getMethodValue());
+  if (route != nullptr) {
+    appendKeyPart(key, route->virtualHost()->name());
+    appendKeyPart(key, route->routeName());
+  } else {
+    appendKeyPart(key, "");
+    appendKeyPart(key, "");
+  }
+  // Routes need not be named, so the path tells apart requests that an unnamed route matches.
+  const absl::string_view path = headers.getPathValue();
+  appendKeyPart(key, path.substr(0, path.find('?')));
+  // The map's iteration order is unspecified, so the extensions are sorted.
+  std::vector<std::pair<absl::string_view, absl::string_view>> extensions(
+      context_extensions.begin(), context_extensions.end());
+  std::sort(extensions.begin(), extensions.end());
+  absl::StrAppend(&key, extensions.size(), ";");
+  for (const auto& [name, value] : extensions) {
+    appendKeyPart(key, name);
+    appendKeyPart(key, value);
+  }
+  // A header's number of values tells an absent header apart from an empty one.
+  for (const Http::LowerCaseString& name : key_headers_) {
+    const Http::HeaderMap::GetResult values = headers.get(name);
+    absl::StrAppend(&key, values.size(), ";");
+    for (size_t i = 0; i < values.size(); ++i) {
+      appendKeyPart(key, values[i]->value().getStringView());
+    }
+  }
+  return key;
+}
+
+DecisionCache::ResponseConstSharedPtr DecisionCache::lookup(const std::string& key) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  if (tls_ != nullptr) {
+    absl::optional<Entry> entry = (*tls_)->lru_.lookup(key, now);
+    if (entry.has_value()) {
+      stats_.hit_.inc();
+      stats_.local_hit_.inc();
+      return entry->response_;
+    }
+  }
+
+  absl::optional<Entry> entry;
+  {
+    Thread::LockGuard lock(mutex_);
+    entry = shared_.lookup(key, now);
+  }
+  if (!entry.has_value()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+  stats_.hit_.inc();
+  // The worker's copy expires with the shared entry.
+  if (tls_ != nullptr) {
+    stats_.eviction_.add((*tls_)->lru_.insert(key, *entry));
+  }
+  return entry->response_;
+}
+
+void DecisionCache::insert(const std::string& key,
+                           const Filters::Common::ExtAuthz::Response& response) {
+  const absl::optional<std::chrono::milliseconds> entry_ttl = ttl(response);
+  if (!entry_ttl.has_value() || entry_ttl->count() == 0) {
+    return;
+  }
+  const Entry entry{std::make_shared<const Filters::Common::ExtAuthz::Response>(response),
+                    time_source_.monotonicTime() + *entry_ttl};
+  stats_.insert_.inc();
+  uint32_t evicted;
+  {
+    Thread::LockGuard lock(mutex_);
+    evicted = shared_.insert(key, entry);
+  }
+  if (tls_ != nullptr) {
+    evicted += (*tls_)->lru_.insert(key, entry);
+  }
+  stats_.eviction_.add(evicted);
+}
+
+absl::optional<std::chrono::milliseconds>
+DecisionCache::ttl(const Filters::Common::ExtAuthz::Response& response) const {
+  using Filters::Common::ExtAuthz::CheckStatus;
+  if (response.status == CheckStatus::Error ||
+      (response.status == CheckStatus::Denied && !denied_ttl_.has_value())) {
+    return absl::nullopt;
+  }
+
+  if (ttl_header_.has_value()) {
+    // The headers of a denial, which go to the local reply, may be in any of the lists.
+    for (const auto* headers :
+         {&response.headers_to_set, &response.headers_to_add, &response.headers_to_append}) {
+      for (const auto& [name, value] : *headers) {
+        uint64_t seconds;
+        if (absl::EqualsIgnoreCase(name, ttl_header_->get()) &&
+            absl::SimpleAtoi(value, &seconds)) {
+          return std::chrono::seconds(std::min<uint64_t>(seconds, MaxTtl.count()));
+        }
+      }
+    }
+  }
+  if (!ttl_metadata_field_.empty()) {
+    const auto it = response.dynamic_metadata.fields().find(ttl_metadata_field_);
+    // NaN fails the comparison, and larger values, including infinity, are clamped.
+    if (it != response.dynamic_metadata.fields().end() && it->second.has_number_value() &&
+        it->second.number_value() >= 0) {
+      const double seconds = std::min<double>(it->second.number_value(), MaxTtl.count());
+      return std::chrono::milliseconds(static_cast<uint64_t>(seconds * 1000));
+    }
+  }
+  return response.status == CheckStatus::OK ? ttl_ : *denied_ttl_;
+}
+
+absl::optional<DecisionCache::Entry> DecisionCache::Lru::lookup(const std::string& key,
+                                                                MonotonicTime now) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return absl::nullopt;
+  }
+  if (it->second->second.expiry_ <= now) {
+    list_.erase(it->second);
+    index_.erase(it);
+    return absl::nullopt;
+  }
+  list_.splice(list_.begin(), list_, it->second);
+  return it->second->second;
+}
+
+uint32_t DecisionCache::Lru::insert(const std::string& key, const Entry& entry) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = entry;
+    list_.splice(list_.begin(), list_, it->second);
+    return 0;
+  }
+  uint32_t evicted = 0;
+  while (list_.size() >= max_entries_) {
+    index_.erase(list_.back().first);
+    list_.pop_back();
+    ++evicted;
+  }
+  list_.emplace_front(key, entry);
+  index_.emplace(key, list_.begin());
+  return evicted;
+}
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
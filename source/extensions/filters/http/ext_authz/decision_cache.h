@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/extensions/filters/http/ext_authz/v3/ext_authz.pb.h"
+#include "envoy/http/header_map.h"
+#include "envoy/router/router.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "source/common/common/thread.h"
+#include "source/extensions/filters/common/ext_authz/ext_authz.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+
+/**
+ * Decision cache stats. @see stats_macros.h
+ * "local_hit" counts the hits served by the per-worker caches, which are also counted as "hit".
+ */
+#define ALL_DECISION_CACHE_STATS(COUNTER)                                                          \
+  COUNTER(hit)                                                                                     \
+  COUNTER(local_hit)                                                                               \
+  COUNTER(miss)                                                                                    \
+  COUNTER(insert)                                                                                  \
+  COUNTER(eviction)
+
+/**
+ * Struct definition for decision cache stats. @see stats_macros.h
+ */
+struct DecisionCacheStats {
+  ALL_DECISION_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A cache of authorization decisions, keyed by configured attributes of the requests they were
+ * made for. Decisions are kept in a least-recently-used cache shared by all the workers using a
+ * filter configuration, optionally fronted by a smaller cache on each worker.
+ */
+class DecisionCache {
+public:
+  using Config = envoy::extensions::filters::http::ext_authz::v3::ExtAuthz::DecisionCache;
+  using ContextExtensionsMap = Protobuf::Map<std::string, std::string>;
+  // Cached decisions are immutable, and remain valid for as long as they are referenced, even
+  // after they expire or are evicted.
+  using ResponseConstSharedPtr = std::shared_ptr<const Filters::Common::ExtAuthz::Response>;
+
+  DecisionCache(const Config& config, const std::string& stats_prefix, Stats::Scope& scope,
+                ThreadLocal::SlotAllocator& tls, TimeSource& time_source);
+
+  /**
+   * @return the key of the decision for a request.
+   * @param headers the request headers.
+   * @param route the route of the request, if any.
+   * @param context_extensions the context extensions sent to the authorization service.
+   */
+  std::string makeKey(const Http::RequestHeaderMap& headers, const Router::Route* route,
+                      const ContextExtensionsMap& context_extensions) const;
+
+  /**
+   * Looks a decision up, in the worker's cache first. Must be called on a worker thread if the
+   * per-worker caches are enabled.
+   * @return the unexpired decision cached under key, or nullptr on a miss.
+   */
+  ResponseConstSharedPtr lookup(const std::string& key);
+
+  /**
+   * Caches the decision of an authorization response under key, for the time it tells or the
+   * configured time. Errors, and denials unless negative caching is configured, are not cached.
+   */
+  void insert(const std::string& key, const Filters::Common::ExtAuthz::Response& response);
+
+  const DecisionCacheStats& stats() const { return stats_; }
+
+private:
+  struct Entry {
+    ResponseConstSharedPtr response_;
+    MonotonicTime expiry_;
+  };
+
+  // A bounded map of unexpired entries, evicting the least recently used first.
+  class Lru {
+  public:
+    explicit Lru(uint32_t max_entries) : max_entries_(max_entries) {}
+
+    // Returns the entry for key if it has not expired by now, dropping it otherwise.
+    absl::optional<Entry> lookup(const std::string& key, MonotonicTime now);
+    // Returns the number of entries evicted to make room for the new one.
+    uint32_t insert(const std::string& key, const Entry& entry);
+
+  private:
+    using List = std::list<std::pair<std::string, Entry>>;
+
+    const uint32_t max_entries_;
+    // Most recently used entries are at the front.
+    List list_;
+    absl::flat_hash_map<std::string, List::iterator> index_;
+  };
+
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    explicit ThreadLocalCache(uint32_t max_entries) : lru_(max_entries) {}
+    Lru lru_;
+  };
+
+  absl::optional<std::chrono::milliseconds>
+  ttl(const Filters::Common::ExtAuthz::Response& response) const;
+
+  const std::vector<Http::LowerCaseString> key_headers_;
+  const std::chrono::milliseconds ttl_;
+  const absl::optional<std::chrono::milliseconds> denied_ttl_;
+  const absl::optional<Http::LowerCaseString> ttl_header_;
+  const std::string ttl_metadata_field_;
+  TimeSource& time_source_;
+  DecisionCacheStats stats_;
+
+  Thread::MutexBasicLockable mutex_;
+  Lru shared_ ABSL_GUARDED_BY(mutex_);
+  // Only allocated if per-worker caches are configured.
+  ThreadLocal::TypedSlotPtr<ThreadLocalCache> tls_;
+};
+
+using DecisionCachePtr = std::unique_ptr<DecisionCache>;
+
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
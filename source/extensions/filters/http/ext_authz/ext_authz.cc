@@ -163,6 +163,21 @@ FilterConfig::FilterConfig(const envoy::extensions::filters::http::ext_authz::v3
     disallowed_headers_matcher_ = Filters::Common::ExtAuthz::CheckRequestUtils::toRequestMatchers(
         config.disallowed_headers(), false, factory_context);
   }
+
+  if (config.has_decision_cache()) {
+    if (config.has_with_request_body()) {
+      throw EnvoyException(
+          "decision_cache cannot be used with with_request_body, as the request body is not part "
+          "of the cache key.");
+    }
+    decision_cache_ = std::make_unique<DecisionCache>(
+        config.decision_cache(),
+        absl::StrCat(stats_prefix, "ext_authz.",
+                     config.stat_prefix().empty() ? EMPTY_STRING
+                                                  : absl::StrCat(config.stat_prefix(), "."),
+                     "decision_cache."),
+        scope, factory_context.threadLocal(), factory_context.timeSource());
+  }
 }
 
 void FilterConfigPerRoute::merge(const FilterConfigPerRoute& other) {
@@ -340,6 +355,13 @@ void Filter::initiateCall(const Http::RequestHeaderMap& headers) {
     }
   }
 
+  // Decisions of per-route services, and decisions on request bodies that a route's check
+  // settings buffer, are not cached, as the cache key does not tell them apart.
+  if (per_route_client_ == nullptr && !buffer_data_ &&
+      completeFromDecisionCache(headers, context_extensions)) {
+    return;
+  }
+
   // If metadata_context_namespaces or typed_metadata_context_namespaces is specified,
   // pass matching filter metadata to the ext_authz service.
   // If metadata key is set in both the connection and request metadata,
@@ -595,11 +617,42 @@ CheckResult Filter::validateAndCheckDecoderHeaderMutation(
   return config_->checkDecoderHeaderMutation(operation, Http::LowerCaseString(key), value);
 }
 
+bool Filter::completeFromDecisionCache(
+    const Http::RequestHeaderMap& headers,
+    const Protobuf::Map<std::string, std::string>& context_extensions) {
+  DecisionCache* cache = config_->decisionCache();
+  if (cache == nullptr) {
+    return false;
+  }
+  std::string key = cache->makeKey(headers, decoder_callbacks_->route().get(), context_extensions);
+  DecisionCache::ResponseConstSharedPtr cached = cache->lookup(key);
+  if (cached == nullptr) {
+    decision_cache_key_ = std::move(key);
+    return false;
+  }
+
+  ENVOY_STREAM_LOG(trace, "ext_authz filter replaying a cached decision.", *decoder_callbacks_);
+  // The decision is replayed as if the authorization service had returned it synchronously,
+  // applying its mutations again to this request.
+  state_ = State::Calling;
+  filter_return_ = FilterReturn::StopDecoding;
+  cluster_ = decoder_callbacks_->clusterInfo();
+  initiating_call_ = true;
+  onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(*cached));
+  initiating_call_ = false;
+  return true;
+}
+
 void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
   state_ = State::Complete;
   using Filters::Common::ExtAuthz::CheckStatus;
   Stats::StatName empty_stat_name;
 
+  if (decision_cache_key_.has_value()) {
+    // Cached before it is modified below, so that hits replay what the service returned.
+    config_->decisionCache()->insert(*decision_cache_key_, *response);
+  }
+
   updateLoggingInfo(response->grpc_status);
 
   if (response->saw_invalid_append_actions) {
@@ -28,6 +28,7 @@
 #include "source/extensions/filters/common/ext_authz/ext_authz_grpc_impl.h"
 #include "source/extensions/filters/common/ext_authz/ext_authz_http_impl.h"
 #include "source/extensions/filters/common/mutation_rules/mutation_rules.h"
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -217,6 +218,9 @@ public:
     return disallowed_headers_matcher_;
   }
 
+  // Returns the cache of authorization decisions, or nullptr if decisions are not cached.
+  DecisionCache* decisionCache() const { return decision_cache_.get(); }
+
 private:
   static Http::Code toErrorCode(uint64_t status) {
     const auto code = static_cast<Http::Code>(status);
@@ -283,6 +287,8 @@ private:
   Filters::Common::ExtAuthz::MatcherSharedPtr allowed_headers_matcher_;
   Filters::Common::ExtAuthz::MatcherSharedPtr disallowed_headers_matcher_;
 
+  DecisionCachePtr decision_cache_;
+
 public:
   // TODO(nezdolik): deprecate cluster scope stats counters in favor of filter scope stats
   // (ExtAuthzFilterStats stats_).
@@ -439,6 +445,9 @@ private:
   void continueDecoding();
   bool isBufferFull(uint64_t num_bytes_processing) const;
   void updateLoggingInfo(const absl::optional<Grpc::Status::GrpcStatus>& grpc_status);
+  // Completes the call with a cached decision, if there is one for the request.
+  bool completeFromDecisionCache(const Http::RequestHeaderMap& headers,
+                                 const Protobuf::Map<std::string, std::string>& context_extensions);
 
   // This holds a set of flags defined in per-route configuration.
   struct PerRouteFlags {
@@ -487,6 +496,8 @@ private:
   bool buffer_data_{};
   bool skip_check_{false};
   envoy::service::auth::v3::CheckRequest check_request_{};
+  // The key under which the decision of the authorization service is cached, if it is.
+  absl::optional<std::string> decision_cache_key_;
 };
 
 } // namespace ExtAuthz
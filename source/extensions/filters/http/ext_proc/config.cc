@@ -67,9 +67,25 @@ absl::Status verifyFilterConfig(
                                       "be set to none-default at the same time.");
   }
 
+  if (config.has_multiplexed_streams() && !config.has_grpc_service()) {
+    return absl::InvalidArgumentError("multiplexed_streams requires grpc_service");
+  }
+
   return verifyProcessingModeConfig(config);
 }
 
+// Creates the gRPC client of a filter, whose streams are multiplexed over the worker's shared
+// streams if so configured.
+ExternalProcessorClientPtr createGrpcClient(FilterConfig& filter_config,
+                                            Grpc::AsyncClientManager& client_manager,
+                                            Stats::Scope& scope) {
+  MultiplexedStreamPool* pool = filter_config.threadLocalStreamManager().multiplexedStreamPool();
+  if (pool != nullptr) {
+    return std::make_unique<MultiplexedProcessorClient>(*pool);
+  }
+  return createExternalProcessorClient(client_manager, scope);
+}
+
 } // namespace
 
 absl::StatusOr<Http::FilterFactoryCb>
@@ -94,8 +110,8 @@ ExternalProcessingFilterConfig::createFilterFactoryFromProtoTyped(
   if (proto_config.has_grpc_service()) {
     return [filter_config = std::move(filter_config), &context,
             dual_info](Http::FilterChainFactoryCallbacks& callbacks) {
-      auto client = createExternalProcessorClient(context.clusterManager().grpcAsyncClientManager(),
-                                                  dual_info.scope);
+      auto client = createGrpcClient(
+          *filter_config, context.clusterManager().grpcAsyncClientManager(), dual_info.scope);
       callbacks.addStreamFilter(
           Http::StreamFilterSharedPtr{std::make_shared<Filter>(filter_config, std::move(client))});
     };
@@ -142,8 +158,9 @@ ExternalProcessingFilterConfig::createFilterFactoryFromProtoWithServerContextTyp
   if (proto_config.has_grpc_service()) {
     return [filter_config = std::move(filter_config),
             &server_context](Http::FilterChainFactoryCallbacks& callbacks) {
-      auto client = createExternalProcessorClient(
-          server_context.clusterManager().grpcAsyncClientManager(), server_context.scope());
+      auto client = createGrpcClient(*filter_config,
+                                     server_context.clusterManager().grpcAsyncClientManager(),
+                                     server_context.scope());
       callbacks.addStreamFilter(
           Http::StreamFilterSharedPtr{std::make_shared<Filter>(filter_config, std::move(client))});
     };
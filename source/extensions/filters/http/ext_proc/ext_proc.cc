@@ -8,6 +8,7 @@
 #include "envoy/config/common/mutation_rules/v3/mutation_rules.pb.h"
 #include "envoy/config/core/v3/grpc_service.pb.h"
 #include "envoy/extensions/filters/http/ext_proc/v3/processing_mode.pb.h"
+#include "envoy/upstream/cluster_manager.h"
 
 #include "source/common/config/utility.h"
 #include "source/common/http/utility.h"
@@ -295,8 +296,23 @@ FilterConfig::FilterConfig(const ExternalProcessor& config,
     route_cache_action_ = ExternalProcessor::RETAIN;
   }
 
+  if (!config.has_multiplexed_streams()) {
+    thread_local_stream_manager_slot_->set(
+        [](Envoy::Event::Dispatcher&) { return std::make_shared<ThreadLocalStreamManager>(); });
+    return;
+  }
+  const uint32_t streams_per_worker =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.multiplexed_streams(), streams_per_worker, 1);
+  const std::string final_prefix = absl::StrCat(stats_prefix, "ext_proc.", config.stat_prefix());
+  const MultiplexedStreamStats multiplexed_stream_stats{
+      ALL_MULTIPLEXED_STREAM_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
   thread_local_stream_manager_slot_->set(
-      [](Envoy::Event::Dispatcher&) { return std::make_shared<ThreadLocalStreamManager>(); });
+      [&context, &scope, streams_per_worker,
+       multiplexed_stream_stats](Envoy::Event::Dispatcher& dispatcher) {
+        return std::make_shared<ThreadLocalStreamManager>(std::make_unique<MultiplexedStreamPool>(
+            createExternalProcessorClient(context.clusterManager().grpcAsyncClientManager(), scope),
+            streams_per_worker, multiplexed_stream_stats, dispatcher.timeSource()));
+      });
 }
 
 void ExtProcLoggingInfo::recordGrpcCall(
@@ -27,6 +27,7 @@
 #include "source/extensions/filters/http/common/pass_through_filter.h"
 #include "source/extensions/filters/http/ext_proc/client_impl.h"
 #include "source/extensions/filters/http/ext_proc/matching_utils.h"
+#include "source/extensions/filters/http/ext_proc/multiplexed_stream.h"
 #include "source/extensions/filters/http/ext_proc/on_processing_response.h"
 #include "source/extensions/filters/http/ext_proc/processing_request_modifier.h"
 #include "source/extensions/filters/http/ext_proc/processor_state.h"
@@ -195,6 +196,10 @@ using DeferredDeletableStreamPtr = std::unique_ptr<DeferredDeletableStream>;
 
 class ThreadLocalStreamManager : public Envoy::ThreadLocal::ThreadLocalObject {
 public:
+  ThreadLocalStreamManager() = default;
+  explicit ThreadLocalStreamManager(MultiplexedStreamPoolPtr&& multiplexed_stream_pool)
+      : multiplexed_stream_pool_(std::move(multiplexed_stream_pool)) {}
+
   // Store the ExternalProcessorStreamPtr (as a wrapper object) in the map and return the raw
   // pointer of ExternalProcessorStream.
   ExternalProcessorStream* store(ExternalProcessorStreamPtr stream, const ExtProcFilterStats& stat,
@@ -216,7 +221,13 @@ public:
     it->second->deferredClose(dispatcher);
   }
 
+  // The worker's shared streams if HTTP requests are multiplexed over them, or nullptr.
+  MultiplexedStreamPool* multiplexedStreamPool() { return multiplexed_stream_pool_.get(); }
+
 private:
+  // Declared first, so that the streams of HTTP requests are destroyed before the shared streams
+  // carrying them.
+  MultiplexedStreamPoolPtr multiplexed_stream_pool_;
   // Map of DeferredDeletableStreamPtrs with ExternalProcessorStream pointer as key.
   absl::flat_hash_map<ExternalProcessorStream*, DeferredDeletableStreamPtr> stream_manager_;
 };
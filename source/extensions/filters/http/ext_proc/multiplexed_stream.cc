@@ -0,0 +1,223 @@
+#include "source/extensions/filters/http/ext_proc/multiplexed_stream.h"
+
+#include "source/common/tracing/tracer_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+
+SharedStream::SharedStream(MultiplexedStreamPool& pool,
+                           const Grpc::GrpcServiceConfigWithHashKey& service)
+    : pool_(pool), service_(service) {}
+
+SharedStream::~SharedStream() {
+  ASSERT(streams_.empty());
+  if (stream_ != nullptr) {
+    stream_->close();
+  }
+}
+
+bool SharedStream::start(ExternalProcessorClient& client) {
+  // The stream outlives the HTTP requests it carries, so it has no parent stream, and neither
+  // a timeout nor retries.
+  Http::AsyncClient::StreamOptions options;
+  stream_ = client.start(*this, service_, options, watermark_callbacks_);
+  return stream_ != nullptr && !failed_;
+}
+
+uint64_t SharedStream::attach(MultiplexedStream& stream) {
+  ASSERT(!failed_);
+  const uint64_t id = next_id_++;
+  streams_.emplace(id, &stream);
+  return id;
+}
+
+void SharedStream::detach(uint64_t id) { streams_.erase(id); }
+
+void SharedStream::send(ProcessingRequest&& request) {
+  ASSERT(!failed_);
+  // Messages sent in the same dispatcher iteration are coalesced in the connection's write buffer
+  // and written to the processor together.
+  stream_->send(std::move(request), false);
+}
+
+void SharedStream::onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response) {
+  auto it = streams_.find(response->multiplexed_stream_id());
+  if (it == streams_.end()) {
+    // The request may have completed, e.g. on a message timeout, before the response arrived.
+    ENVOY_LOG(debug, "Ignoring ext_proc response for unknown multiplexed stream {}",
+              response->multiplexed_stream_id());
+    pool_.stats().multiplexed_msgs_unknown_.inc();
+    return;
+  }
+  it->second->onReceiveMessage(std::move(response));
+}
+
+void SharedStream::onGrpcError(Grpc::Status::GrpcStatus status, const std::string& message) {
+  fail(status, message);
+}
+
+void SharedStream::onGrpcClose() {
+  // Unlike the stream of a single request, a shared stream closed by the processor does not mean
+  // that processing of the requests on it is complete, so they fail.
+  fail(Grpc::Status::Aborted, "shared ext_proc stream closed by the processor");
+}
+
+void SharedStream::fail(Grpc::Status::GrpcStatus status, const std::string& message) {
+  if (failed_) {
+    return;
+  }
+  ENVOY_LOG(debug, "Shared ext_proc stream failed with status {}: {}", status, message);
+  failed_ = true;
+  status_ = status;
+  message_ = message;
+  // The requests failed below release their references to this stream.
+  const SharedStreamSharedPtr self = weak_from_this().lock();
+  pool_.onSharedStreamFailure(*this);
+  // A request's callbacks may close other requests' streams, so detach them all first.
+  absl::flat_hash_map<uint64_t, MultiplexedStream*> streams = std::move(streams_);
+  streams_.clear();
+  for (const auto& [id, stream] : streams) {
+    stream->onSharedStreamFailure(status, message);
+  }
+}
+
+MultiplexedStream::MultiplexedStream(ExternalProcessorCallbacks& callbacks,
+                                     SharedStreamSharedPtr shared, Tracing::SpanPtr span)
+    : callbacks_(callbacks), shared_(std::move(shared)), span_(std::move(span)),
+      id_(shared_->attach(*this)) {}
+
+MultiplexedStream::~MultiplexedStream() { close(); }
+
+void MultiplexedStream::onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response) {
+  if (!callbacks_.has_value()) {
+    ENVOY_LOG(debug, "Underlying filter object has been destroyed.");
+    return;
+  }
+  callbacks_->onReceiveMessage(std::move(response));
+}
+
+void MultiplexedStream::onSharedStreamFailure(Grpc::Status::GrpcStatus status,
+                                              const std::string& message) {
+  // The shared stream has already forgotten this request.
+  closed_ = true;
+  span_->setTag(Tracing::Tags::get().GrpcStatusCode, std::to_string(status));
+  span_->setTag(Tracing::Tags::get().Error, Tracing::Tags::get().True);
+  span_->finishSpan();
+  if (!callbacks_.has_value()) {
+    return;
+  }
+  callbacks_->logStreamInfo();
+  callbacks_->onGrpcError(status, message);
+}
+
+void MultiplexedStream::send(ProcessingRequest&& request, bool end_stream) {
+  if (closed_) {
+    return;
+  }
+  request.set_multiplexed_stream_id(id_);
+  shared_->send(std::move(request));
+  if (end_stream) {
+    close();
+  }
+}
+
+bool MultiplexedStream::close() {
+  if (closed_) {
+    return false;
+  }
+  ENVOY_LOG(debug, "Closing multiplexed stream {}", id_);
+  closed_ = true;
+  shared_->detach(id_);
+  // Tell the processor that the request is complete.
+  ProcessingRequest end;
+  end.set_multiplexed_stream_id(id_);
+  end.mutable_multiplexed_stream_end();
+  shared_->send(std::move(end));
+  span_->finishSpan();
+  return true;
+}
+
+MultiplexedStreamPool::MultiplexedStreamPool(ExternalProcessorClientPtr&& client,
+                                             uint32_t streams_per_service,
+                                             const MultiplexedStreamStats& stats,
+                                             TimeSource& time_source)
+    : client_(std::move(client)), streams_per_service_(streams_per_service), stats_(stats),
+      time_source_(time_source) {}
+
+ExternalProcessorStreamPtr
+MultiplexedStreamPool::start(ExternalProcessorCallbacks& callbacks,
+                             const Grpc::GrpcServiceConfigWithHashKey& service,
+                             const Http::AsyncClient::StreamOptions& options) {
+  ServiceStreams& service_streams = services_[service];
+  const uint32_t index = service_streams.next_++ % streams_per_service_;
+  if (index < service_streams.streams_.size()) {
+    return std::make_unique<MultiplexedStream>(callbacks, service_streams.streams_[index],
+                                               startSpan(options, service));
+  }
+
+  auto shared = std::make_shared<SharedStream>(*this, service);
+  if (!shared->start(*client_)) {
+    stats_.shared_streams_failed_.inc();
+    callbacks.onGrpcError(shared->status(), shared->message());
+    return nullptr;
+  }
+  stats_.shared_streams_started_.inc();
+  service_streams.streams_.push_back(shared);
+  return std::make_unique<MultiplexedStream>(callbacks, std::move(shared),
+                                             startSpan(options, service));
+}
+
+Tracing::SpanPtr
+MultiplexedStreamPool::startSpan(const Http::AsyncClient::StreamOptions& options,
+                                 const Grpc::GrpcServiceConfigWithHashKey& service) {
+  if (options.parent_span_ == nullptr) {
+    return std::make_unique<Tracing::NullSpan>();
+  }
+  const std::string span_name =
+      options.child_span_name_.empty()
+          ? "async envoy.service.ext_proc.v3.ExternalProcessor.Process multiplexed egress"
+          : options.child_span_name_;
+  Tracing::SpanPtr span = options.parent_span_->spawnChild(Tracing::EgressConfig::get(), span_name,
+                                                           time_source_.systemTime());
+  if (service.config().has_envoy_grpc()) {
+    span->setTag(Tracing::Tags::get().UpstreamCluster,
+                 service.config().envoy_grpc().cluster_name());
+  }
+  span->setTag(Tracing::Tags::get().Component, Tracing::Tags::get().Proxy);
+  if (options.sampled_.has_value()) {
+    span->setSampled(options.sampled_.value());
+  }
+  return span;
+}
+
+void MultiplexedStreamPool::onSharedStreamFailure(SharedStream& stream) {
+  auto it = services_.find(stream.service());
+  if (it == services_.end()) {
+    return;
+  }
+  std::vector<SharedStreamSharedPtr>& streams = it->second.streams_;
+  for (auto stream_it = streams.begin(); stream_it != streams.end(); ++stream_it) {
+    if (stream_it->get() == &stream) {
+      stats_.shared_streams_failed_.inc();
+      streams.erase(stream_it);
+      return;
+    }
+  }
+}
+
+void MultiplexedProcessorClient::sendRequest(ProcessingRequest&& request, bool end_stream,
+                                             const uint64_t,
+                                             CommonExtProc::RequestCallbacks<ProcessingResponse>*,
+                                             CommonExtProc::StreamBase* stream) {
+  auto* grpc_stream = dynamic_cast<ExternalProcessorStream*>(stream);
+  if (grpc_stream != nullptr) {
+    grpc_stream->send(std::move(request), end_stream);
+  }
+}
+
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/grpc/async_client_manager.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/tracing/tracer.h"
+
+#include "source/common/common/logger.h"
+#include "source/common/http/sidestream_watermark.h"
+#include "source/extensions/filters/http/ext_proc/client_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+
+#define ALL_MULTIPLEXED_STREAM_STATS(COUNTER)                                                      \
+  COUNTER(shared_streams_started)                                                                  \
+  COUNTER(shared_streams_failed)                                                                   \
+  COUNTER(multiplexed_msgs_unknown)
+
+struct MultiplexedStreamStats {
+  ALL_MULTIPLEXED_STREAM_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+class MultiplexedStream;
+class MultiplexedStreamPool;
+
+/**
+ * A long-lived gRPC stream to an external processor carrying the messages of many HTTP requests,
+ * each tagged with the multiplexed_stream_id of the request.
+ */
+class SharedStream : public ExternalProcessorCallbacks,
+                     public std::enable_shared_from_this<SharedStream>,
+                     public Logger::Loggable<Logger::Id::ext_proc> {
+public:
+  SharedStream(MultiplexedStreamPool& pool, const Grpc::GrpcServiceConfigWithHashKey& service);
+  ~SharedStream() override;
+
+  /**
+   * Starts the underlying gRPC stream.
+   * @return whether the stream started. If not, status() and message() tell why.
+   */
+  bool start(ExternalProcessorClient& client);
+
+  /**
+   * Attaches an HTTP request's stream, which receives the responses tagged with its identifier.
+   * @return the identifier of the request on this stream.
+   */
+  uint64_t attach(MultiplexedStream& stream);
+  void detach(uint64_t id);
+  void send(ProcessingRequest&& request);
+
+  bool failed() const { return failed_; }
+  const Grpc::GrpcServiceConfigWithHashKey& service() const { return service_; }
+  Grpc::Status::GrpcStatus status() const { return status_; }
+  const std::string& message() const { return message_; }
+  const StreamInfo::StreamInfo& streamInfo() const { return stream_->streamInfo(); }
+  StreamInfo::StreamInfo& streamInfo() { return stream_->streamInfo(); }
+
+  // ExternalProcessorCallbacks
+  void onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response) override;
+  void onGrpcError(Grpc::Status::GrpcStatus status, const std::string& message) override;
+  void onGrpcClose() override;
+  void logStreamInfo() override {}
+  void onComplete(ProcessingResponse&) override {}
+  void onError() override {}
+
+private:
+  // Fails the stream and every HTTP request attached to it.
+  void fail(Grpc::Status::GrpcStatus status, const std::string& message);
+
+  MultiplexedStreamPool& pool_;
+  const Grpc::GrpcServiceConfigWithHashKey service_;
+  // Not tied to any HTTP request, so a busy processor does not push back on the requests
+  // multiplexed over the stream.
+  Http::StreamFilterSidestreamWatermarkCallbacks watermark_callbacks_;
+  // Kept once failed, for the stream info of the requests still attached.
+  ExternalProcessorStreamPtr stream_;
+  bool failed_{false};
+  absl::flat_hash_map<uint64_t, MultiplexedStream*> streams_;
+  uint64_t next_id_{1};
+  Grpc::Status::GrpcStatus status_{Grpc::Status::Unavailable};
+  std::string message_{"failed to start the shared ext_proc stream"};
+};
+
+using SharedStreamSharedPtr = std::shared_ptr<SharedStream>;
+
+/**
+ * The stream of one HTTP request to an external processor, multiplexed over a shared stream.
+ * Closing it tells the processor that the request is complete. Its span, a child of the HTTP
+ * request's span, lasts until then.
+ */
+class MultiplexedStream : public ExternalProcessorStream,
+                          public Logger::Loggable<Logger::Id::ext_proc> {
+public:
+  MultiplexedStream(ExternalProcessorCallbacks& callbacks, SharedStreamSharedPtr shared,
+                    Tracing::SpanPtr span);
+  ~MultiplexedStream() override;
+
+  void onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response);
+  void onSharedStreamFailure(Grpc::Status::GrpcStatus status, const std::string& message);
+
+  // ExternalProcessorStream
+  void send(ProcessingRequest&& request, bool end_stream) override;
+  bool close() override;
+  bool halfCloseAndDeleteOnRemoteClose() override { return close(); }
+  const StreamInfo::StreamInfo& streamInfo() const override { return shared_->streamInfo(); }
+  StreamInfo::StreamInfo& streamInfo() override { return shared_->streamInfo(); }
+  void notifyFilterDestroy() override { callbacks_.reset(); }
+
+private:
+  OptRef<ExternalProcessorCallbacks> callbacks_;
+  const SharedStreamSharedPtr shared_;
+  const Tracing::SpanPtr span_;
+  const uint64_t id_;
+  bool closed_{false};
+};
+
+/**
+ * The shared streams of a worker, up to a configured number per gRPC service, over which HTTP
+ * requests are multiplexed in turn.
+ */
+class MultiplexedStreamPool : public Logger::Loggable<Logger::Id::ext_proc> {
+public:
+  MultiplexedStreamPool(ExternalProcessorClientPtr&& client, uint32_t streams_per_service,
+                        const MultiplexedStreamStats& stats, TimeSource& time_source);
+
+  /**
+   * Starts the stream of an HTTP request, over a shared stream to the service.
+   * @param options the options of the request's stream. Only its parent span and sampling
+   *        decision apply, to the span of the request's processing. The shared stream outlives
+   *        the request, so it has neither the request's parent context nor its timeouts and
+   *        retries, and the trace context is not sent to the processor.
+   * @return the stream, or nullptr if no shared stream could be started, in which case the
+   *         callbacks were notified of the error.
+   */
+  ExternalProcessorStreamPtr start(ExternalProcessorCallbacks& callbacks,
+                                   const Grpc::GrpcServiceConfigWithHashKey& service,
+                                   const Http::AsyncClient::StreamOptions& options);
+
+  void onSharedStreamFailure(SharedStream& stream);
+  MultiplexedStreamStats& stats() { return stats_; }
+
+private:
+  struct ServiceStreams {
+    std::vector<SharedStreamSharedPtr> streams_;
+    uint32_t next_{0};
+  };
+
+  Tracing::SpanPtr startSpan(const Http::AsyncClient::StreamOptions& options,
+                             const Grpc::GrpcServiceConfigWithHashKey& service);
+
+  const ExternalProcessorClientPtr client_;
+  const uint32_t streams_per_service_;
+  MultiplexedStreamStats stats_;
+  TimeSource& time_source_;
+  absl::flat_hash_map<Grpc::GrpcServiceConfigWithHashKey, ServiceStreams> services_;
+};
+
+using MultiplexedStreamPoolPtr = std::unique_ptr<MultiplexedStreamPool>;
+
+/**
+ * A client whose streams are multiplexed over the shared streams of the worker's pool.
+ */
+class MultiplexedProcessorClient : public ExternalProcessorClient {
+public:
+  explicit MultiplexedProcessorClient(MultiplexedStreamPool& pool) : pool_(pool) {}
+
+  // ExternalProcessorClient
+  ExternalProcessorStreamPtr start(ExternalProcessorCallbacks& callbacks,
+                                   const Grpc::GrpcServiceConfigWithHashKey& config_with_hash_key,
+                                   Http::AsyncClient::StreamOptions& options,
+                                   Http::StreamFilterSidestreamWatermarkCallbacks&) override {
+    return pool_.start(callbacks, config_with_hash_key, options);
+  }
+  void sendRequest(ProcessingRequest&& request, bool end_stream, const uint64_t,
+                   CommonExtProc::RequestCallbacks<ProcessingResponse>*,
+                   CommonExtProc::StreamBase* stream) override;
+  void cancel() override {}
+  const StreamInfo::StreamInfo* getStreamInfo() const override { return nullptr; }
+
+private:
+  MultiplexedStreamPool& pool_;
+};
+
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
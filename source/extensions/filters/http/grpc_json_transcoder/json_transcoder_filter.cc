@@ -1,5 +1,6 @@
 #include "source/extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
 
+#include <limits>
 #include <memory>
 #include <unordered_set>
 
@@ -18,6 +19,7 @@
 #include "source/common/runtime/runtime_features.h"
 #include "source/extensions/filters/http/grpc_json_transcoder/http_body_utils.h"
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_join.h"
 #include "google/api/annotations.pb.h"
 #include "google/api/http.pb.h"
@@ -64,6 +66,9 @@ using RcDetails = ConstSingleton<RcDetailsValues>;
 
 namespace {
 
+// The HttpBody response bodies from which size on are moved to the response rather than copied.
+constexpr uint64_t MinMovedHttpBodySize = 16 * 1024;
+
 const Http::LowerCaseString& trailerHeader() {
   CONSTRUCT_ON_FIRST_USE(Http::LowerCaseString, "trailer");
 }
@@ -526,6 +531,21 @@ Http::FilterHeadersStatus JsonTranscoderFilter::decodeHeaders(Http::RequestHeade
       content_type_.assign(content_type.begin(), content_type.end());
     }
 
+    // The envelope of a unary message only depends on the length of its body, so the body can be
+    // streamed rather than buffered when its length is known in advance.
+    uint64_t content_length = 0;
+    if (!end_stream && !method_->descriptor_->client_streaming() &&
+        headers.ContentLength() != nullptr &&
+        absl::SimpleAtoi(headers.getContentLengthValue(), &content_length) &&
+        content_length <= std::numeric_limits<uint32_t>::max() / 2 &&
+        Runtime::runtimeFeatureEnabled(
+            "envoy.reloadable_features.grpc_json_transcoder_stream_http_body_request")) {
+      if (decoderBufferLimitReached(content_length)) {
+        return Http::FilterHeadersStatus::StopIteration;
+      }
+      request_content_length_ = content_length;
+    }
+
     uint64_t stream_size_before = request_in_.bytesStored();
     uint64_t buffer_size_before = initial_request_data_.length();
     bool done = !readToBuffer(*transcoder_->RequestOutput(), initial_request_data_);
@@ -591,7 +611,11 @@ Http::FilterDataStatus JsonTranscoderFilter::decodeData(Buffer::Instance& data,
     return Http::FilterDataStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (request_content_length_.has_value()) {
+    if (!streamHttpBodyRequestData(data, end_stream)) {
+      return Http::FilterDataStatus::StopIterationNoBuffer;
+    }
+  } else if (method_->request_type_is_http_body_) {
     stats_->transcoder_request_buffer_bytes_.add(data.length());
     request_data_.move(data);
     if (!method_->descriptor_->client_streaming() &&
@@ -651,7 +675,15 @@ Http::FilterTrailersStatus JsonTranscoderFilter::decodeTrailers(Http::RequestTra
     return Http::FilterTrailersStatus::Continue;
   }
 
-  if (method_->request_type_is_http_body_) {
+  if (request_content_length_.has_value()) {
+    Buffer::OwnedImpl data;
+    if (!streamHttpBodyRequestData(data, true)) {
+      return Http::FilterTrailersStatus::StopIteration;
+    }
+    if (data.length() > 0) {
+      decoder_callbacks_->addDecodedData(data, true);
+    }
+  } else if (method_->request_type_is_http_body_) {
     maybeSendHttpBodyRequestMessage(nullptr);
   } else {
     request_in_.finish();
@@ -953,6 +985,37 @@ void JsonTranscoderFilter::maybeSendHttpBodyRequestMessage(Buffer::Instance* dat
   first_request_sent_ = true;
 }
 
+bool JsonTranscoderFilter::streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream) {
+  const uint64_t content_length = request_content_length_.value();
+  streamed_request_bytes_ += data.length();
+  if (streamed_request_bytes_ > content_length ||
+      (end_stream && streamed_request_bytes_ < content_length)) {
+    ENVOY_STREAM_LOG(debug, "Request body size {} does not match its content length {}",
+                     *decoder_callbacks_, streamed_request_bytes_, content_length);
+    error_ = true;
+    decoder_callbacks_->sendLocalReply(
+        Http::Code::BadRequest, "Request body does not match its content length", nullptr,
+        absl::nullopt, absl::StrCat(RcDetails::get().GrpcTranscodeFailed, "{BAD_REQUEST}"));
+    return false;
+  }
+  if (first_request_sent_) {
+    return true;
+  }
+
+  Buffer::OwnedImpl message_payload;
+  stats_->transcoder_request_buffer_bytes_.sub(initial_request_data_.length());
+  message_payload.move(initial_request_data_);
+  HttpBodyUtils::appendHttpBodyEnvelope(message_payload, method_->request_body_field_path,
+                                        std::move(content_type_), content_length,
+                                        unknown_params_);
+  content_type_.clear();
+  Envoy::Grpc::Encoder().prependFrameHeader(Envoy::Grpc::GRPC_FH_DEFAULT, message_payload,
+                                            message_payload.length() + content_length);
+  data.prepend(message_payload);
+  first_request_sent_ = true;
+  return true;
+}
+
 bool JsonTranscoderFilter::buildResponseFromHttpBodyOutput(
     Http::ResponseHeaderMap& response_headers, Buffer::Instance& data) {
   std::vector<Grpc::Frame> frames;
@@ -972,14 +1035,25 @@ bool JsonTranscoderFilter::buildResponseFromHttpBodyOutput(
         encoder_callbacks_->resetStream();
         return true;
       }
-      const auto& body = MessageUtil::bytesToString(http_body.data());
-
-      data.add(body);
+      const uint64_t body_size = http_body.data().size();
+      if (body_size < MinMovedHttpBodySize) {
+        data.add(MessageUtil::bytesToString(http_body.data()));
+      } else {
+        // Hand the body over to the buffer rather than copying large ones.
+        auto* body = new std::string(std::move(*http_body.mutable_data()));
+        auto fragment = new Buffer::BufferFragmentImpl(
+            body->data(), body->size(),
+            [body](const void*, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
+              delete body;
+              delete this_fragment;
+            });
+        data.addBufferFragment(*fragment);
+      }
 
       if (!method_->descriptor_->server_streaming()) {
         // Non streaming case: single message with content type / length
         response_headers.setContentType(http_body.content_type());
-        response_headers.setContentLength(body.size());
+        response_headers.setContentLength(body_size);
         return true;
       } else if (!http_body_response_headers_set_) {
         // Streaming case: set content type only once from first HttpBody message
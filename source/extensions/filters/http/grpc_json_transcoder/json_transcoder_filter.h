@@ -182,6 +182,12 @@ private:
   bool checkAndRejectIfResponseTranscoderFailed();
   bool readToBuffer(Protobuf::io::ZeroCopyInputStream& stream, Buffer::Instance& data);
   void maybeSendHttpBodyRequestMessage(Buffer::Instance* data);
+  /**
+   * Streams the data of a unary HttpBody request whose content length is known, prefixing it
+   * with the gRPC frame header and the envelope of the message on the first call.
+   * Returns false if the request was rejected because its body does not match the content length.
+   */
+  bool streamHttpBodyRequestData(Buffer::Instance& data, bool end_stream);
   /**
    * Builds response from HttpBody protobuf.
    * Returns true if at least one gRPC frame has processed.
@@ -222,6 +228,9 @@ private:
   Buffer::OwnedImpl request_data_;
   bool first_request_sent_{false};
   std::string content_type_;
+  // Set if the data of a unary HttpBody request is streamed rather than buffered.
+  absl::optional<uint64_t> request_content_length_;
+  uint64_t streamed_request_bytes_{};
 
   bool error_{false};
   bool has_body_{false};
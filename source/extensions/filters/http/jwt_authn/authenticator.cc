@@ -108,6 +108,8 @@ private:
   JwtLocationConstPtr curr_token_;
   // The JWT object.
   std::unique_ptr<::google::jwt_verify::Jwt> owned_jwt_;
+  // The JWT object found in the JWT cache, which may be evicted by other threads meanwhile.
+  std::shared_ptr<const ::google::jwt_verify::Jwt> cached_jwt_;
   // The JWKS data object
   JwksCache::JwksData* jwks_data_{};
   // The HTTP request headers
@@ -129,7 +131,7 @@ private:
   const bool is_allow_failed_;
   const bool is_allow_missing_;
   TimeSource& time_source_;
-  ::google::jwt_verify::Jwt* jwt_{};
+  const ::google::jwt_verify::Jwt* jwt_{};
 };
 
 std::string AuthenticatorImpl::name() const {
@@ -179,9 +181,18 @@ void AuthenticatorImpl::startVerify() {
   Status status;
   if (provider_.has_value()) {
     jwks_data_ = jwks_cache_.findByProvider(*provider_);
-    jwt_ = jwks_data_->getJwtCache().lookup(curr_token_->token());
-    if (jwt_ != nullptr) {
+    absl::optional<JwtCache::Verification> cached =
+        jwks_data_->getJwtCache().lookup(curr_token_->token());
+    if (cached.has_value()) {
       jwks_cache_.stats().jwt_cache_hit_.inc();
+      if (cached->jwt_ == nullptr) {
+        // The JWT recently failed signature verification.
+        jwks_cache_.stats().jwt_cache_failure_hit_.inc();
+        doneWithStatus(cached->status_);
+        return;
+      }
+      cached_jwt_ = std::move(cached->jwt_);
+      jwt_ = cached_jwt_.get();
       use_jwt_cache = true;
     } else {
       jwks_cache_.stats().jwt_cache_miss_.inc();
@@ -324,6 +335,9 @@ void AuthenticatorImpl::verifyKey() {
       ::google::jwt_verify::verifyJwtWithoutTimeChecking(*jwt_, *jwks_data_->getJwksObj());
 
   if (status != Status::Ok) {
+    if (provider_) {
+      jwks_data_->getJwtCache().insertFailure(curr_token_->token(), status);
+    }
     doneWithStatus(status);
     return;
   }
@@ -11,6 +11,7 @@
 #include "source/common/common/matchers.h"
 #include "source/common/config/datasource.h"
 #include "source/common/http/utility.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -78,8 +79,13 @@ public:
 
     bool enable_jwt_cache = jwt_provider_.has_jwt_cache_config();
     const auto& config = jwt_provider_.jwt_cache_config();
-    tls_.set([enable_jwt_cache, config](Envoy::Event::Dispatcher& dispatcher) {
-      return std::make_shared<ThreadLocalCache>(enable_jwt_cache, config, dispatcher.timeSource());
+    if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.jwt_authn_shared_jwt_cache")) {
+      shared_jwt_cache_ = JwtCache::create(enable_jwt_cache, config, time_source_);
+    }
+    tls_.set([enable_jwt_cache, config,
+              shared = shared_jwt_cache_ != nullptr](Envoy::Event::Dispatcher& dispatcher) {
+      return std::make_shared<ThreadLocalCache>(
+          shared ? nullptr : JwtCache::create(enable_jwt_cache, config, dispatcher.timeSource()));
     });
 
     const auto inline_jwks =
@@ -150,21 +156,21 @@ public:
     tls_->jwks_ = shared_jwks;
     tls_->expire_ = time_source_.monotonicTime() +
                     JwksAsyncFetcher::getCacheDuration(jwt_provider_.remote_jwks());
+    getJwtCache().clearFailures();
     return shared_jwks.get();
   }
 
-  JwtCache& getJwtCache() override { return *tls_->jwt_cache_; }
+  JwtCache& getJwtCache() override {
+    return shared_jwt_cache_ != nullptr ? *shared_jwt_cache_ : *tls_->jwt_cache_;
+  }
 
 private:
   struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
-    ThreadLocalCache(bool enable_jwt_cache,
-                     const envoy::extensions::filters::http::jwt_authn::v3::JwtCacheConfig& config,
-                     TimeSource& time_source)
-        : jwt_cache_(JwtCache::create(enable_jwt_cache, config, time_source)) {}
+    explicit ThreadLocalCache(JwtCachePtr jwt_cache) : jwt_cache_(std::move(jwt_cache)) {}
 
     // The jwks object.
     JwksConstSharedPtr jwks_;
-    // The JwtCache object
+    // The JwtCache object, unless it is shared by all threads.
     const JwtCachePtr jwt_cache_;
     // The pubkey expiration time.
     MonotonicTime expire_;
@@ -173,10 +179,21 @@ private:
   // Set jwks shared_ptr to all threads.
   void setJwksToAllThreads(JwksConstPtr&& jwks) {
     JwksConstSharedPtr shared_jwks = std::move(jwks);
-    tls_.runOnAllThreads([shared_jwks](OptRef<ThreadLocalCache> obj) {
-      obj->jwks_ = shared_jwks;
-      obj->expire_ = std::chrono::steady_clock::time_point::max();
-    });
+    tls_.runOnAllThreads(
+        [shared_jwks](OptRef<ThreadLocalCache> obj) {
+          obj->jwks_ = shared_jwks;
+          obj->expire_ = std::chrono::steady_clock::time_point::max();
+          if (obj->jwt_cache_ != nullptr) {
+            obj->jwt_cache_->clearFailures();
+          }
+        },
+        // The shared cache drops its failures once all the threads verify with the new keys, so
+        // that no failure with the previous keys is left.
+        [shared_jwt_cache = shared_jwt_cache_]() {
+          if (shared_jwt_cache != nullptr) {
+            shared_jwt_cache->clearFailures();
+          }
+        });
   }
 
   // The jwt provider config.
@@ -185,6 +202,9 @@ private:
   ::google::jwt_verify::CheckAudiencePtr audiences_;
   // the time source
   TimeSource& time_source_;
+  // The JwtCache object shared by all threads, if the caches are not per thread. It is shared with
+  // the callbacks dropping its failures.
+  std::shared_ptr<JwtCache> shared_jwt_cache_;
   // the thread local slot for cache
   ThreadLocal::TypedSlot<ThreadLocalCache> tls_;
   // async fetcher
@@ -1,12 +1,17 @@
 #include "source/extensions/filters/http/jwt_authn/jwt_cache.h"
 
+#include <algorithm>
 #include <limits>
+#include <list>
 
 #include "source/common/common/assert.h"
+#include "source/common/protobuf/utility.h"
 
-#include "simple_lru_cache/simple_lru_cache_inl.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
 
-using ::google::simple_lru_cache::SimpleLRUCache;
+using ::google::jwt_verify::Status;
 
 namespace Envoy {
 namespace Extensions {
@@ -15,9 +20,13 @@ namespace JwtAuthn {
 namespace {
 
 // The default number of entries in JWT cache is 100.
-constexpr int kJwtCacheDefaultSize = 100;
+constexpr uint32_t kJwtCacheDefaultSize = 100;
 // The maximum size of JWT to be cached.
 constexpr int kMaxJwtSizeForCache = 4 * 1024; // 4KiB
+// The cache is split into shards of at least this many JWTs, up to the max shards, each with its
+// own lock.
+constexpr uint32_t kJwtCacheShardSize = 64;
+constexpr uint32_t kJwtCacheMaxShards = 16;
 
 class JwtCacheImpl : public JwtCache {
 public:
@@ -25,54 +34,150 @@ public:
       : time_source_(time_source) {
     if (enable_cache) {
       // if cache_size is 0, it is not specified in the config, use default
-      auto cache_size =
+      const uint32_t cache_size =
           config.jwt_cache_size() == 0 ? kJwtCacheDefaultSize : config.jwt_cache_size();
-      jwt_lru_cache_ =
-          std::make_unique<SimpleLRUCache<std::string, ::google::jwt_verify::Jwt>>(cache_size);
+      const uint32_t shards =
+          std::clamp(cache_size / kJwtCacheShardSize, 1u, kJwtCacheMaxShards);
+      shard_size_ = (cache_size + shards - 1) / shards;
+      shards_.reserve(shards);
+      for (uint32_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+      }
       max_jwt_size_for_cache_ =
           config.jwt_max_token_size() == 0 ? kMaxJwtSizeForCache : config.jwt_max_token_size();
+      failed_jwt_cache_duration_ = std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config, failed_jwt_cache_duration, 0));
     }
   }
 
-  ~JwtCacheImpl() override {
-    if (jwt_lru_cache_) {
-      jwt_lru_cache_->clear();
+  absl::optional<Verification> lookup(const std::string& token) override {
+    if (shards_.empty()) {
+      return absl::nullopt;
+    }
+    Shard& shard = shardFor(token);
+    absl::MutexLock lock(&shard.lock_);
+    if (auto verification = lookupIn(shard.verified_, token); verification.has_value()) {
+      return verification;
     }
+    return lookupIn(shard.failed_, token);
   }
 
-  ::google::jwt_verify::Jwt* lookup(const std::string& token) override {
-    if (!jwt_lru_cache_) {
-      return nullptr;
-    }
-    SimpleLRUCache<std::string, ::google::jwt_verify::Jwt>::ScopedLookup lookup(
-        jwt_lru_cache_.get(), token);
-    if (lookup.found()) {
-      ::google::jwt_verify::Jwt* const found_jwt = lookup.value();
-      ASSERT(found_jwt != nullptr);
-      if (found_jwt->verifyTimeConstraint(DateUtil::nowToSeconds(time_source_)) !=
-          ::google::jwt_verify::Status::JwtExpired) {
-        return found_jwt;
-      } else {
-        jwt_lru_cache_->remove(token);
-      }
+  void insert(const std::string& token, std::unique_ptr<::google::jwt_verify::Jwt>&& jwt) override {
+    if (!isCacheable(token)) {
+      return;
     }
-    return nullptr;
+    // pass the ownership of jwt to cache
+    insertVerification(token, {std::move(jwt)}, MonotonicTime::max());
   }
 
-  void insert(const std::string& token, std::unique_ptr<::google::jwt_verify::Jwt>&& jwt) override {
-    if (!jwt_lru_cache_ || token.size() > std::numeric_limits<uint32_t>::max()) {
+  void insertFailure(const std::string& token, Status status) override {
+    ASSERT(status != Status::Ok);
+    if (failed_jwt_cache_duration_.count() == 0 || !isCacheable(token)) {
       return;
     }
-    if (static_cast<uint32_t>(token.size()) <= max_jwt_size_for_cache_) {
-      // pass the ownership of jwt to cache
-      jwt_lru_cache_->insert(token, jwt.release(), 1);
+    insertVerification(token, {nullptr, status},
+                       time_source_.monotonicTime() + failed_jwt_cache_duration_);
+  }
+
+  void clearFailures() override {
+    for (const auto& shard : shards_) {
+      absl::MutexLock lock(&shard->lock_);
+      shard->failed_.index_.clear();
+      shard->failed_.list_.clear();
     }
   }
 
 private:
-  std::unique_ptr<SimpleLRUCache<std::string, ::google::jwt_verify::Jwt>> jwt_lru_cache_;
+  struct CachedJwt {
+    const std::string token_;
+    const Verification verification_;
+    // Only set for JWTs that failed verification, as verified ones expire with their `exp`.
+    const MonotonicTime failure_expire_;
+  };
+  using LruList = std::list<CachedJwt>;
+  // Keyed by the tokens of the JWTs in the list.
+  using LruIndex = absl::flat_hash_map<absl::string_view, LruList::iterator>;
+
+  struct Lru {
+    // The most recently used JWTs first.
+    LruList list_;
+    LruIndex index_;
+  };
+
+  struct Shard {
+    absl::Mutex lock_;
+    Lru verified_ ABSL_GUARDED_BY(lock_);
+    // The JWTs that failed verification are kept apart, so that requests with invalid JWTs cannot
+    // evict the verified ones.
+    Lru failed_ ABSL_GUARDED_BY(lock_);
+  };
+
+  bool isCacheable(const std::string& token) const {
+    return !shards_.empty() && token.size() <= std::numeric_limits<uint32_t>::max() &&
+           static_cast<uint32_t>(token.size()) <= max_jwt_size_for_cache_;
+  }
+
+  Shard& shardFor(absl::string_view token) {
+    // The low bits of the hash pick the slots of the shards' indexes.
+    return *shards_[(absl::Hash<absl::string_view>()(token) >> 32) % shards_.size()];
+  }
+
+  absl::optional<Verification> lookupIn(Lru& lru, const std::string& token) {
+    const auto it = lru.index_.find(token);
+    if (it == lru.index_.end()) {
+      return absl::nullopt;
+    }
+    const LruList::iterator cached = it->second;
+    const bool expired =
+        cached->verification_.jwt_ != nullptr
+            ? cached->verification_.jwt_->verifyTimeConstraint(
+                  DateUtil::nowToSeconds(time_source_)) == Status::JwtExpired
+            : time_source_.monotonicTime() >= cached->failure_expire_;
+    if (expired) {
+      erase(lru, it);
+      return absl::nullopt;
+    }
+    lru.list_.splice(lru.list_.begin(), lru.list_, cached);
+    return cached->verification_;
+  }
+
+  static void erase(Lru& lru, LruIndex::iterator it) {
+    const LruList::iterator cached = it->second;
+    lru.index_.erase(it);
+    lru.list_.erase(cached);
+  }
+
+  static void erase(Lru& lru, absl::string_view token) {
+    const auto it = lru.index_.find(token);
+    if (it != lru.index_.end()) {
+      erase(lru, it);
+    }
+  }
+
+  void insertVerification(const std::string& token, Verification verification,
+                          MonotonicTime failure_expire) {
+    Shard& shard = shardFor(token);
+    absl::MutexLock lock(&shard.lock_);
+    // Another worker may have verified the same JWT meanwhile, or a JWT that failed may verify
+    // with keys fetched since.
+    erase(shard.verified_, token);
+    erase(shard.failed_, token);
+    Lru& lru = verification.jwt_ != nullptr ? shard.verified_ : shard.failed_;
+    lru.list_.push_front({token, std::move(verification), failure_expire});
+    lru.index_.emplace(lru.list_.front().token_, lru.list_.begin());
+    if (lru.list_.size() > shard_size_) {
+      lru.index_.erase(lru.list_.back().token_);
+      lru.list_.pop_back();
+    }
+  }
+
   TimeSource& time_source_;
-  uint32_t max_jwt_size_for_cache_;
+  // Empty if the cache is disabled.
+  std::vector<std::unique_ptr<Shard>> shards_;
+  uint32_t shard_size_{};
+  uint32_t max_jwt_size_for_cache_{};
+  // Zero if failed JWTs are not cached.
+  std::chrono::milliseconds failed_jwt_cache_duration_{};
 };
 } // namespace
 
@@ -7,6 +7,8 @@
 
 #include "source/common/common/utility.h"
 
+#include "absl/types/optional.h"
+
 #include "jwt_verify_lib/jwt.h"
 #include "jwt_verify_lib/verify.h"
 
@@ -17,7 +19,8 @@ namespace Extensions {
 namespace HttpFilters {
 namespace JwtAuthn {
 
-// Cache key is the JWT string, value is parsed JWT struct.
+// Cache key is the JWT string, value is parsed JWT struct, or the status the JWT failed
+// verification with. The cache is thread-safe.
 
 class JwtCache;
 using JwtCachePtr = std::unique_ptr<JwtCache>;
@@ -26,15 +29,30 @@ class JwtCache {
 public:
   virtual ~JwtCache() = default;
 
-  // Lookup a JWT in the cache, if found return the pointer to its parsed jwt struct.
-  // If no found, return nullptr.
-  virtual ::google::jwt_verify::Jwt* lookup(const std::string& token) PURE;
+  // The outcome of a previous verification of a JWT.
+  struct Verification {
+    // The parsed jwt struct if the JWT was verified. It is shared, so that it stays valid if the
+    // JWT is evicted meanwhile.
+    std::shared_ptr<const ::google::jwt_verify::Jwt> jwt_;
+    // The status the JWT failed verification with, if it did.
+    ::google::jwt_verify::Status status_{::google::jwt_verify::Status::Ok};
+  };
+
+  // Lookup a JWT in the cache, if found return the outcome of its verification.
+  // If no found, return nullopt.
+  virtual absl::optional<Verification> lookup(const std::string& token) PURE;
 
   // Insert a JWT and its parsed JWT struct to the cache.
   // The function will take over the ownership of jwt object.
   virtual void insert(const std::string& token,
                       std::unique_ptr<::google::jwt_verify::Jwt>&& jwt) PURE;
 
+  // Insert a JWT that failed signature verification with the status, if failed JWTs are cached.
+  virtual void insertFailure(const std::string& token, ::google::jwt_verify::Status status) PURE;
+
+  // Drop the JWTs that failed verification, as they may verify with newly fetched keys.
+  virtual void clearFailures() PURE;
+
   // JwtCache factory function.
   static JwtCachePtr create(bool enable_cache, const JwtCacheConfig& config,
                             TimeSource& time_source);
@@ -16,6 +16,7 @@ namespace JwtAuthn {
   COUNTER(denied)                                                                                  \
   COUNTER(jwks_fetch_success)                                                                      \
   COUNTER(jwks_fetch_failed)                                                                       \
+  COUNTER(jwt_cache_failure_hit)                                                                   \
   COUNTER(jwt_cache_hit)                                                                           \
   COUNTER(jwt_cache_miss)
 
@@ -110,9 +110,40 @@ FilterConfig::FilterConfig(
     share_provider = share_provider_manager_->getShareProvider(config.local_cluster_rate_limit());
   }
 
+  absl::optional<Filters::Common::LocalRateLimit::TokenBucketSharding> sharding;
+  if (config.has_worker_sharding()) {
+    if (rate_limit_per_connection_) {
+      throw EnvoyException("worker_sharding is set and "
+                           "local_rate_limit_per_downstream_connection is set to true");
+    }
+    sharding.emplace(Filters::Common::LocalRateLimit::TokenBucketSharding{
+        context.threadLocal(),
+        config.worker_sharding().has_worker_batch()
+            ? config.worker_sharding().worker_batch().value()
+            : 1.0,
+        std::chrono::milliseconds(
+            PROTOBUF_GET_MS_OR_DEFAULT(config.worker_sharding(), rebalance_interval, 100))});
+  }
+
+  Filters::Common::LocalRateLimit::DynamicDescriptorOptions dynamic_descriptor_options;
+  if (config.has_dynamic_descriptors()) {
+    dynamic_descriptor_options.shards_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.dynamic_descriptors(), shards, 0);
+    dynamic_descriptor_options.min_requests_ = config.dynamic_descriptors().min_requests();
+    dynamic_descriptor_options.window_ = std::chrono::milliseconds(
+        PROTOBUF_GET_MS_OR_DEFAULT(config.dynamic_descriptors(), window, 1000));
+  }
+  if (has_descriptors_) {
+    dynamic_descriptor_options.stats_.emplace(
+        generateDynamicDescriptorStats(config.stat_prefix(), scope));
+  }
+
   rate_limiter_ = std::make_unique<Filters::Common::LocalRateLimit::LocalRateLimiterImpl>(
       fill_interval_, max_tokens_, tokens_per_fill_, dispatcher_, descriptors_,
-      always_consume_default_token_bucket_, std::move(share_provider), max_dynamic_descriptors_);
+      always_consume_default_token_bucket_, std::move(share_provider), max_dynamic_descriptors_,
+      makeOptRefFromPtr<const Filters::Common::LocalRateLimit::TokenBucketSharding>(
+          sharding.has_value() ? &sharding.value() : nullptr),
+      dynamic_descriptor_options);
 }
 
 Filters::Common::LocalRateLimit::LocalRateLimiterImpl::Result
@@ -125,6 +156,13 @@ LocalRateLimitStats FilterConfig::generateStats(const std::string& prefix, Stats
   return {ALL_LOCAL_RATE_LIMIT_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
 }
 
+Filters::Common::LocalRateLimit::DynamicDescriptorStats
+FilterConfig::generateDynamicDescriptorStats(const std::string& prefix, Stats::Scope& scope) {
+  const std::string final_prefix = prefix + ".http_local_rate_limit";
+  return {ALL_DYNAMIC_DESCRIPTOR_STATS(POOL_COUNTER_PREFIX(scope, final_prefix),
+                                       POOL_GAUGE_PREFIX(scope, final_prefix))};
+}
+
 bool FilterConfig::enabled() const {
   return filter_enabled_.has_value() ? filter_enabled_->enabled() : false;
 }
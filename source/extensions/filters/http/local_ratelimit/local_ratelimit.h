@@ -131,6 +131,8 @@ private:
   friend class FilterTest;
 
   static LocalRateLimitStats generateStats(const std::string& prefix, Stats::Scope& scope);
+  static Filters::Common::LocalRateLimit::DynamicDescriptorStats
+  generateDynamicDescriptorStats(const std::string& prefix, Stats::Scope& scope);
 
   static Http::Code toErrorCode(uint64_t status) {
     const auto code = static_cast<Http::Code>(status);
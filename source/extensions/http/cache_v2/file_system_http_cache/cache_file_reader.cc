@@ -1,5 +1,6 @@
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_reader.h"
 
+#include "source/common/buffer/buffer_impl.h"
 #include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_fixed_block.h"
 
 namespace Envoy {
@@ -9,6 +10,27 @@ namespace CacheV2 {
 namespace FileSystemHttpCache {
 
 using Common::AsyncFiles::AsyncFileHandle;
+using Common::AsyncFiles::MappedFileRegionSharedPtr;
+
+namespace {
+
+// A buffer fragment referring to part of a mapped file, which holds a reference to the
+// mapping until the fragment is drained.
+class MappedBodyFragment : public Buffer::BufferFragment {
+public:
+  MappedBodyFragment(MappedFileRegionSharedPtr region, absl::string_view data)
+      : region_(std::move(region)), data_(data) {}
+  // Buffer::BufferFragment
+  const void* data() const override { return data_.data(); }
+  size_t size() const override { return data_.size(); }
+  void done() override { delete this; }
+
+private:
+  const MappedFileRegionSharedPtr region_;
+  const absl::string_view data_;
+};
+
+} // namespace
 
 CacheFileReader::CacheFileReader(AsyncFileHandle handle) : file_handle_(handle) {}
 
@@ -34,6 +56,21 @@ CacheFileReader::~CacheFileReader() {
   ASSERT(queued.ok());
 }
 
+MappedCacheFileReader::MappedCacheFileReader(MappedFileRegionSharedPtr body)
+    : body_(std::move(body)) {}
+
+void MappedCacheFileReader::getBody(Event::Dispatcher&, AdjustedByteRange range,
+                                    GetBodyCallback&& cb) {
+  const absl::string_view body = body_->contents();
+  if (range.end() > body.size()) {
+    return cb(nullptr, EndStream::Reset);
+  }
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  buffer->addBufferFragment(
+      *new MappedBodyFragment(body_, body.substr(range.begin(), range.length())));
+  cb(std::move(buffer), EndStream::More);
+}
+
 } // namespace FileSystemHttpCache
 } // namespace CacheV2
 } // namespace HttpFilters
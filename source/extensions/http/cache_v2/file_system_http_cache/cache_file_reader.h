@@ -20,6 +20,20 @@ private:
   Common::AsyncFiles::AsyncFileHandle file_handle_;
 };
 
+// Serves the body of a cache file from a memory mapping of it. Body buffers are fragments
+// referring to the mapping, which is kept alive until every buffer referring to it is drained,
+// so no body bytes are copied and getBody completes synchronously.
+class MappedCacheFileReader : public CacheReader {
+public:
+  // The region must contain exactly the body of the cache file.
+  MappedCacheFileReader(Common::AsyncFiles::MappedFileRegionSharedPtr body);
+  // From CacheReader
+  void getBody(Event::Dispatcher& dispatcher, AdjustedByteRange range, GetBodyCallback&& cb) final;
+
+private:
+  const Common::AsyncFiles::MappedFileRegionSharedPtr body_;
+};
+
 } // namespace FileSystemHttpCache
 } // namespace CacheV2
 } // namespace HttpFilters
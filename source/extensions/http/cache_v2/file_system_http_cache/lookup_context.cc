@@ -13,19 +13,22 @@ namespace CacheV2 {
 namespace FileSystemHttpCache {
 
 FileLookupContext::FileLookupContext(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
-                                     HttpCache::LookupCallback&& callback)
-    : dispatcher_(dispatcher), file_handle_(std::move(handle)), callback_(std::move(callback)) {}
+                                     bool memory_map_body, HttpCache::LookupCallback&& callback)
+    : dispatcher_(dispatcher), file_handle_(std::move(handle)), memory_map_body_(memory_map_body),
+      callback_(std::move(callback)) {}
 
 void FileLookupContext::begin(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
-                              HttpCache::LookupCallback&& callback) {
+                              bool memory_map_body, HttpCache::LookupCallback&& callback) {
   // bare pointer because this object owns itself - it gets captured in
   // lambdas and is deleted when 'done' is eventually called.
-  FileLookupContext* p = new FileLookupContext(dispatcher, std::move(handle), std::move(callback));
+  FileLookupContext* p = new FileLookupContext(dispatcher, std::move(handle), memory_map_body,
+                                               std::move(callback));
   p->getHeaderBlock();
 }
 
 void FileLookupContext::done(absl::StatusOr<LookupResult>&& result) {
-  if (!result.ok() || result.value().cache_reader_ == nullptr) {
+  // The file handle is still held unless it was handed to a CacheFileReader.
+  if (file_handle_) {
     auto queued = file_handle_->close(nullptr, [](absl::Status) {});
     ASSERT(queued.ok(), queued.status().ToString());
   }
@@ -73,6 +76,9 @@ void FileLookupContext::getHeaders() {
                            result_.response_headers_ = headersFromHeaderProto(header_proto);
                            result_.response_metadata_ = metadataFromHeaderProto(header_proto);
                            result_.body_length_ = header_block_.bodySize();
+                           if (memory_map_body_ && header_block_.bodySize() > 0) {
+                             return mapBody();
+                           }
                            result_.cache_reader_ =
                                std::make_unique<CacheFileReader>(std::move(file_handle_));
                            return done(std::move(result_));
@@ -80,6 +86,22 @@ void FileLookupContext::getHeaders() {
   ASSERT(queued.ok(), queued.status().ToString());
 }
 
+void FileLookupContext::mapBody() {
+  auto queued = file_handle_->mmap(
+      &dispatcher_, CacheFileFixedBlock::offsetToBody(), header_block_.bodySize(),
+      [this](absl::StatusOr<Common::AsyncFiles::MappedFileRegionSharedPtr> mmap_result) -> void {
+        if (mmap_result.ok()) {
+          // The mapping remains valid after the file is closed.
+          result_.cache_reader_ = std::make_unique<MappedCacheFileReader>(std::move(*mmap_result));
+        } else {
+          // Mapping is only an optimization; fall back to reading the file.
+          result_.cache_reader_ = std::make_unique<CacheFileReader>(std::move(file_handle_));
+        }
+        return done(std::move(result_));
+      });
+  ASSERT(queued.ok(), queued.status().ToString());
+}
+
 void FileLookupContext::getTrailers() {
   auto queued = file_handle_->read(
       &dispatcher_, header_block_.offsetToTrailers(), header_block_.trailerSize(),
@@ -19,19 +19,22 @@ using Envoy::Extensions::Common::AsyncFiles::AsyncFileHandle;
 
 class FileLookupContext {
 public:
-  static void begin(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
+  // If memory_map_body is true, the body is served from a memory mapping of the file.
+  static void begin(Event::Dispatcher& dispatcher, AsyncFileHandle handle, bool memory_map_body,
                     HttpCache::LookupCallback&& callback);
 
 private:
-  FileLookupContext(Event::Dispatcher& dispatcher, AsyncFileHandle handle,
+  FileLookupContext(Event::Dispatcher& dispatcher, AsyncFileHandle handle, bool memory_map_body,
                     HttpCache::LookupCallback&& callback);
   void getHeaderBlock();
   void getHeaders();
+  void mapBody();
   void getTrailers();
   void done(absl::StatusOr<LookupResult>&& result);
 
   Event::Dispatcher& dispatcher_;
   AsyncFileHandle file_handle_;
+  const bool memory_map_body_;
   CacheFileFixedBlock header_block_;
   HttpCache::LookupCallback callback_;
   LookupResult result_;
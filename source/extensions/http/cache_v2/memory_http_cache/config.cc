@@ -0,0 +1,87 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/http/cache_v2/memory_http_cache/v3/memory_http_cache.pb.h"
+#include "envoy/extensions/http/cache_v2/memory_http_cache/v3/memory_http_cache.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/memory_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+namespace {
+
+/**
+ * A singleton that hands out one MemoryHttpCache per cache_name. If given configs with the same
+ * cache_name but different configuration, an error status is returned.
+ */
+class CacheSingleton : public Envoy::Singleton::Instance {
+public:
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  get(const ConfigProto& config, Server::Configuration::FactoryContext& context) {
+    std::shared_ptr<CacheSessions> cache;
+    absl::MutexLock lock(&mu_);
+    auto it = caches_.find(config.cache_name());
+    if (it != caches_.end()) {
+      cache = it->second.lock();
+    }
+    if (!cache) {
+      // The cache may outlive the listener that created it, so its stats live in the server scope.
+      cache = CacheSessions::create(
+          context, std::make_unique<MemoryHttpCache>(
+                       config, context.serverFactoryContext().serverScope()));
+      caches_[config.cache_name()] = cache;
+    } else {
+      MemoryHttpCache& memory_cache = static_cast<MemoryHttpCache&>(cache->cache());
+      if (!Protobuf::util::MessageDifferencer::Equals(memory_cache.config(), config)) {
+        return absl::InvalidArgumentError(
+            fmt::format("mismatched MemoryHttpCacheV2Config with same cache_name\n{}\nvs.\n{}",
+                        memory_cache.config().DebugString(), config.DebugString()));
+      }
+    }
+    return cache;
+  }
+
+private:
+  absl::Mutex mu_;
+  // Caches are destroyed once no filter config refers to them any more.
+  absl::flat_hash_map<std::string, std::weak_ptr<CacheSessions>> caches_ ABSL_GUARDED_BY(mu_);
+};
+
+SINGLETON_MANAGER_REGISTRATION(memory_http_cache_v2_singleton);
+
+class MemoryHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string{MemoryHttpCache::name()}; }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ConfigProto>();
+  }
+  // From HttpCacheFactory
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
+           Server::Configuration::FactoryContext& context) override {
+    ConfigProto config;
+    RETURN_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
+    std::shared_ptr<CacheSingleton> caches =
+        context.serverFactoryContext().singletonManager().getTyped<CacheSingleton>(
+            SINGLETON_MANAGER_REGISTERED_NAME(memory_http_cache_v2_singleton),
+            [] { return std::make_shared<CacheSingleton>(); });
+    return caches->get(config, context);
+  }
+};
+
+static Registry::RegisterFactory<MemoryHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
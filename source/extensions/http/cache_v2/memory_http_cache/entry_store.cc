@@ -0,0 +1,275 @@
+#include "source/extensions/http/cache_v2/memory_http_cache/entry_store.h"
+
+#include <algorithm>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+namespace {
+
+// References part of a stored body chunk, keeping the chunk alive until the fragment has been
+// drained from every buffer it was added to.
+class ChunkFragment : public Buffer::BufferFragment {
+public:
+  ChunkFragment(std::shared_ptr<const std::string> chunk, size_t offset, size_t size)
+      : chunk_(std::move(chunk)), offset_(offset), size_(size) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return chunk_->data() + offset_; }
+  size_t size() const override { return size_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<const std::string> chunk_;
+  const size_t offset_;
+  const size_t size_;
+};
+
+} // namespace
+
+MemoryHttpCacheStats generateStats(Stats::Scope& scope, absl::string_view prefix) {
+  return {ALL_MEMORY_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                      POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
+Buffer::InstancePtr CacheEntry::body(AdjustedByteRange range) const {
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  absl::ReaderMutexLock lock(&mu_);
+  // Find the last chunk starting at or before the beginning of the range.
+  auto it = std::upper_bound(
+      body_.begin(), body_.end(), range.begin(),
+      [](uint64_t position, const Chunk& chunk) { return position < chunk.offset_; });
+  if (it == body_.begin()) {
+    return buffer;
+  }
+  for (--it; it != body_.end() && it->offset_ < range.end(); ++it) {
+    const uint64_t begin = std::max(range.begin(), it->offset_) - it->offset_;
+    const uint64_t end =
+        std::min<uint64_t>(range.end(), it->offset_ + it->data_->size()) - it->offset_;
+    if (end > begin) {
+      buffer->addBufferFragment(*new ChunkFragment(it->data_, begin, end - begin));
+    }
+  }
+  return buffer;
+}
+
+void CacheEntry::appendBody(Buffer::Instance& buf) {
+  if (buf.length() == 0) {
+    return;
+  }
+  auto chunk = std::make_shared<const std::string>(buf.toString());
+  absl::WriterMutexLock lock(&mu_);
+  body_.push_back({body_size_, chunk});
+  body_size_ += chunk->size();
+}
+
+uint64_t CacheEntry::bodySize() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return body_size_;
+}
+
+Http::ResponseHeaderMapPtr CacheEntry::copyHeaders() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*response_headers_);
+}
+
+Http::ResponseTrailerMapPtr CacheEntry::copyTrailers() const {
+  absl::ReaderMutexLock lock(&mu_);
+  if (!trailers_) {
+    return nullptr;
+  }
+  return Http::createHeaderMap<Http::ResponseTrailerMapImpl>(*trailers_);
+}
+
+ResponseMetadata CacheEntry::metadata() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return metadata_;
+}
+
+void CacheEntry::updateHeadersAndMetadata(Http::ResponseHeaderMapPtr response_headers,
+                                          ResponseMetadata metadata) {
+  absl::WriterMutexLock lock(&mu_);
+  response_headers_ = std::move(response_headers);
+  metadata_ = std::move(metadata);
+}
+
+void CacheEntry::setTrailers(Http::ResponseTrailerMapPtr trailers) {
+  absl::WriterMutexLock lock(&mu_);
+  trailers_ = std::move(trailers);
+}
+
+uint64_t CacheEntry::byteSize() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return sizeof(CacheEntry) + body_size_ + body_.size() * sizeof(Chunk) +
+         response_headers_->byteSize() + (trailers_ ? trailers_->byteSize() : 0);
+}
+
+EntryStore::EntryStore(uint64_t max_bytes, uint64_t max_entry_bytes, uint32_t shard_count,
+                       MemoryHttpCacheStats stats)
+    : max_entry_bytes_(std::min(max_entry_bytes, std::max<uint64_t>(max_bytes / shard_count, 1))),
+      stats_(std::move(stats)) {
+  ASSERT(shard_count > 0);
+  stats_.size_limit_bytes_.set(max_bytes);
+  shards_.reserve(shard_count);
+  for (uint32_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(
+        std::make_unique<Shard>(*this, std::max<uint64_t>(max_bytes / shard_count, 1)));
+  }
+}
+
+CacheEntrySharedPtr EntryStore::lookup(const Key& key) {
+  CacheEntrySharedPtr entry = shardFor(MessageUtil::hash(key)).lookup(key, true);
+  if (entry) {
+    stats_.lookup_hit_.inc();
+  } else {
+    stats_.lookup_miss_.inc();
+  }
+  return entry;
+}
+
+CacheEntrySharedPtr EntryStore::peek(const Key& key) {
+  return shardFor(MessageUtil::hash(key)).lookup(key, false);
+}
+
+bool EntryStore::insert(const Key& key, CacheEntrySharedPtr entry) {
+  const uint64_t charge = Shard::charge(key, *entry);
+  if (charge > max_entry_bytes_) {
+    stats_.insert_rejected_.inc();
+    return false;
+  }
+  const size_t hash = MessageUtil::hash(key);
+  shardFor(hash).insert(key, hash, std::move(entry), charge);
+  stats_.insert_.inc();
+  return true;
+}
+
+void EntryStore::erase(const Key& key) { shardFor(MessageUtil::hash(key)).erase(key); }
+
+uint64_t EntryStore::Shard::charge(const Key& key, const CacheEntry& entry) {
+  // The key is held twice, by the index and by the eviction queue node.
+  return entry.byteSize() + 2 * key.ByteSizeLong() + sizeof(Node);
+}
+
+CacheEntrySharedPtr EntryStore::Shard::lookup(const Key& key, bool record_access) {
+  absl::ReaderMutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+  Node& node = *it->second;
+  if (record_access) {
+    // Concurrent lookups may lose an increment, which only makes the frequency approximate.
+    const uint8_t frequency = node.frequency_.load(std::memory_order_relaxed);
+    if (frequency < MaxFrequency) {
+      node.frequency_.store(frequency + 1, std::memory_order_relaxed);
+    }
+  }
+  return node.entry_;
+}
+
+void EntryStore::Shard::insert(const Key& key, size_t hash, CacheEntrySharedPtr entry,
+                               uint64_t charge) {
+  absl::MutexLock lock(&mu_);
+  auto existing = index_.find(key);
+  if (existing != index_.end()) {
+    removeLocked(existing->second);
+  }
+  while (small_bytes_ + main_bytes_ + charge > capacity_ && evictOneLocked()) {
+  }
+  const bool in_main = takeGhostLocked(hash);
+  NodeList& queue = in_main ? main_ : small_;
+  queue.emplace_back(key, hash, std::move(entry), charge, in_main);
+  index_.emplace(key, std::prev(queue.end()));
+  (in_main ? main_bytes_ : small_bytes_) += charge;
+  if (in_main) {
+    parent_.stats_.ghost_hit_.inc();
+  }
+  parent_.stats_.size_bytes_.add(charge);
+  parent_.stats_.size_count_.inc();
+}
+
+void EntryStore::Shard::erase(const Key& key) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    removeLocked(it->second);
+  }
+}
+
+void EntryStore::Shard::removeLocked(NodeList::iterator node) {
+  const uint64_t charge = node->charge_;
+  index_.erase(node->key_);
+  if (node->in_main_) {
+    main_bytes_ -= charge;
+    main_.erase(node);
+  } else {
+    small_bytes_ -= charge;
+    small_.erase(node);
+  }
+  parent_.stats_.size_bytes_.sub(charge);
+  parent_.stats_.size_count_.dec();
+}
+
+bool EntryStore::Shard::evictOneLocked() {
+  if (!small_.empty() && (small_bytes_ >= capacity_ / 10 || main_.empty())) {
+    auto head = small_.begin();
+    if (head->frequency_.load(std::memory_order_relaxed) > 0) {
+      // Looked up while in the small FIFO; give it a place in the main FIFO instead.
+      head->frequency_.store(0, std::memory_order_relaxed);
+      head->in_main_ = true;
+      small_bytes_ -= head->charge_;
+      main_bytes_ += head->charge_;
+      main_.splice(main_.end(), small_, head);
+      return true;
+    }
+    addGhostLocked(head->hash_);
+    removeLocked(head);
+    parent_.stats_.eviction_.inc();
+    return true;
+  }
+  while (!main_.empty()) {
+    auto head = main_.begin();
+    const uint8_t frequency = head->frequency_.load(std::memory_order_relaxed);
+    if (frequency == 0) {
+      removeLocked(head);
+      parent_.stats_.eviction_.inc();
+      return true;
+    }
+    head->frequency_.store(frequency - 1, std::memory_order_relaxed);
+    main_.splice(main_.end(), main_, head);
+  }
+  return false;
+}
+
+void EntryStore::Shard::addGhostLocked(size_t hash) {
+  ghost_fifo_.push_back(hash);
+  ++ghost_[hash];
+  // Remember about as many evicted keys as there are entries in the shard.
+  while (ghost_fifo_.size() > std::max<size_t>(index_.size(), 1)) {
+    auto it = ghost_.find(ghost_fifo_.front());
+    if (it != ghost_.end() && --it->second == 0) {
+      ghost_.erase(it);
+    }
+    ghost_fifo_.pop_front();
+  }
+}
+
+bool EntryStore::Shard::takeGhostLocked(size_t hash) {
+  auto it = ghost_.find(hash);
+  if (it == ghost_.end()) {
+    return false;
+  }
+  ghost_.erase(it);
+  return true;
+}
+
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+
+/**
+ * All memory cache stats. @see stats_macros.h
+ *
+ * size_bytes is the sum of the approximate entry sizes used against size_limit_bytes. Changes in
+ * entry size due to header updates are ignored.
+ */
+#define ALL_MEMORY_HTTP_CACHE_STATS(COUNTER, GAUGE)                                                \
+  COUNTER(lookup_hit)                                                                              \
+  COUNTER(lookup_miss)                                                                             \
+  COUNTER(insert)                                                                                  \
+  COUNTER(insert_rejected)                                                                         \
+  COUNTER(eviction)                                                                                \
+  COUNTER(ghost_hit)                                                                               \
+  GAUGE(size_bytes, NeverImport)                                                                   \
+  GAUGE(size_count, NeverImport)                                                                   \
+  GAUGE(size_limit_bytes, NeverImport)
+
+/**
+ * Struct definition for memory cache stats. @see stats_macros.h
+ */
+struct MemoryHttpCacheStats {
+  ALL_MEMORY_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+// Creates the stats of a memory cache, each named prefix followed by the stat's name.
+MemoryHttpCacheStats generateStats(Stats::Scope& scope, absl::string_view prefix);
+
+/**
+ * A cached response. The body is kept as a list of immutable, reference counted chunks so that
+ * readers can be handed the body without copying it, and keep reading it after the entry has
+ * been evicted. The body may be appended to while it is being read.
+ */
+class CacheEntry {
+public:
+  CacheEntry(Http::ResponseHeaderMapPtr response_headers, ResponseMetadata metadata)
+      : response_headers_(std::move(response_headers)), metadata_(std::move(metadata)) {}
+
+  // Returns the requested part of the body. The returned buffer references the stored chunks.
+  Buffer::InstancePtr body(AdjustedByteRange range) const;
+  void appendBody(Buffer::Instance& buf);
+  uint64_t bodySize() const;
+  Http::ResponseHeaderMapPtr copyHeaders() const;
+  Http::ResponseTrailerMapPtr copyTrailers() const;
+  ResponseMetadata metadata() const;
+  void updateHeadersAndMetadata(Http::ResponseHeaderMapPtr response_headers,
+                                ResponseMetadata metadata);
+  void setTrailers(Http::ResponseTrailerMapPtr trailers);
+  // The approximate number of bytes of memory held by this entry.
+  uint64_t byteSize() const;
+
+private:
+  struct Chunk {
+    uint64_t offset_;
+    std::shared_ptr<const std::string> data_;
+  };
+
+  mutable absl::Mutex mu_;
+  std::vector<Chunk> body_ ABSL_GUARDED_BY(mu_);
+  uint64_t body_size_ ABSL_GUARDED_BY(mu_){0};
+  Http::ResponseHeaderMapPtr response_headers_ ABSL_GUARDED_BY(mu_);
+  ResponseMetadata metadata_ ABSL_GUARDED_BY(mu_);
+  Http::ResponseTrailerMapPtr trailers_ ABSL_GUARDED_BY(mu_);
+};
+
+using CacheEntrySharedPtr = std::shared_ptr<CacheEntry>;
+
+/**
+ * A byte bounded map from cache key to entry, split into independently locked shards.
+ *
+ * Each shard evicts using S3-FIFO: new entries go into a small FIFO that holds about a tenth of
+ * the shard's bytes. Entries that were looked up while in the small FIFO move to the main FIFO
+ * when they reach its head, others are evicted and their key hash is remembered in a ghost FIFO.
+ * Entries whose key is found in the ghost FIFO are inserted straight into the main FIFO. The main
+ * FIFO reinserts entries that were looked up since they last reached its head. Lookups only take
+ * a shard's lock for reading, since recording an access is a relaxed atomic update.
+ */
+class EntryStore {
+public:
+  EntryStore(uint64_t max_bytes, uint64_t max_entry_bytes, uint32_t shard_count,
+             MemoryHttpCacheStats stats);
+
+  // Returns the entry for the key, or nullptr, and records an access to it.
+  CacheEntrySharedPtr lookup(const Key& key);
+  // Returns the entry for the key, or nullptr, without recording an access.
+  CacheEntrySharedPtr peek(const Key& key);
+  // Adds the entry, replacing any entry with the same key, and evicts entries as needed to stay
+  // within the byte budget. Returns false if the entry is too large to be cached.
+  bool insert(const Key& key, CacheEntrySharedPtr entry);
+  void erase(const Key& key);
+
+  // The largest charge of an entry that can be inserted.
+  uint64_t maxEntryBytes() const { return max_entry_bytes_; }
+  MemoryHttpCacheStats& stats() { return stats_; }
+
+private:
+  // Frequency saturates at 3, so that an entry can be reinserted into the main FIFO at most three
+  // times without being looked up again.
+  static constexpr uint8_t MaxFrequency = 3;
+
+  class Shard {
+  public:
+    Shard(EntryStore& parent, uint64_t capacity) : parent_(parent), capacity_(capacity) {}
+
+    // The number of bytes charged against the shard's capacity for holding the entry.
+    static uint64_t charge(const Key& key, const CacheEntry& entry);
+
+    CacheEntrySharedPtr lookup(const Key& key, bool record_access);
+    void insert(const Key& key, size_t hash, CacheEntrySharedPtr entry, uint64_t charge);
+    void erase(const Key& key);
+
+  private:
+    struct Node {
+      Node(const Key& key, size_t hash, CacheEntrySharedPtr entry, uint64_t charge, bool in_main)
+          : key_(key), hash_(hash), entry_(std::move(entry)), charge_(charge), in_main_(in_main) {}
+
+      const Key key_;
+      const size_t hash_;
+      const CacheEntrySharedPtr entry_;
+      const uint64_t charge_;
+      std::atomic<uint8_t> frequency_{0};
+      bool in_main_;
+    };
+    using NodeList = std::list<Node>;
+
+    void removeLocked(NodeList::iterator node) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    // Makes progress towards freeing memory. Returns false if there is nothing left to evict.
+    bool evictOneLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    void addGhostLocked(size_t hash) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+    bool takeGhostLocked(size_t hash) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    EntryStore& parent_;
+    const uint64_t capacity_;
+    absl::Mutex mu_;
+    absl::flat_hash_map<Key, NodeList::iterator, MessageUtil, MessageUtil>
+        index_ ABSL_GUARDED_BY(mu_);
+    NodeList small_ ABSL_GUARDED_BY(mu_);
+    NodeList main_ ABSL_GUARDED_BY(mu_);
+    uint64_t small_bytes_ ABSL_GUARDED_BY(mu_){0};
+    uint64_t main_bytes_ ABSL_GUARDED_BY(mu_){0};
+    std::deque<size_t> ghost_fifo_ ABSL_GUARDED_BY(mu_);
+    absl::flat_hash_map<size_t, uint32_t> ghost_ ABSL_GUARDED_BY(mu_);
+  };
+
+  Shard& shardFor(size_t hash) { return *shards_[hash % shards_.size()]; }
+
+  const uint64_t max_entry_bytes_;
+  MemoryHttpCacheStats stats_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,193 @@
+#include "source/extensions/http/cache_v2/memory_http_cache/memory_http_cache.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+namespace {
+
+constexpr uint32_t DefaultShardCount = 16;
+constexpr uint64_t InsertReadChunkSize = 512 * 1024;
+
+class MemoryHttpCacheReader : public CacheReader {
+public:
+  explicit MemoryHttpCacheReader(CacheEntrySharedPtr entry) : entry_(std::move(entry)) {}
+
+  // CacheReader
+  void getBody(Event::Dispatcher&, AdjustedByteRange range, GetBodyCallback&& cb) override {
+    cb(entry_->body(std::move(range)), EndStream::More);
+  }
+
+private:
+  const CacheEntrySharedPtr entry_;
+};
+
+// Streams the body and trailers from the source into the entry, and adds the entry to the store
+// once the whole response has been read. Deletes itself when done.
+class InsertContext {
+public:
+  static void start(std::shared_ptr<EntryStore> store, Key key, CacheEntrySharedPtr entry,
+                    std::shared_ptr<CacheProgressReceiver> progress_receiver,
+                    HttpSourcePtr source);
+
+private:
+  InsertContext(std::shared_ptr<EntryStore> store, Key key, CacheEntrySharedPtr entry,
+                std::shared_ptr<CacheProgressReceiver> progress_receiver, HttpSourcePtr source)
+      : store_(std::move(store)), key_(std::move(key)), entry_(std::move(entry)),
+        progress_receiver_(std::move(progress_receiver)), source_(std::move(source)) {}
+  void onBody(AdjustedByteRange range, Buffer::InstancePtr buffer, EndStream end_stream);
+  void onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream);
+
+  const std::shared_ptr<EntryStore> store_;
+  const Key key_;
+  const CacheEntrySharedPtr entry_;
+  const std::shared_ptr<CacheProgressReceiver> progress_receiver_;
+  const HttpSourcePtr source_;
+};
+
+void InsertContext::start(std::shared_ptr<EntryStore> store, Key key, CacheEntrySharedPtr entry,
+                          std::shared_ptr<CacheProgressReceiver> progress_receiver,
+                          HttpSourcePtr source) {
+  auto ctx = new InsertContext(std::move(store), std::move(key), std::move(entry),
+                               std::move(progress_receiver), std::move(source));
+  ctx->source_->getBody(AdjustedByteRange(0, InsertReadChunkSize), [ctx](Buffer::InstancePtr buffer,
+                                                                         EndStream end_stream) {
+    ctx->onBody(AdjustedByteRange(0, InsertReadChunkSize), std::move(buffer), end_stream);
+  });
+}
+
+void InsertContext::onBody(AdjustedByteRange range, Buffer::InstancePtr buffer,
+                           EndStream end_stream) {
+  if (end_stream == EndStream::Reset) {
+    progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset"));
+    delete this;
+    return;
+  }
+  if (buffer) {
+    ASSERT(range.length() >= buffer->length());
+    if (entry_->byteSize() + buffer->length() > store_->maxEntryBytes()) {
+      // The entry could never be added to the store, and its body would hold memory that the
+      // store does not account for.
+      store_->stats().insert_rejected_.inc();
+      progress_receiver_->onInsertFailed(
+          absl::ResourceExhaustedError("response exceeds the maximum cache entry size"));
+      delete this;
+      return;
+    }
+    range = AdjustedByteRange(range.begin(), range.begin() + buffer->length());
+    entry_->appendBody(*buffer);
+  } else if (end_stream == EndStream::More) {
+    // Neither buffer nor EndStream::End means we want trailers.
+    return source_->getTrailers([this](Http::ResponseTrailerMapPtr trailers, EndStream end_stream) {
+      onTrailers(std::move(trailers), end_stream);
+    });
+  } else {
+    range = AdjustedByteRange(0, entry_->bodySize());
+  }
+  if (end_stream == EndStream::End) {
+    store_->insert(key_, entry_);
+  }
+  progress_receiver_->onBodyInserted(std::move(range), end_stream == EndStream::End);
+  if (end_stream != EndStream::End) {
+    AdjustedByteRange next_range(range.end(), range.end() + InsertReadChunkSize);
+    return source_->getBody(next_range,
+                            [this, next_range](Buffer::InstancePtr buffer, EndStream end_stream) {
+                              onBody(next_range, std::move(buffer), end_stream);
+                            });
+  }
+  delete this;
+}
+
+void InsertContext::onTrailers(Http::ResponseTrailerMapPtr trailers, EndStream end_stream) {
+  if (end_stream == EndStream::Reset) {
+    progress_receiver_->onInsertFailed(absl::UnavailableError("upstream reset during trailers"));
+  } else {
+    entry_->setTrailers(std::move(trailers));
+    store_->insert(key_, entry_);
+    progress_receiver_->onTrailersInserted(entry_->copyTrailers());
+  }
+  delete this;
+}
+
+} // namespace
+
+std::shared_ptr<EntryStore> MemoryHttpCache::createStore(const ConfigProto& config,
+                                                         Stats::Scope& scope,
+                                                         absl::string_view stat_prefix) {
+  return std::make_shared<EntryStore>(
+      config.max_cache_size_bytes(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_individual_cache_entry_size_bytes,
+                                      std::numeric_limits<uint64_t>::max()),
+      config.shard_count() > 0 ? config.shard_count() : DefaultShardCount,
+      generateStats(scope, stat_prefix));
+}
+
+LookupResult MemoryHttpCache::lookupResult(CacheEntrySharedPtr entry) {
+  LookupResult result;
+  result.response_headers_ = entry->copyHeaders();
+  result.response_metadata_ = entry->metadata();
+  result.response_trailers_ = entry->copyTrailers();
+  result.body_length_ = entry->bodySize();
+  result.cache_reader_ = std::make_unique<MemoryHttpCacheReader>(std::move(entry));
+  return result;
+}
+
+MemoryHttpCache::MemoryHttpCache(ConfigProto config, Stats::Scope& scope)
+    : config_(std::move(config)),
+      store_(createStore(config_, scope,
+                         absl::StrCat("cache.memory.", config_.cache_name(), "."))) {}
+
+CacheInfo MemoryHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = name();
+  return cache_info;
+}
+
+void MemoryHttpCache::lookup(LookupRequest&& request, LookupCallback&& callback) {
+  CacheEntrySharedPtr entry = store_->lookup(request.key());
+  if (!entry) {
+    return callback(LookupResult{});
+  }
+  callback(lookupResult(std::move(entry)));
+}
+
+void MemoryHttpCache::evict(Event::Dispatcher&, const Key& key) { store_->erase(key); }
+
+void MemoryHttpCache::updateHeaders(Event::Dispatcher&, const Key& key,
+                                    const Http::ResponseHeaderMap& updated_headers,
+                                    const ResponseMetadata& updated_metadata) {
+  CacheEntrySharedPtr entry = store_->peek(key);
+  if (!entry) {
+    return;
+  }
+  entry->updateHeadersAndMetadata(
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers), updated_metadata);
+}
+
+void MemoryHttpCache::insert(Event::Dispatcher&, Key key, Http::ResponseHeaderMapPtr headers,
+                             ResponseMetadata metadata, HttpSourcePtr source,
+                             std::shared_ptr<CacheProgressReceiver> progress) {
+  auto entry = std::make_shared<CacheEntry>(
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*headers), std::move(metadata));
+  if (source) {
+    progress->onHeadersInserted(std::make_unique<MemoryHttpCacheReader>(entry), std::move(headers),
+                                false);
+    InsertContext::start(store_, std::move(key), std::move(entry), std::move(progress),
+                         std::move(source));
+  } else {
+    store_->insert(key, std::move(entry));
+    progress->onHeadersInserted(nullptr, std::move(headers), true);
+  }
+}
+
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
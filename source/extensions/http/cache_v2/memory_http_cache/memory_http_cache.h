@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/extensions/http/cache_v2/memory_http_cache/v3/memory_http_cache.pb.h"
+#include "envoy/stats/scope.h"
+
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/entry_store.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+
+using ConfigProto =
+    envoy::extensions::http::cache_v2::memory_http_cache::v3::MemoryHttpCacheV2Config;
+
+// An in-memory cache backend with a byte budget, suitable for use as an edge cache.
+// @see EntryStore for the sharding and eviction policy.
+class MemoryHttpCache : public HttpCache {
+public:
+  MemoryHttpCache(ConfigProto config, Stats::Scope& scope);
+
+  static absl::string_view name() { return "envoy.extensions.http.cache_v2.memory_http_cache"; }
+  // Creates the entry store described by the config, with stats named stat_prefix followed by
+  // the stat's name.
+  static std::shared_ptr<EntryStore> createStore(const ConfigProto& config, Stats::Scope& scope,
+                                                 absl::string_view stat_prefix);
+  // Returns a lookup result that serves the entry without copying its body.
+  static LookupResult lookupResult(CacheEntrySharedPtr entry);
+  const ConfigProto& config() const { return config_; }
+  MemoryHttpCacheStats& stats() { return store_->stats(); }
+
+  // HttpCache
+  CacheInfo cacheInfo() const override;
+  void lookup(LookupRequest&& request, LookupCallback&& callback) override;
+  void evict(Event::Dispatcher& dispatcher, const Key& key) override;
+  // Accesses are recorded by lookup, so there is nothing more to do here.
+  void touch(const Key&, SystemTime) override {}
+  void updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                     const Http::ResponseHeaderMap& updated_headers,
+                     const ResponseMetadata& updated_metadata) override;
+  void insert(Event::Dispatcher& dispatcher, Key key, Http::ResponseHeaderMapPtr headers,
+              ResponseMetadata metadata, HttpSourcePtr source,
+              std::shared_ptr<CacheProgressReceiver> progress) override;
+
+private:
+  const ConfigProto config_;
+  // Shared with in-progress inserts, which add their entry to the store once complete.
+  const std::shared_ptr<EntryStore> store_;
+};
+
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,131 @@
+#include <memory>
+#include <string>
+
+#include "envoy/extensions/http/cache_v2/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/extensions/http/cache_v2/tiered_http_cache/v3/tiered_http_cache.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace TieredHttpCache {
+namespace {
+
+// Returns the lower tier's cache, kept alive by the returned pointer.
+absl::StatusOr<std::shared_ptr<HttpCache>>
+getLowerTier(const ConfigProto& config,
+             const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
+             Server::Configuration::FactoryContext& context) {
+  const std::string type{
+      TypeUtil::typeUrlToDescriptorFullName(config.lower_tier().typed_config().type_url())};
+  if (type == ConfigProto().GetDescriptor()->full_name()) {
+    return absl::InvalidArgumentError("the lower tier of a tiered cache cannot be a tiered cache");
+  }
+  HttpCacheFactory* const factory =
+      Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(type);
+  if (factory == nullptr) {
+    return absl::InvalidArgumentError(
+        fmt::format("Didn't find a registered implementation for type: '{}'", type));
+  }
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config lower_config = filter_config;
+  *lower_config.mutable_typed_config() = config.lower_tier().typed_config();
+  absl::StatusOr<std::shared_ptr<CacheSessions>> sessions =
+      factory->getCache(lower_config, context);
+  RETURN_IF_NOT_OK(sessions.status());
+  // Share ownership of the lower tier's sessions, which own its cache.
+  return std::shared_ptr<HttpCache>(*sessions, &(*sessions)->cache());
+}
+
+/**
+ * A singleton that hands out one TieredHttpCache per memory tier cache_name. If given configs
+ * with the same cache_name but different configuration, or different cache_names over the same
+ * lower tier cache, an error status is returned.
+ */
+class CacheSingleton : public Envoy::Singleton::Instance {
+public:
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  get(const ConfigProto& config,
+      const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
+      Server::Configuration::FactoryContext& context) {
+    std::shared_ptr<CacheSessions> cache;
+    absl::MutexLock lock(&mu_);
+    const std::string& cache_name = config.memory_tier().cache_name();
+    auto it = caches_.find(cache_name);
+    if (it != caches_.end()) {
+      cache = it->second.lock();
+    }
+    if (!cache) {
+      absl::StatusOr<std::shared_ptr<HttpCache>> lower_tier =
+          getLowerTier(config, filter_config, context);
+      RETURN_IF_NOT_OK(lower_tier.status());
+      // Each memory tier must see all inserts and evictions of its lower tier, which it wouldn't
+      // if another tiered cache shared the lower tier.
+      for (const auto& [other_name, other] : caches_) {
+        std::shared_ptr<CacheSessions> other_cache = other.lock();
+        if (other_cache != nullptr &&
+            &static_cast<TieredHttpCache&>(other_cache->cache()).lowerTier() ==
+                lower_tier->get()) {
+          return absl::InvalidArgumentError(
+              fmt::format("tiered caches '{}' and '{}' cannot share a lower tier cache",
+                          cache_name, other_name));
+        }
+      }
+      // The cache may outlive the listener that created it, so its stats live in the server scope.
+      cache = CacheSessions::create(
+          context, std::make_unique<TieredHttpCache>(config, *std::move(lower_tier),
+                                                     context.serverFactoryContext().serverScope()));
+      caches_[cache_name] = cache;
+    } else {
+      TieredHttpCache& tiered_cache = static_cast<TieredHttpCache&>(cache->cache());
+      if (!Protobuf::util::MessageDifferencer::Equals(tiered_cache.config(), config)) {
+        return absl::InvalidArgumentError(
+            fmt::format("mismatched TieredHttpCacheV2Config with same cache_name\n{}\nvs.\n{}",
+                        tiered_cache.config().DebugString(), config.DebugString()));
+      }
+    }
+    return cache;
+  }
+
+private:
+  absl::Mutex mu_;
+  // Caches are destroyed once no filter config refers to them any more.
+  absl::flat_hash_map<std::string, std::weak_ptr<CacheSessions>> caches_ ABSL_GUARDED_BY(mu_);
+};
+
+SINGLETON_MANAGER_REGISTRATION(tiered_http_cache_v2_singleton);
+
+class TieredHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string{TieredHttpCache::name()}; }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<ConfigProto>();
+  }
+  // From HttpCacheFactory
+  absl::StatusOr<std::shared_ptr<CacheSessions>>
+  getCache(const envoy::extensions::filters::http::cache_v2::v3::CacheV2Config& filter_config,
+           Server::Configuration::FactoryContext& context) override {
+    ConfigProto config;
+    RETURN_IF_NOT_OK(MessageUtil::unpackTo(filter_config.typed_config(), config));
+    std::shared_ptr<CacheSingleton> caches =
+        context.serverFactoryContext().singletonManager().getTyped<CacheSingleton>(
+            SINGLETON_MANAGER_REGISTERED_NAME(tiered_http_cache_v2_singleton),
+            [] { return std::make_shared<CacheSingleton>(); });
+    return caches->get(config, filter_config, context);
+  }
+};
+
+static Registry::RegisterFactory<TieredHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace
+} // namespace TieredHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,253 @@
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+#include <algorithm>
+
+#include "source/common/http/header_map_impl.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/memory_http_cache.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace TieredHttpCache {
+namespace {
+
+using MemoryHttpCache::CacheEntry;
+using MemoryHttpCache::CacheEntrySharedPtr;
+
+constexpr uint32_t DefaultPromotionThreshold = 2;
+constexpr uint64_t PromotionReadChunkSize = 512 * 1024;
+
+// One sketch counter per 4KiB of memory tier, so that the sketch tracks several times more keys
+// than the memory tier can hold.
+uint32_t sketchWidth(const ConfigProto& config) {
+  return std::clamp<uint64_t>(config.memory_tier().max_cache_size_bytes() / 4096, 1024, 1 << 20);
+}
+
+// Reads a response from the lower tier into a new memory tier entry. Runs on the dispatcher of
+// the lookup that triggered it, and deletes itself when done.
+class Promotion {
+public:
+  static void start(std::shared_ptr<TieredHttpCache::State> state, Key key, uint64_t id,
+                    Event::Dispatcher& dispatcher);
+
+private:
+  Promotion(std::shared_ptr<TieredHttpCache::State> state, Key key, uint64_t id,
+            Event::Dispatcher& dispatcher)
+      : state_(std::move(state)), key_(std::move(key)), id_(id), dispatcher_(dispatcher) {}
+  void onLookup(absl::StatusOr<LookupResult>&& result);
+  void readBody();
+  void onBody(Buffer::InstancePtr buffer, EndStream end_stream);
+  void finish(bool success);
+
+  const std::shared_ptr<TieredHttpCache::State> state_;
+  const Key key_;
+  const uint64_t id_;
+  Event::Dispatcher& dispatcher_;
+  CacheReaderPtr reader_;
+  CacheEntrySharedPtr entry_;
+  uint64_t body_length_{0};
+};
+
+void Promotion::start(std::shared_ptr<TieredHttpCache::State> state, Key key, uint64_t id,
+                      Event::Dispatcher& dispatcher) {
+  auto promotion = new Promotion(std::move(state), std::move(key), id, dispatcher);
+  promotion->state_->lower_->lookup(LookupRequest(Key(promotion->key_), dispatcher),
+                                    [promotion](absl::StatusOr<LookupResult>&& result) {
+                                      promotion->onLookup(std::move(result));
+                                    });
+}
+
+void Promotion::onLookup(absl::StatusOr<LookupResult>&& result) {
+  if (!result.ok() || !result->populated()) {
+    return finish(false);
+  }
+  body_length_ = result->body_length_.value();
+  entry_ = std::make_shared<CacheEntry>(std::move(result->response_headers_),
+                                        std::move(result->response_metadata_));
+  if (result->response_trailers_) {
+    entry_->setTrailers(std::move(result->response_trailers_));
+  }
+  reader_ = std::move(result->cache_reader_);
+  if (body_length_ == 0) {
+    return finish(true);
+  }
+  if (!reader_) {
+    return finish(false);
+  }
+  readBody();
+}
+
+void Promotion::readBody() {
+  const uint64_t begin = entry_->bodySize();
+  const uint64_t end = std::min(begin + PromotionReadChunkSize, body_length_);
+  reader_->getBody(dispatcher_, AdjustedByteRange(begin, end),
+                   [this](Buffer::InstancePtr buffer, EndStream end_stream) {
+                     onBody(std::move(buffer), end_stream);
+                   });
+}
+
+void Promotion::onBody(Buffer::InstancePtr buffer, EndStream end_stream) {
+  if (end_stream == EndStream::Reset || buffer == nullptr || buffer->length() == 0) {
+    return finish(false);
+  }
+  entry_->appendBody(*buffer);
+  if (entry_->bodySize() < body_length_) {
+    return readBody();
+  }
+  finish(true);
+}
+
+void Promotion::finish(bool success) {
+  if (state_->finishPromotion(key_, id_, success ? std::move(entry_) : nullptr)) {
+    state_->stats_.promotion_.inc();
+  } else {
+    state_->stats_.promotion_failed_.inc();
+  }
+  delete this;
+}
+
+} // namespace
+
+FrequencySketch::FrequencySketch(uint32_t width) : width_(width), counters_(Depth * width, 0) {}
+
+uint8_t FrequencySketch::record(size_t hash) {
+  absl::MutexLock lock(&mu_);
+  uint8_t estimate = MaxCount;
+  for (uint32_t row = 0; row < Depth; ++row) {
+    // Each row uses a different multiplicative rehash of the key hash.
+    const uint64_t row_hash = (hash ^ (hash >> 29)) * (0x9e3779b97f4a7c15ULL + 2 * row);
+    uint8_t& counter = counters_[row * width_ + (row_hash >> 32) % width_];
+    if (counter < MaxCount) {
+      ++counter;
+    }
+    estimate = std::min(estimate, counter);
+  }
+  if (++accesses_ >= 10ULL * width_) {
+    for (uint8_t& counter : counters_) {
+      counter >>= 1;
+    }
+    accesses_ /= 2;
+  }
+  return estimate;
+}
+
+TieredHttpCache::State::State(const ConfigProto& config, std::shared_ptr<HttpCache> lower_tier,
+                              Stats::Scope& scope)
+    : memory_(MemoryHttpCache::MemoryHttpCache::createStore(
+          config.memory_tier(), scope,
+          absl::StrCat("cache.tiered.", config.memory_tier().cache_name(), ".memory."))),
+      lower_(std::move(lower_tier)),
+      promotion_threshold_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, promotion_threshold, DefaultPromotionThreshold)),
+      stats_({ALL_TIERED_HTTP_CACHE_STATS(POOL_COUNTER_PREFIX(
+          scope, absl::StrCat("cache.tiered.", config.memory_tier().cache_name(), ".")))}),
+      sketch_(sketchWidth(config)) {}
+
+uint64_t TieredHttpCache::State::shouldPromote(const Key& key, uint64_t body_length) {
+  if (sketch_.record(MessageUtil::hash(key)) < promotion_threshold_ ||
+      body_length > memory_->maxEntryBytes()) {
+    return 0;
+  }
+  absl::MutexLock lock(&mu_);
+  if (!promoting_.try_emplace(key, next_promotion_id_).second) {
+    return 0;
+  }
+  return next_promotion_id_++;
+}
+
+bool TieredHttpCache::State::finishPromotion(const Key& key, uint64_t id,
+                                             CacheEntrySharedPtr entry) {
+  // The entry is added under the lock so that a concurrent cancelPromotion either prevents it,
+  // or is followed by the caller's erase of the memory tier copy.
+  absl::MutexLock lock(&mu_);
+  auto it = promoting_.find(key);
+  if (it == promoting_.end() || it->second != id) {
+    return false;
+  }
+  promoting_.erase(it);
+  return entry != nullptr && memory_->insert(key, std::move(entry));
+}
+
+void TieredHttpCache::State::cancelPromotion(const Key& key) {
+  absl::MutexLock lock(&mu_);
+  promoting_.erase(key);
+}
+
+TieredHttpCache::TieredHttpCache(ConfigProto config, std::shared_ptr<HttpCache> lower_tier,
+                                 Stats::Scope& scope)
+    : config_(std::move(config)),
+      state_(std::make_shared<State>(config_, std::move(lower_tier), scope)) {}
+
+CacheInfo TieredHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = name();
+  return cache_info;
+}
+
+void TieredHttpCache::lookup(LookupRequest&& request, LookupCallback&& callback) {
+  if (CacheEntrySharedPtr entry = state_->memory_->lookup(request.key())) {
+    state_->stats_.memory_hit_.inc();
+    return callback(MemoryHttpCache::MemoryHttpCache::lookupResult(std::move(entry)));
+  }
+  Key key = request.key();
+  Event::Dispatcher& dispatcher = request.dispatcher();
+  // The lower tier's reader, e.g. a FileSystemHttpCache CacheFileReader, is handed to the caller
+  // as is, so serving from the lower tier stays asynchronous.
+  state_->lower_->lookup(
+      std::move(request), [state = state_, key = std::move(key), &dispatcher,
+                           callback = std::move(callback)](
+                              absl::StatusOr<LookupResult>&& result) mutable {
+        if (!result.ok() || !result->populated()) {
+          if (result.ok()) {
+            state->stats_.miss_.inc();
+          }
+          return callback(std::move(result));
+        }
+        state->stats_.lower_hit_.inc();
+        const uint64_t promotion_id = state->shouldPromote(key, result->body_length_.value());
+        callback(std::move(result));
+        if (promotion_id != 0) {
+          Promotion::start(std::move(state), std::move(key), promotion_id, dispatcher);
+        }
+      });
+}
+
+void TieredHttpCache::evict(Event::Dispatcher& dispatcher, const Key& key) {
+  state_->cancelPromotion(key);
+  state_->memory_->erase(key);
+  state_->lower_->evict(dispatcher, key);
+}
+
+void TieredHttpCache::touch(const Key& key, SystemTime timestamp) {
+  state_->lower_->touch(key, timestamp);
+}
+
+void TieredHttpCache::updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                                    const Http::ResponseHeaderMap& updated_headers,
+                                    const ResponseMetadata& updated_metadata) {
+  // A promotion in flight may have read the headers before the update.
+  state_->cancelPromotion(key);
+  if (CacheEntrySharedPtr entry = state_->memory_->peek(key)) {
+    entry->updateHeadersAndMetadata(
+        Http::createHeaderMap<Http::ResponseHeaderMapImpl>(updated_headers), updated_metadata);
+  }
+  state_->lower_->updateHeaders(dispatcher, key, updated_headers, updated_metadata);
+}
+
+void TieredHttpCache::insert(Event::Dispatcher& dispatcher, Key key,
+                             Http::ResponseHeaderMapPtr headers, ResponseMetadata metadata,
+                             HttpSourcePtr source,
+                             std::shared_ptr<CacheProgressReceiver> progress) {
+  // The new response replaces any promoted copy of an older one, or one being promoted.
+  state_->cancelPromotion(key);
+  state_->memory_->erase(key);
+  state_->lower_->insert(dispatcher, std::move(key), std::move(headers), std::move(metadata),
+                         std::move(source), std::move(progress));
+}
+
+} // namespace TieredHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "envoy/extensions/http/cache_v2/tiered_http_cache/v3/tiered_http_cache.pb.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "source/common/protobuf/utility.h"
+#include "source/extensions/filters/http/cache_v2/http_cache.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/entry_store.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace TieredHttpCache {
+
+using ConfigProto =
+    envoy::extensions::http::cache_v2::tiered_http_cache::v3::TieredHttpCacheV2Config;
+
+/**
+ * All tiered cache stats. @see stats_macros.h
+ */
+#define ALL_TIERED_HTTP_CACHE_STATS(COUNTER)                                                       \
+  COUNTER(memory_hit)                                                                              \
+  COUNTER(lower_hit)                                                                               \
+  COUNTER(miss)                                                                                    \
+  COUNTER(promotion)                                                                               \
+  COUNTER(promotion_failed)
+
+/**
+ * Struct definition for tiered cache stats. @see stats_macros.h
+ */
+struct TieredHttpCacheStats {
+  ALL_TIERED_HTTP_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * An approximate count of recent accesses per key hash: a count-min sketch of four rows of
+ * counters saturating at 15. All counters are halved once the number of recorded accesses reaches
+ * ten times the width of a row, so that keys that were popular long ago fade out.
+ */
+class FrequencySketch {
+public:
+  explicit FrequencySketch(uint32_t width);
+
+  // Records an access and returns the estimated number of recent accesses, including this one.
+  uint8_t record(size_t hash);
+
+private:
+  static constexpr uint8_t MaxCount = 15;
+  static constexpr uint32_t Depth = 4;
+
+  const uint32_t width_;
+  absl::Mutex mu_;
+  std::vector<uint8_t> counters_ ABSL_GUARDED_BY(mu_);
+  uint64_t accesses_ ABSL_GUARDED_BY(mu_){0};
+};
+
+/**
+ * A cache that keeps frequently requested responses of a lower tier cache in a bounded memory
+ * tier. Inserts go to the lower tier, which remains the authoritative copy; a response is read
+ * back from the lower tier into the memory tier, on the requesting worker's dispatcher, once the
+ * frequency sketch says it has been served from the lower tier often enough. Responses evicted
+ * from the memory tier are thereby demoted to being served by the lower tier again.
+ */
+class TieredHttpCache : public HttpCache {
+public:
+  // lower_tier must not be used by the caller for inserts or evictions while this cache exists,
+  // as the memory tier would not see them.
+  TieredHttpCache(ConfigProto config, std::shared_ptr<HttpCache> lower_tier, Stats::Scope& scope);
+
+  static absl::string_view name() { return "envoy.extensions.http.cache_v2.tiered_http_cache"; }
+  const ConfigProto& config() const { return config_; }
+  const HttpCache& lowerTier() const { return *state_->lower_; }
+  TieredHttpCacheStats& stats() { return state_->stats_; }
+  MemoryHttpCache::MemoryHttpCacheStats& memoryStats() { return state_->memory_->stats(); }
+
+  // HttpCache
+  CacheInfo cacheInfo() const override;
+  void lookup(LookupRequest&& request, LookupCallback&& callback) override;
+  void evict(Event::Dispatcher& dispatcher, const Key& key) override;
+  void touch(const Key& key, SystemTime timestamp) override;
+  void updateHeaders(Event::Dispatcher& dispatcher, const Key& key,
+                     const Http::ResponseHeaderMap& updated_headers,
+                     const ResponseMetadata& updated_metadata) override;
+  void insert(Event::Dispatcher& dispatcher, Key key, Http::ResponseHeaderMapPtr headers,
+              ResponseMetadata metadata, HttpSourcePtr source,
+              std::shared_ptr<CacheProgressReceiver> progress) override;
+
+  // State shared with in-flight lookups and promotions, which may outlive the cache.
+  struct State {
+    State(const ConfigProto& config, std::shared_ptr<HttpCache> lower_tier, Stats::Scope& scope);
+
+    // Records a lower tier hit, and returns the id of a new promotion if the response should be
+    // promoted, or 0 otherwise. At most one promotion per key is in flight at a time; the caller
+    // must call finishPromotion with a non-zero id.
+    uint64_t shouldPromote(const Key& key, uint64_t body_length);
+    // Adds entry, if set, to the memory tier unless the promotion was cancelled in the meantime.
+    // Returns whether the entry was added.
+    bool finishPromotion(const Key& key, uint64_t id, MemoryHttpCache::CacheEntrySharedPtr entry);
+    // Cancels the promotion in flight for key, if any, as the response it reads is out of date.
+    void cancelPromotion(const Key& key);
+
+    const std::shared_ptr<MemoryHttpCache::EntryStore> memory_;
+    const std::shared_ptr<HttpCache> lower_;
+    const uint32_t promotion_threshold_;
+    TieredHttpCacheStats stats_;
+    FrequencySketch sketch_;
+    absl::Mutex mu_;
+    // The ids of the promotions in flight, by key.
+    absl::flat_hash_map<Key, uint64_t, MessageUtil, MessageUtil> promoting_ ABSL_GUARDED_BY(mu_);
+    uint64_t next_promotion_id_ ABSL_GUARDED_BY(mu_){1};
+  };
+
+private:
+  const ConfigProto config_;
+  const std::shared_ptr<State> state_;
+};
+
+} // namespace TieredHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -6,6 +6,7 @@
 
 #include "source/common/network/udp_listener_impl.h"
 #include "source/common/network/utility.h"
+#include "source/common/runtime/runtime_features.h"
 
 #include "spdlog/spdlog.h"
 
@@ -21,12 +22,17 @@ ActiveUdpListenerBase::ActiveUdpListenerBase(uint32_t worker_index, uint32_t con
       udp_listener_(std::move(listener)),
       udp_stats_({ALL_UDP_LISTENER_STATS(POOL_COUNTER_PREFIX(config->listenerScope(), "udp"))}),
       udp_listener_worker_router_(config_->udpListenerConfig()->listenerWorkerRouter(
-          *listen_socket.connectionInfoProvider().localAddress())) {
+          *listen_socket.connectionInfoProvider().localAddress())),
+      batch_forwarding_(Runtime::runtimeFeatureEnabled(
+          "envoy.reloadable_features.udp_listener_batch_worker_forwarding")) {
   ASSERT(worker_index_ < concurrency_);
   udp_listener_worker_router_.registerWorkerForListener(*this);
 }
 
 ActiveUdpListenerBase::~ActiveUdpListenerBase() {
+  // Hand over anything still queued so that datagrams owned by other workers are not lost when
+  // this worker's listener goes away first.
+  flushForwardBatches();
   udp_listener_worker_router_.unregisterWorkerForListener(*this);
 }
 
@@ -42,6 +48,24 @@ void ActiveUdpListenerBase::post(Network::UdpRecvData&& data) {
       listener->get().onDataWorker(std::move(data));
     }
   });
+  udp_stats_.downstream_rx_datagram_forward_posts_.inc();
+}
+
+void ActiveUdpListenerBase::postBatch(std::vector<Network::UdpRecvData>&& data) {
+  ASSERT(!udp_listener_->dispatcher().isThreadSafe(),
+         "Shouldn't be posting if thread safe; use onWorkerData() instead.");
+
+  auto address = listen_socket_.connectionInfoProvider().localAddress();
+  udp_listener_->dispatcher().post([data = std::move(data), tag = config_->listenerTag(),
+                                    &parent = parent_, address]() mutable {
+    Network::UdpListenerCallbacksOptRef listener = parent.getUdpListenerCallbacks(tag, *address);
+    if (listener.has_value()) {
+      for (Network::UdpRecvData& datagram : data) {
+        listener->get().onDataWorker(std::move(datagram));
+      }
+    }
+  });
+  udp_stats_.downstream_rx_datagram_forward_posts_.inc();
 }
 
 void ActiveUdpListenerBase::onData(Network::UdpRecvData&& data) {
@@ -55,11 +79,44 @@ void ActiveUdpListenerBase::onData(Network::UdpRecvData&& data) {
 
   if (dest == worker_index_) {
     onDataWorker(std::move(data));
+    return;
+  }
+
+  udp_stats_.downstream_rx_datagram_forwarded_.inc();
+  if (batch_forwarding_) {
+    queueForward(dest, std::move(data));
   } else {
     udp_listener_worker_router_.deliver(dest, std::move(data));
   }
 }
 
+void ActiveUdpListenerBase::queueForward(uint32_t dest, Network::UdpRecvData&& data) {
+  if (flush_forward_batches_cb_ == nullptr) {
+    forward_batches_.resize(concurrency_);
+    flush_forward_batches_cb_ =
+        udp_listener_->dispatcher().createSchedulableCallback([this]() { flushForwardBatches(); });
+  }
+  forward_batches_[dest].push_back(std::move(data));
+  if (!flush_forward_batches_cb_->enabled()) {
+    flush_forward_batches_cb_->scheduleCallbackCurrentIteration();
+  }
+}
+
+void ActiveUdpListenerBase::flushForwardBatches() {
+  for (uint32_t dest = 0; dest < forward_batches_.size(); ++dest) {
+    std::vector<Network::UdpRecvData>& batch = forward_batches_[dest];
+    if (batch.empty()) {
+      continue;
+    }
+    if (batch.size() == 1) {
+      udp_listener_worker_router_.deliver(dest, std::move(batch.front()));
+    } else {
+      udp_listener_worker_router_.deliverBatch(dest, std::move(batch));
+    }
+    batch.clear();
+  }
+}
+
 ActiveRawUdpListener::ActiveRawUdpListener(uint32_t worker_index, uint32_t concurrency,
                                            Network::UdpConnectionHandler& parent,
                                            Network::SocketSharedPtr listen_socket_ptr,
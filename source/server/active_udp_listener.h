@@ -3,7 +3,9 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <vector>
 
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -15,7 +17,11 @@
 namespace Envoy {
 namespace Server {
 
-#define ALL_UDP_LISTENER_STATS(COUNTER) COUNTER(downstream_rx_datagram_dropped)
+#define ALL_UDP_LISTENER_STATS(COUNTER)                                                            \
+  COUNTER(downstream_rx_datagram_dropped)                                                          \
+  COUNTER(downstream_rx_datagram_forwarded)                                                        \
+  COUNTER(downstream_rx_datagram_forward_posts)                                                    \
+  COUNTER(downstream_rx_datagram_steering_mismatch)
 
 /**
  * Wrapper struct for UDP listener stats. @see stats_macros.h
@@ -36,6 +42,7 @@ public:
   void onData(Network::UdpRecvData&& data) final;
   uint32_t workerIndex() const final { return worker_index_; }
   void post(Network::UdpRecvData&& data) final;
+  void postBatch(std::vector<Network::UdpRecvData>&& data) final;
   void onDatagramsDropped(uint32_t dropped) final {
     udp_stats_.downstream_rx_datagram_dropped_.add(dropped);
   }
@@ -56,6 +63,17 @@ protected:
   Network::UdpListenerPtr udp_listener_;
   UdpListenerStats udp_stats_;
   Network::UdpListenerWorkerRouter& udp_listener_worker_router_;
+
+private:
+  // Queues a datagram that belongs to another worker. All datagrams queued for the same worker
+  // during one event loop iteration are handed over with a single cross-thread post.
+  void queueForward(uint32_t dest, Network::UdpRecvData&& data);
+  void flushForwardBatches();
+
+  const bool batch_forwarding_;
+  // Indexed by destination worker; only allocated once the first datagram is forwarded.
+  std::vector<std::vector<Network::UdpRecvData>> forward_batches_;
+  Event::SchedulableCallbackPtr flush_forward_batches_cb_;
 };
 
 /**
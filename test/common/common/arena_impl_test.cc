@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "source/common/common/arena_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+// Records its destruction order into a shared vector.
+class Tracked {
+public:
+  Tracked(std::vector<int>& destroyed, int id) : destroyed_(destroyed), id_(id) {}
+  ~Tracked() { destroyed_.push_back(id_); }
+
+private:
+  std::vector<int>& destroyed_;
+  const int id_;
+};
+
+TEST(ArenaImplTest, NoAllocationUntilUsed) {
+  ArenaImpl arena;
+  EXPECT_EQ(0, arena.blockCount());
+  EXPECT_EQ(0, arena.bytesReserved());
+  EXPECT_EQ(0, arena.bytesAllocated());
+}
+
+TEST(ArenaImplTest, BumpsWithinBlock) {
+  ArenaImpl arena(256);
+  char* first = static_cast<char*>(arena.allocate(16, 8));
+  char* second = static_cast<char*>(arena.allocate(16, 8));
+  EXPECT_EQ(first + 16, second);
+  EXPECT_EQ(1, arena.blockCount());
+  EXPECT_EQ(32, arena.bytesAllocated());
+}
+
+TEST(ArenaImplTest, Alignment) {
+  ArenaImpl arena(256);
+  arena.allocate(1, 1);
+  for (size_t alignment : {2, 4, 8, 16, 64, 256}) {
+    void* p = arena.allocate(3, alignment);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % alignment) << alignment;
+  }
+}
+
+TEST(ArenaImplTest, ZeroSizeAllocationIsNotNull) {
+  ArenaImpl arena;
+  EXPECT_NE(nullptr, arena.allocate(0, 1));
+}
+
+TEST(ArenaImplTest, GrowsBlocksGeometrically) {
+  ArenaImpl arena(64);
+  arena.allocate(64, 1);
+  EXPECT_EQ(1, arena.blockCount());
+  // The second block is 128 bytes and fits both of these.
+  arena.allocate(64, 1);
+  arena.allocate(64, 1);
+  EXPECT_EQ(2, arena.blockCount());
+  arena.allocate(1, 1);
+  EXPECT_EQ(3, arena.blockCount());
+}
+
+TEST(ArenaImplTest, LargeAllocationKeepsCurrentBlock) {
+  ArenaImpl arena(128);
+  char* first = static_cast<char*>(arena.allocate(8, 8));
+  void* large = arena.allocate(4096, 8);
+  EXPECT_NE(nullptr, large);
+  EXPECT_EQ(2, arena.blockCount());
+  // Small allocations continue in the original block.
+  char* second = static_cast<char*>(arena.allocate(8, 8));
+  EXPECT_EQ(first + 8, second);
+  EXPECT_EQ(2, arena.blockCount());
+}
+
+TEST(ArenaImplTest, CreateRunsDestructorsInReverseOrder) {
+  std::vector<int> destroyed;
+  {
+    ArenaImpl arena(64);
+    for (int i = 0; i < 10; ++i) {
+      arena.create<Tracked>(destroyed, i);
+    }
+    EXPECT_TRUE(destroyed.empty());
+  }
+  EXPECT_EQ((std::vector<int>{9, 8, 7, 6, 5, 4, 3, 2, 1, 0}), destroyed);
+}
+
+TEST(ArenaImplTest, CreateNonTrivialMember) {
+  ArenaImpl arena;
+  std::string* value = arena.create<std::string>(1000, 'a');
+  EXPECT_EQ(1000, value->size());
+}
+
+TEST(ArenaImplTest, TriviallyDestructibleTypesDoNotRegisterCleanup) {
+  ArenaImpl arena;
+  arena.create<uint64_t>(42);
+  const uint64_t reserved = arena.bytesReserved();
+  const uint64_t allocated = arena.bytesAllocated();
+  EXPECT_EQ(sizeof(uint64_t), allocated);
+  EXPECT_EQ(reserved, arena.bytesReserved());
+}
+
+TEST(ArenaImplTest, MakeUniqueDestroysOnReset) {
+  std::vector<int> destroyed;
+  ArenaImpl arena;
+  Arena::UniquePtr<Tracked> tracked = arena.makeUnique<Tracked>(destroyed, 1);
+  EXPECT_TRUE(destroyed.empty());
+  tracked.reset();
+  EXPECT_EQ(std::vector<int>{1}, destroyed);
+}
+
+} // namespace
+} // namespace Envoy
@@ -757,6 +757,44 @@ TEST_F(FilterManagerTest, IdleTimerResets) {
   filter_1->decoder_callbacks_->encodeTrailers(std::move(basic_resp_trailers));
   filter_manager_->destroyFilters();
 }
+
+// Verifies that filters share the per-stream arena and that arena owned objects are destroyed
+// together with the filter manager, after the filters themselves.
+TEST_F(FilterManagerTest, StreamArena) {
+  initialize();
+
+  auto filter_1 = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  auto filter_2 = std::make_shared<NiceMock<MockStreamDecoderFilter>>();
+  EXPECT_CALL(filter_factory_, createFilterChain(_))
+      .WillOnce(Invoke([&](FilterChainManager& manager) -> bool {
+        auto factory_1 = createDecoderFilterFactoryCb(filter_1);
+        manager.applyFilterFactoryCb({}, factory_1);
+        auto factory_2 = createDecoderFilterFactoryCb(filter_2);
+        manager.applyFilterFactoryCb({}, factory_2);
+        return true;
+      }));
+  filter_manager_->createDownstreamFilterChain();
+
+  Arena& arena = filter_1->callbacks_->streamArena();
+  EXPECT_EQ(&arena, &filter_2->callbacks_->streamArena());
+  EXPECT_EQ(&arena, &filter_manager_->arena());
+  // The filter wrappers themselves live in the arena.
+  EXPECT_GT(filter_manager_->arena().bytesAllocated(), 0);
+
+  bool destroyed = false;
+  struct Object {
+    explicit Object(bool& destroyed) : destroyed_(destroyed) {}
+    ~Object() { destroyed_ = true; }
+    bool& destroyed_;
+  };
+  arena.create<Object>(destroyed);
+
+  filter_manager_->destroyFilters();
+  EXPECT_FALSE(destroyed);
+  filter_manager_.reset();
+  EXPECT_TRUE(destroyed);
+}
+
 } // namespace
 } // namespace Http
 } // namespace Envoy
@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "source/common/http/header_map_impl.h"
 #include "source/common/http/headers.h"
 
@@ -210,6 +212,28 @@ static void headerMapImplPopulate(benchmark::State& state) {
 }
 BENCHMARK(headerMapImplPopulate);
 
+/**
+ * Measure the speed of creating a HeaderMapImpl, populating it with a number of custom
+ * headers and tearing it down. The numeric Arg passed by the BENCHMARK(...) macro call below
+ * indicates how many headers this test will add. Run with
+ * --runtime_feature envoy.restart_features.header_map_node_pool:true to compare against
+ * slab-allocated header entries.
+ */
+static void headerMapImplCreatePopulateDestroy(benchmark::State& state) {
+  std::vector<LowerCaseString> keys;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    keys.emplace_back("x-custom-header-" + std::to_string(i));
+  }
+  for (auto _ : state) { // NOLINT
+    auto headers = Http::RequestHeaderMapImpl::create();
+    for (const auto& key : keys) {
+      headers->addReference(key, "value");
+    }
+    benchmark::DoNotOptimize(headers->size());
+  }
+}
+BENCHMARK(headerMapImplCreatePopulateDestroy)->Arg(1)->Arg(5)->Arg(10)->Arg(50);
+
 /**
  * Measure the speed of encoding headers as part of upgraded requests (HTTP/1 to HTTP/2)
  * @note The measured time for each iteration includes the time needed to add
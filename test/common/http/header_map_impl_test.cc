@@ -66,6 +66,14 @@ TEST(HeaderStringTest, All) {
   }
 }
 
+// The node pool test target enables the pool through a runtime override which the test runner
+// applies as each test starts. No header map may be created before that, or the latch would miss
+// the override and the pooled path would not be covered.
+TEST(HeaderMapImplTest, NodePoolingLatchesRuntimeFeature) {
+  EXPECT_EQ(Runtime::runtimeFeatureEnabled("envoy.restart_features.header_map_node_pool"),
+            HeaderMapImpl::nodePoolingEnabled());
+}
+
 Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::RequestHeaders>
     custom_header_1(Http::LowerCaseString{"foo_custom_header"});
 Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::RequestHeaders>
@@ -0,0 +1,171 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Measures the server side cost of answering a burst of concurrent gRPC-like requests on a single
+// HTTP/2 connection, with and without coalescing of the frames produced in one send pass into a
+// single connection write.
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "source/common/http/http2/codec_impl.h"
+#include "source/common/http/utility.h"
+
+#include "test/common/http/http2/codec_impl_test_util.h"
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+// Answers each request with headers, one DATA frame and trailers as soon as the request headers
+// are decoded, so that all responses of a burst are produced while the server codec dispatches.
+class RespondingDecoder : public RequestDecoder {
+public:
+  RespondingDecoder(ResponseEncoder& encoder, const std::string& body)
+      : encoder_(encoder), body_(body) {}
+
+  // Http::RequestDecoder
+  void decodeHeaders(RequestHeaderMapSharedPtr&&, bool) override {
+    TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-type", "application/grpc"}};
+    encoder_.encodeHeaders(headers, false);
+    Buffer::OwnedImpl data(body_);
+    encoder_.encodeData(data, false);
+    TestResponseTrailerMapImpl trailers{{"grpc-status", "0"}};
+    encoder_.encodeTrailers(trailers);
+  }
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeMetadata(MetadataMapPtr&&) override {}
+  void decodeTrailers(RequestTrailerMapPtr&&) override {}
+  void sendLocalReply(Code, absl::string_view, const std::function<void(ResponseHeaderMap&)>&,
+                      const absl::optional<Grpc::Status::GrpcStatus>, absl::string_view) override {}
+  StreamInfo::StreamInfo& streamInfo() override { PANIC("not implemented"); }
+  AccessLog::InstanceSharedPtrVector accessLogHandlers() override { return {}; }
+  RequestDecoderHandlePtr getRequestDecoderHandle() override {
+    return std::make_unique<Handle>(*this);
+  }
+
+private:
+  class Handle : public RequestDecoderHandle {
+  public:
+    explicit Handle(RequestDecoder& decoder) : decoder_(decoder) {}
+    OptRef<RequestDecoder> get() override { return decoder_; }
+
+  private:
+    RequestDecoder& decoder_;
+  };
+
+  ResponseEncoder& encoder_;
+  const std::string& body_;
+};
+
+class MultiplexedStreamsSpeedTest {
+public:
+  explicit MultiplexedStreamsSpeedTest(bool coalesce_writes) {
+    scoped_runtime_.mergeValues({{"envoy.reloadable_features.http2_coalesce_writes",
+                                  coalesce_writes ? "true" : "false"}});
+    options_ = ::Envoy::Http2::Utility::initializeAndValidateOptions(options_).value();
+
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) { to_server_.move(data); }));
+    ON_CALL(server_connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) {
+          ++server_writes_;
+          to_client_.move(data);
+        }));
+    ON_CALL(server_callbacks_, newStream(_, _))
+        .WillByDefault(Invoke([this](ResponseEncoder& encoder, bool) -> RequestDecoder& {
+          return decoders_.emplace_back(encoder, body_);
+        }));
+
+    client_ = std::make_unique<TestClientConnectionImpl>(
+        client_connection_, client_callbacks_, *client_stats_store_.rootScope(), options_,
+        random_, Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        ProdNghttp2SessionFactory::get());
+    server_ = std::make_unique<TestServerConnectionImpl>(
+        server_connection_, server_callbacks_, *server_stats_store_.rootScope(), options_, random_,
+        Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+        envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+  }
+
+  // Opens `streams` concurrent requests and drives both codecs until all responses are received.
+  void runBurst(uint32_t streams) {
+    for (uint32_t i = 0; i < streams; ++i) {
+      RequestEncoder& encoder = client_->newStream(response_decoder_);
+      TestRequestHeaderMapImpl headers{{":method", "POST"},
+                                       {":path", "/service/Method"},
+                                       {":scheme", "http"},
+                                       {":authority", "host"},
+                                       {"content-type", "application/grpc"}};
+      encoder.encodeHeaders(headers, true).IgnoreError();
+    }
+    while (to_server_.length() > 0 || to_client_.length() > 0) {
+      if (to_server_.length() > 0) {
+        server_->dispatch(to_server_).IgnoreError();
+      }
+      if (to_client_.length() > 0) {
+        client_->dispatch(to_client_).IgnoreError();
+      }
+    }
+    client_connection_.dispatcher_.clearDeferredDeleteList();
+    server_connection_.dispatcher_.clearDeferredDeleteList();
+    decoders_.clear();
+  }
+
+  uint64_t serverWrites() const { return server_writes_; }
+
+private:
+  TestScopedRuntime scoped_runtime_;
+  envoy::config::core::v3::Http2ProtocolOptions options_;
+  Stats::TestUtil::TestStore client_stats_store_;
+  Stats::TestUtil::TestStore server_stats_store_;
+  NiceMock<Random::MockRandomGenerator> random_;
+  NiceMock<Network::MockConnection> client_connection_;
+  NiceMock<Network::MockConnection> server_connection_;
+  NiceMock<MockConnectionCallbacks> client_callbacks_;
+  NiceMock<MockServerConnectionCallbacks> server_callbacks_;
+  NiceMock<MockResponseDecoder> response_decoder_;
+  const std::string body_ = std::string(256, 'a');
+  std::list<RespondingDecoder> decoders_;
+  Buffer::OwnedImpl to_server_;
+  Buffer::OwnedImpl to_client_;
+  uint64_t server_writes_{};
+  std::unique_ptr<TestClientConnectionImpl> client_;
+  std::unique_ptr<TestServerConnectionImpl> server_;
+};
+
+// The first argument is the number of concurrent streams per burst. The second selects write
+// coalescing.
+static void http2MultiplexedStreams(benchmark::State& state) {
+  const uint32_t streams = state.range(0);
+  MultiplexedStreamsSpeedTest test(state.range(1) != 0);
+  // Exchange the connection preface and SETTINGS outside of the measured loop.
+  test.runBurst(1);
+  const uint64_t writes_before = test.serverWrites();
+  for (auto _ : state) { // NOLINT
+    test.runBurst(streams);
+  }
+  state.counters["server_writes_per_burst"] = benchmark::Counter(
+      test.serverWrites() - writes_before, benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * streams);
+}
+BENCHMARK(http2MultiplexedStreams)
+    ->ArgsProduct({{1, 16, 128}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
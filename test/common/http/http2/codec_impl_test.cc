@@ -3164,6 +3164,70 @@ TEST_P(Http2CodecImplTest, PingFlood) {
   EXPECT_EQ(1, server_stats_store_.counter("http2.outbound_control_flood").value());
 }
 
+// Verify that with write coalescing all PING ACKs produced by one dispatch are written to the
+// connection at once, and that the outbound frames are still released as the buffer drains.
+TEST_P(Http2CodecImplTest, CoalescedWritesPingAcks) {
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.http2_coalesce_writes", "true"}});
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  EXPECT_TRUE(request_encoder_->encodeHeaders(request_headers, false).ok());
+  driveToCompletion();
+
+  constexpr uint32_t kPings = 10;
+  for (uint32_t i = 0; i < kPings; ++i) {
+    submitPing(client_, i);
+  }
+
+  Buffer::OwnedImpl buffer;
+  EXPECT_CALL(server_connection_, write(_, _))
+      .WillOnce(Invoke([&buffer](Buffer::Instance& data, bool) { buffer.move(data); }));
+  driveToCompletion();
+
+  // PING frames are 17 bytes each.
+  EXPECT_EQ(kPings * 17, buffer.length());
+  EXPECT_EQ(kPings, TestUtility::findGauge(server_stats_store_,
+                                           "http2.outbound_control_frames_active")
+                        ->value());
+  buffer.drain(buffer.length());
+  EXPECT_EQ(0, TestUtility::findGauge(server_stats_store_, "http2.outbound_control_frames_active")
+                   ->value());
+}
+
+// Verify that PING flood is detected when the ACKs are coalesced into a single write.
+TEST_P(Http2CodecImplTest, CoalescedWritesPingFlood) {
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.http2_coalesce_writes", "true"}});
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+  EXPECT_TRUE(request_encoder_->encodeHeaders(request_headers, false).ok());
+  driveToCompletion();
+
+  // Send one frame above the outbound control queue size limit
+  for (uint32_t i = 0; i < CommonUtility::OptionsLimits::DEFAULT_MAX_OUTBOUND_CONTROL_FRAMES + 1;
+       ++i) {
+    submitPing(client_, i);
+  }
+
+  int write_count = 0;
+  Buffer::OwnedImpl buffer;
+  ON_CALL(server_connection_, write(_, _))
+      .WillByDefault(Invoke([&buffer, &write_count](Buffer::Instance& data, bool) {
+        ++write_count;
+        buffer.move(data);
+      }));
+
+  driveToCompletion();
+  EXPECT_EQ(1, write_count);
+  EXPECT_FALSE(server_wrapper_->status_.ok());
+  EXPECT_TRUE(isBufferFloodError(server_wrapper_->status_));
+  EXPECT_EQ(1, server_stats_store_.counter("http2.outbound_control_flood").value());
+}
+
 // Verify that codec allows PING flood when mitigation is disabled
 TEST_P(Http2CodecImplTest, PingFloodMitigationDisabled) {
   max_outbound_control_frames_ = 2147483647;
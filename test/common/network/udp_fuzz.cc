@@ -43,6 +43,7 @@ public:
   void onReceiveError(Api::IoError::IoErrorCode error_code) override;
   void onDataWorker(Network::UdpRecvData&& data) override;
   void post(Network::UdpRecvData&& data) override;
+  void postBatch(std::vector<Network::UdpRecvData>&& data) override;
   void onDatagramsDropped(uint32_t dropped) override;
   uint32_t workerIndex() const override;
   Network::UdpPacketWriter& udpPacketWriter() override;
@@ -176,6 +177,10 @@ void FuzzUdpListenerCallbacks::onDataWorker(Network::UdpRecvData&& data) {
 }
 void FuzzUdpListenerCallbacks::post(Network::UdpRecvData&& data) { UNREFERENCED_PARAMETER(data); }
 
+void FuzzUdpListenerCallbacks::postBatch(std::vector<Network::UdpRecvData>&& data) {
+  UNREFERENCED_PARAMETER(data);
+}
+
 void FuzzUdpListenerCallbacks::onDatagramsDropped(uint32_t dropped) {
   my_upf_->sent_packets_++;
   if (my_upf_->sent_packets_ == my_upf_->total_packets_) {
@@ -167,6 +167,42 @@ TEST_P(UdpListenerImplBatchWriterTest, SendData) {
             total_bytes_sent);
 }
 
+/**
+ * Tests that flush requests are ignored while the writer is in deferred flush mode, and that the
+ * buffered packets are sent by the first flush after leaving it.
+ */
+TEST_P(UdpListenerImplBatchWriterTest, DeferredFlush) {
+  auto& gso_writer = dynamic_cast<Quic::UdpGsoBatchWriter&>(*udp_packet_writer_);
+  Address::InstanceConstSharedPtr send_from_addr = getNonDefaultSourceAddress();
+  const uint64_t total_bytes_sent =
+      listener_config_.listenerScope().counterFromString("total_bytes_sent").value();
+
+  gso_writer.setFlushDeferred(true);
+  const std::string payload("length7");
+  for (int i = 0; i < 3; ++i) {
+    Buffer::OwnedImpl buffer(payload);
+    UdpSendData send_data{send_from_addr->ip(), *client_.localAddress(), buffer};
+    EXPECT_TRUE(listener_->send(send_data).ok());
+    EXPECT_TRUE(udp_packet_writer_->flush().ok());
+  }
+  EXPECT_EQ(3, listener_config_.listenerScope().counterFromString("flushes_deferred").value());
+  EXPECT_EQ(total_bytes_sent,
+            listener_config_.listenerScope().counterFromString("total_bytes_sent").value());
+  EXPECT_EQ(listener_config_.listenerScope()
+                .gaugeFromString("internal_buffer_size", Stats::Gauge::ImportMode::NeverImport)
+                .value(),
+            3 * payload.length());
+
+  gso_writer.setFlushDeferred(false);
+  EXPECT_TRUE(udp_packet_writer_->flush().ok());
+  EXPECT_EQ(total_bytes_sent + 3 * payload.length(),
+            listener_config_.listenerScope().counterFromString("total_bytes_sent").value());
+  EXPECT_EQ(listener_config_.listenerScope()
+                .gaugeFromString("internal_buffer_size", Stats::Gauge::ImportMode::NeverImport)
+                .value(),
+            0);
+}
+
 /**
  * Tests UDP Packet writer behavior when socket is write-blocked.
  * 1. Setup the udp_listener and have a payload buffered in the internal buffer.
@@ -456,6 +456,25 @@ TEST_P(ActiveQuicListenerTest, ReceiveCHLO) {
   readFromClientSockets();
 }
 
+TEST_P(ActiveQuicListenerTest, ReceiveCHLOWithWriteBatching) {
+  scoped_runtime_.mergeValues({{"envoy.reloadable_features.quic_listener_write_batching", "true"}});
+  initialize();
+  maybeConfigureMocks(/* connection_count = */ 1);
+  quic::QuicConnectionId connection_id = quic::test::TestConnectionId(1);
+  sendCHLO(connection_id);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+  EXPECT_NE(0u, quic_dispatcher_->NumSessions());
+#if UDP_GSO_BATCH_WRITER_COMPILETIME_SUPPORT
+  // The session's flush of the handshake response was absorbed into the listener batch, which was
+  // sent at the end of the event loop iteration.
+  EXPECT_LT(0u, listener_config_.listenerScope().counterFromString("flushes_deferred").value());
+  EXPECT_EQ(0u, listener_config_.listenerScope()
+                    .gaugeFromString("internal_buffer_size", Stats::Gauge::ImportMode::NeverImport)
+                    .value());
+#endif
+  readFromClientSockets();
+}
+
 class MockNonDispatchedUdpPacketHandler : public Network::NonDispatchedUdpPacketHandler {
 public:
   MOCK_METHOD(void, handle, (uint32_t worker_index, const Network::UdpRecvData& packet));
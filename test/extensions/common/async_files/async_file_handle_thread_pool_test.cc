@@ -1,3 +1,5 @@
+#include <sys/mman.h>
+
 #include <future>
 #include <memory>
 #include <string>
@@ -344,6 +346,45 @@ TEST_F(AsyncFileHandleTest, DuplicateCreatesIndependentHandle) {
   close(dup_file);
 }
 
+TEST_F(AsyncFileHandleTest, MmapMapsRangeOfFile) {
+  auto handle = createAnonymousFile();
+  absl::StatusOr<size_t> write_status;
+  Buffer::OwnedImpl buf("hello world");
+  EXPECT_OK(handle->write(dispatcher_.get(), buf, 0, [&](absl::StatusOr<size_t> result) {
+    write_status = std::move(result);
+  }));
+  resolveFileActions();
+  EXPECT_THAT(write_status, IsOkAndHolds(11U));
+  absl::StatusOr<MappedFileRegionSharedPtr> mmap_status;
+  EXPECT_OK(handle->mmap(dispatcher_.get(), 6, 5,
+                         [&](absl::StatusOr<MappedFileRegionSharedPtr> result) {
+                           mmap_status = std::move(result);
+                         }));
+  resolveFileActions();
+  ASSERT_OK(mmap_status);
+  close(handle);
+  // The mapping outlives the file handle.
+  EXPECT_EQ("world", mmap_status.value()->contents());
+}
+
+TEST_F(AsyncFileHandleTest, MmapBeyondEndOfFileReturnsError) {
+  auto handle = createAnonymousFile();
+  absl::StatusOr<size_t> write_status;
+  Buffer::OwnedImpl buf("hello");
+  EXPECT_OK(handle->write(dispatcher_.get(), buf, 0, [&](absl::StatusOr<size_t> result) {
+    write_status = std::move(result);
+  }));
+  resolveFileActions();
+  absl::StatusOr<MappedFileRegionSharedPtr> mmap_status;
+  EXPECT_OK(handle->mmap(dispatcher_.get(), 2, 5,
+                         [&](absl::StatusOr<MappedFileRegionSharedPtr> result) {
+                           mmap_status = std::move(result);
+                         }));
+  resolveFileActions();
+  EXPECT_THAT(mmap_status, StatusIs(absl::StatusCode::kOutOfRange));
+  close(handle);
+}
+
 TEST_F(AsyncFileHandleWithMockPosixTest, PartialReadReturnsPartialResult) {
   auto handle = createAnonymousFile();
   EXPECT_CALL(mock_posix_file_operations_, pread(_, _, _, _))
@@ -493,6 +534,24 @@ TEST_F(AsyncFileHandleWithMockPosixTest, StatFailureReportsError) {
   close(handle);
 }
 
+TEST_F(AsyncFileHandleWithMockPosixTest, MmapFailureReportsError) {
+  auto handle = createAnonymousFile();
+  EXPECT_CALL(mock_posix_file_operations_, fstat(_, _)).WillOnce([](int, struct stat* buffer) {
+    buffer->st_size = 100;
+    return Api::SysCallIntResult{0, 0};
+  });
+  EXPECT_CALL(mock_posix_file_operations_, mmap(_, _, _, _, _, _))
+      .WillOnce(Return(Api::SysCallPtrResult{MAP_FAILED, ENOMEM}));
+  absl::StatusOr<MappedFileRegionSharedPtr> mmap_status;
+  EXPECT_OK(handle->mmap(dispatcher_.get(), 0, 100,
+                         [&](absl::StatusOr<MappedFileRegionSharedPtr> result) {
+                           mmap_status = std::move(result);
+                         }));
+  resolveFileActions();
+  EXPECT_FALSE(mmap_status.ok());
+  close(handle);
+}
+
 TEST_F(AsyncFileHandleWithMockPosixTest, CloseFailureReportsError) {
   auto handle = createAnonymousFile();
   EXPECT_CALL(mock_posix_file_operations_, close(1))
@@ -47,6 +47,14 @@ MockAsyncFileContext::MockAsyncFileContext(std::shared_ptr<MockAsyncFileManager>
                                  std::unique_ptr<MockAsyncFileAction>(
                                      new TypedMockAsyncFileAction(std::move(on_complete))));
       });
+  ON_CALL(*this, mmap(_, _, _, _))
+      .WillByDefault(
+          [this](Event::Dispatcher* dispatcher, off_t, size_t,
+                 absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete) {
+            return manager_->enqueue(dispatcher,
+                                     std::unique_ptr<MockAsyncFileAction>(
+                                         new TypedMockAsyncFileAction(std::move(on_complete))));
+          });
   ON_CALL(*this, duplicate(_, _))
       .WillByDefault(
           [this](Event::Dispatcher* dispatcher,
@@ -39,6 +39,9 @@ public:
   MOCK_METHOD(absl::StatusOr<CancelFunction>, write,
               (Event::Dispatcher * dispatcher, Buffer::Instance& contents, off_t offset,
                absl::AnyInvocable<void(absl::StatusOr<size_t>)> on_complete));
+  MOCK_METHOD(absl::StatusOr<CancelFunction>, mmap,
+              (Event::Dispatcher * dispatcher, off_t offset, size_t length,
+               absl::AnyInvocable<void(absl::StatusOr<MappedFileRegionSharedPtr>)> on_complete));
   MOCK_METHOD(
       absl::StatusOr<CancelFunction>, duplicate,
       (Event::Dispatcher * dispatcher,
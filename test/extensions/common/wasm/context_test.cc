@@ -317,6 +317,23 @@ TEST_F(ContextTest, ClearRouteCacheDoesNothingInUpstreamConfiguration) {
   test_ctx.removeHeaderMapValue(WasmHeaderMapType::RequestHeaders, "key");
 }
 
+TEST_F(ContextTest, SetHeaderMapPairsReplacesAllHeaders) {
+  TestContext test_ctx;
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":path", "/123"}, {"key", "value1"}, {"key", "value2"}, {"other", "value"}};
+  test_ctx.setRequestHeaders(&request_headers);
+
+  EXPECT_EQ(WasmResult::Ok,
+            test_ctx.setHeaderMapPairs(WasmHeaderMapType::RequestHeaders,
+                                       Pairs{{":path", "/456"}, {"Key", "a"}, {"key", "b"}}));
+  EXPECT_EQ((Http::TestRequestHeaderMapImpl{{":path", "/456"}, {"key", "a"}, {"key", "b"}}),
+            request_headers);
+
+  Pairs pairs;
+  EXPECT_EQ(WasmResult::Ok, test_ctx.getHeaderMapPairs(WasmHeaderMapType::RequestHeaders, &pairs));
+  EXPECT_EQ((Pairs{{":path", "/456"}, {"key", "a"}, {"key", "b"}}), pairs);
+}
+
 } // namespace Wasm
 } // namespace Common
 } // namespace Extensions
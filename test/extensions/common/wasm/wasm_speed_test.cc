@@ -1,5 +1,6 @@
 #include "source/common/common/thread.h"
 #include "source/common/common/thread_synchronizer.h"
+#include "source/extensions/common/wasm/context.h"
 #include "source/extensions/common/wasm/wasm.h"
 
 #include "test/mocks/server/mocks.h"
@@ -63,6 +64,56 @@ void bmWasmSpeedTest(benchmark::State& state) {
 
 BENCHMARK(bmWasmSpeedTest);
 
+namespace {
+
+// A context processing a request, without a plugin.
+class RequestContext : public Envoy::Extensions::Common::Wasm::Context {
+public:
+  explicit RequestContext(Envoy::Http::RequestHeaderMap& request_headers) {
+    request_headers_ = &request_headers;
+  }
+};
+
+} // namespace
+
+// Measures the per-request overhead of the header map host calls that a plugin typically makes.
+void bmWasmHeaderMapCalls(benchmark::State& state) {
+  using Envoy::Extensions::Common::Wasm::WasmHeaderMapType;
+  const std::vector<std::pair<std::string, std::string>> rewritten{
+      {":method", "GET"},
+      {":path", "/api/v2/users"},
+      {":authority", "example.com"},
+      {"x-request-id", "0af7651916cd43dd8448eb211c80319c"},
+      {"x-tenant", "b"}};
+  Envoy::Extensions::Common::Wasm::Pairs rewritten_pairs;
+  for (const auto& [key, value] : rewritten) {
+    rewritten_pairs.emplace_back(key, value);
+  }
+
+  for (__attribute__((unused)) auto _ : state) {
+    Envoy::Http::TestRequestHeaderMapImpl headers{
+        {":method", "GET"},
+        {":path", "/api/users"},
+        {":authority", "example.com"},
+        {"user-agent", "curl/8.0"},
+        {"accept", "*/*"},
+        {"x-request-id", "0af7651916cd43dd8448eb211c80319c"},
+        {"x-tenant", "a"}};
+    RequestContext context(headers);
+    Envoy::Extensions::Common::Wasm::Pairs pairs;
+    std::string_view value;
+    context.getHeaderMapPairs(WasmHeaderMapType::RequestHeaders, &pairs);
+    context.getHeaderMapValue(WasmHeaderMapType::RequestHeaders, "x-tenant", &value);
+    context.addHeaderMapValue(WasmHeaderMapType::RequestHeaders, "x-wasm", "true");
+    context.replaceHeaderMapValue(WasmHeaderMapType::RequestHeaders, "x-tenant", "b");
+    context.removeHeaderMapValue(WasmHeaderMapType::RequestHeaders, "x-wasm");
+    context.setHeaderMapPairs(WasmHeaderMapType::RequestHeaders, rewritten_pairs);
+    benchmark::DoNotOptimize(pairs);
+  }
+}
+
+BENCHMARK(bmWasmHeaderMapCalls);
+
 } // namespace Envoy
 
 int main(int argc, char** argv) {
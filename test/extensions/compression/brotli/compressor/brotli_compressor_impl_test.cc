@@ -133,6 +133,51 @@ TEST_P(ConfigTest, LoadConfig) {
   verifyWithDecompressor(factory->createCompressor());
 }
 
+TEST_F(BrotliCompressorImplTest, SharedDictionary) {
+  envoy::extensions::compression::brotli::compressor::v3::Brotli brotli;
+  BrotliCompressorLibraryFactory lib_factory;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory =
+      lib_factory.createCompressorFactoryFromProto(brotli, context);
+
+  // Random content compresses only against itself.
+  Buffer::OwnedImpl random;
+  TestUtility::feedBufferWithRandomCharacters(random, 4096);
+  const std::string dictionary = random.toString();
+  const std::string sha256(32, 's');
+  Envoy::Compression::Compressor::CompressorFactoryPtr dictionary_factory =
+      factory->createSharedDictionaryCompressorFactory(dictionary, sha256);
+  ASSERT_NE(nullptr, dictionary_factory);
+  EXPECT_EQ("dcb", dictionary_factory->contentEncoding());
+
+  Envoy::Compression::Compressor::CompressorPtr compressor = dictionary_factory->createCompressor();
+  Buffer::OwnedImpl buffer(dictionary);
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+
+  // The output is a magic number and the dictionary's hash, then a stream compressed against the
+  // dictionary.
+  const std::string output = buffer.toString();
+  ASSERT_GT(output.size(), 36);
+  EXPECT_EQ(absl::StrCat("\xff\x44\x43\x42", sha256), output.substr(0, 36));
+  EXPECT_LT(output.size(), 100);
+
+  std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> decoder(
+      BrotliDecoderCreateInstance(nullptr, nullptr, nullptr), &BrotliDecoderDestroyInstance);
+  ASSERT_EQ(BROTLI_TRUE, BrotliDecoderAttachDictionary(
+                             decoder.get(), BROTLI_SHARED_DICTIONARY_RAW, dictionary.size(),
+                             reinterpret_cast<const uint8_t*>(dictionary.data())));
+  std::string decompressed(dictionary.size() + 1, '\0');
+  size_t available_in = output.size() - 36;
+  const uint8_t* next_in = reinterpret_cast<const uint8_t*>(output.data()) + 36;
+  size_t available_out = decompressed.size();
+  uint8_t* next_out = reinterpret_cast<uint8_t*>(decompressed.data());
+  EXPECT_EQ(BROTLI_DECODER_RESULT_SUCCESS,
+            BrotliDecoderDecompressStream(decoder.get(), &available_in, &next_in, &available_out,
+                                          &next_out, nullptr));
+  decompressed.resize(decompressed.size() - available_out);
+  EXPECT_EQ(dictionary, decompressed);
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Brotli
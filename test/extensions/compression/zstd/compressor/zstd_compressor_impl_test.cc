@@ -139,6 +139,94 @@ TEST_F(ZstdCompressorImplTest, IllegalConfig) {
       "assert failure: id != 0. Details: Illegal Zstd dictionary");
 }
 
+TEST_F(ZstdCompressorImplTest, CompressWithThreadPool) {
+  ZstdThreadPool thread_pool(2);
+  auto compressor = std::make_unique<ZstdCompressorImpl>(
+      default_compression_level_, default_enable_checksum_, default_strategy_,
+      default_cdict_manager_, 4096, &thread_pool);
+
+  default_input_size_ = 60000;
+  verifyWithDecompressor(std::move(compressor));
+}
+
+TEST_F(ZstdCompressorImplTest, ParallelCompression) {
+  envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
+  ZstdCompressorLibraryFactory lib_factory;
+  NiceMock<Server::Configuration::MockFactoryContext> mock_context;
+  TestUtility::loadFromJson(R"EOF({
+  "parallel_compression": {
+    "threads": 2,
+    "min_content_length": 1024
+  }
+})EOF",
+                            zstd);
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory =
+      lib_factory.createCompressorFactoryFromProto(zstd, mock_context);
+
+  // Bodies at least as long as the threshold are compressed on the pool, shorter ones are not; the
+  // output decompresses the same either way.
+  verifyWithDecompressor(factory->createCompressorForContentLength(1024));
+  verifyWithDecompressor(factory->createCompressorForContentLength(1023));
+  verifyWithDecompressor(factory->createCompressor());
+}
+
+TEST_F(ZstdCompressorImplTest, SharedDictionary) {
+  envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
+  ZstdCompressorLibraryFactory lib_factory;
+  NiceMock<Server::Configuration::MockFactoryContext> mock_context;
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory =
+      lib_factory.createCompressorFactoryFromProto(zstd, mock_context);
+
+  // Random content compresses only against itself.
+  Buffer::OwnedImpl random;
+  TestUtility::feedBufferWithRandomCharacters(random, 4096);
+  const std::string dictionary = random.toString();
+  const std::string sha256(32, 's');
+  Envoy::Compression::Compressor::CompressorFactoryPtr dictionary_factory =
+      factory->createSharedDictionaryCompressorFactory(dictionary, sha256);
+  ASSERT_NE(nullptr, dictionary_factory);
+  EXPECT_EQ("dcz", dictionary_factory->contentEncoding());
+
+  Envoy::Compression::Compressor::CompressorPtr compressor = dictionary_factory->createCompressor();
+  Buffer::OwnedImpl buffer(dictionary);
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Flush);
+  Buffer::OwnedImpl accumulation_buffer;
+  accumulation_buffer.move(buffer);
+  buffer.add(dictionary);
+  compressor->compress(buffer, Envoy::Compression::Compressor::State::Finish);
+  accumulation_buffer.move(buffer);
+
+  // The output is the dictionary's hash in a skippable frame, then a frame compressed against the
+  // dictionary's raw content.
+  const std::string output = accumulation_buffer.toString();
+  ASSERT_GT(output.size(), 40);
+  EXPECT_EQ(absl::StrCat(absl::string_view("\x5e\x2a\x4d\x18\x20\x00\x00\x00", 8), sha256),
+            output.substr(0, 40));
+  EXPECT_LT(output.size(), 100);
+
+  std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> dctx(ZSTD_createDCtx(), &ZSTD_freeDCtx);
+  ASSERT_FALSE(ZSTD_isError(ZSTD_DCtx_refPrefix(dctx.get(), dictionary.data(), dictionary.size())));
+  std::string decompressed(2 * dictionary.size() + 1, '\0');
+  ZSTD_inBuffer input{output.data() + 40, output.size() - 40, 0};
+  ZSTD_outBuffer out{decompressed.data(), decompressed.size(), 0};
+  while (input.pos < input.size) {
+    ASSERT_FALSE(ZSTD_isError(ZSTD_decompressStream(dctx.get(), &out, &input)));
+  }
+  decompressed.resize(out.pos);
+  EXPECT_EQ(dictionary + dictionary, decompressed);
+}
+
+TEST_F(ZstdCompressorImplTest, SharedDictionaryRejectsTrainedDictionary) {
+  envoy::extensions::compression::zstd::compressor::v3::Zstd zstd;
+  ZstdCompressorLibraryFactory lib_factory;
+  NiceMock<Server::Configuration::MockFactoryContext> mock_context;
+  Envoy::Compression::Compressor::CompressorFactoryPtr factory =
+      lib_factory.createCompressorFactoryFromProto(zstd, mock_context);
+
+  EXPECT_EQ(nullptr, factory->createSharedDictionaryCompressorFactory(
+                         absl::string_view("\x37\xa4\x30\xec trained", 12), std::string(32, 's')));
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace Zstd
@@ -0,0 +1,62 @@
+// Compares the cost of a module rewriting request headers with one ABI call per header and with a
+// single bulk call.
+
+#include "source/extensions/filters/http/dynamic_modules/filter.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace DynamicModules {
+namespace HttpFilters {
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void rewriteRequestHeaders(::benchmark::State& state) {
+  const bool bulk = state.range(0);
+  const size_t num_headers = state.range(1);
+
+  Stats::SymbolTableImpl symbol_table;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  DynamicModuleHttpFilter filter(nullptr, symbol_table);
+  filter.setDecoderFilterCallbacks(decoder_callbacks);
+  // The headers set by the first iteration are replaced by the next ones.
+  Http::TestRequestHeaderMapImpl headers{
+      {":method", "GET"}, {":path", "/"}, {":authority", "example.com"}};
+  ON_CALL(decoder_callbacks, requestHeaders())
+      .WillByDefault(testing::Return(makeOptRef<Http::RequestHeaderMap>(headers)));
+
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < num_headers; i++) {
+    keys.push_back(absl::StrCat("x-module-header-", i));
+  }
+  std::string value = "value";
+  std::vector<envoy_dynamic_module_type_module_http_header> module_headers;
+  for (std::string& key : keys) {
+    module_headers.push_back({key.data(), key.size(), value.data(), value.size()});
+  }
+
+  for (auto _ : state) { // NOLINT
+    if (bulk) {
+      envoy_dynamic_module_callback_http_update_request_headers(&filter, module_headers.data(),
+                                                                module_headers.size());
+    } else {
+      for (const auto& header : module_headers) {
+        envoy_dynamic_module_callback_http_set_request_header(
+            &filter, header.key_ptr, header.key_length, header.value_ptr, header.value_length);
+      }
+    }
+    ::benchmark::DoNotOptimize(headers.size());
+  }
+  state.SetItemsProcessed(state.iterations() * num_headers);
+}
+BENCHMARK(rewriteRequestHeaders)->ArgsProduct({{false, true}, {1, 8, 32}});
+
+} // namespace HttpFilters
+} // namespace DynamicModules
+} // namespace Extensions
+} // namespace Envoy
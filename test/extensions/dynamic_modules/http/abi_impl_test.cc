@@ -258,6 +258,80 @@ INSTANTIATE_TEST_SUITE_P(
                       envoy_dynamic_module_callback_http_set_response_header,
                       envoy_dynamic_module_callback_http_set_response_trailer));
 
+// Parameterized test for update_headers
+using UpdateHeadersCallbackType = bool (*)(envoy_dynamic_module_type_http_filter_envoy_ptr,
+                                           envoy_dynamic_module_type_module_http_header*, size_t);
+
+class DynamicModuleHttpFilterUpdateHeadersTest
+    : public DynamicModuleHttpFilterTest,
+      public ::testing::WithParamInterface<UpdateHeadersCallbackType> {};
+
+TEST_P(DynamicModuleHttpFilterUpdateHeadersTest, UpdateHeaders) {
+  UpdateHeadersCallbackType callback = GetParam();
+
+  // Test with nullptr accessors.
+  EXPECT_FALSE(callback(filter_.get(), nullptr, 0));
+
+  std::initializer_list<std::pair<std::string, std::string>> headers = {
+      {"single", "value"}, {"multi", "value1"}, {"multi", "value2"}, {"removed", "value"}};
+  Http::TestRequestHeaderMapImpl request_headers{headers};
+  Http::TestRequestTrailerMapImpl request_trailers{headers};
+  Http::TestResponseHeaderMapImpl response_headers{headers};
+  Http::TestResponseTrailerMapImpl response_trailers{headers};
+  EXPECT_CALL(decoder_callbacks_, requestHeaders())
+      .WillRepeatedly(testing::Return(makeOptRef<RequestHeaderMap>(request_headers)));
+  EXPECT_CALL(decoder_callbacks_, requestTrailers())
+      .WillRepeatedly(testing::Return(makeOptRef<RequestTrailerMap>(request_trailers)));
+  EXPECT_CALL(encoder_callbacks_, responseHeaders())
+      .WillRepeatedly(testing::Return(makeOptRef<ResponseHeaderMap>(response_headers)));
+  EXPECT_CALL(encoder_callbacks_, responseTrailers())
+      .WillRepeatedly(testing::Return(makeOptRef<ResponseTrailerMap>(response_trailers)));
+
+  Http::HeaderMap* header_map = nullptr;
+  if (callback == &envoy_dynamic_module_callback_http_update_request_headers) {
+    header_map = &request_headers;
+  } else if (callback == &envoy_dynamic_module_callback_http_update_request_trailers) {
+    header_map = &request_trailers;
+  } else if (callback == &envoy_dynamic_module_callback_http_update_response_headers) {
+    header_map = &response_headers;
+  } else if (callback == &envoy_dynamic_module_callback_http_update_response_trailers) {
+    header_map = &response_trailers;
+  } else {
+    FAIL();
+  }
+
+  // New, replaced and removed headers. Headers are updated in order, so the last value wins.
+  std::vector<std::pair<std::string, absl::optional<std::string>>> updates = {
+      {"new_one", "value"},
+      {"single", "new_value"},
+      {"multi", "new_value"},
+      {"removed", absl::nullopt},
+      {"new_one", "last_value"}};
+  std::vector<envoy_dynamic_module_type_module_http_header> module_headers;
+  for (auto& [key, value] : updates) {
+    module_headers.push_back({key.data(), key.size(), value ? value->data() : nullptr,
+                              value ? value->size() : 0});
+  }
+  EXPECT_TRUE(callback(filter_.get(), module_headers.data(), module_headers.size()));
+
+  for (const auto& [key, value] :
+       std::vector<std::pair<std::string, std::string>>{
+           {"new_one", "last_value"}, {"single", "new_value"}, {"multi", "new_value"}}) {
+    auto values = header_map->get(Envoy::Http::LowerCaseString(key));
+    ASSERT_EQ(values.size(), 1);
+    EXPECT_EQ(values[0]->value().getStringView(), value);
+  }
+  EXPECT_TRUE(header_map->get(Envoy::Http::LowerCaseString("removed")).empty());
+  EXPECT_EQ(header_map->size(), 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    UpdateHeadersTests, DynamicModuleHttpFilterUpdateHeadersTest,
+    ::testing::Values(envoy_dynamic_module_callback_http_update_request_headers,
+                      envoy_dynamic_module_callback_http_update_request_trailers,
+                      envoy_dynamic_module_callback_http_update_response_headers,
+                      envoy_dynamic_module_callback_http_update_response_trailers));
+
 // Parameterized test for get_headers_count
 using GetHeadersCountCallbackType = size_t (*)(envoy_dynamic_module_type_http_filter_envoy_ptr);
 
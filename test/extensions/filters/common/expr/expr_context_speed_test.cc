@@ -3,15 +3,18 @@
 #include "source/common/protobuf/protobuf.h"
 #include "source/common/router/string_accessor_impl.h"
 #include "source/extensions/filters/common/expr/context.h"
+#include "source/extensions/filters/common/expr/evaluator.h"
 
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/upstream/host.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
+#include "parser/parser.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -90,6 +93,24 @@ public:
     }
   }
 
+  // Compares matching requests with the specialized expressions and with the interpreter.
+  void testMatches(::benchmark::State& state) {
+    static const std::vector<std::string> expressions = {
+        "request.path.startsWith('/meow') && request.headers['x-request-id'] == 'blah'",
+        "source.address == '10.20.30.40:456' || connection.requested_server_name == 'kittens.com'",
+        "request.method == 'POST' && !(request.headers['referer'] == 'cats.com') && "
+        "destination.port == 123 && 1 < 2"};
+    TestScopedRuntime scoped_runtime;
+    scoped_runtime.mergeValues({{"envoy.reloadable_features.cel_specialized_expressions",
+                                 state.range(0) ? "true" : "false"}});
+    auto parsed = google::api::expr::parser::Parse(expressions[state.range(1)]);
+    auto compiled = CompiledExpression::Create(createBuilder(nullptr), parsed.value().expr());
+
+    for (auto _ : state) { // NOLINT
+      benchmark::DoNotOptimize(compiled->matches(info_, request_headers_));
+    }
+  }
+
 private:
   Http::TestRequestHeaderMapImpl makeRequestHeaders() {
     return Http::TestRequestHeaderMapImpl{{":method", "POST"},      {":scheme", "http"},
@@ -165,6 +186,11 @@ static void bmFilterState(::benchmark::State& state) {
   speed_test.testFilterState(state);
 }
 
+static void bmMatches(::benchmark::State& state) {
+  ExpressionContextSpeedTest speed_test(0);
+  speed_test.testMatches(state);
+}
+
 BENCHMARK(bmRequestAttributes)
     ->Unit(::benchmark::kMicrosecond)
     ->RangeMultiplier(100)
@@ -177,6 +203,8 @@ BENCHMARK(bmResponseAttributes)
 
 BENCHMARK(bmFilterState)->Unit(::benchmark::kMicrosecond)->RangeMultiplier(100)->Range(10, 100000);
 
+BENCHMARK(bmMatches)->ArgsProduct({{false, true}, {0, 1, 2}})->Unit(::benchmark::kNanosecond);
+
 } // namespace Expr
 } // namespace Common
 } // namespace Filters
@@ -0,0 +1,158 @@
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/common/expr/evaluator.h"
+#include "source/extensions/filters/common/expr/specialized_expression.h"
+
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "parser/parser.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace Expr {
+namespace {
+
+class SpecializedExpressionTest : public testing::Test {
+protected:
+  SpecializedExpressionTest() {
+    info_.downstream_connection_info_provider_->setRemoteAddress(
+        Network::Utility::parseInternetAddressNoThrow("10.0.0.1", 1234, false));
+    info_.downstream_connection_info_provider_->setLocalAddress(
+        Network::Utility::parseInternetAddressNoThrow("10.0.0.2", 443, false));
+    info_.downstream_connection_info_provider_->setRequestedServerName("api.example.com");
+    TestUtility::loadFromYaml(R"EOF(
+filter_metadata:
+  envoy.filters.http.test:
+    tenant: a
+    nested: {weight: 2}
+    list: [a]
+)EOF",
+                              info_.metadata_);
+  }
+
+  static cel::expr::Expr parse(absl::string_view text) {
+    auto parsed = google::api::expr::parser::Parse(text);
+    EXPECT_TRUE(parsed.ok()) << parsed.status();
+    return parsed.value().expr();
+  }
+
+  // Expects both the specialized expression and the interpreter to match the request as expected.
+  void expectMatches(absl::string_view text, bool expected) {
+    const cel::expr::Expr expr = parse(text);
+    const SpecializedExpressionConstPtr specialized = SpecializedExpression::create(expr);
+    ASSERT_NE(nullptr, specialized) << text;
+    Protobuf::Arena arena;
+    EXPECT_EQ(absl::make_optional(expected), specialized->matches(arena, info_, &headers_))
+        << text;
+
+    TestScopedRuntime scoped_runtime;
+    scoped_runtime.mergeValues(
+        {{"envoy.reloadable_features.cel_specialized_expressions", "false"}});
+    auto compiled = CompiledExpression::Create(createBuilder(nullptr), expr);
+    ASSERT_TRUE(compiled.ok());
+    EXPECT_EQ(expected, compiled->matches(info_, headers_)) << text;
+  }
+
+  NiceMock<StreamInfo::MockStreamInfo> info_;
+  Http::TestRequestHeaderMapImpl headers_{{":path", "/api/users?id=1"},
+                                          {":method", "GET"},
+                                          {"x-tenant", "a"},
+                                          {"x-multi", "a"},
+                                          {"x-multi", "b"}};
+};
+
+TEST_F(SpecializedExpressionTest, Request) {
+  expectMatches("request.path == '/api/users?id=1'", true);
+  expectMatches("request.url_path.startsWith('/api/')", true);
+  expectMatches("request.method != 'GET'", false);
+  expectMatches("request.headers['X-Tenant'] == 'a'", true);
+  expectMatches("request.headers['x-multi'] == 'a,b'", true);
+  expectMatches("request.headers['x-tenant'].contains('b')", false);
+}
+
+TEST_F(SpecializedExpressionTest, PeerAndConnection) {
+  expectMatches("source.address == '10.0.0.1:1234'", true);
+  expectMatches("source.port > 1024 && destination.port == 443", true);
+  expectMatches("connection.requested_server_name.endsWith('.example.com')", true);
+  expectMatches("connection.mtls", false);
+  // There is no TLS connection to look the version up from.
+  expectMatches("connection.tls_version == 'TLSv1.3'", false);
+}
+
+TEST_F(SpecializedExpressionTest, Metadata) {
+  expectMatches("metadata.filter_metadata['envoy.filters.http.test']['tenant'] == 'a'", true);
+  expectMatches("metadata.filter_metadata['envoy.filters.http.test'].nested.weight >= 2.0", true);
+  expectMatches("metadata.filter_metadata['envoy.filters.http.test']['missing'] == 'a'", false);
+}
+
+TEST_F(SpecializedExpressionTest, Errors) {
+  // Missing attributes are errors, which are absorbed by the logical operators as in CEL.
+  expectMatches("request.headers['missing'] == 'a'", false);
+  expectMatches("!(request.headers['missing'] == 'a')", false);
+  expectMatches("request.headers['missing'] == 'a' || request.method == 'GET'", true);
+  expectMatches("request.method == 'POST' && request.headers['missing'] == 'a'", false);
+}
+
+TEST_F(SpecializedExpressionTest, ConstantFolding) {
+  expectMatches("'a' == 'a'", true);
+  expectMatches("1 < 2 && request.method == 'GET'", true);
+  expectMatches("false && request.headers['missing'] == 'a'", false);
+  expectMatches("true || request.headers['missing'] == 'a'", true);
+}
+
+TEST_F(SpecializedExpressionTest, Evaluate) {
+  const SpecializedExpressionConstPtr specialized =
+      SpecializedExpression::create(parse("request.headers['x-tenant']"));
+  ASSERT_NE(nullptr, specialized);
+  Protobuf::Arena arena;
+  const absl::optional<CelValue> value = specialized->evaluate(arena, info_, &headers_);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ("a", value->StringOrDie().value());
+  // The interpreter reports the errors.
+  EXPECT_FALSE(specialized->evaluate(arena, info_, nullptr).has_value());
+}
+
+TEST_F(SpecializedExpressionTest, Fallback) {
+  // Values of other types than those compared are left to the interpreter.
+  Protobuf::Arena arena;
+  for (const absl::string_view text :
+       {"metadata.filter_metadata['envoy.filters.http.test']['tenant'] == 1",
+        "metadata.filter_metadata['envoy.filters.http.test']['list'] == 'a'",
+        "metadata.filter_metadata['envoy.filters.http.test'].nested.weight == 2"}) {
+    const SpecializedExpressionConstPtr specialized = SpecializedExpression::create(parse(text));
+    ASSERT_NE(nullptr, specialized) << text;
+    EXPECT_FALSE(specialized->matches(arena, info_, &headers_).has_value()) << text;
+  }
+  for (const absl::string_view text :
+       {"request.path.matches('^/api')", "size(request.path) == 1", "request.headers == {}",
+        "has(request.headers.x)", "xds.cluster_name == 'a'", "'a' == 1"}) {
+    EXPECT_EQ(nullptr, SpecializedExpression::create(parse(text))) << text;
+  }
+}
+
+TEST_F(SpecializedExpressionTest, CompiledExpression) {
+  // The interpreter evaluates what the specialized expression falls back on.
+  const cel::expr::Expr expr =
+      parse("metadata.filter_metadata['envoy.filters.http.test'].nested.weight == 2");
+  auto compiled = CompiledExpression::Create(createBuilder(nullptr), expr);
+  ASSERT_TRUE(compiled.ok());
+  const bool matches = compiled->matches(info_, headers_);
+
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues({{"envoy.reloadable_features.cel_specialized_expressions", "false"}});
+  auto interpreted = CompiledExpression::Create(createBuilder(nullptr), expr);
+  ASSERT_TRUE(interpreted.ok());
+  EXPECT_EQ(interpreted->matches(info_, headers_), matches);
+}
+
+} // namespace
+} // namespace Expr
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
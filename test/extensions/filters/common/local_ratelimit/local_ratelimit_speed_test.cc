@@ -0,0 +1,85 @@
+// Compares the throughput of workers concurrently consuming a local rate limit token bucket, when
+// they all update the shared bucket and when the bucket is sharded across them.
+
+#include "source/common/thread_local/thread_local_impl.h"
+#include "source/extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace LocalRateLimit {
+
+// Requests each worker makes per iteration.
+constexpr uint32_t RequestsPerWorker = 100000;
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void consumeConcurrently(::benchmark::State& state) {
+  const bool sharded = state.range(0);
+  const uint32_t num_workers = benchmark::skipExpensiveBenchmarks() ? 2 : state.range(1);
+
+  Api::ApiPtr api = Api::createApiForTest();
+  ThreadLocal::InstanceImpl tls;
+  Event::DispatcherPtr main_dispatcher = api->allocateDispatcher("main_thread");
+  tls.registerThread(*main_dispatcher, true);
+  std::vector<Event::DispatcherPtr> dispatchers;
+  for (uint32_t i = 0; i < num_workers; ++i) {
+    dispatchers.push_back(api->allocateDispatcher(absl::StrCat("worker_", i)));
+    tls.registerThread(*dispatchers.back(), false);
+  }
+  main_dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+
+  // The bucket refills faster than the workers consume, so that requests are never limited and
+  // only the cost of consuming is measured.
+  const TokenBucketSharding sharding{tls, 0.001, std::chrono::milliseconds(100)};
+  auto bucket = std::make_unique<RateLimitTokenBucket>(
+      1000000000, 1000000000, std::chrono::milliseconds(1000), api->timeSource(),
+      sharded ? makeOptRef(sharding) : OptRef<const TokenBucketSharding>());
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (Event::DispatcherPtr& dispatcher : dispatchers) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&dispatcher]() {
+      dispatcher->run(Event::Dispatcher::RunType::RunUntilExit);
+    }));
+  }
+
+  for (auto _ : state) { // NOLINT
+    absl::BlockingCounter done(num_workers);
+    for (Event::DispatcherPtr& dispatcher : dispatchers) {
+      dispatcher->post([&bucket, &done]() {
+        for (uint32_t i = 0; i < RequestsPerWorker; ++i) {
+          ::benchmark::DoNotOptimize(bucket->consume());
+        }
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_workers * RequestsPerWorker);
+
+  for (uint32_t i = 0; i < num_workers; ++i) {
+    dispatchers[i]->exit();
+    threads[i]->join();
+  }
+  tls.shutdownGlobalThreading();
+  bucket.reset();
+  tls.shutdownThread();
+}
+BENCHMARK(consumeConcurrently)
+    ->ArgsProduct({{false, true}, {1, 4, 16, 48}})
+    ->UseRealTime()
+    ->Unit(::benchmark::kMillisecond);
+
+} // namespace LocalRateLimit
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,9 +1,12 @@
 #include "source/common/singleton/manager_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
 #include "source/extensions/filters/common/local_ratelimit/local_ratelimit_impl.h"
 
 #include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/cluster_manager.h"
 #include "test/mocks/upstream/cluster_priority_set.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
@@ -694,6 +697,120 @@ TEST_F(LocalRateLimiterDescriptorImplTest, NullDefaultTokenBucket) {
   EXPECT_FALSE(no_match_result.token_bucket_context);
 }
 
+// Workers take tokens from the shared bucket in batches, and return those they have not used.
+TEST(RateLimitTokenBucketTest, WorkerSharding) {
+  Event::SimulatedTimeSystem time_system;
+  NiceMock<ThreadLocal::MockInstance> tls;
+  auto* rebalance_timer = new NiceMock<Event::MockTimer>(&tls.dispatcher_);
+  const TokenBucketSharding sharding{tls, 40.0, std::chrono::milliseconds(100)};
+  RateLimitTokenBucket bucket(10, 1, std::chrono::milliseconds(1000), time_system, sharding);
+
+  // The worker takes a batch of 4 tokens.
+  EXPECT_TRUE(bucket.consume());
+  EXPECT_TRUE(rebalance_timer->enabled());
+  EXPECT_EQ(9, bucket.remainingTokens());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(bucket.consume());
+  }
+  EXPECT_EQ(6, bucket.remainingTokens());
+  EXPECT_TRUE(bucket.consume());
+  EXPECT_EQ(5, bucket.remainingTokens());
+
+  // The 3 unused tokens are returned to the shared bucket.
+  rebalance_timer->invokeCallback();
+  EXPECT_EQ(5, bucket.remainingTokens());
+
+  // Requests needing more than a batch take what they need.
+  EXPECT_FALSE(bucket.consume(1.0, 6));
+  EXPECT_TRUE(bucket.consume(1.0, 5));
+  EXPECT_EQ(0, bucket.remainingTokens());
+  EXPECT_FALSE(bucket.consume());
+
+  // The share factor scales the tokens a request needs.
+  time_system.advanceTimeWait(std::chrono::seconds(2));
+  EXPECT_FALSE(bucket.consume(0.5, 2));
+  EXPECT_TRUE(bucket.consume(0.5, 1));
+}
+
+class DynamicDescriptorTest : public testing::Test {
+public:
+  void initialize(uint32_t lru_size, DynamicDescriptorOptions options = {}) {
+    options.stats_.emplace(DynamicDescriptorStats{ALL_DYNAMIC_DESCRIPTOR_STATS(
+        POOL_COUNTER(*store_.rootScope()), POOL_GAUGE(*store_.rootScope()))});
+    stats_.emplace(*options.stats_);
+    dynamic_descriptor_ = std::make_unique<DynamicDescriptor>(
+        2, 1, std::chrono::milliseconds(1000), lru_size, time_system_, options);
+  }
+
+  RateLimitTokenBucketSharedPtr bucket(absl::string_view user) {
+    return dynamic_descriptor_->addOrGetDescriptor({{{"user", std::string(user)}}});
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl store_;
+  absl::optional<DynamicDescriptorStats> stats_;
+  std::unique_ptr<DynamicDescriptor> dynamic_descriptor_;
+};
+
+// Values looked up since the clock hand last passed them are not evicted.
+TEST_F(DynamicDescriptorTest, ClockEviction) {
+  initialize(2);
+
+  const RateLimitTokenBucketSharedPtr a = bucket("A");
+  const RateLimitTokenBucketSharedPtr b = bucket("B");
+  EXPECT_EQ(a, bucket("A"));
+  EXPECT_EQ(2, stats_->dynamic_descriptors_active_.value());
+
+  // B is evicted, A's flag is cleared.
+  const RateLimitTokenBucketSharedPtr c = bucket("C");
+  EXPECT_EQ(a, bucket("A"));
+  EXPECT_EQ(c, bucket("C"));
+  EXPECT_EQ(1, stats_->dynamic_descriptors_evicted_.value());
+
+  // Both were looked up, so the hand evicts the one it comes back to.
+  EXPECT_NE(b, bucket("B"));
+  EXPECT_EQ(2, stats_->dynamic_descriptors_evicted_.value());
+  EXPECT_EQ(2, dynamic_descriptor_->size());
+  EXPECT_EQ(2, stats_->dynamic_descriptors_active_.value());
+
+  dynamic_descriptor_.reset();
+  EXPECT_EQ(0, stats_->dynamic_descriptors_active_.value());
+}
+
+// Values are split into shards each keeping an equal share of them.
+TEST_F(DynamicDescriptorTest, Shards) {
+  initialize(10, {4});
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NE(nullptr, bucket(absl::StrCat(i)));
+  }
+  // Each of the 4 shards keeps up to 3 values.
+  EXPECT_LE(dynamic_descriptor_->size(), 12);
+  EXPECT_EQ(dynamic_descriptor_->size(), stats_->dynamic_descriptors_active_.value());
+  EXPECT_EQ(100 - dynamic_descriptor_->size(), stats_->dynamic_descriptors_evicted_.value());
+}
+
+// Values only get a bucket once they have been seen min_requests times in a window.
+TEST_F(DynamicDescriptorTest, MinRequests) {
+  initialize(20, {0, 3, std::chrono::milliseconds(1000)});
+
+  EXPECT_EQ(nullptr, bucket("A"));
+  EXPECT_EQ(nullptr, bucket("A"));
+  const RateLimitTokenBucketSharedPtr a = bucket("A");
+  EXPECT_NE(nullptr, a);
+  EXPECT_EQ(a, bucket("A"));
+  EXPECT_EQ(2, stats_->dynamic_descriptors_filtered_.value());
+  EXPECT_EQ(1, stats_->dynamic_descriptors_active_.value());
+
+  // Counts are halved when a window ends.
+  EXPECT_EQ(nullptr, bucket("B"));
+  EXPECT_EQ(nullptr, bucket("B"));
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1000));
+  EXPECT_EQ(nullptr, bucket("B"));
+  EXPECT_NE(nullptr, bucket("B"));
+  EXPECT_EQ(5, stats_->dynamic_descriptors_filtered_.value());
+}
+
 } // Namespace LocalRateLimit
 } // namespace Common
 } // namespace Filters
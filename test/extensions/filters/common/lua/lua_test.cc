@@ -178,6 +178,53 @@ TEST_F(LuaTest, MarkDead) {
   lua_gc(cr1->luaState(), LUA_GCCOLLECT, 0);
 }
 
+// Threads of coroutines that returned are reused by later coroutines, but not those of coroutines
+// that errored or are still yielded.
+TEST_F(LuaTest, CoroutineReuse) {
+  const std::string SCRIPT{R"EOF(
+    function callMe(action)
+      if getfenv(0) ~= _G then
+        error("unexpected globals")
+      end
+      if action == "yield" then
+        coroutine.yield()
+      elseif action == "error" then
+        error("failed")
+      elseif action == "setfenv" then
+        setfenv(0, {})
+      end
+    end
+  )EOF"};
+
+  setup(SCRIPT);
+  const int callMeRef = state_->getGlobalRef(state_->registerGlobal("callMe", initializers_));
+  EXPECT_NE(LUA_REFNIL, callMeRef);
+  const auto run = [&](const std::string& action) {
+    CoroutinePtr cr(state_->createCoroutine());
+    lua_pushstring(cr->luaState(), action.c_str());
+    if (action == "error") {
+      EXPECT_THROW_WITH_REGEX(cr->start(callMeRef, 1, yield_callback_), LuaException, "failed");
+    } else {
+      cr->start(callMeRef, 1, yield_callback_);
+    }
+    return cr->luaState();
+  };
+
+  lua_State* returned = run("return");
+  // Stop collecting the threads, so that their addresses are not reused.
+  lua_gc(returned, LUA_GCSTOP, 0);
+  EXPECT_EQ(returned, run("return"));
+  // The globals of the thread are restored when it is reused.
+  EXPECT_EQ(returned, run("setfenv"));
+  EXPECT_EQ(returned, run("return"));
+
+  EXPECT_CALL(on_yield_, ready());
+  EXPECT_EQ(returned, run("yield"));
+  lua_State* errored = run("error");
+  EXPECT_NE(returned, errored);
+  EXPECT_NE(errored, run("return"));
+}
+
 class ThreadSafeTest : public testing::Test {
 public:
   ThreadSafeTest()
@@ -12,6 +12,7 @@
 #include "test/mocks/server/factory_context.h"
 #include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -668,6 +669,48 @@ TEST(RoleBasedAccessControlMatcherEngineImpl, LogIfMatched) {
   checkMatcherEngine(engine, true, RBAC::LogResult::No, info, conn, headers);
 }
 
+// The prefilter does not change which policy matches first.
+TEST(RoleBasedAccessControlEngineImpl, PolicyPrefilter) {
+  for (const bool prefilter : {false, true}) {
+    TestScopedRuntime scoped_runtime;
+    scoped_runtime.mergeValues(
+        {{"envoy.reloadable_features.rbac_policy_prefilter", prefilter ? "true" : "false"}});
+    NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+    envoy::config::rbac::v3::RBAC rbac;
+    rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+    envoy::config::rbac::v3::Policy port_policy;
+    port_policy.add_permissions()->set_destination_port(123);
+    port_policy.add_principals()->set_any(true);
+    (*rbac.mutable_policies())["a"] = port_policy;
+    envoy::config::rbac::v3::Policy tenant_policy;
+    tenant_policy.add_permissions()->set_any(true);
+    auto* header = tenant_policy.add_principals()->mutable_header();
+    header->set_name("x-tenant");
+    header->mutable_string_match()->set_exact("t");
+    (*rbac.mutable_policies())["b"] = tenant_policy;
+    (*rbac.mutable_policies())["c"] = tenant_policy;
+    RBAC::RoleBasedAccessControlEngineImpl engine(
+        rbac, ProtobufMessage::getStrictValidationVisitor(), factory_context);
+
+    Envoy::Network::MockConnection conn;
+    NiceMock<StreamInfo::MockStreamInfo> info;
+    info.downstream_connection_info_provider_->setLocalAddress(
+        Envoy::Network::Utility::parseInternetAddressNoThrow("1.2.3.4", 456, false));
+    std::string effective_policy_id;
+    EXPECT_TRUE(engine.handleAction(conn, Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "t"}},
+                                    info, &effective_policy_id));
+    EXPECT_EQ("b", effective_policy_id);
+    EXPECT_FALSE(engine.handleAction(conn, Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "u"}},
+                                     info, nullptr));
+
+    info.downstream_connection_info_provider_->setLocalAddress(
+        Envoy::Network::Utility::parseInternetAddressNoThrow("1.2.3.4", 123, false));
+    EXPECT_TRUE(engine.handleAction(conn, Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "t"}},
+                                    info, &effective_policy_id));
+    EXPECT_EQ("a", effective_policy_id);
+  }
+}
+
 } // namespace
 } // namespace RBAC
 } // namespace Common
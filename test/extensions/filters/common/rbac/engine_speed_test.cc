@@ -0,0 +1,67 @@
+// Compares RBAC engine evaluation with and without the policy prefilter, over policies each
+// allowing a single tenant, for requests matching the last policy or none of them.
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+
+#include "source/extensions/filters/common/rbac/engine_impl.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void evaluatePolicies(::benchmark::State& state) {
+  const bool prefilter = state.range(0);
+  const uint32_t num_policies = benchmark::skipExpensiveBenchmarks() ? 10 : state.range(1);
+  const bool matching = state.range(2);
+
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.rbac_policy_prefilter", prefilter ? "true" : "false"}});
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  for (uint32_t i = 0; i < num_policies; ++i) {
+    envoy::config::rbac::v3::Policy& policy =
+        (*rbac.mutable_policies())[absl::StrCat("policy-", absl::Dec(i, absl::kZeroPad5))];
+    policy.add_permissions()->set_any(true);
+    auto* header = policy.add_principals()->mutable_header();
+    header->set_name("x-tenant");
+    header->mutable_string_match()->set_exact(absl::StrCat("tenant-", i));
+  }
+  RoleBasedAccessControlEngineImpl engine(rbac, ProtobufMessage::getStrictValidationVisitor(),
+                                          factory_context);
+
+  NiceMock<Envoy::Network::MockConnection> connection;
+  NiceMock<StreamInfo::MockStreamInfo> info;
+  // Names are zero-padded, so that the last policy evaluated is the last one added.
+  const Envoy::Http::TestRequestHeaderMapImpl headers{
+      {":path", "/"},
+      {"x-tenant", matching ? absl::StrCat("tenant-", num_policies - 1) : "unknown"}};
+  std::string effective_policy_id;
+  for (auto _ : state) { // NOLINT
+    ::benchmark::DoNotOptimize(engine.handleAction(connection, headers, info,
+                                                   &effective_policy_id));
+  }
+}
+BENCHMARK(evaluatePolicies)
+    ->ArgsProduct({{false, true}, {10, 1000, 10000}, {false, true}})
+    ->Unit(::benchmark::kMicrosecond);
+
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
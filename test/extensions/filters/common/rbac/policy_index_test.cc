@@ -0,0 +1,220 @@
+#include "envoy/config/rbac/v3/rbac.pb.h"
+
+#include "source/common/network/utility.h"
+#include "source/extensions/filters/common/rbac/policy_index.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Const;
+using testing::ElementsAre;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+namespace {
+
+class PolicyIndexTest : public testing::Test {
+protected:
+  void initialize(const std::vector<std::string>& yamls) {
+    policies_.resize(yamls.size());
+    std::vector<const envoy::config::rbac::v3::Policy*> policies;
+    for (size_t i = 0; i < yamls.size(); ++i) {
+      TestUtility::loadFromYaml(yamls[i], policies_[i]);
+      policies.push_back(&policies_[i]);
+    }
+    index_ = std::make_unique<PolicyIndex>(policies);
+  }
+
+  std::vector<uint32_t> candidates(const Envoy::Http::RequestHeaderMap& headers) {
+    return index_->candidates(conn_, headers, info_);
+  }
+
+  std::vector<envoy::config::rbac::v3::Policy> policies_;
+  std::unique_ptr<PolicyIndex> index_;
+  NiceMock<Envoy::Network::MockConnection> conn_;
+  NiceMock<StreamInfo::MockStreamInfo> info_;
+};
+
+TEST_F(PolicyIndexTest, Headers) {
+  initialize({R"EOF(
+permissions: [{any: true}]
+principals:
+- header: {name: X-Tenant, string_match: {exact: a}}
+- header: {name: x-tenant, string_match: {exact: b}}
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{header: {name: x-tenant, string_match: {exact: b}}}]
+)EOF",
+              // Inverted, case-insensitive and prefix matches are not indexed.
+              R"EOF(
+permissions: [{any: true}]
+principals: [{header: {name: x-tenant, string_match: {exact: c}, invert_match: true}}]
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{header: {name: x-tenant, string_match: {exact: c, ignore_case: true}}}]
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{header: {name: x-tenant, string_match: {prefix: c}}}]
+)EOF"});
+  EXPECT_EQ(2, index_->indexedPolicies());
+
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "a"}}),
+              ElementsAre(0, 2, 3, 4));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "b"}}),
+              ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{}), ElementsAre(2, 3, 4));
+  // Multiple values are matched joined, as the header matchers do.
+  EXPECT_THAT(
+      candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "a"}, {"x-tenant", "b"}}),
+      ElementsAre(2, 3, 4));
+}
+
+TEST_F(PolicyIndexTest, Paths) {
+  initialize({R"EOF(
+permissions: [{url_path: {path: {prefix: /api/}}}]
+principals: [{any: true}]
+)EOF",
+              R"EOF(
+permissions: [{url_path: {path: {exact: /api/users}}}]
+principals: [{any: true}]
+)EOF",
+              R"EOF(
+permissions: [{url_path: {path: {prefix: /admin}}}]
+principals: [{any: true}]
+)EOF"});
+  EXPECT_EQ(3, index_->indexedPolicies());
+
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{":path", "/api/users?a=b"}}),
+              ElementsAre(0, 1));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{":path", "/api/groups"}}),
+              ElementsAre(0));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{":path", "/"}}), ElementsAre());
+}
+
+TEST_F(PolicyIndexTest, Ips) {
+  initialize({R"EOF(
+permissions: [{any: true}]
+principals:
+- source_ip: {address_prefix: 10.0.0.0, prefix_len: 8}
+- source_ip: {address_prefix: 192.168.0.0, prefix_len: 16}
+)EOF",
+              R"EOF(
+permissions: [{destination_ip: {address_prefix: 1.2.3.4, prefix_len: 32}}]
+principals: [{any: true}]
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{remote_ip: {address_prefix: 10.1.0.0, prefix_len: 16}}]
+)EOF"});
+  EXPECT_EQ(3, index_->indexedPolicies());
+
+  conn_.stream_info_.downstream_connection_info_provider_->setRemoteAddress(
+      Envoy::Network::Utility::parseInternetAddressNoThrow("10.1.2.3", 123, false));
+  info_.downstream_connection_info_provider_->setLocalAddress(
+      Envoy::Network::Utility::parseInternetAddressNoThrow("1.2.3.5", 456, false));
+  info_.downstream_connection_info_provider_->setRemoteAddress(
+      Envoy::Network::Utility::parseInternetAddressNoThrow("10.1.2.3", 123, false));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{}), ElementsAre(0, 2));
+
+  info_.downstream_connection_info_provider_->setLocalAddress(
+      Envoy::Network::Utility::parseInternetAddressNoThrow("1.2.3.4", 456, false));
+  info_.downstream_connection_info_provider_->setRemoteAddress(
+      Envoy::Network::Utility::parseInternetAddressNoThrow("192.168.1.1", 123, false));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{}), ElementsAre(0, 1));
+}
+
+TEST_F(PolicyIndexTest, PrincipalNames) {
+  initialize({R"EOF(
+permissions: [{any: true}]
+principals: [{authenticated: {principal_name: {exact: "spiffe://cluster.local/ns/a"}}}]
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{authenticated: {principal_name: {exact: "subject"}}}]
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals: [{authenticated: {principal_name: {exact: "b.example.com"}}}]
+)EOF"});
+  EXPECT_EQ(3, index_->indexedPolicies());
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{}), ElementsAre());
+
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  const std::vector<std::string> uri_sans{"spiffe://cluster.local/ns/a"};
+  const std::vector<std::string> dns_sans{"a.example.com"};
+  const std::string subject = "subject";
+  ON_CALL(*ssl, uriSanPeerCertificate()).WillByDefault(Return(uri_sans));
+  ON_CALL(*ssl, dnsSansPeerCertificate()).WillByDefault(Return(dns_sans));
+  ON_CALL(*ssl, subjectPeerCertificate()).WillByDefault(ReturnRef(subject));
+  ON_CALL(Const(conn_), ssl()).WillByDefault(Return(ssl));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{}), ElementsAre(0, 1));
+}
+
+TEST_F(PolicyIndexTest, CompoundRules) {
+  initialize({// One of the rules of a conjunction is enough.
+              R"EOF(
+permissions: [{any: true}]
+principals:
+- and_ids:
+    ids:
+    - metadata: {filter: f, path: [{key: k}], value: {string_match: {exact: v}}}
+    - header: {name: x-tenant, string_match: {exact: a}}
+)EOF",
+              // All the rules of a disjunction must be on the same attribute.
+              R"EOF(
+permissions: [{any: true}]
+principals:
+- or_ids:
+    ids:
+    - header: {name: x-tenant, string_match: {exact: b}}
+    - header: {name: x-tenant, string_match: {exact: c}}
+)EOF",
+              R"EOF(
+permissions: [{any: true}]
+principals:
+- or_ids:
+    ids:
+    - header: {name: x-tenant, string_match: {exact: b}}
+    - header: {name: x-user, string_match: {exact: b}}
+)EOF",
+              // Permissions are indexed when principals cannot be.
+              R"EOF(
+permissions:
+- and_rules:
+    rules:
+    - destination_port: 443
+    - or_rules:
+        rules:
+        - header: {name: x-tenant, string_match: {exact: c}}
+        - header: {name: x-tenant, string_match: {exact: d}}
+principals: [{any: true}]
+)EOF"});
+  EXPECT_EQ(3, index_->indexedPolicies());
+
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "a"}}),
+              ElementsAre(0, 2));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "c"}}),
+              ElementsAre(1, 2, 3));
+  EXPECT_THAT(candidates(Envoy::Http::TestRequestHeaderMapImpl{{"x-tenant", "e"}}),
+              ElementsAre(2));
+}
+
+} // namespace
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
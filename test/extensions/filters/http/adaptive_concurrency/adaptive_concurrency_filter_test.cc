@@ -254,6 +254,27 @@ TEST_F(AdaptiveConcurrencyFilterTest, DecodeHeadersTestBlock) {
             filter_->decodeHeaders(request_headers, true));
 }
 
+TEST_F(AdaptiveConcurrencyFilterTest, DecodeHeadersTestRouteController) {
+  // Verify that the requests to a route with its own controller are only admitted and sampled by
+  // that controller.
+  auto route_controller = std::make_shared<MockConcurrencyController>();
+  AdaptiveConcurrencyRouteConfig route_config(route_controller);
+  ON_CALL(*decoder_callbacks_.route_, mostSpecificPerFilterConfig(_))
+      .WillByDefault(Return(&route_config));
+
+  EXPECT_CALL(*controller_, forwardingDecision()).Times(0);
+  EXPECT_CALL(*route_controller, forwardingDecision())
+      .WillOnce(Return(RequestForwardingAction::Forward));
+  Http::TestRequestHeaderMapImpl request_headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+
+  Http::TestResponseHeaderMapImpl response_headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(response_headers, true));
+  EXPECT_CALL(*controller_, recordLatencySample(_)).Times(0);
+  EXPECT_CALL(*route_controller, recordLatencySample(_));
+  filter_->encodeComplete();
+}
+
 TEST_F(AdaptiveConcurrencyFilterTest, RecordSampleInDestructor) {
   // Verify that the request latency is always sampled even if encodeComplete() is never called.
   EXPECT_CALL(*controller_, forwardingDecision())
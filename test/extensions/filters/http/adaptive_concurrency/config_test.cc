@@ -0,0 +1,132 @@
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.validate.h"
+
+#include "source/extensions/filters/http/adaptive_concurrency/adaptive_concurrency_filter.h"
+#include "source/extensions/filters/http/adaptive_concurrency/config.h"
+
+#include "test/mocks/server/server_factory_context.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace {
+
+class AdaptiveConcurrencyPerRouteConfigTest : public testing::Test {
+public:
+  std::shared_ptr<const AdaptiveConcurrencyRouteConfig> makeRouteConfig(const std::string& yaml) {
+    auto status_or = createRouteConfig(yaml);
+    EXPECT_TRUE(status_or.ok()) << status_or.status();
+    return std::dynamic_pointer_cast<const AdaptiveConcurrencyRouteConfig>(*status_or);
+  }
+
+  absl::StatusOr<Router::RouteSpecificFilterConfigConstSharedPtr>
+  createRouteConfig(const std::string& yaml) {
+    envoy::extensions::filters::http::adaptive_concurrency::v3::AdaptiveConcurrencyPerRoute proto;
+    TestUtility::loadFromYamlAndValidate(yaml, proto);
+    return factory_.createRouteSpecificFilterConfig(proto, context_,
+                                                    ProtobufMessage::getStrictValidationVisitor());
+  }
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> context_;
+  AdaptiveConcurrencyFilterFactory factory_;
+};
+
+const std::string VegasRouteConfig = R"EOF(
+stat_prefix: route_a
+vegas_controller_config:
+  concurrency_update_interval: 0.1s
+  initial_concurrency_limit: 20
+)EOF";
+
+const std::string GradientRouteConfig = R"EOF(
+stat_prefix: route_b
+gradient_controller_config:
+  sample_aggregate_percentile:
+    value: 50
+  concurrency_limit_params:
+    concurrency_update_interval: 0.1s
+  min_rtt_calc_params:
+    interval: 30s
+    request_count: 50
+)EOF";
+
+TEST_F(AdaptiveConcurrencyPerRouteConfigTest, CreatesControllerWithRouteStats) {
+  auto vegas_route = makeRouteConfig(VegasRouteConfig);
+  ASSERT_NE(vegas_route, nullptr);
+  EXPECT_EQ(20, vegas_route->controller()->concurrencyLimit());
+  EXPECT_NE(nullptr, TestUtility::findGauge(
+                         context_.store_,
+                         "adaptive_concurrency.route_a.vegas_controller.concurrency_limit"));
+
+  auto gradient_route = makeRouteConfig(GradientRouteConfig);
+  ASSERT_NE(gradient_route, nullptr);
+  EXPECT_NE(nullptr, TestUtility::findGauge(
+                         context_.store_,
+                         "adaptive_concurrency.route_b.gradient_controller.concurrency_limit"));
+}
+
+// Routes and route configuration updates with the same stat_prefix share the controller, which
+// emits the stats under that prefix.
+TEST_F(AdaptiveConcurrencyPerRouteConfigTest, SameStatPrefixSharesController) {
+  auto first = makeRouteConfig(VegasRouteConfig);
+  auto second = makeRouteConfig(VegasRouteConfig);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(first->controller(), second->controller());
+}
+
+TEST_F(AdaptiveConcurrencyPerRouteConfigTest, SameStatPrefixWithOtherControllerIsRejected) {
+  auto route = makeRouteConfig(VegasRouteConfig);
+  ASSERT_NE(route, nullptr);
+  auto status_or = createRouteConfig(R"EOF(
+stat_prefix: route_a
+vegas_controller_config:
+  concurrency_update_interval: 0.1s
+  initial_concurrency_limit: 30
+)EOF");
+  EXPECT_FALSE(status_or.ok());
+  EXPECT_THAT(status_or.status().message(),
+              testing::HasSubstr("mismatched AdaptiveConcurrencyPerRoute with same stat_prefix"));
+}
+
+// Once no route refers to the controller of a stat_prefix any more, it can be configured anew.
+TEST_F(AdaptiveConcurrencyPerRouteConfigTest, ReleasedStatPrefixCanBeReconfigured) {
+  makeRouteConfig(VegasRouteConfig);
+  auto route = makeRouteConfig(R"EOF(
+stat_prefix: route_a
+vegas_controller_config:
+  concurrency_update_interval: 0.1s
+  initial_concurrency_limit: 30
+)EOF");
+  ASSERT_NE(route, nullptr);
+  EXPECT_EQ(30, route->controller()->concurrencyLimit());
+}
+
+// The controller owns main-thread timers, so the request that drops the last reference to it on a
+// worker hands its deletion to the main thread's dispatcher.
+TEST_F(AdaptiveConcurrencyPerRouteConfigTest, ControllerIsDeletedOnMainThread) {
+  auto route = makeRouteConfig(VegasRouteConfig);
+  ASSERT_NE(route, nullptr);
+  ConcurrencyControllerSharedPtr request_controller = route->controller();
+  route.reset();
+
+  EXPECT_CALL(context_.dispatcher_, deleteInDispatcherThread(_))
+      .WillOnce([](const Event::DispatcherThreadDeletableConstPtr& deletable) {
+        EXPECT_NE(deletable, nullptr);
+      });
+  request_controller.reset();
+}
+
+} // namespace
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,254 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.h"
+#include "envoy/extensions/filters/http/adaptive_concurrency/v3/adaptive_concurrency.pb.validate.h"
+
+#include "source/extensions/filters/http/adaptive_concurrency/controller/controller.h"
+#include "source/extensions/filters/http/adaptive_concurrency/controller/sharded_latency_histogram.h"
+#include "source/extensions/filters/http/adaptive_concurrency/controller/vegas_controller.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace AdaptiveConcurrency {
+namespace Controller {
+namespace {
+
+VegasControllerConfig makeConfig(const std::string& yaml_config) {
+  envoy::extensions::filters::http::adaptive_concurrency::v3::VegasControllerConfig proto;
+  TestUtility::loadFromYamlAndValidate(yaml_config, proto);
+  return VegasControllerConfig{proto};
+}
+
+class VegasControllerTest : public testing::Test {
+public:
+  VegasControllerTest()
+      : api_(Api::createApiForTest(time_system_)),
+        dispatcher_(api_->allocateDispatcher("test_thread")) {}
+
+  std::shared_ptr<VegasController> makeController(const std::string& yaml_config) {
+    auto controller = std::make_shared<VegasController>(
+        makeConfig(yaml_config), *dispatcher_, "test_prefix.", *stats_.rootScope(), time_system_);
+
+    // Advance time so that the latency sample calculations don't underflow if monotonic time is 0.
+    time_system_.advanceTimeAndRun(std::chrono::hours(42), *dispatcher_,
+                                   Event::Dispatcher::RunType::Block);
+
+    return controller;
+  }
+
+protected:
+  // Forwards a number of concurrent requests, samples them with the given latency, then ends the
+  // interval.
+  void sampleInterval(const std::shared_ptr<VegasController>& controller,
+                      std::chrono::milliseconds latency, int concurrent_requests = 12) {
+    for (int i = 0; i < concurrent_requests; ++i) {
+      EXPECT_EQ(RequestForwardingAction::Forward, controller->forwardingDecision());
+    }
+    for (int i = 0; i < concurrent_requests; ++i) {
+      controller->recordLatencySample(time_system_.monotonicTime() - latency);
+    }
+    time_system_.advanceTimeAndRun(std::chrono::milliseconds(100), *dispatcher_,
+                                   Event::Dispatcher::RunType::Block);
+  }
+
+  uint64_t gaugeValue(const std::string& name) {
+    return stats_.gauge(absl::StrCat("test_prefix.", name), Stats::Gauge::ImportMode::NeverImport)
+        .value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::TestUtil::TestStore stats_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+};
+
+TEST(VegasControllerConfigTest, BasicTest) {
+  const std::string yaml = R"EOF(
+concurrency_update_interval: 0.123s
+initial_concurrency_limit: 50
+min_concurrency_limit: 5
+max_concurrency_limit: 500
+sample_aggregate_percentile:
+  value: 90
+min_rtt_reset_interval: 30s
+)EOF";
+
+  auto config = makeConfig(yaml);
+
+  EXPECT_EQ(config.sampleRTTCalcInterval(), std::chrono::milliseconds(123));
+  EXPECT_EQ(config.initialConcurrencyLimit(), 50);
+  EXPECT_EQ(config.minConcurrencyLimit(), 5);
+  EXPECT_EQ(config.maxConcurrencyLimit(), 500);
+  EXPECT_EQ(config.sampleAggregatePercentile(), .9);
+  EXPECT_EQ(config.minRTTResetInterval(), std::chrono::seconds(30));
+}
+
+TEST(VegasControllerConfigTest, DefaultValuesTest) {
+  const std::string yaml = R"EOF(
+concurrency_update_interval: 0.1s
+)EOF";
+
+  auto config = makeConfig(yaml);
+
+  EXPECT_EQ(config.sampleRTTCalcInterval(), std::chrono::milliseconds(100));
+  EXPECT_EQ(config.initialConcurrencyLimit(), 20);
+  EXPECT_EQ(config.minConcurrencyLimit(), 3);
+  EXPECT_EQ(config.maxConcurrencyLimit(), 1000);
+  EXPECT_EQ(config.sampleAggregatePercentile(), .5);
+  EXPECT_EQ(config.minRTTResetInterval(), std::chrono::seconds(60));
+}
+
+TEST(VegasControllerConfigTest, InvalidConfigTest) {
+  EXPECT_THROW_WITH_MESSAGE(makeConfig(R"EOF(
+concurrency_update_interval: 0.0001s
+)EOF"),
+                            EnvoyException,
+                            "adaptive_concurrency: `concurrency_update_interval` must be at least "
+                            "1ms");
+  EXPECT_THROW_WITH_MESSAGE(makeConfig(R"EOF(
+concurrency_update_interval: 0.1s
+min_concurrency_limit: 10
+max_concurrency_limit: 5
+)EOF"),
+                            EnvoyException,
+                            "adaptive_concurrency: `min_concurrency_limit` is greater than "
+                            "`max_concurrency_limit`");
+}
+
+TEST_F(VegasControllerTest, BlockAtConcurrencyLimit) {
+  auto controller = makeController(R"EOF(
+concurrency_update_interval: 0.1s
+initial_concurrency_limit: 3
+)EOF");
+  EXPECT_EQ(3, controller->concurrencyLimit());
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(RequestForwardingAction::Forward, controller->forwardingDecision());
+  }
+  EXPECT_EQ(RequestForwardingAction::Block, controller->forwardingDecision());
+  EXPECT_EQ(1, stats_.counter("test_prefix.rq_blocked").value());
+
+  // A sampled or cancelled request frees up its slot.
+  controller->cancelLatencySample();
+  EXPECT_EQ(RequestForwardingAction::Forward, controller->forwardingDecision());
+}
+
+TEST_F(VegasControllerTest, IncreaseLimitWithoutQueueing) {
+  auto controller = makeController(R"EOF(
+concurrency_update_interval: 0.1s
+max_concurrency_limit: 22
+)EOF");
+  EXPECT_EQ(20, controller->concurrencyLimit());
+
+  // An interval without samples leaves the limit unchanged.
+  time_system_.advanceTimeAndRun(std::chrono::milliseconds(100), *dispatcher_,
+                                 Event::Dispatcher::RunType::Block);
+  EXPECT_EQ(20, controller->concurrencyLimit());
+
+  // The latency does not grow, so the limit increases until it reaches the maximum.
+  sampleInterval(controller, std::chrono::milliseconds(5));
+  EXPECT_EQ(5, gaugeValue("min_rtt_msecs"));
+  EXPECT_EQ(21, controller->concurrencyLimit());
+  sampleInterval(controller, std::chrono::milliseconds(5));
+  EXPECT_EQ(22, controller->concurrencyLimit());
+  sampleInterval(controller, std::chrono::milliseconds(5));
+  EXPECT_EQ(22, controller->concurrencyLimit());
+  EXPECT_EQ(22, gaugeValue("concurrency_limit"));
+}
+
+TEST_F(VegasControllerTest, LightLoadDoesNotIncreaseLimit) {
+  auto controller = makeController(R"EOF(
+concurrency_update_interval: 0.1s
+)EOF");
+
+  // Fewer than half of the limit's requests are ever outstanding at once, so the short queue
+  // does not show that the upstream could take more.
+  sampleInterval(controller, std::chrono::milliseconds(5), 9);
+  EXPECT_EQ(20, controller->concurrencyLimit());
+  sampleInterval(controller, std::chrono::milliseconds(5), 10);
+  EXPECT_EQ(21, controller->concurrencyLimit());
+}
+
+TEST_F(VegasControllerTest, DecreaseLimitWithQueueing) {
+  auto controller = makeController(R"EOF(
+concurrency_update_interval: 0.1s
+min_concurrency_limit: 18
+)EOF");
+
+  sampleInterval(controller, std::chrono::milliseconds(5));
+  EXPECT_EQ(21, controller->concurrencyLimit());
+
+  // The latency grows tenfold, so most of the outstanding requests are queued and the limit
+  // decreases until it reaches the minimum.
+  sampleInterval(controller, std::chrono::milliseconds(50));
+  EXPECT_EQ(5, gaugeValue("min_rtt_msecs"));
+  EXPECT_EQ(50, gaugeValue("sample_rtt_msecs"));
+  EXPECT_EQ(19, controller->concurrencyLimit());
+  sampleInterval(controller, std::chrono::milliseconds(50));
+  EXPECT_EQ(18, controller->concurrencyLimit());
+  sampleInterval(controller, std::chrono::milliseconds(50));
+  EXPECT_EQ(18, controller->concurrencyLimit());
+}
+
+TEST_F(VegasControllerTest, MinRTTReset) {
+  auto controller = makeController(R"EOF(
+concurrency_update_interval: 0.1s
+min_rtt_reset_interval: 1s
+)EOF");
+
+  sampleInterval(controller, std::chrono::milliseconds(5));
+  EXPECT_EQ(5, gaugeValue("min_rtt_msecs"));
+
+  // The minRTT is kept until it is reset, and then follows the latency of the upstream.
+  for (int i = 0; i < 9; ++i) {
+    sampleInterval(controller, std::chrono::milliseconds(20));
+    EXPECT_EQ(5, gaugeValue("min_rtt_msecs"));
+  }
+  sampleInterval(controller, std::chrono::milliseconds(20));
+  EXPECT_EQ(20, gaugeValue("min_rtt_msecs"));
+}
+
+TEST(ShardedLatencyHistogramTest, MergeAndClear) {
+  ShardedLatencyHistogram samples;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&samples]() {
+      for (int j = 0; j < 100; ++j) {
+        samples.insert(std::chrono::microseconds(1000));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(400, samples.sampleCount());
+
+  LatencyHistogramPtr histogram(hist_fast_alloc(), hist_free);
+  samples.mergeInto(histogram.get());
+  EXPECT_EQ(400, hist_sample_count(histogram.get()));
+  EXPECT_EQ(0, samples.sampleCount());
+
+  samples.insert(std::chrono::microseconds(1000));
+  EXPECT_EQ(1, samples.sampleCount());
+  samples.clear();
+  EXPECT_EQ(0, samples.sampleCount());
+  samples.mergeInto(histogram.get());
+  EXPECT_EQ(400, hist_sample_count(histogram.get()));
+}
+
+} // namespace
+} // namespace Controller
+} // namespace AdaptiveConcurrency
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -3,6 +3,7 @@
 #include "source/extensions/filters/http/bandwidth_limit/bandwidth_limit.h"
 
 #include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -630,6 +631,188 @@ TEST_F(FilterTest, WithTrailersNoEndStream) {
   EXPECT_EQ("50", response_trailers_.get_("bandwidth-response-filter-delay-ms"));
 }
 
+TEST_F(FilterTest, FairQueuingInvalidConfig) {
+  envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit config;
+  TestUtility::loadFromYaml(R"(
+  stat_prefix: test
+  limit_kbps: 1
+  fair_queuing: true
+  )",
+                            config);
+  auto config_or_status =
+      FilterConfig::create(config, *stats_.rootScope(), runtime_, time_system_, true);
+  EXPECT_EQ(config_or_status.status().message(),
+            "fair_queuing and per_connection_limit_kbps can not be set for per route filter "
+            "config");
+
+  TestUtility::loadFromYaml(R"(
+  stat_prefix: test
+  limit_kbps: 1
+  per_connection_limit_kbps: 1
+  )",
+                            config);
+  config_or_status = FilterConfig::create(config, *stats_.rootScope(), runtime_, time_system_);
+  EXPECT_EQ(config_or_status.status().message(),
+            "per_connection_limit_kbps requires fair_queuing to be set");
+}
+
+class FairQueuingTest : public testing::Test {
+public:
+  struct Stream {
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_filter_callbacks_;
+    NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_filter_callbacks_;
+    std::shared_ptr<BandwidthLimiter> filter_;
+  };
+
+  void setup(const std::string& yaml) {
+    envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit config;
+    TestUtility::loadFromYaml(yaml, config);
+    fill_timer_ = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+    auto config_or_status =
+        FilterConfig::create(config, *stats_.rootScope(), runtime_, time_system_, false, &tls_);
+    EXPECT_TRUE(config_or_status.ok());
+    config_ = *config_or_status;
+    EXPECT_TRUE(config_->fairQueuing());
+
+    for (Stream& stream : streams_) {
+      stream.filter_ = std::make_shared<BandwidthLimiter>(config_);
+      stream.filter_->setDecoderFilterCallbacks(stream.decoder_filter_callbacks_);
+      stream.filter_->setEncoderFilterCallbacks(stream.encoder_filter_callbacks_);
+    }
+  }
+
+  uint64_t findCounter(const std::string& name) {
+    const auto counter = TestUtility::findCounter(stats_, name);
+    return counter != nullptr ? counter->value() : 0;
+  }
+
+  NiceMock<Stats::IsolatedStoreImpl> stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Event::MockTimer* fill_timer_{};
+  std::shared_ptr<FilterConfig> config_;
+  std::array<Stream, 2> streams_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+  Event::SimulatedTimeSystem time_system_;
+};
+
+TEST_F(FairQueuingTest, ShareLimitAcrossStreams) {
+  setup(R"(
+  stat_prefix: test
+  enable_mode: REQUEST
+  limit_kbps: 1
+  fair_queuing: true
+  )");
+
+  // Both streams queue more data than the limit allows on a fill interval.
+  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(0), _));
+  for (Stream& stream : streams_) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream.filter_->decodeHeaders(request_headers_, false));
+    Buffer::OwnedImpl data(std::string(100, 'a'));
+    EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer,
+              stream.filter_->decodeData(data, true));
+  }
+
+  // The first stream gets the tokens of the first fill interval.
+  EXPECT_CALL(streams_[0].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, false));
+  EXPECT_CALL(streams_[1].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, _))
+      .Times(0);
+  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(50), _));
+  fill_timer_->invokeCallback();
+  EXPECT_EQ(0, findCounter("test.http_bandwidth_limit.request_enforced"));
+
+  // The second stream, which got no tokens, is served first on the next fill interval.
+  time_system_.advanceTimeWait(std::chrono::milliseconds(50));
+  EXPECT_CALL(streams_[0].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, _))
+      .Times(0);
+  EXPECT_CALL(streams_[1].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, false));
+  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(50), _));
+  fill_timer_->invokeCallback();
+  EXPECT_EQ(1, findCounter("test.http_bandwidth_limit.request_enforced"));
+
+  // Once the bucket is refilled both streams are drained.
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_CALL(streams_[0].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, true));
+  EXPECT_CALL(streams_[1].decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, true));
+  EXPECT_CALL(*fill_timer_, enableTimer(_, _)).Times(0);
+  fill_timer_->invokeCallback();
+  EXPECT_EQ(3, findCounter("test.http_bandwidth_limit.request_enforced"));
+  EXPECT_EQ(200, findCounter("test.http_bandwidth_limit.request_allowed_total_size"));
+
+  for (Stream& stream : streams_) {
+    stream.filter_->onDestroy();
+  }
+}
+
+TEST_F(FairQueuingTest, PerConnectionLimit) {
+  setup(R"(
+  stat_prefix: test
+  enable_mode: RESPONSE
+  limit_kbps: 100
+  fair_queuing: true
+  per_connection_limit_kbps: 1
+  )");
+
+  Stream& stream = streams_[0];
+  Http::TestResponseHeaderMapImpl response_headers;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream.filter_->encodeHeaders(response_headers, false));
+  EXPECT_TRUE(stream.decoder_filter_callbacks_.stream_info_.filterState()->hasDataWithName(
+      PerConnectionTokenBucket::key()));
+
+  // The limit of the filter allows the whole response, but not the one of the connection.
+  Buffer::OwnedImpl data(std::string(100, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, stream.filter_->encodeData(data, true));
+  EXPECT_CALL(stream.encoder_filter_callbacks_, injectEncodedDataToFilterChain(_, false));
+  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(50), _));
+  fill_timer_->invokeCallback();
+
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_CALL(stream.encoder_filter_callbacks_, injectEncodedDataToFilterChain(_, true));
+  fill_timer_->invokeCallback();
+  EXPECT_EQ(100, findCounter("test.http_bandwidth_limit.response_allowed_total_size"));
+
+  stream.filter_->onDestroy();
+}
+
+TEST_F(FairQueuingTest, RouteLimit) {
+  setup(R"(
+  stat_prefix: test
+  enable_mode: REQUEST
+  limit_kbps: 100
+  fair_queuing: true
+  )");
+
+  envoy::extensions::filters::http::bandwidth_limit::v3::BandwidthLimit route_proto_config;
+  TestUtility::loadFromYaml(R"(
+  stat_prefix: route
+  enable_mode: REQUEST
+  limit_kbps: 1
+  )",
+                            route_proto_config);
+  auto route_config =
+      *FilterConfig::create(route_proto_config, *stats_.rootScope(), runtime_, time_system_, true);
+
+  Stream& stream = streams_[0];
+  ON_CALL(*stream.decoder_filter_callbacks_.route_, mostSpecificPerFilterConfig(_))
+      .WillByDefault(Return(route_config.get()));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream.filter_->decodeHeaders(request_headers_, false));
+
+  // The data is subject to the limit of the route as well as the one of the filter.
+  Buffer::OwnedImpl data(std::string(100, 'a'));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, stream.filter_->decodeData(data, true));
+  EXPECT_CALL(stream.decoder_filter_callbacks_, injectDecodedDataToFilterChain(_, false));
+  EXPECT_CALL(*fill_timer_, enableTimer(std::chrono::milliseconds(50), _));
+  fill_timer_->invokeCallback();
+
+  // Destroying the stream removes it from the shaper.
+  EXPECT_CALL(*fill_timer_, disableTimer());
+  stream.filter_->onDestroy();
+  EXPECT_EQ(1, findCounter("route.http_bandwidth_limit.request_enabled"));
+}
+
 } // namespace BandwidthLimitFilter
 } // namespace HttpFilters
 } // namespace Extensions
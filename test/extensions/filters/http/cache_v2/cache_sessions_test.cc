@@ -129,10 +129,12 @@ protected:
         {"host", "test_host"}, {":path", std::string{path}}, {":scheme", "https"}};
   }
 
-  ActiveLookupRequestPtr testLookupRequest(Http::RequestHeaderMap& headers) {
+  ActiveLookupRequestPtr testLookupRequest(Http::RequestHeaderMap& headers,
+                                           uint64_t slice_size = 0) {
     return std::make_unique<ActiveLookupRequest>(
         headers, mockUpstreamFactory(), "test_cluster", *dispatcher_,
-        api_->timeSource().systemTime(), mock_cacheable_response_checker_, cache_sessions_, false);
+        api_->timeSource().systemTime(), mock_cacheable_response_checker_, cache_sessions_, false,
+        slice_size);
   }
 
   ActiveLookupRequestPtr testLookupRequest(absl::string_view path) {
@@ -146,6 +148,13 @@ protected:
     return testLookupRequest(headers);
   }
 
+  ActiveLookupRequestPtr testLookupSlicedRangeRequest(absl::string_view path, int start, int end,
+                                                      uint64_t slice_size) {
+    auto headers = requestHeaders(path);
+    headers.addCopy("range", absl::StrCat("bytes=", start, "-", end));
+    return testLookupRequest(headers, slice_size);
+  }
+
   ActiveLookupRequestPtr testLookupRequestWithNoCache(absl::string_view path) {
     auto headers = requestHeaders(path);
     headers.addCopy("cache-control", "no-cache");
@@ -207,6 +216,11 @@ inline constexpr auto LookupHasKey = [](const auto& m) {
 
 inline constexpr auto LookupHasPath = [](const auto& m) { return LookupHasKey(KeyHasPath(m)); };
 
+inline constexpr auto KeyHasSlice = [](const auto& begin, const auto& length) {
+  return AllOf(Property("slice_begin", &Key::slice_begin, begin),
+               Property("slice_length", &Key::slice_length, length));
+};
+
 inline constexpr auto RangeIs = [](const auto& m1, const auto& m2) {
   return AllOf(Property("begin", &AdjustedByteRange::begin, m1),
                Property("end", &AdjustedByteRange::end, m2));
@@ -841,6 +855,163 @@ TEST_F(CacheSessionsTest, RangeRequestWhenLengthIsUnknownReturnsNotSatisfiable)
   Mock::VerifyAndClearExpectations(&headers_callback1);
 }
 
+Http::ResponseHeaderMapPtr cacheableSliceHeaders(uint64_t begin, uint64_t end,
+                                                 uint64_t complete_length) {
+  auto h = cacheableResponseHeaders(end - begin);
+  h->setStatus("206");
+  h->addCopy("content-range", absl::StrCat("bytes ", begin, "-", end - 1, "/", complete_length));
+  h->addCopy("etag", "\"v1\"");
+  return h;
+}
+
+TEST_F(CacheSessionsTest, SlicedRangeRequestIsServedFromCachedSlices) {
+  EXPECT_CALL(*mock_http_cache_, touch).Times(AnyNumber());
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasKey(KeyHasSlice(100, 100)), _));
+  ActiveLookupResultPtr result;
+  cache_sessions_->lookup(testLookupSlicedRangeRequest("/a", 150, 249, 100),
+                          [&result](ActiveLookupResultPtr r) { result = std::move(r); });
+  pumpDispatcher();
+  auto slice_hit = [this](std::unique_ptr<MockCacheReader> reader, uint64_t begin, uint64_t end) {
+    ResponseMetadata metadata;
+    metadata.response_time_ = api_->timeSource().systemTime();
+    consumeCallback(captured_lookup_callbacks_.back())(LookupResult{
+        std::move(reader),
+        cacheableSliceHeaders(begin, end, 300),
+        nullptr,
+        std::move(metadata),
+        end - begin,
+    });
+    pumpDispatcher();
+  };
+  auto reader1 = std::make_unique<MockCacheReader>();
+  MockCacheReader* mock_reader1 = reader1.get();
+  slice_hit(std::move(reader1), 100, 200);
+  ASSERT_THAT(result, NotNull());
+  EXPECT_THAT(result->status_, Eq(CacheEntryStatus::Hit));
+  MockFunction<void(Http::ResponseHeaderMapPtr, EndStream)> header_callback;
+  EXPECT_CALL(header_callback,
+              Call(Pointee(AllOf(HasHeader(":status", "206"), HasHeader("content-length", "100"),
+                                 HasHeader("content-range", "bytes 150-249/300"))),
+                   EndStream::More));
+  result->http_source_->getHeaders(header_callback.AsStdFunction());
+  pumpDispatcher();
+
+  // The first part of the range is read from the middle of the first slice.
+  MockFunction<void(Buffer::InstancePtr, EndStream)> body_callback1, body_callback2;
+  EXPECT_CALL(*mock_reader1, getBody(_, RangeIs(50, 100), _))
+      .WillOnce([&](Event::Dispatcher&, AdjustedByteRange, GetBodyCallback cb) {
+        cb(std::make_unique<Buffer::OwnedImpl>(std::string(50, 'b')), EndStream::More);
+      });
+  EXPECT_CALL(body_callback1,
+              Call(Pointee(BufferStringEqual(std::string(50, 'b'))), EndStream::More));
+  result->http_source_->getBody(AdjustedByteRange(150, 250), body_callback1.AsStdFunction());
+  pumpDispatcher();
+
+  // The rest is read from the start of the next slice, which is looked up separately.
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasKey(KeyHasSlice(200, 100)), _));
+  result->http_source_->getBody(AdjustedByteRange(200, 250), body_callback2.AsStdFunction());
+  pumpDispatcher();
+  auto reader2 = std::make_unique<MockCacheReader>();
+  EXPECT_CALL(*reader2, getBody(_, RangeIs(0, 50), _))
+      .WillOnce([&](Event::Dispatcher&, AdjustedByteRange, GetBodyCallback cb) {
+        cb(std::make_unique<Buffer::OwnedImpl>(std::string(50, 'c')), EndStream::More);
+      });
+  EXPECT_CALL(body_callback2,
+              Call(Pointee(BufferStringEqual(std::string(50, 'c'))), EndStream::More));
+  slice_hit(std::move(reader2), 200, 300);
+}
+
+TEST_F(CacheSessionsTest, SlicedRangeRequestMissRequestsTheSliceFromUpstream) {
+  EXPECT_CALL(*mock_http_cache_, touch).Times(AnyNumber());
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasKey(KeyHasSlice(0, 100)), _));
+  ActiveLookupResultPtr result;
+  cache_sessions_->lookup(testLookupSlicedRangeRequest("/a", 10, 19, 100),
+                          [&result](ActiveLookupResultPtr r) { result = std::move(r); });
+  pumpDispatcher();
+  // Cache miss.
+  consumeCallback(captured_lookup_callbacks_[0])(LookupResult{});
+  pumpDispatcher();
+  ASSERT_THAT(fake_upstreams_.size(), Eq(1));
+  // The upstream request asks for the whole slice rather than the client's range.
+  EXPECT_THAT(fake_upstream_sent_headers_[0],
+              Pointee(AllOf(IsSupersetOfHeaders(Http::TestRequestHeaderMapImpl{{":path", "/a"}}),
+                            HasHeader("range", "bytes=0-99"))));
+  auto response_headers = cacheableSliceHeaders(0, 100, 1000);
+  EXPECT_CALL(*mock_http_cache_,
+              insert(_, KeyHasSlice(0, 100), Pointee(IsSupersetOfHeaders(*response_headers)), _,
+                     NotNull(), _));
+  consumeCallback(fake_upstream_get_headers_callbacks_[0])(
+      Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*response_headers), EndStream::More);
+  pumpDispatcher();
+}
+
+TEST_F(CacheSessionsTest, SlicedRangeRequestPassesThroughResponseThatIsNotASlice) {
+  EXPECT_CALL(*mock_http_cache_, touch).Times(AnyNumber());
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasKey(KeyHasSlice(0, 100)), _));
+  ActiveLookupResultPtr result;
+  cache_sessions_->lookup(testLookupSlicedRangeRequest("/a", 10, 19, 100),
+                          [&result](ActiveLookupResultPtr r) { result = std::move(r); });
+  pumpDispatcher();
+  // Cache miss.
+  consumeCallback(captured_lookup_callbacks_[0])(LookupResult{});
+  pumpDispatcher();
+  ASSERT_THAT(fake_upstreams_.size(), Eq(1));
+  // The upstream ignores the range header, so its response is not cached.
+  EXPECT_CALL(*mock_http_cache_, insert).Times(0);
+  consumeCallback(fake_upstream_get_headers_callbacks_[0])(cacheableResponseHeaders(1000),
+                                                           EndStream::More);
+  pumpDispatcher();
+  ASSERT_THAT(result, NotNull());
+  EXPECT_THAT(result->status_, Eq(CacheEntryStatus::Uncacheable));
+  // The complete response is narrowed to the requested range.
+  MockFunction<void(Http::ResponseHeaderMapPtr, EndStream)> header_callback;
+  EXPECT_CALL(header_callback,
+              Call(Pointee(AllOf(HasHeader(":status", "206"), HasHeader("content-length", "10"),
+                                 HasHeader("content-range", "bytes 10-19/1000"))),
+                   EndStream::More));
+  result->http_source_->getHeaders(header_callback.AsStdFunction());
+  pumpDispatcher();
+  // The bytes before the range are read from the upstream and discarded.
+  EXPECT_CALL(*fake_upstreams_[0], getBody(RangeIs(0, 10), _))
+      .WillOnce([](AdjustedByteRange, GetBodyCallback&& cb) {
+        cb(std::make_unique<Buffer::OwnedImpl>(std::string(10, 'a')), EndStream::More);
+      });
+  EXPECT_CALL(*fake_upstreams_[0], getBody(RangeIs(10, 20), _))
+      .WillOnce([](AdjustedByteRange, GetBodyCallback&& cb) {
+        cb(std::make_unique<Buffer::OwnedImpl>(std::string(10, 'b')), EndStream::More);
+      });
+  MockFunction<void(Buffer::InstancePtr, EndStream)> body_callback;
+  EXPECT_CALL(body_callback,
+              Call(Pointee(BufferStringEqual(std::string(10, 'b'))), EndStream::More));
+  result->http_source_->getBody(AdjustedByteRange(10, 20), body_callback.AsStdFunction());
+  pumpDispatcher();
+}
+
+TEST_F(CacheSessionsTest, SlicedRangeRequestPassesThroughResponseOfUnknownLengthUnchanged) {
+  EXPECT_CALL(*mock_http_cache_, touch).Times(AnyNumber());
+  EXPECT_CALL(*mock_http_cache_, lookup(LookupHasKey(KeyHasSlice(0, 100)), _));
+  ActiveLookupResultPtr result;
+  cache_sessions_->lookup(testLookupSlicedRangeRequest("/a", 10, 19, 100),
+                          [&result](ActiveLookupResultPtr r) { result = std::move(r); });
+  pumpDispatcher();
+  // Cache miss.
+  consumeCallback(captured_lookup_callbacks_[0])(LookupResult{});
+  pumpDispatcher();
+  ASSERT_THAT(fake_upstreams_.size(), Eq(1));
+  EXPECT_CALL(*mock_http_cache_, insert).Times(0);
+  consumeCallback(fake_upstream_get_headers_callbacks_[0])(cacheableResponseHeaders(absl::nullopt),
+                                                           EndStream::More);
+  pumpDispatcher();
+  ASSERT_THAT(result, NotNull());
+  // Without a content-length the requested range can't be located, so the
+  // response is served as is.
+  MockFunction<void(Http::ResponseHeaderMapPtr, EndStream)> header_callback;
+  EXPECT_CALL(header_callback,
+              Call(Pointee(AllOf(HasHeader(":status", "200"), HasNoHeader("content-range"))),
+                   EndStream::More));
+  result->http_source_->getHeaders(header_callback.AsStdFunction());
+}
+
 // TODO: UpdateHeadersSkipSpecificHeaders
 // TODO: Vary
 
@@ -328,6 +328,33 @@ TEST(GetRangeDetailsTest, NotSatisfiableRange) {
   ASSERT_TRUE(result->ranges_.empty());
 }
 
+TEST(ParseContentRangeTest, ValidContentRange) {
+  absl::optional<ContentRange> result = RangeUtils::parseContentRange("bytes 100-199/1000");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->range_, AdjustedByteRange(100, 200));
+  EXPECT_EQ(result->complete_length_, 1000);
+}
+
+TEST(ParseContentRangeTest, InvalidContentRangeReturnsEmpty) {
+  for (absl::string_view content_range :
+       {"", "bytes", "bytes 100-199", "bytes 100-199/*", "bytes */1000", "bytes 200-100/1000",
+        "bytes 100-1000/1000", "bytes 100-199/1000 ", "bits 100-199/1000", "bytes -199/1000"}) {
+    EXPECT_FALSE(RangeUtils::parseContentRange(content_range).has_value()) << content_range;
+  }
+}
+
+TEST(ParseContentRangeTest, FromResponseHeaders) {
+  Envoy::Http::TestResponseHeaderMapImpl headers{{":status", "206"},
+                                                 {"content-range", "bytes 0-9/10"}};
+  absl::optional<ContentRange> result = RangeUtils::parseContentRange(headers);
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->range_, AdjustedByteRange(0, 10));
+  EXPECT_EQ(result->complete_length_, 10);
+
+  headers.addCopy("content-range", "bytes 0-9/10");
+  EXPECT_FALSE(RangeUtils::parseContentRange(headers).has_value());
+}
+
 // operator<<(ostream&, const AdjustedByteRange&) is only used in tests, but lives in //source,
 // and so needs test coverage. This test provides that coverage, to keep the coverage test happy.
 TEST(AdjustedByteRange, StreamingTest) {
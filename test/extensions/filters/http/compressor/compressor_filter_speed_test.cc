@@ -11,6 +11,7 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/utility.h"
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
@@ -106,9 +107,13 @@ struct CompressionParams {
 
 CompressorFilterConfigSharedPtr makeGzipConfig(Stats::IsolatedStoreImpl& stats,
                                                testing::NiceMock<Runtime::MockLoader>& runtime,
-                                               const CompressionParams& params) {
+                                               const CompressionParams& params,
+                                               bool with_response_cache = false) {
 
   envoy::extensions::filters::http::compressor::v3::Compressor compressor;
+  if (with_response_cache) {
+    compressor.mutable_response_direction_config()->mutable_compressed_response_cache();
+  }
 
   const auto level =
       static_cast<Compression::Gzip::Compressor::ZlibCompressorImpl::CompressionLevel>(
@@ -120,8 +125,9 @@ CompressorFilterConfigSharedPtr makeGzipConfig(Stats::IsolatedStoreImpl& stats,
   const auto memory_level = params.memory_level;
   Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory =
       std::make_unique<MockGzipCompressorFactory>(level, strategy, window_bits, memory_level);
+  Api::ApiPtr api = Api::createApiForTest();
   CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
-      compressor, "test.", *stats.rootScope(), runtime, std::move(compressor_factory));
+      compressor, "test.", *stats.rootScope(), runtime, *api, std::move(compressor_factory));
 
   return config;
 }
@@ -136,8 +142,9 @@ CompressorFilterConfigSharedPtr makeZstdConfig(Stats::IsolatedStoreImpl& stats,
   const auto strategy = params.strategy;
   Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory =
       std::make_unique<MockZstdCompressorFactory>(level, strategy);
+  Api::ApiPtr api = Api::createApiForTest();
   CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
-      compressor, "test.", *stats.rootScope(), runtime, std::move(compressor_factory));
+      compressor, "test.", *stats.rootScope(), runtime, *api, std::move(compressor_factory));
 
   return config;
 }
@@ -151,8 +158,9 @@ CompressorFilterConfigSharedPtr makeBrotliConfig(Stats::IsolatedStoreImpl& stats
   const auto quality = params.level;
   Envoy::Compression::Compressor::CompressorFactoryPtr compressor_factory =
       std::make_unique<MockBrotliCompressorFactory>(quality);
+  Api::ApiPtr api = Api::createApiForTest();
   CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
-      compressor, "test.", *stats.rootScope(), runtime, std::move(compressor_factory));
+      compressor, "test.", *stats.rootScope(), runtime, *api, std::move(compressor_factory));
 
   return config;
 }
@@ -432,6 +440,98 @@ BENCHMARK(compressChunks1024WithGzip)
     ->UseManualTime()
     ->Unit(benchmark::kMillisecond);
 
+// Passes a response through a filter whose configuration has a compressed response cache.
+// The response carries a strong ETag, so all but the first response for a configuration are
+// served from the cache rather than compressed.
+static Result
+serveWithResponseCache(const CompressorFilterConfigSharedPtr& config,
+                       std::vector<Buffer::OwnedImpl>&& chunks,
+                       NiceMock<Http::MockStreamDecoderFilterCallbacks>& decoder_callbacks,
+                       benchmark::State& state) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto filter = std::make_unique<CompressorFilter>(config);
+  filter->setDecoderFilterCallbacks(decoder_callbacks);
+
+  Http::TestRequestHeaderMapImpl headers = {
+      {":method", "get"}, {":authority", "example.com"}, {":path", "/app.json"},
+      {"accept-encoding", "gzip"}};
+  filter->decodeHeaders(headers, false);
+
+  Http::TestResponseHeaderMapImpl response_headers = {
+      {":method", "get"},
+      {"content-length", "122880"},
+      {"content-type", "application/json;charset=utf-8"},
+      {"etag", "\"v1\""}};
+  filter->encodeHeaders(response_headers, false);
+
+  uint64_t idx = 0;
+  Result res;
+  for (auto& data : chunks) {
+    res.total_uncompressed_bytes += data.length();
+    filter->encodeData(data, idx == (chunks.size() - 1));
+    res.total_compressed_bytes += data.length();
+    ++idx;
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+  state.SetIterationTime(elapsed.count());
+
+  return res;
+}
+
+// Compare with compressFullWithGzip and compressChunks1024WithGzip: the same responses, served
+// from the compressed response cache.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void responseCacheHitFullWithGzip(benchmark::State& state) {
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  Stats::IsolatedStoreImpl stats;
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  ON_CALL(runtime.snapshot_, featureEnabled("test.filter_enabled", 100))
+      .WillByDefault(Return(true));
+  const auto& params = gzip_compression_params[state.range(0)];
+  CompressorFilterConfigSharedPtr config = makeGzipConfig(stats, runtime, params, true);
+  // Fill the cache.
+  serveWithResponseCache(config, generateChunks(1, 122880), decoder_callbacks, state);
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    std::vector<Buffer::OwnedImpl> chunks = generateChunks(1, 122880);
+    serveWithResponseCache(config, std::move(chunks), decoder_callbacks, state);
+  }
+  EXPECT_EQ(state.iterations(),
+            stats.counterFromString("test.compressor..gzip.response.cache.hit").value());
+}
+BENCHMARK(responseCacheHitFullWithGzip)
+    ->DenseRange(0, 8, 1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void responseCacheHitChunks1024WithGzip(benchmark::State& state) {
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  Stats::IsolatedStoreImpl stats;
+  testing::NiceMock<Runtime::MockLoader> runtime;
+  ON_CALL(runtime.snapshot_, featureEnabled("test.filter_enabled", 100))
+      .WillByDefault(Return(true));
+  const auto& params = gzip_compression_params[state.range(0)];
+  CompressorFilterConfigSharedPtr config = makeGzipConfig(stats, runtime, params, true);
+  // Fill the cache.
+  serveWithResponseCache(config, generateChunks(120, 1024), decoder_callbacks, state);
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    std::vector<Buffer::OwnedImpl> chunks = generateChunks(120, 1024);
+    serveWithResponseCache(config, std::move(chunks), decoder_callbacks, state);
+  }
+  EXPECT_EQ(state.iterations(),
+            stats.counterFromString("test.compressor..gzip.response.cache.hit").value());
+}
+BENCHMARK(responseCacheHitChunks1024WithGzip)
+    ->DenseRange(0, 8, 1)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
 static constexpr CompressionParams zstd_compression_params[] = {
     // level1 + default
     {1, 0, 0, 0},
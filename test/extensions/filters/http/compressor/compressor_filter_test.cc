@@ -27,22 +27,39 @@ using testing::Return;
 
 class TestCompressorFactory : public Envoy::Compression::Compressor::CompressorFactory {
 public:
-  TestCompressorFactory(const std::string& content_encoding)
-      : content_encoding_(content_encoding) {}
+  TestCompressorFactory(const std::string& content_encoding,
+                        bool supports_shared_dictionaries = true)
+      : content_encoding_(content_encoding),
+        supports_shared_dictionaries_(supports_shared_dictionaries) {}
 
   Envoy::Compression::Compressor::CompressorPtr createCompressor() override {
     auto compressor = std::make_unique<Compression::Compressor::MockCompressor>();
     EXPECT_CALL(*compressor, compress(_, _)).Times(expected_compress_calls_);
     return compressor;
   }
+  Envoy::Compression::Compressor::CompressorPtr
+  createCompressorForContentLength(uint64_t content_length) override {
+    content_lengths_.push_back(content_length);
+    return createCompressor();
+  }
   const std::string& statsPrefix() const override { CONSTRUCT_ON_FIRST_USE(std::string, "test."); }
   const std::string& contentEncoding() const override { return content_encoding_; }
+  Envoy::Compression::Compressor::CompressorFactoryPtr
+  createSharedDictionaryCompressorFactory(absl::string_view, absl::string_view) override {
+    return supports_shared_dictionaries_
+               ? std::make_unique<TestCompressorFactory>("dc" + content_encoding_)
+               : nullptr;
+  }
 
   void setExpectedCompressCalls(uint32_t calls) { expected_compress_calls_ = calls; }
+  // The content lengths passed to createCompressorForContentLength().
+  const std::vector<uint64_t>& contentLengths() const { return content_lengths_; }
 
 private:
+  std::vector<uint64_t> content_lengths_;
   uint32_t expected_compress_calls_{1};
   const std::string content_encoding_;
+  const bool supports_shared_dictionaries_;
 };
 
 class CompressorFilterTest : public testing::Test {
@@ -71,8 +88,8 @@ public:
     TestUtility::loadFromJson(json, compressor);
     auto compressor_factory = std::make_unique<TestCompressorFactory>("test");
     compressor_factory_ = compressor_factory.get();
-    config_ = std::make_shared<CompressorFilterConfig>(compressor, "test.", *stats_.rootScope(),
-                                                       runtime_, std::move(compressor_factory));
+    config_ = std::make_shared<CompressorFilterConfig>(
+        compressor, "test.", *stats_.rootScope(), runtime_, *api_, std::move(compressor_factory));
     filter_ = std::make_unique<CompressorFilter>(config_);
     filter_->setDecoderFilterCallbacks(decoder_callbacks_);
     filter_->setEncoderFilterCallbacks(encoder_callbacks_);
@@ -186,6 +203,7 @@ public:
   std::string response_stats_prefix_{};
   Stats::TestUtil::TestStore stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  Api::ApiPtr api_{Api::createApiForTest()};
   NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
   NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
   NiceMock<StreamInfo::MockStreamInfo> stream_info_;
@@ -301,6 +319,28 @@ TEST_F(CompressorFilterTest, CompressRequest) {
   doResponseNoCompression(headers);
 }
 
+TEST_F(CompressorFilterTest, ContentLengthIsPassedToCompressorFactory) {
+  setUpFilter(R"EOF(
+{
+  "request_direction_config": {},
+  "response_direction_config": {},
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  }
+}
+)EOF");
+  response_stats_prefix_ = "response.";
+  doRequestCompression(
+      {{":method", "post"}, {"accept-encoding", "deflate, test"}, {"content-length", "256"}},
+      false);
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"content-length", "512"}};
+  doResponseCompression(headers, false);
+  EXPECT_THAT(compressor_factory_->contentLengths(), testing::ElementsAre(256, 512));
+}
+
 TEST_F(CompressorFilterTest, CompressRequestAndResponseNoContentLength) {
   setUpFilter(R"EOF(
 {
@@ -318,6 +358,7 @@ TEST_F(CompressorFilterTest, CompressRequestAndResponseNoContentLength) {
   doRequestCompression({{":method", "post"}, {"accept-encoding", "deflate, test"}}, false);
   Http::TestResponseHeaderMapImpl headers{{":status", "200"}};
   doResponseCompression(headers, false);
+  EXPECT_TRUE(compressor_factory_->contentLengths().empty());
 }
 
 TEST_F(CompressorFilterTest, CompressRequestWithTrailers) {
@@ -995,7 +1036,8 @@ protected:
     auto compressor_factory1 = std::make_unique<TestCompressorFactory>("test1");
     compressor_factory1->setExpectedCompressCalls(0);
     auto config1 = std::make_shared<CompressorFilterConfig>(
-        compressor, "test1.", *stats1_.rootScope(), runtime_, std::move(compressor_factory1));
+        compressor, "test1.", *stats1_.rootScope(), runtime_, *api_,
+        std::move(compressor_factory1));
     filter1_ = std::make_unique<CompressorFilter>(config1);
 
     TestUtility::loadFromJson(R"EOF(
@@ -1012,11 +1054,13 @@ protected:
     auto compressor_factory2 = std::make_unique<TestCompressorFactory>("test2");
     compressor_factory2->setExpectedCompressCalls(0);
     auto config2 = std::make_shared<CompressorFilterConfig>(
-        compressor, "test2.", *stats2_.rootScope(), runtime_, std::move(compressor_factory2));
+        compressor, "test2.", *stats2_.rootScope(), runtime_, *api_,
+        std::move(compressor_factory2));
     filter2_ = std::make_unique<CompressorFilter>(config2);
   }
 
   NiceMock<Runtime::MockLoader> runtime_;
+  Api::ApiPtr api_{Api::createApiForTest()};
   Stats::TestUtil::TestStore stats1_;
   Stats::TestUtil::TestStore stats2_;
   std::unique_ptr<CompressorFilter> filter1_;
@@ -1118,7 +1162,8 @@ protected:
                               compressor);
     auto compressor_factory1 = std::make_unique<TestCompressorFactory>("test1");
     auto config1 = std::make_shared<CompressorFilterConfig>(
-        compressor, "test1.", *stats1_.rootScope(), runtime_, std::move(compressor_factory1));
+        compressor, "test1.", *stats1_.rootScope(), runtime_, *api_,
+        std::move(compressor_factory1));
     filter1_ = std::make_unique<CompressorFilter>(config1);
 
     TestUtility::loadFromJson(fmt::format(R"EOF(
@@ -1136,7 +1181,8 @@ protected:
                               compressor);
     auto compressor_factory2 = std::make_unique<TestCompressorFactory>("test2");
     auto config2 = std::make_shared<CompressorFilterConfig>(
-        compressor, "test2.", *stats2_.rootScope(), runtime_, std::move(compressor_factory2));
+        compressor, "test2.", *stats2_.rootScope(), runtime_, *api_,
+        std::move(compressor_factory2));
     filter2_ = std::make_unique<CompressorFilter>(config2);
   }
 
@@ -1391,6 +1437,377 @@ TEST_F(CompressorPerRouteLibraryTest, GetCompressorFactoryUsesPerRoute) {
   EXPECT_EQ(per_route_factory.contentEncoding(), "test");
 }
 
+class CompressedResponseCacheTest : public CompressorFilterTest {
+public:
+  void SetUp() override { setUpCache(R"EOF({})EOF"); }
+
+  void setUpCache(const std::string& cache_json) {
+    setUpFilter(fmt::format(R"EOF(
+{{
+  "compressor_library": {{
+     "name": "test",
+     "typed_config": {{
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }}
+  }},
+  "response_direction_config": {{
+    "compressed_response_cache": {}
+  }}
+}}
+)EOF",
+                            cache_json));
+  }
+
+  // Passes a request for path and the given response through a new filter instance sharing the
+  // configuration, and returns the response body the filter sends. The test compressor leaves
+  // the body unchanged.
+  std::string doCachedResponse(const std::string& path,
+                               Http::TestResponseHeaderMapImpl&& response_headers,
+                               const std::string& body) {
+    startCachedResponse(path, response_headers);
+    Buffer::OwnedImpl data(body);
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+    return data.toString();
+  }
+
+  void startCachedResponse(const std::string& path,
+                           Http::TestResponseHeaderMapImpl& response_headers) {
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    Http::TestRequestHeaderMapImpl request_headers{
+        {":authority", "example.com"}, {":path", path}, {"accept-encoding", "test"}};
+    extra_request_headers_.iterate([&request_headers](const Http::HeaderEntry& header) {
+      request_headers.addCopy(Http::LowerCaseString(header.key().getStringView()),
+                              header.value().getStringView());
+      return Http::HeaderMap::Iterate::Continue;
+    });
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter_->encodeHeaders(response_headers, false));
+    EXPECT_EQ("test", response_headers.get_("content-encoding"));
+  }
+
+  void expectNotCached(const Http::TestResponseHeaderMapImpl& response_headers) {
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_EQ("body", doCachedResponse(
+                            "/app.js", Http::TestResponseHeaderMapImpl(response_headers), "body"));
+    }
+  }
+
+  // Added to the request headers of every response passed through the filter.
+  Http::TestRequestHeaderMapImpl extra_request_headers_;
+
+  uint64_t cacheCounter(absl::string_view name) {
+    return stats_.counter(absl::StrCat("test.compressor.test.test.response.cache.", name)).value();
+  }
+  uint64_t cacheGauge(absl::string_view name) {
+    return stats_
+        .gauge(absl::StrCat("test.compressor.test.test.response.cache.", name),
+               Stats::Gauge::ImportMode::Accumulate)
+        .value();
+  }
+};
+
+TEST_F(CompressedResponseCacheTest, ServesRepeatedResponseFromCache) {
+  EXPECT_EQ("first body", doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}},
+                                           "first body"));
+  EXPECT_EQ(1, cacheCounter("miss"));
+  EXPECT_EQ(1, cacheCounter("insert"));
+  EXPECT_EQ(10, cacheGauge("size_bytes"));
+  // The same validator identifies the same body, so the cached body is sent in place of the
+  // upstream one, which is not compressed.
+  EXPECT_EQ("first body", doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}},
+                                           "other body!"));
+  EXPECT_EQ(1, cacheCounter("hit"));
+  EXPECT_EQ(11, cacheCounter("uncompressed_bytes_saved"));
+  EXPECT_EQ(10,
+            stats_.counter("test.compressor.test.test.response.total_uncompressed_bytes").value());
+  EXPECT_EQ(2, stats_.counter("test.compressor.test.test.response.compressed").value());
+}
+
+TEST_F(CompressedResponseCacheTest, DifferentValidatorOrPathMisses) {
+  doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}}, "first body");
+  EXPECT_EQ("second body",
+            doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v2\""}}, "second body"));
+  EXPECT_EQ("third body",
+            doCachedResponse("/lib.js", {{":status", "200"}, {"etag", "\"v1\""}}, "third body"));
+  EXPECT_EQ(0, cacheCounter("hit"));
+  EXPECT_EQ(3, cacheCounter("miss"));
+}
+
+TEST_F(CompressedResponseCacheTest, LastModifiedDoesNotIdentifyBody) {
+  // The body may change more than once within the second that Last-Modified resolves.
+  expectNotCached({{":status", "200"}, {"last-modified", "Tue, 15 Nov 1994 12:45:26 GMT"}});
+  expectNotCached({{":status", "200"},
+                   {"etag", "W/\"v1\""},
+                   {"last-modified", "Tue, 15 Nov 1994 12:45:26 GMT"}});
+  EXPECT_EQ(0, cacheCounter("hit"));
+  EXPECT_EQ(0, cacheCounter("miss"));
+}
+
+TEST_F(CompressedResponseCacheTest, ResponsesToRequestsWithCredentialsAreNotCached) {
+  extra_request_headers_ = Http::TestRequestHeaderMapImpl{{"authorization", "Bearer token"}};
+  expectNotCached({{":status", "200"}, {"etag", "\"v1\""}});
+  extra_request_headers_ = Http::TestRequestHeaderMapImpl{{"cookie", "session=1"}};
+  expectNotCached({{":status", "200"}, {"etag", "\"v1\""}});
+  EXPECT_EQ(0, cacheCounter("hit"));
+  EXPECT_EQ(0, cacheCounter("miss"));
+}
+
+TEST_F(CompressedResponseCacheTest, UnidentifiedOrPrivateResponsesAreNotCached) {
+  expectNotCached({{":status", "200"}});
+  expectNotCached({{":status", "200"}, {"etag", "W/\"v1\""}});
+  expectNotCached(
+      {{":status", "200"}, {"etag", "\"v1\""}, {"cache-control", "private, max-age=60"}});
+  expectNotCached({{":status", "200"}, {"etag", "\"v1\""}, {"cache-control", "no-store"}});
+  expectNotCached({{":status", "200"}, {"etag", "\"v1\""}, {"vary", "accept-encoding, cookie"}});
+  EXPECT_EQ(0, cacheCounter("hit"));
+  EXPECT_EQ(0, cacheCounter("miss"));
+  // Varying only on the encoding the filter handles does not prevent caching.
+  doCachedResponse("/app.js",
+                   {{":status", "200"}, {"etag", "\"v1\""}, {"vary", "Accept-Encoding"}}, "body");
+  EXPECT_EQ(1, cacheCounter("insert"));
+}
+
+TEST_F(CompressedResponseCacheTest, PartialResponsesAreNotCached) {
+  // Two ranges of the same length of one resource must not share a cache entry.
+  EXPECT_EQ("first part", doCachedResponse("/app.js",
+                                           {{":status", "206"},
+                                            {"etag", "\"v1\""},
+                                            {"content-length", "10"},
+                                            {"content-range", "bytes 0-9/20"}},
+                                           "first part"));
+  EXPECT_EQ("other part", doCachedResponse("/app.js",
+                                           {{":status", "206"},
+                                            {"etag", "\"v1\""},
+                                            {"content-length", "10"},
+                                            {"content-range", "bytes 10-19/20"}},
+                                           "other part"));
+  expectNotCached({{":status", "200"}, {"etag", "\"v1\""}, {"content-range", "bytes 0-3/4"}});
+  expectNotCached({{":status", "203"}, {"etag", "\"v1\""}});
+  EXPECT_EQ(0, cacheCounter("hit"));
+  EXPECT_EQ(0, cacheCounter("miss"));
+}
+
+TEST_F(CompressedResponseCacheTest, OversizedBodyIsNotCached) {
+  setUpCache(R"EOF({"max_entry_size_bytes": 8})EOF");
+  doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}}, "longer than eight");
+  EXPECT_EQ(1, cacheCounter("insert_rejected"));
+  EXPECT_EQ("longer than eight",
+            doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}},
+                             "longer than eight"));
+  EXPECT_EQ(2, cacheCounter("miss"));
+}
+
+TEST_F(CompressedResponseCacheTest, EvictsLeastRecentlyUsed) {
+  setUpCache(R"EOF({"max_cache_size_bytes": 25})EOF");
+  doCachedResponse("/a", {{":status", "200"}, {"etag", "\"v1\""}}, "aaaaaaaaaa");
+  doCachedResponse("/b", {{":status", "200"}, {"etag", "\"v1\""}}, "bbbbbbbbbb");
+  // Using /a makes /b the least recently used.
+  doCachedResponse("/a", {{":status", "200"}, {"etag", "\"v1\""}}, "aaaaaaaaaa");
+  doCachedResponse("/c", {{":status", "200"}, {"etag", "\"v1\""}}, "cccccccccc");
+  EXPECT_EQ(1, cacheCounter("eviction"));
+  EXPECT_EQ(2, cacheGauge("size_count"));
+  EXPECT_EQ(20, cacheGauge("size_bytes"));
+  doCachedResponse("/a", {{":status", "200"}, {"etag", "\"v1\""}}, "aaaaaaaaaa");
+  EXPECT_EQ(2, cacheCounter("hit"));
+  doCachedResponse("/b", {{":status", "200"}, {"etag", "\"v1\""}}, "bbbbbbbbbb");
+  EXPECT_EQ(2, cacheCounter("hit"));
+}
+
+TEST_F(CompressedResponseCacheTest, ResponsesWithTrailersAreCachedAndServed) {
+  // The body is compressed, then the compressor is flushed when the trailers arrive.
+  compressor_factory_->setExpectedCompressCalls(2);
+  Http::TestResponseHeaderMapImpl miss_headers{{":status", "200"}, {"etag", "\"v1\""}};
+  startCachedResponse("/app.js", miss_headers);
+  Buffer::OwnedImpl data("first body");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, false));
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true));
+  Http::TestResponseTrailerMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+  EXPECT_EQ(1, cacheCounter("insert"));
+
+  // A hit with no body before the trailers sends the cached body with them.
+  Http::TestResponseHeaderMapImpl hit_headers{{":status", "200"}, {"etag", "\"v1\""}};
+  startCachedResponse("/app.js", hit_headers);
+  Buffer::OwnedImpl sent;
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+      .WillOnce(Invoke([&](Buffer::Instance& added, bool) { sent.move(added); }));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+  EXPECT_EQ("first body", sent.toString());
+  EXPECT_EQ(1, cacheCounter("hit"));
+}
+
+TEST_F(CompressedResponseCacheTest, CachedBodyIsSentOnceInPlaceOfFirstChunk) {
+  doCachedResponse("/app.js", {{":status", "200"}, {"etag", "\"v1\""}}, "first body");
+  Http::TestResponseHeaderMapImpl headers{{":status", "200"}, {"etag", "\"v1\""}};
+  startCachedResponse("/app.js", headers);
+  Buffer::OwnedImpl chunk1("first");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(chunk1, false));
+  EXPECT_EQ("first body", chunk1.toString());
+  Buffer::OwnedImpl chunk2(" body");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(chunk2, true));
+  EXPECT_EQ("", chunk2.toString());
+  EXPECT_EQ(10, cacheCounter("uncompressed_bytes_saved"));
+}
+
+TEST_F(CompressedResponseCacheTest, PerRouteCompressorLibraryBypassesCache) {
+  CompressorPerRoute per_route_proto;
+  TestUtility::loadFromJson(R"EOF(
+{
+  "overrides": {
+    "compressor_library": {
+      "name": "gzip",
+      "typed_config": {
+        "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+      }
+    }
+  }
+}
+)EOF",
+                            per_route_proto);
+  auto per_route_config =
+      std::make_unique<CompressorPerRouteFilterConfig>(per_route_proto, factory_context_);
+  ON_CALL(decoder_callbacks_, mostSpecificPerFilterConfig())
+      .WillByDefault(Return(per_route_config.get()));
+  filter_ = std::make_unique<CompressorFilter>(config_);
+  filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+  filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":authority", "example.com"}, {":path", "/app.js"}, {"accept-encoding", "gzip"}};
+  filter_->decodeHeaders(request_headers, true);
+  Http::TestResponseHeaderMapImpl response_headers{{":status", "200"}, {"etag", "\"v1\""}};
+  filter_->encodeHeaders(response_headers, false);
+  EXPECT_EQ("gzip", response_headers.get_("content-encoding"));
+  EXPECT_EQ(0, cacheCounter("miss"));
+}
+
+class SharedDictionaryTest : public CompressorFilterTest {
+public:
+  void SetUp() override {
+    setUpFilter(std::string(sharedDictionaryConfig()));
+    response_stats_prefix_ = "response.";
+  }
+
+  static constexpr absl::string_view sharedDictionaryConfig() {
+    return R"EOF(
+{
+  "compressor_library": {
+     "name": "test",
+     "typed_config": {
+       "@type": "type.googleapis.com/envoy.extensions.compression.gzip.compressor.v3.Gzip"
+     }
+  },
+  "response_direction_config": {
+    "shared_dictionaries": [
+      {
+        "dictionary": { "inline_string": "dictionary" },
+        "path": "/dictionaries/app",
+        "match": "/app/*.js",
+        "id": "v1"
+      }
+    ]
+  }
+}
+)EOF";
+  }
+
+  // The Available-Dictionary header of a client holding "dictionary".
+  const std::string available_dictionary_{":F3ynD0Le8SOONtoylHMmPtP+rdFAlMB5oiML4Bk0NvU=:"};
+
+  uint64_t responseCounter(absl::string_view name) {
+    return stats_.counter(absl::StrCat("test.compressor.test.test.response.", name)).value();
+  }
+};
+
+TEST_F(SharedDictionaryTest, ServesDictionary) {
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+      .WillOnce(Invoke([](Http::ResponseHeaderMap& headers, bool) {
+        EXPECT_EQ("200", headers.getStatusValue());
+        EXPECT_EQ("10", headers.getContentLengthValue());
+        EXPECT_EQ("match=\"/app/*.js\", id=\"v1\"",
+                  headers.get(Http::LowerCaseString("use-as-dictionary"))[0]->value()
+                      .getStringView());
+        EXPECT_EQ("max-age=86400",
+                  headers.get(Http::LowerCaseString("cache-control"))[0]->value().getStringView());
+      }));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, true))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) {
+        EXPECT_EQ("dictionary", data.toString());
+      }));
+  Http::TestRequestHeaderMapImpl headers{
+      {":method", "GET"}, {":path", "/dictionaries/app?v=1"}, {"accept-encoding", "test"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->decodeHeaders(headers, true));
+  EXPECT_EQ(1, responseCounter("shared_dictionary_served"));
+}
+
+TEST_F(SharedDictionaryTest, ServesDictionaryHeadersOnHead) {
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, true));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, _)).Times(0);
+  Http::TestRequestHeaderMapImpl headers{{":method", "HEAD"}, {":path", "/dictionaries/app"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter_->decodeHeaders(headers, true));
+}
+
+TEST_F(SharedDictionaryTest, OtherMethodsAreForwarded) {
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+  Http::TestRequestHeaderMapImpl headers{{":method", "POST"}, {":path", "/dictionaries/app"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+}
+
+TEST_F(SharedDictionaryTest, CompressesAgainstAvailableDictionary) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                 {":path", "/app/main.js"},
+                                                 {"accept-encoding", "test, dctest"},
+                                                 {"available-dictionary", available_dictionary_}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            filter_->encodeHeaders(response_headers, false));
+  EXPECT_EQ("dctest", response_headers.get_("content-encoding"));
+  EXPECT_EQ("Accept-Encoding, Available-Dictionary", response_headers.get_("vary"));
+  populateBuffer(1000);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data_, true));
+  EXPECT_EQ(1, responseCounter("shared_dictionary_used"));
+  EXPECT_EQ(1, responseCounter("compressed"));
+}
+
+TEST_F(SharedDictionaryTest, DictionaryEncodingNotAccepted) {
+  Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                 {":path", "/app/main.js"},
+                                                 {"accept-encoding", "test, dctest;q=0"},
+                                                 {"available-dictionary", available_dictionary_}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  doResponseCompression(response_headers, false);
+  EXPECT_EQ(0, responseCounter("shared_dictionary_used"));
+}
+
+TEST_F(SharedDictionaryTest, UnknownDictionary) {
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "GET"},
+      {":path", "/app/main.js"},
+      {"accept-encoding", "test, dctest"},
+      {"available-dictionary", ":pZGm1Av0IEBKARczz7exkNYsZb8LzaMrV7J32a2fFG4=:"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, true));
+  Http::TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  doResponseCompression(response_headers, false);
+  EXPECT_EQ(1, responseCounter("shared_dictionary_unknown"));
+  EXPECT_EQ(0, responseCounter("shared_dictionary_used"));
+}
+
+TEST_F(SharedDictionaryTest, UnsupportedCompressorLibrary) {
+  envoy::extensions::filters::http::compressor::v3::Compressor compressor;
+  TestUtility::loadFromJson(std::string(sharedDictionaryConfig()), compressor);
+  EXPECT_THROW_WITH_MESSAGE(
+      std::make_shared<CompressorFilterConfig>(
+          compressor, "test.", *stats_.rootScope(), runtime_, *api_,
+          std::make_unique<TestCompressorFactory>("test", false)),
+      EnvoyException,
+      "compressor library 'test' cannot compress against the shared dictionary served at "
+      "'/dictionaries/app'");
+}
+
 } // namespace
 } // namespace Compressor
 } // namespace HttpFilters
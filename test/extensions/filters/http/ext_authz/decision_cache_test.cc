@@ -0,0 +1,233 @@
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/ext_authz/decision_cache.h"
+
+#include "test/mocks/router/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExtAuthz {
+namespace {
+
+using Filters::Common::ExtAuthz::CheckStatus;
+using Filters::Common::ExtAuthz::Response;
+using testing::NiceMock;
+
+class DecisionCacheTest : public testing::Test {
+protected:
+  void initialize(const std::string& yaml) {
+    DecisionCache::Config config;
+    TestUtility::loadFromYaml(yaml, config);
+    cache_ = std::make_unique<DecisionCache>(config, "test.", *stats_store_.rootScope(), tls_,
+                                             time_system_);
+  }
+
+  static Response response(CheckStatus status) {
+    Response response{};
+    response.status = status;
+    return response;
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  Event::SimulatedTimeSystem time_system_;
+  std::unique_ptr<DecisionCache> cache_;
+  DecisionCache::ContextExtensionsMap no_extensions_;
+};
+
+TEST_F(DecisionCacheTest, Key) {
+  initialize(R"EOF(
+  key_headers: ["authorization", "x-tenant"]
+  ttl: 10s
+  )EOF");
+  NiceMock<Router::MockRoute> route;
+  const Http::TestRequestHeaderMapImpl headers{
+      {":method", "GET"}, {":path", "/foo?a=b"}, {"authorization", "alice"}};
+  const std::string key = cache_->makeKey(headers, &route, no_extensions_);
+  EXPECT_EQ(key, cache_->makeKey(headers, &route, no_extensions_));
+
+  // The path is part of the key, so that unnamed routes don't share decisions, but its query
+  // string is not.
+  Http::TestRequestHeaderMapImpl other_query = headers;
+  other_query.setPath("/foo?a=c");
+  EXPECT_EQ(key, cache_->makeKey(other_query, &route, no_extensions_));
+  Http::TestRequestHeaderMapImpl other_path = headers;
+  other_path.setPath("/bar?a=b");
+  EXPECT_NE(key, cache_->makeKey(other_path, &route, no_extensions_));
+  EXPECT_NE(cache_->makeKey(headers, nullptr, no_extensions_),
+            cache_->makeKey(other_path, nullptr, no_extensions_));
+
+  Http::TestRequestHeaderMapImpl other_method = headers;
+  other_method.setMethod("POST");
+  EXPECT_NE(key, cache_->makeKey(other_method, &route, no_extensions_));
+
+  // An empty header is told apart from an absent one.
+  Http::TestRequestHeaderMapImpl empty_tenant = headers;
+  empty_tenant.addCopy("x-tenant", "");
+  EXPECT_NE(key, cache_->makeKey(empty_tenant, &route, no_extensions_));
+
+  DecisionCache::ContextExtensionsMap extensions;
+  extensions["scope"] = "admin";
+  EXPECT_NE(key, cache_->makeKey(headers, &route, extensions));
+
+  NiceMock<Router::MockRoute> other_route;
+  other_route.route_name_ = "other";
+  EXPECT_NE(key, cache_->makeKey(headers, &other_route, no_extensions_));
+}
+
+TEST_F(DecisionCacheTest, Ttl) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  ttl_header: "x-authz-ttl"
+  ttl_metadata_field: "ttl"
+  )EOF");
+  cache_->insert("default", response(CheckStatus::OK));
+  Response from_header = response(CheckStatus::OK);
+  from_header.headers_to_set = {{"X-Authz-Ttl", "20"}};
+  cache_->insert("header", from_header);
+  Response from_metadata = response(CheckStatus::OK);
+  (*from_metadata.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(30);
+  cache_->insert("metadata", from_metadata);
+  // Errors, and denials without negative caching, are not cached.
+  cache_->insert("error", response(CheckStatus::Error));
+  cache_->insert("denied", response(CheckStatus::Denied));
+  EXPECT_EQ(3, cache_->stats().insert_.value());
+
+  EXPECT_NE(nullptr, cache_->lookup("default"));
+  EXPECT_EQ(nullptr, cache_->lookup("error"));
+  EXPECT_EQ(nullptr, cache_->lookup("denied"));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(nullptr, cache_->lookup("default"));
+  EXPECT_NE(nullptr, cache_->lookup("header"));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(nullptr, cache_->lookup("header"));
+  EXPECT_NE(nullptr, cache_->lookup("metadata"));
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(nullptr, cache_->lookup("metadata"));
+  EXPECT_EQ(3, cache_->stats().hit_.value());
+  EXPECT_EQ(5, cache_->stats().miss_.value());
+}
+
+TEST_F(DecisionCacheTest, TtlHeaderOfDenial) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  denied_ttl: 1s
+  ttl_header: "x-authz-ttl"
+  )EOF");
+  // The headers of a denied response are appended to the local reply.
+  Response added = response(CheckStatus::Denied);
+  added.headers_to_add = {{"x-authz-ttl", "5"}};
+  cache_->insert("added", added);
+  Response appended = response(CheckStatus::Denied);
+  appended.headers_to_append = {{"x-authz-ttl", "5"}};
+  cache_->insert("appended", appended);
+  time_system_.advanceTimeWait(std::chrono::seconds(4));
+  EXPECT_NE(nullptr, cache_->lookup("added"));
+  EXPECT_NE(nullptr, cache_->lookup("appended"));
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ(nullptr, cache_->lookup("added"));
+  EXPECT_EQ(nullptr, cache_->lookup("appended"));
+}
+
+TEST_F(DecisionCacheTest, TtlIsClamped) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  ttl_header: "x-authz-ttl"
+  ttl_metadata_field: "ttl"
+  )EOF");
+  Response from_header = response(CheckStatus::OK);
+  from_header.headers_to_set = {{"x-authz-ttl", "18446744073709551615"}};
+  cache_->insert("header", from_header);
+  Response huge = response(CheckStatus::OK);
+  (*huge.dynamic_metadata.mutable_fields())["ttl"] = ValueUtil::numberValue(1e300);
+  cache_->insert("huge", huge);
+  Response infinite = response(CheckStatus::OK);
+  (*infinite.dynamic_metadata.mutable_fields())["ttl"] =
+      ValueUtil::numberValue(std::numeric_limits<double>::infinity());
+  cache_->insert("infinite", infinite);
+  // NaN is not a valid number of seconds, so the configured TTL applies.
+  Response nan = response(CheckStatus::OK);
+  (*nan.dynamic_metadata.mutable_fields())["ttl"] =
+      ValueUtil::numberValue(std::numeric_limits<double>::quiet_NaN());
+  cache_->insert("nan", nan);
+
+  time_system_.advanceTimeWait(std::chrono::hours(24));
+  EXPECT_NE(nullptr, cache_->lookup("header"));
+  EXPECT_NE(nullptr, cache_->lookup("huge"));
+  EXPECT_NE(nullptr, cache_->lookup("infinite"));
+  EXPECT_EQ(nullptr, cache_->lookup("nan"));
+  time_system_.advanceTimeWait(std::chrono::hours(24 * 365));
+  EXPECT_EQ(nullptr, cache_->lookup("header"));
+  EXPECT_EQ(nullptr, cache_->lookup("huge"));
+  EXPECT_EQ(nullptr, cache_->lookup("infinite"));
+}
+
+TEST_F(DecisionCacheTest, NegativeCaching) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  denied_ttl: 1s
+  )EOF");
+  cache_->insert("denied", response(CheckStatus::Denied));
+  DecisionCache::ResponseConstSharedPtr cached = cache_->lookup("denied");
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(CheckStatus::Denied, cached->status);
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_EQ(nullptr, cache_->lookup("denied"));
+}
+
+TEST_F(DecisionCacheTest, EvictsLeastRecentlyUsed) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  max_entries: 2
+  )EOF");
+  cache_->insert("a", response(CheckStatus::OK));
+  cache_->insert("b", response(CheckStatus::OK));
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  cache_->insert("c", response(CheckStatus::OK));
+  EXPECT_EQ(1, cache_->stats().eviction_.value());
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(nullptr, cache_->lookup("b"));
+  EXPECT_NE(nullptr, cache_->lookup("c"));
+}
+
+TEST_F(DecisionCacheTest, PerWorkerCache) {
+  initialize(R"EOF(
+  key_headers: ["authorization"]
+  ttl: 10s
+  max_entries: 2
+  per_worker_max_entries: 1
+  )EOF");
+  cache_->insert("a", response(CheckStatus::OK));
+  cache_->insert("b", response(CheckStatus::OK));
+  EXPECT_EQ(1, cache_->stats().eviction_.value());
+
+  // "b" is in both caches, "a" only in the shared cache, and is copied to the worker's on a hit.
+  EXPECT_NE(nullptr, cache_->lookup("b"));
+  EXPECT_EQ(1, cache_->stats().local_hit_.value());
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(1, cache_->stats().local_hit_.value());
+  EXPECT_NE(nullptr, cache_->lookup("a"));
+  EXPECT_EQ(2, cache_->stats().local_hit_.value());
+  EXPECT_EQ(3, cache_->stats().hit_.value());
+
+  // The worker's copy expires with the shared entry.
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_EQ(nullptr, cache_->lookup("a"));
+}
+
+} // namespace
+} // namespace ExtAuthz
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
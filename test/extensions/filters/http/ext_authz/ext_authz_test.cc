@@ -1081,6 +1081,120 @@ TEST_F(HttpFilterTest, StatsWithPrefix) {
                     .value());
 }
 
+// Test that a cached decision is replayed, with its header mutations, without calling the
+// authorization service.
+TEST_F(HttpFilterTest, DecisionCacheReplaysAllowedDecision) {
+  initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  decision_cache:
+    key_headers: ["authorization"]
+    ttl: 60s
+  )EOF");
+  prepareCheck();
+  request_headers_ = Http::TestRequestHeaderMapImpl{
+      {":method", "GET"}, {":path", "/foo"}, {"authorization", "alice"}};
+
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::OK;
+  response.headers_to_set = {{"x-user", "alice"}};
+  EXPECT_CALL(*client_, check(_, _, _, _))
+      .WillOnce(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks,
+                           const envoy::service::auth::v3::CheckRequest&, Tracing::Span&,
+                           const StreamInfo::StreamInfo&) -> void {
+        callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+      }));
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers_, false));
+  EXPECT_EQ("alice", request_headers_.get_("x-user"));
+  EXPECT_EQ(1U, config_->decisionCache()->stats().miss_.value());
+  EXPECT_EQ(1U, config_->decisionCache()->stats().insert_.value());
+
+  // A request with the same key is authorized by the cached decision.
+  auto* client = new NiceMock<Filters::Common::ExtAuthz::MockClient>();
+  EXPECT_CALL(*client, check(_, _, _, _)).Times(0);
+  Filter filter(config_, Filters::Common::ExtAuthz::ClientPtr{client}, factory_context_);
+  filter.setDecoderFilterCallbacks(decoder_filter_callbacks_);
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":path", "/foo"}, {"authorization", "alice"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter.decodeHeaders(request_headers, false));
+  EXPECT_EQ("alice", request_headers.get_("x-user"));
+  EXPECT_EQ(1U, config_->decisionCache()->stats().hit_.value());
+  EXPECT_EQ(2U, config_->stats().ok_.value());
+
+  // A request with another key calls the authorization service.
+  client = new NiceMock<Filters::Common::ExtAuthz::MockClient>();
+  EXPECT_CALL(*client, check(_, _, _, _));
+  Filter other_filter(config_, Filters::Common::ExtAuthz::ClientPtr{client}, factory_context_);
+  other_filter.setDecoderFilterCallbacks(decoder_filter_callbacks_);
+  Http::TestRequestHeaderMapImpl other_request_headers{
+      {":method", "GET"}, {":path", "/foo"}, {"authorization", "bob"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            other_filter.decodeHeaders(other_request_headers, false));
+  EXPECT_EQ(2U, config_->decisionCache()->stats().miss_.value());
+  other_filter.onDestroy();
+}
+
+// Test that denied decisions are only cached when negative caching is configured, and that the
+// authorization response can set how long its decision is cached.
+TEST_F(HttpFilterTest, DecisionCacheDeniedDecision) {
+  initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  decision_cache:
+    key_headers: ["authorization"]
+    ttl: 60s
+    denied_ttl: 5s
+    ttl_header: "x-authz-ttl"
+  )EOF");
+  prepareCheck();
+  request_headers_ = Http::TestRequestHeaderMapImpl{
+      {":method", "GET"}, {":path", "/foo"}, {"authorization", "mallory"}};
+
+  Filters::Common::ExtAuthz::Response response{};
+  response.status = Filters::Common::ExtAuthz::CheckStatus::Denied;
+  response.status_code = Http::Code::Forbidden;
+  response.headers_to_set = {{"x-authz-ttl", "0"}};
+  EXPECT_CALL(*client_, check(_, _, _, _))
+      .WillOnce(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks,
+                           const envoy::service::auth::v3::CheckRequest&, Tracing::Span&,
+                           const StreamInfo::StreamInfo&) -> void {
+        callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+      }));
+  EXPECT_CALL(decoder_filter_callbacks_, sendLocalReply(Http::Code::Forbidden, _, _, _, _));
+  filter_->decodeHeaders(request_headers_, false);
+  // The response asked not to be cached.
+  EXPECT_EQ(0U, config_->decisionCache()->stats().insert_.value());
+
+  response.headers_to_set = {{"x-authz-ttl", "30"}};
+  auto* client = new NiceMock<Filters::Common::ExtAuthz::MockClient>();
+  EXPECT_CALL(*client, check(_, _, _, _))
+      .WillOnce(Invoke([&](Filters::Common::ExtAuthz::RequestCallbacks& callbacks,
+                           const envoy::service::auth::v3::CheckRequest&, Tracing::Span&,
+                           const StreamInfo::StreamInfo&) -> void {
+        callbacks.onComplete(std::make_unique<Filters::Common::ExtAuthz::Response>(response));
+      }));
+  Filter filter(config_, Filters::Common::ExtAuthz::ClientPtr{client}, factory_context_);
+  filter.setDecoderFilterCallbacks(decoder_filter_callbacks_);
+  Http::TestRequestHeaderMapImpl request_headers{
+      {":method", "GET"}, {":path", "/foo"}, {"authorization", "mallory"}};
+  EXPECT_CALL(decoder_filter_callbacks_, sendLocalReply(Http::Code::Forbidden, _, _, _, _));
+  filter.decodeHeaders(request_headers, false);
+  EXPECT_EQ(1U, config_->decisionCache()->stats().insert_.value());
+
+  // The denial is replayed.
+  client = new NiceMock<Filters::Common::ExtAuthz::MockClient>();
+  EXPECT_CALL(*client, check(_, _, _, _)).Times(0);
+  Filter cached_filter(config_, Filters::Common::ExtAuthz::ClientPtr{client}, factory_context_);
+  cached_filter.setDecoderFilterCallbacks(decoder_filter_callbacks_);
+  EXPECT_CALL(decoder_filter_callbacks_, sendLocalReply(Http::Code::Forbidden, _, _, _, _));
+  EXPECT_EQ(Http::FilterHeadersStatus::StopAllIterationAndWatermark,
+            cached_filter.decodeHeaders(request_headers, false));
+  EXPECT_EQ(1U, config_->decisionCache()->stats().hit_.value());
+  EXPECT_EQ(3U, config_->stats().denied_.value());
+}
+
 // Test when failure_mode_allow is set to false and the response from the authorization service is
 // Error that the request is not allowed to continue.
 TEST_F(HttpFilterTest, ErrorFailClose) {
@@ -1338,6 +1452,24 @@ TEST_F(HttpFilterTest, BadConfig) {
                ProtoValidationException);
 }
 
+// Check that caching decisions is rejected when the request body is sent, as it is not part of
+// the cache key.
+TEST_F(HttpFilterTest, DecisionCacheWithRequestBodyIsRejected) {
+  EXPECT_THROW_WITH_MESSAGE(initialize(R"EOF(
+  grpc_service:
+    envoy_grpc:
+      cluster_name: "ext_authz_server"
+  with_request_body:
+    max_request_bytes: 10
+  decision_cache:
+    key_headers: ["authorization"]
+    ttl: 60s
+  )EOF"),
+                            EnvoyException,
+                            "decision_cache cannot be used with with_request_body, as the request "
+                            "body is not part of the cache key.");
+}
+
 // Checks that filter does not initiate the authorization request when the buffer reaches the max
 // request bytes.
 TEST_F(HttpFilterTest, RequestDataIsTooLarge) {
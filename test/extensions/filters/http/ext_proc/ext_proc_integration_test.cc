@@ -31,6 +31,8 @@
 #include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 #include "ocpdiag/core/testing/status_matchers.h"
@@ -4697,6 +4699,87 @@ TEST_P(ExtProcIntegrationTest, AccessLogExtProcInCompositeFilter) {
   EXPECT_THAT(log_content, testing::HasSubstr("response_header_latency_us"));
 }
 
+
+// Concurrent HTTP requests multiplexed over the worker's shared stream are processed on a single
+// gRPC stream of the processor, which may answer them in any order.
+TEST_P(ExtProcIntegrationTest, MultiplexedRequestsShareOneProcessorStream) {
+  proto_config_.mutable_multiplexed_streams();
+  proto_config_.mutable_processing_mode()->set_response_header_mode(ProcessingMode::SKIP);
+  initializeConfig();
+  HttpIntegrationTest::initialize();
+
+  constexpr size_t kRequests = 3;
+  codec_client_ = makeHttpConnection(lookupPort("http"));
+  std::vector<IntegrationStreamDecoderPtr> responses;
+  for (size_t i = 0; i < kRequests; ++i) {
+    Http::TestRequestHeaderMapImpl headers;
+    HttpTestUtility::addDefaultHeaders(headers);
+    headers.setPath(absl::StrCat("/request", i));
+    responses.push_back(codec_client_->makeHeaderOnlyRequest(headers));
+  }
+
+  // The headers of every request arrive on the same stream, tagged with the request.
+  ASSERT_TRUE(grpc_upstreams_[0]->waitForHttpConnection(*dispatcher_, processor_connection_));
+  ASSERT_TRUE(processor_connection_->waitForNewStream(*dispatcher_, processor_stream_));
+  absl::flat_hash_map<uint64_t, std::string> paths;
+  for (size_t i = 0; i < kRequests; ++i) {
+    ProcessingRequest request;
+    ASSERT_TRUE(processor_stream_->waitForGrpcMessage(*dispatcher_, request));
+    ASSERT_TRUE(request.has_request_headers());
+    for (const auto& header : request.request_headers().headers().headers()) {
+      if (header.key() == ":path") {
+        paths[request.multiplexed_stream_id()] = header.raw_value();
+      }
+    }
+  }
+  ASSERT_EQ(kRequests, paths.size());
+
+  // Answer the requests in the reverse order of their identifiers, each with its own mutation.
+  std::vector<uint64_t> ids;
+  for (const auto& [id, path] : paths) {
+    ids.push_back(id);
+  }
+  std::sort(ids.rbegin(), ids.rend());
+  processor_stream_->startGrpcStream();
+  for (const uint64_t id : ids) {
+    ProcessingResponse response;
+    response.set_multiplexed_stream_id(id);
+    auto* header = response.mutable_request_headers()
+                       ->mutable_response()
+                       ->mutable_header_mutation()
+                       ->add_set_headers();
+    header->mutable_header()->set_key("x-processed-path");
+    header->mutable_header()->set_raw_value(paths[id]);
+    processor_stream_->sendGrpcMessage(response);
+  }
+
+  // Each request reaches the upstream with the mutation meant for it.
+  ASSERT_TRUE(fake_upstreams_[0]->waitForHttpConnection(*dispatcher_, fake_upstream_connection_));
+  std::vector<FakeStreamPtr> upstream_requests(kRequests);
+  for (auto& upstream_request : upstream_requests) {
+    ASSERT_TRUE(fake_upstream_connection_->waitForNewStream(*dispatcher_, upstream_request));
+    ASSERT_TRUE(upstream_request->waitForEndStream(*dispatcher_));
+    EXPECT_THAT(upstream_request->headers(),
+                ContainsHeader("x-processed-path", upstream_request->headers().getPathValue()));
+    upstream_request->encodeHeaders(Http::TestResponseHeaderMapImpl{{":status", "200"}}, true);
+  }
+  for (auto& response : responses) {
+    ASSERT_TRUE(response->waitForEndStream());
+    EXPECT_EQ("200", response->headers().getStatusValue());
+  }
+
+  // The processor is told of the completion of each request, on the same stream.
+  absl::flat_hash_set<uint64_t> ended;
+  for (size_t i = 0; i < kRequests; ++i) {
+    ProcessingRequest request;
+    ASSERT_TRUE(processor_stream_->waitForGrpcMessage(*dispatcher_, request));
+    EXPECT_TRUE(request.has_multiplexed_stream_end());
+    ended.insert(request.multiplexed_stream_id());
+  }
+  EXPECT_EQ(kRequests, ended.size());
+  EXPECT_EQ(1, test_server_->counter("http.config_test.ext_proc.shared_streams_started")->value());
+}
+
 } // namespace ExternalProcessing
 } // namespace HttpFilters
 } // namespace Extensions
@@ -0,0 +1,256 @@
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/ext_proc/multiplexed_stream.h"
+
+#include "test/extensions/filters/http/ext_proc/mock_server.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace ExternalProcessing {
+namespace {
+
+using testing::_;
+using testing::Eq;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+// The callbacks of one HTTP request's filter.
+class TestCallbacks : public ExternalProcessorCallbacks {
+public:
+  void onReceiveMessage(std::unique_ptr<ProcessingResponse>&& response) override {
+    responses_.push_back(std::move(response));
+  }
+  void onGrpcError(Grpc::Status::GrpcStatus status, const std::string&) override {
+    grpc_status_ = status;
+  }
+  void onGrpcClose() override {}
+  void logStreamInfo() override {}
+  void onComplete(ProcessingResponse&) override {}
+  void onError() override {}
+
+  std::vector<std::unique_ptr<ProcessingResponse>> responses_;
+  absl::optional<Grpc::Status::GrpcStatus> grpc_status_;
+};
+
+class MultiplexedStreamTest : public testing::Test {
+protected:
+  void setUpPool(uint32_t streams_per_service) {
+    auto client = std::make_unique<MockClient>();
+    client_ = client.get();
+    pool_ = std::make_unique<MultiplexedStreamPool>(
+        std::move(client), streams_per_service,
+        MultiplexedStreamStats{
+            ALL_MULTIPLEXED_STREAM_STATS(POOL_COUNTER_PREFIX(*stats_store_.rootScope(), "test."))},
+        time_system_);
+    service_.mutable_envoy_grpc()->set_cluster_name("ext_proc_server");
+    config_with_hash_key_.setConfig(service_);
+  }
+
+  // Expects a shared stream to be started, recording what is sent on it.
+  void expectSharedStream() {
+    EXPECT_CALL(*client_, start(_, _, _, _))
+        .WillOnce(Invoke([this](ExternalProcessorCallbacks& callbacks,
+                                const Grpc::GrpcServiceConfigWithHashKey&,
+                                Http::AsyncClient::StreamOptions&,
+                                Http::StreamFilterSidestreamWatermarkCallbacks&)
+                             -> ExternalProcessorStreamPtr {
+          const size_t index = shared_callbacks_.size();
+          shared_callbacks_.push_back(&callbacks);
+          auto stream = std::make_unique<NiceMock<MockStream>>();
+          ON_CALL(*stream, send(_, _))
+              .WillByDefault(Invoke([this, index](ProcessingRequest&& request, bool) {
+                sent_.push_back(std::move(request));
+                sent_on_.push_back(index);
+              }));
+          return stream;
+        }))
+        .RetiresOnSaturation();
+  }
+
+  ExternalProcessorStreamPtr start(TestCallbacks& callbacks) {
+    return pool_->start(callbacks, config_with_hash_key_, options_);
+  }
+
+  static std::unique_ptr<ProcessingResponse> response(uint64_t id) {
+    auto response = std::make_unique<ProcessingResponse>();
+    response->mutable_request_headers();
+    response->set_multiplexed_stream_id(id);
+    return response;
+  }
+
+  uint64_t counter(absl::string_view name) {
+    return stats_store_.counterFromString(absl::StrCat("test.", name)).value();
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_store_;
+  MockClient* client_;
+  std::unique_ptr<MultiplexedStreamPool> pool_;
+  envoy::config::core::v3::GrpcService service_;
+  Grpc::GrpcServiceConfigWithHashKey config_with_hash_key_;
+  Http::AsyncClient::StreamOptions options_;
+  std::vector<ExternalProcessorCallbacks*> shared_callbacks_;
+  std::vector<ProcessingRequest> sent_;
+  // The index of the shared stream each message in sent_ was sent on.
+  std::vector<size_t> sent_on_;
+};
+
+TEST_F(MultiplexedStreamTest, RequestsShareOneStream) {
+  setUpPool(1);
+  expectSharedStream();
+  TestCallbacks callbacks1, callbacks2;
+  ExternalProcessorStreamPtr stream1 = start(callbacks1);
+  ExternalProcessorStreamPtr stream2 = start(callbacks2);
+  ASSERT_NE(nullptr, stream1);
+  ASSERT_NE(nullptr, stream2);
+  EXPECT_EQ(1, counter("shared_streams_started"));
+
+  // Messages are tagged with their request.
+  stream1->send(ProcessingRequest(), false);
+  stream2->send(ProcessingRequest(), false);
+  ASSERT_EQ(2, sent_.size());
+  const uint64_t id1 = sent_[0].multiplexed_stream_id();
+  const uint64_t id2 = sent_[1].multiplexed_stream_id();
+  EXPECT_NE(0, id1);
+  EXPECT_NE(0, id2);
+  EXPECT_NE(id1, id2);
+
+  // Responses are routed by their tag, in whatever order they arrive.
+  shared_callbacks_[0]->onReceiveMessage(response(id2));
+  shared_callbacks_[0]->onReceiveMessage(response(id1));
+  EXPECT_EQ(1, callbacks1.responses_.size());
+  EXPECT_EQ(1, callbacks2.responses_.size());
+
+  // Closing a request tells the processor, and its late responses are dropped.
+  EXPECT_TRUE(stream1->close());
+  EXPECT_FALSE(stream1->close());
+  ASSERT_EQ(3, sent_.size());
+  EXPECT_EQ(id1, sent_[2].multiplexed_stream_id());
+  EXPECT_TRUE(sent_[2].has_multiplexed_stream_end());
+  shared_callbacks_[0]->onReceiveMessage(response(id1));
+  EXPECT_EQ(1, callbacks1.responses_.size());
+  EXPECT_EQ(1, counter("multiplexed_msgs_unknown"));
+  stream1->send(ProcessingRequest(), false);
+  EXPECT_EQ(3, sent_.size());
+}
+
+TEST_F(MultiplexedStreamTest, RequestsAreSpreadOverStreams) {
+  setUpPool(2);
+  expectSharedStream();
+  expectSharedStream();
+  TestCallbacks callbacks;
+  ExternalProcessorStreamPtr stream1 = start(callbacks);
+  ExternalProcessorStreamPtr stream2 = start(callbacks);
+  ExternalProcessorStreamPtr stream3 = start(callbacks);
+  EXPECT_EQ(2, counter("shared_streams_started"));
+
+  stream1->send(ProcessingRequest(), false);
+  stream2->send(ProcessingRequest(), false);
+  stream3->send(ProcessingRequest(), false);
+  EXPECT_THAT(sent_on_, testing::ElementsAre(0, 1, 0));
+}
+
+TEST_F(MultiplexedStreamTest, SharedStreamFailureFailsItsRequests) {
+  setUpPool(1);
+  expectSharedStream();
+  TestCallbacks callbacks1, callbacks2;
+  ExternalProcessorStreamPtr stream1 = start(callbacks1);
+  ExternalProcessorStreamPtr stream2 = start(callbacks2);
+  stream2->notifyFilterDestroy();
+
+  shared_callbacks_[0]->onGrpcError(Grpc::Status::Unavailable, "unavailable");
+  EXPECT_EQ(Grpc::Status::Unavailable, callbacks1.grpc_status_);
+  EXPECT_FALSE(callbacks2.grpc_status_.has_value());
+  EXPECT_EQ(1, counter("shared_streams_failed"));
+  // The failed requests no longer use the stream.
+  EXPECT_FALSE(stream1->close());
+  stream1.reset();
+  stream2.reset();
+
+  // The next request opens a new stream, which a clean close by the processor also fails.
+  expectSharedStream();
+  TestCallbacks callbacks3;
+  ExternalProcessorStreamPtr stream3 = start(callbacks3);
+  EXPECT_EQ(2, counter("shared_streams_started"));
+  shared_callbacks_[1]->onGrpcClose();
+  EXPECT_EQ(Grpc::Status::Aborted, callbacks3.grpc_status_);
+}
+
+TEST_F(MultiplexedStreamTest, StartFailureFailsRequest) {
+  setUpPool(1);
+  EXPECT_CALL(*client_, start(_, _, _, _)).WillOnce(Return(nullptr));
+  TestCallbacks callbacks;
+  EXPECT_EQ(nullptr, start(callbacks));
+  EXPECT_EQ(Grpc::Status::Unavailable, callbacks.grpc_status_);
+  EXPECT_EQ(1, counter("shared_streams_failed"));
+  EXPECT_EQ(0, counter("shared_streams_started"));
+}
+
+TEST_F(MultiplexedStreamTest, ClientSendsOnMultiplexedStream) {
+  setUpPool(1);
+  expectSharedStream();
+  TestCallbacks callbacks;
+  ExternalProcessorStreamPtr stream = start(callbacks);
+  MultiplexedProcessorClient client(*pool_);
+  client.sendRequest(ProcessingRequest(), true, 0, nullptr, stream.get());
+  // Ending the stream with the message also ends the request.
+  ASSERT_EQ(2, sent_.size());
+  EXPECT_TRUE(sent_[1].has_multiplexed_stream_end());
+  EXPECT_FALSE(stream->close());
+}
+
+// The processing of each request is traced by a child of the request's span, which lasts until the
+// request is closed.
+TEST_F(MultiplexedStreamTest, RequestSpanIsChildOfParentSpan) {
+  setUpPool(1);
+  expectSharedStream();
+  NiceMock<Tracing::MockSpan> parent_span;
+  options_.setParentSpan(parent_span).setSampled(true);
+  auto* child_span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(parent_span,
+              spawnChild_(_,
+                          "async envoy.service.ext_proc.v3.ExternalProcessor.Process multiplexed "
+                          "egress",
+                          _))
+      .WillOnce(Return(child_span));
+  EXPECT_CALL(*child_span, setTag(Eq(Tracing::Tags::get().UpstreamCluster), Eq("ext_proc_server")));
+  EXPECT_CALL(*child_span,
+              setTag(Eq(Tracing::Tags::get().Component), Eq(Tracing::Tags::get().Proxy)));
+  EXPECT_CALL(*child_span, setSampled(true));
+  TestCallbacks callbacks;
+  ExternalProcessorStreamPtr stream = start(callbacks);
+  ASSERT_NE(nullptr, stream);
+
+  EXPECT_CALL(*child_span, finishSpan());
+  EXPECT_TRUE(stream->close());
+}
+
+TEST_F(MultiplexedStreamTest, RequestSpanRecordsSharedStreamFailure) {
+  setUpPool(1);
+  expectSharedStream();
+  NiceMock<Tracing::MockSpan> parent_span;
+  options_.setParentSpan(parent_span);
+  auto* child_span = new NiceMock<Tracing::MockSpan>();
+  EXPECT_CALL(parent_span, spawnChild_(_, _, _)).WillOnce(Return(child_span));
+  TestCallbacks callbacks;
+  ExternalProcessorStreamPtr stream = start(callbacks);
+  ASSERT_NE(nullptr, stream);
+
+  EXPECT_CALL(*child_span, setTag(Eq(Tracing::Tags::get().GrpcStatusCode), Eq("14")));
+  EXPECT_CALL(*child_span, setTag(Eq(Tracing::Tags::get().Error), Eq(Tracing::Tags::get().True)));
+  EXPECT_CALL(*child_span, finishSpan());
+  shared_callbacks_[0]->onGrpcError(Grpc::Status::Unavailable, "unavailable");
+  EXPECT_EQ(Grpc::Status::Unavailable, callbacks.grpc_status_);
+}
+
+} // namespace
+} // namespace ExternalProcessing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,176 @@
+// Measures the throughput of the gRPC-JSON transcoder filter transcoding messages of 1 KiB,
+// 100 KiB and 10 MiB, received in pieces as they would be from the network.
+
+#include "source/common/grpc/common.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/grpc_json_transcoder/json_transcoder_filter.h"
+
+#include "test/benchmark/main.h"
+#include "test/mocks/http/mocks.h"
+#include "test/proto/bookstore.pb.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace GrpcJsonTranscoder {
+
+// The size of the pieces the messages are received in.
+constexpr uint64_t PieceSize = 16 * 1024;
+
+class TranscoderBenchmark {
+public:
+  TranscoderBenchmark()
+      : config_(std::make_shared<JsonTranscoderConfig>(protoConfig(), *api_)),
+        stats_(std::make_shared<GrpcJsonTranscoderFilterStats>(
+            GrpcJsonTranscoderFilterStats::generateStats("bench.", *store_.rootScope()))) {
+    // Do not limit the size of the buffered messages.
+    ON_CALL(decoder_callbacks_, decoderBufferLimit()).WillByDefault(testing::Return(64 << 20));
+    ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(testing::Return(64 << 20));
+  }
+
+  std::unique_ptr<JsonTranscoderFilter> createFilter() {
+    auto filter = std::make_unique<JsonTranscoderFilter>(config_, stats_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  // Passes the message to the filter piece by piece.
+  template <class DataCallback>
+  static void receive(absl::string_view message, DataCallback data_callback) {
+    Buffer::OwnedImpl body(message);
+    while (body.length() > 0) {
+      Buffer::OwnedImpl data;
+      data.move(body, PieceSize);
+      ::benchmark::DoNotOptimize(data_callback(data, body.length() == 0));
+    }
+  }
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+
+private:
+  static envoy::extensions::filters::http::grpc_json_transcoder::v3::GrpcJsonTranscoder
+  protoConfig() {
+    envoy::extensions::filters::http::grpc_json_transcoder::v3::GrpcJsonTranscoder proto_config;
+    proto_config.set_proto_descriptor(
+        TestEnvironment::runfilesPath("test/proto/bookstore.descriptor"));
+    proto_config.add_services("bookstore.Bookstore");
+    return proto_config;
+  }
+
+  Api::ApiPtr api_{Api::createApiForTest()};
+  Stats::IsolatedStoreImpl store_;
+  const JsonTranscoderConfigSharedPtr config_;
+  const GrpcJsonTranscoderFilterStatsSharedPtr stats_;
+};
+
+// Transcodes JSON requests into gRPC ones.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void transcodeJsonRequest(::benchmark::State& state) {
+  const std::string message = absl::StrCat(R"({"id": 1, "theme": ")",
+                                            std::string(state.range(0), 'a'), R"("})");
+  TranscoderBenchmark benchmark;
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl headers{
+        {":method", "POST"}, {":path", "/shelf"}, {"content-type", "application/json"}};
+    auto filter = benchmark.createFilter();
+    filter->decodeHeaders(headers, false);
+    TranscoderBenchmark::receive(message, [&filter](Buffer::Instance& data, bool end_stream) {
+      return filter->decodeData(data, end_stream);
+    });
+    filter->onDestroy();
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(transcodeJsonRequest)->Arg(1 << 10)->Arg(100 << 10)->Arg(10 << 20);
+
+// Transcodes gRPC responses into JSON ones.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void transcodeJsonResponse(::benchmark::State& state) {
+  bookstore::Shelf shelf;
+  shelf.set_id(1);
+  shelf.set_theme(std::string(state.range(0), 'a'));
+  const std::string message = Grpc::Common::serializeToGrpcFrame(shelf)->toString();
+  TranscoderBenchmark benchmark;
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/shelves/1"}};
+    Http::TestResponseHeaderMapImpl response_headers{{":status", "200"},
+                                                     {"content-type", "application/grpc"}};
+    Http::TestResponseTrailerMapImpl response_trailers{{"grpc-status", "0"}};
+    auto filter = benchmark.createFilter();
+    filter->decodeHeaders(request_headers, true);
+    filter->encodeHeaders(response_headers, false);
+    TranscoderBenchmark::receive(message, [&filter](Buffer::Instance& data, bool) {
+      return filter->encodeData(data, false);
+    });
+    filter->encodeTrailers(response_trailers);
+    filter->onDestroy();
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(transcodeJsonResponse)->Arg(1 << 10)->Arg(100 << 10)->Arg(10 << 20);
+
+// Transcodes HttpBody requests into gRPC ones, buffering their body or streaming it as their
+// content length is known.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void transcodeHttpBodyRequest(::benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.grpc_json_transcoder_stream_http_body_request",
+        state.range(1) ? "true" : "false"}});
+  const std::string message(state.range(0), 'a');
+  TranscoderBenchmark benchmark;
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl headers{{":method", "POST"},
+                                           {":path", "/postBody?arg=hi"},
+                                           {"content-type", "text/plain"},
+                                           {"content-length", absl::StrCat(message.size())}};
+    auto filter = benchmark.createFilter();
+    filter->decodeHeaders(headers, false);
+    TranscoderBenchmark::receive(message, [&filter](Buffer::Instance& data, bool end_stream) {
+      return filter->decodeData(data, end_stream);
+    });
+    filter->onDestroy();
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(transcodeHttpBodyRequest)->ArgsProduct({{1 << 10, 100 << 10, 10 << 20}, {false, true}});
+
+// Transcodes gRPC responses into HttpBody ones.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void transcodeHttpBodyResponse(::benchmark::State& state) {
+  google::api::HttpBody body;
+  body.set_content_type("text/plain");
+  body.set_data(std::string(state.range(0), 'a'));
+  const std::string message = Grpc::Common::serializeToGrpcFrame(body)->toString();
+  TranscoderBenchmark benchmark;
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/index"}};
+    Http::TestResponseHeaderMapImpl response_headers{{":status", "200"},
+                                                     {"content-type", "application/grpc"}};
+    auto filter = benchmark.createFilter();
+    filter->decodeHeaders(request_headers, true);
+    filter->encodeHeaders(response_headers, false);
+    // The filter manager buffers the transcoded response.
+    Buffer::OwnedImpl response;
+    TranscoderBenchmark::receive(message, [&filter, &response](Buffer::Instance& data, bool) {
+      const Http::FilterDataStatus status = filter->encodeData(data, false);
+      response.move(data);
+      return status;
+    });
+    filter->onDestroy();
+  }
+  state.SetBytesProcessed(state.iterations() * message.size());
+}
+BENCHMARK(transcodeHttpBodyResponse)->Arg(1 << 10)->Arg(100 << 10)->Arg(10 << 20);
+
+} // namespace GrpcJsonTranscoder
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1137,8 +1137,8 @@ TEST_F(AuthenticatorJwtCacheTest, TestNonProvider) {
 TEST_F(AuthenticatorJwtCacheTest, TestCacheMissGoodToken) {
   createAuthenticator("provider");
 
-  // jwt_cache miss: lookup return nullptr
-  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(nullptr));
+  // jwt_cache miss: lookup return nullopt
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(absl::nullopt));
   // jwt_cache insert is called for a good jwt.
   EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insert(GoodToken, _));
 
@@ -1149,8 +1149,8 @@ TEST_F(AuthenticatorJwtCacheTest, TestCacheMissGoodToken) {
 TEST_F(AuthenticatorJwtCacheTest, TestCacheMissExpiredToken) {
   createAuthenticator("provider");
 
-  // jwt_cache miss: lookup return nullptr
-  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(nullptr));
+  // jwt_cache miss: lookup return nullopt
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(absl::nullopt));
   // jwt_cache insert is not called for a bad Jwt
   EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insert(_, _)).Times(0);
 
@@ -1158,6 +1158,38 @@ TEST_F(AuthenticatorJwtCacheTest, TestCacheMissExpiredToken) {
   expectVerifyStatus(Status::JwtExpired, headers);
 }
 
+TEST_F(AuthenticatorJwtCacheTest, TestCacheMissBadSignature) {
+  createAuthenticator("provider");
+
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(absl::nullopt));
+  // jwt_cache insertFailure is called for a Jwt failing signature verification.
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insert(_, _)).Times(0);
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_,
+              insertFailure(NonExistKidToken, Status::JwtVerificationFail));
+
+  Http::TestRequestHeaderMapImpl headers{
+      {"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  expectVerifyStatus(Status::JwtVerificationFail, headers);
+}
+
+TEST_F(AuthenticatorJwtCacheTest, TestCacheFailureHit) {
+  createAuthenticator("provider");
+
+  // jwt_cache hit: lookup return the status the jwt failed verification with.
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_))
+      .WillOnce(Return(JwtCache::Verification{nullptr, Status::JwtVerificationFail}));
+  // The signature is not verified again.
+  EXPECT_CALL(jwks_cache_.jwks_data_, getJwksObj()).Times(0);
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insert(_, _)).Times(0);
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insertFailure(_, _)).Times(0);
+
+  Http::TestRequestHeaderMapImpl headers{
+      {"Authorization", "Bearer " + std::string(NonExistKidToken)}};
+  expectVerifyStatus(Status::JwtVerificationFail, headers);
+  EXPECT_EQ(1U, jwks_cache_.stats_.jwt_cache_hit_.value());
+  EXPECT_EQ(1U, jwks_cache_.stats_.jwt_cache_failure_hit_.value());
+}
+
 TEST_F(AuthenticatorJwtCacheTest, TestCacheHit) {
   jwks_cache_.jwks_data_.jwt_provider_.set_forward_payload_header("jwt-payload");
   jwks_cache_.jwks_data_.jwt_provider_.set_forward(true);
@@ -1165,10 +1197,11 @@ TEST_F(AuthenticatorJwtCacheTest, TestCacheHit) {
 
   createAuthenticator("provider");
 
-  ::google::jwt_verify::Jwt cached_jwt;
-  cached_jwt.parseFromString(GoodToken);
+  auto cached_jwt = std::make_shared<::google::jwt_verify::Jwt>();
+  cached_jwt->parseFromString(GoodToken);
   // jwt_cache hit: lookup return a cached jwt.
-  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_)).WillOnce(Return(&cached_jwt));
+  EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, lookup(_))
+      .WillOnce(Return(JwtCache::Verification{cached_jwt}));
   // jwt_cache insert is not called.
   EXPECT_CALL(jwks_cache_.jwks_data_.jwt_cache_, insert(_, _)).Times(0);
 
@@ -9,6 +9,7 @@
 
 #include "test/extensions/filters/http/jwt_authn/test_common.h"
 #include "test/mocks/server/factory_context.h"
+#include "test/test_common/test_runtime.h"
 #include "test/test_common/utility.h"
 
 #include "absl/time/time.h"
@@ -122,6 +123,56 @@ TEST_F(JwksCacheTest, TestSetRemoteJwksWithDefaultCacheDuration) {
   EXPECT_FALSE(jwks->isExpired());
 }
 
+// The JWT cache of a provider is shared by all threads, so that a JWT verified by one is a hit for
+// the others.
+TEST_F(JwksCacheTest, TestSharedJwtCacheHit) {
+  auto& provider0 = (*config_.mutable_providers())[std::string(ProviderName)];
+  provider0.mutable_jwt_cache_config();
+  cache_ = JwksCache::create(config_, context_, mock_fetcher_.AsStdFunction(), stats_);
+
+  auto jwks = cache_->findByIssuer("https://example.com");
+  auto jwt = std::make_unique<::google::jwt_verify::Jwt>();
+  ASSERT_EQ(jwt->parseFromString(GoodToken), Status::Ok);
+  const auto* origin_jwt = jwt.get();
+  jwks->getJwtCache().insert(GoodToken, std::move(jwt));
+
+  JwtCache* other_thread_cache = nullptr;
+  std::thread([&]() { other_thread_cache = &jwks->getJwtCache(); }).join();
+  EXPECT_EQ(other_thread_cache, &jwks->getJwtCache());
+  auto verification = other_thread_cache->lookup(GoodToken);
+  ASSERT_TRUE(verification.has_value());
+  EXPECT_EQ(verification->jwt_.get(), origin_jwt);
+}
+
+class JwksCacheFailureTest : public JwksCacheTest, public testing::WithParamInterface<bool> {
+protected:
+  void SetUp() override {
+    JwksCacheTest::SetUp();
+    scoped_runtime_.mergeValues(
+        {{"envoy.reloadable_features.jwt_authn_shared_jwt_cache", GetParam() ? "true" : "false"}});
+    auto& provider0 = (*config_.mutable_providers())[std::string(ProviderName)];
+    provider0.mutable_jwt_cache_config()->mutable_failed_jwt_cache_duration()->set_seconds(10);
+  }
+
+  TestScopedRuntime scoped_runtime_;
+};
+
+INSTANTIATE_TEST_SUITE_P(SharedJwtCache, JwksCacheFailureTest, testing::Bool());
+
+// JWTs that failed verification are cached until the remote JWKS is fetched again.
+TEST_P(JwksCacheFailureTest, FailuresAreClearedBySetRemoteJwks) {
+  cache_ = JwksCache::create(config_, context_, mock_fetcher_.AsStdFunction(), stats_);
+  auto jwks = cache_->findByIssuer("https://example.com");
+
+  jwks->getJwtCache().insertFailure(NonExistKidToken, Status::JwtVerificationFail);
+  auto verification = jwks->getJwtCache().lookup(NonExistKidToken);
+  ASSERT_TRUE(verification.has_value());
+  EXPECT_EQ(verification->status_, Status::JwtVerificationFail);
+
+  EXPECT_EQ(jwks->setRemoteJwks(std::move(jwks_))->getStatus(), Status::Ok);
+  EXPECT_FALSE(jwks->getJwtCache().lookup(NonExistKidToken).has_value());
+}
+
 // Test a good local jwks
 TEST_F(JwksCacheTest, TestGoodInlineJwks) {
   auto& provider0 = (*config_.mutable_providers())[std::string(ProviderName)];
@@ -20,13 +20,20 @@ namespace {
 
 class JwtCacheTest : public testing::Test {
 public:
-  void setupCache(bool enable, int max_token_size = 0) {
+  void setupCache(bool enable, int max_token_size = 0, int cache_size = 0,
+                  int failed_jwt_cache_seconds = 0) {
     envoy::extensions::filters::http::jwt_authn::v3::JwtCacheConfig config;
-    config.set_jwt_cache_size(0);
+    config.set_jwt_cache_size(cache_size);
     config.set_jwt_max_token_size(max_token_size);
+    config.mutable_failed_jwt_cache_duration()->set_seconds(failed_jwt_cache_seconds);
     cache_ = JwtCache::create(enable, config, time_system_);
   }
 
+  const ::google::jwt_verify::Jwt* lookupJwt(const std::string& token) {
+    auto verification = cache_->lookup(token);
+    return verification.has_value() ? verification->jwt_.get() : nullptr;
+  }
+
   void loadJwt(const char* jwt_str) {
     jwt_ = std::make_unique<::google::jwt_verify::Jwt>();
     Status status = jwt_->parseFromString(jwt_str);
@@ -48,11 +55,11 @@ TEST_F(JwtCacheTest, TestEnabledCache) {
   // jwt ownership is moved into the cache.
   EXPECT_FALSE(jwt_);
 
-  auto* jwt1 = cache_->lookup(GoodToken);
+  auto* jwt1 = lookupJwt(GoodToken);
   EXPECT_TRUE(jwt1 != nullptr);
   EXPECT_EQ(jwt1, origin_jwt);
 
-  auto* jwt2 = cache_->lookup(ExpiredToken);
+  auto* jwt2 = lookupJwt(ExpiredToken);
   EXPECT_TRUE(jwt2 == nullptr);
 }
 
@@ -65,7 +72,7 @@ TEST_F(JwtCacheTest, TestDisabledCache) {
   // jwt ownership is not moved into the cache.
   EXPECT_TRUE(jwt_);
 
-  auto* jwt = cache_->lookup(GoodToken);
+  auto* jwt = lookupJwt(GoodToken);
   // not found since cache is disabled.
   EXPECT_TRUE(jwt == nullptr);
 }
@@ -77,7 +84,7 @@ TEST_F(JwtCacheTest, TestExpiredToken) {
 
   cache_->insert(ExpiredToken, std::move(jwt_));
 
-  auto* jwt = cache_->lookup(ExpiredToken);
+  auto* jwt = lookupJwt(ExpiredToken);
   // not be found since it is expired.
   EXPECT_TRUE(jwt == nullptr);
 }
@@ -92,7 +99,7 @@ TEST_F(JwtCacheTest, TestValidTokenSize) {
   // jwt ownership is moved into the cache.
   EXPECT_FALSE(jwt_);
 
-  auto* jwt = cache_->lookup(GoodToken);
+  auto* jwt = lookupJwt(GoodToken);
   EXPECT_TRUE(jwt != nullptr);
   EXPECT_EQ(jwt, origin_jwt);
 }
@@ -106,10 +113,93 @@ TEST_F(JwtCacheTest, TestInvalidTokenSize) {
   // jwt ownership is not moved into the cache.
   EXPECT_TRUE(jwt_);
 
-  auto* jwt = cache_->lookup(GoodToken);
+  auto* jwt = lookupJwt(GoodToken);
   EXPECT_TRUE(jwt == nullptr);
 }
 
+TEST_F(JwtCacheTest, TestLruEviction) {
+  setupCache(true, 0, 2);
+
+  loadJwt(GoodToken);
+  cache_->insert(GoodToken, std::move(jwt_));
+  loadJwt(NonExpiringToken);
+  cache_->insert(NonExpiringToken, std::move(jwt_));
+  // GoodToken becomes the most recently used.
+  EXPECT_NE(lookupJwt(GoodToken), nullptr);
+  loadJwt(OtherGoodToken);
+  cache_->insert(OtherGoodToken, std::move(jwt_));
+
+  EXPECT_NE(lookupJwt(GoodToken), nullptr);
+  EXPECT_EQ(lookupJwt(NonExpiringToken), nullptr);
+  EXPECT_NE(lookupJwt(OtherGoodToken), nullptr);
+}
+
+TEST_F(JwtCacheTest, TestFailedToken) {
+  setupCache(true, 0, 0, 10);
+
+  cache_->insertFailure(NonExistKidToken, Status::JwtVerificationFail);
+  auto verification = cache_->lookup(NonExistKidToken);
+  ASSERT_TRUE(verification.has_value());
+  EXPECT_EQ(verification->jwt_, nullptr);
+  EXPECT_EQ(verification->status_, Status::JwtVerificationFail);
+
+  // Failed tokens are only cached for a while.
+  time_system_.advanceTimeWait(std::chrono::seconds(10));
+  EXPECT_FALSE(cache_->lookup(NonExistKidToken).has_value());
+}
+
+TEST_F(JwtCacheTest, TestFailedTokenNotCached) {
+  setupCache(true);
+
+  cache_->insertFailure(NonExistKidToken, Status::JwtVerificationFail);
+  EXPECT_FALSE(cache_->lookup(NonExistKidToken).has_value());
+}
+
+// Failed JWTs are kept in an LRU of their own, so that they cannot evict the verified ones.
+TEST_F(JwtCacheTest, TestFailedTokensDoNotEvictVerifiedTokens) {
+  setupCache(true, 0, 2, 10);
+
+  loadJwt(GoodToken);
+  cache_->insert(GoodToken, std::move(jwt_));
+  loadJwt(NonExpiringToken);
+  cache_->insert(NonExpiringToken, std::move(jwt_));
+  cache_->insertFailure("bad-token-1", Status::JwtVerificationFail);
+  cache_->insertFailure("bad-token-2", Status::JwtVerificationFail);
+  cache_->insertFailure("bad-token-3", Status::JwtVerificationFail);
+
+  EXPECT_NE(lookupJwt(GoodToken), nullptr);
+  EXPECT_NE(lookupJwt(NonExpiringToken), nullptr);
+  // The failure LRU is bounded by the cache size as well.
+  EXPECT_FALSE(cache_->lookup("bad-token-1").has_value());
+  EXPECT_TRUE(cache_->lookup("bad-token-2").has_value());
+  EXPECT_TRUE(cache_->lookup("bad-token-3").has_value());
+}
+
+TEST_F(JwtCacheTest, TestVerifiedTokenReplacesFailure) {
+  setupCache(true, 0, 0, 10);
+
+  cache_->insertFailure(GoodToken, Status::JwtVerificationFail);
+  loadJwt(GoodToken);
+  cache_->insert(GoodToken, std::move(jwt_));
+
+  auto verification = cache_->lookup(GoodToken);
+  ASSERT_TRUE(verification.has_value());
+  EXPECT_NE(verification->jwt_, nullptr);
+  EXPECT_EQ(verification->status_, Status::Ok);
+}
+
+TEST_F(JwtCacheTest, TestClearFailures) {
+  setupCache(true, 0, 0, 10);
+
+  loadJwt(GoodToken);
+  cache_->insert(GoodToken, std::move(jwt_));
+  cache_->insertFailure(NonExistKidToken, Status::JwtVerificationFail);
+  cache_->clearFailures();
+
+  EXPECT_NE(lookupJwt(GoodToken), nullptr);
+  EXPECT_FALSE(cache_->lookup(NonExistKidToken).has_value());
+}
+
 } // namespace
 } // namespace JwtAuthn
 } // namespace HttpFilters
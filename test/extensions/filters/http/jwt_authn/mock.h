@@ -66,8 +66,10 @@ public:
 
 class MockJwtCache : public JwtCache {
 public:
-  MOCK_METHOD(::google::jwt_verify::Jwt*, lookup, (const std::string&), ());
+  MOCK_METHOD(absl::optional<Verification>, lookup, (const std::string&), ());
   MOCK_METHOD(void, insert, (const std::string&, std::unique_ptr<::google::jwt_verify::Jwt>&&), ());
+  MOCK_METHOD(void, insertFailure, (const std::string&, ::google::jwt_verify::Status), ());
+  MOCK_METHOD(void, clearFailures, (), ());
 };
 
 class MockJwksData : public JwksCache::JwksData {
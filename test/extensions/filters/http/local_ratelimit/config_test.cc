@@ -414,6 +414,104 @@ local_cluster_rate_limit: {}
                   .ok());
 }
 
+TEST(Factory, WorkerSharding) {
+  const std::string config_yaml = R"(
+stat_prefix: test
+token_bucket:
+  max_tokens: 100
+  tokens_per_fill: 100
+  fill_interval: 1s
+worker_sharding:
+  worker_batch:
+    value: 5
+  rebalance_interval: 0.5s
+)";
+
+  LocalRateLimitFilterConfig factory;
+  ProtobufTypes::MessagePtr proto_config = factory.createEmptyRouteConfigProto();
+  TestUtility::loadFromYaml(config_yaml, *proto_config);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  const auto route_config =
+      factory
+          .createRouteSpecificFilterConfig(*proto_config, context,
+                                           ProtobufMessage::getNullValidationVisitor())
+          .value();
+  const auto* config = dynamic_cast<const FilterConfig*>(route_config.get());
+  EXPECT_TRUE(config->requestAllowed({}).allowed);
+}
+
+TEST(Factory, DynamicDescriptors) {
+  const std::string config_yaml = R"(
+stat_prefix: test
+token_bucket:
+  max_tokens: 100
+  tokens_per_fill: 100
+  fill_interval: 1s
+descriptors:
+- entries:
+  - key: user
+  token_bucket:
+    max_tokens: 1
+    tokens_per_fill: 1
+    fill_interval: 60s
+dynamic_descriptors:
+  shards: 2
+  min_requests: 2
+  window: 10s
+)";
+
+  LocalRateLimitFilterConfig factory;
+  ProtobufTypes::MessagePtr proto_config = factory.createEmptyRouteConfigProto();
+  TestUtility::loadFromYaml(config_yaml, *proto_config);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+  const auto route_config =
+      factory
+          .createRouteSpecificFilterConfig(*proto_config, context,
+                                           ProtobufMessage::getNullValidationVisitor())
+          .value();
+  const auto* config = dynamic_cast<const FilterConfig*>(route_config.get());
+
+  // The value only gets its own bucket on its second request.
+  std::vector<RateLimit::Descriptor> descriptors{{{{"user", "A"}}}};
+  EXPECT_TRUE(config->requestAllowed(descriptors).allowed);
+  EXPECT_TRUE(config->requestAllowed(descriptors).allowed);
+  EXPECT_FALSE(config->requestAllowed(descriptors).allowed);
+  EXPECT_EQ(1, TestUtility::findCounter(context.store_,
+                                        "test.http_local_rate_limit.dynamic_descriptors_filtered")
+                   ->value());
+  EXPECT_EQ(1, TestUtility::findGauge(context.store_,
+                                      "test.http_local_rate_limit.dynamic_descriptors_active")
+                   ->value());
+}
+
+TEST(Factory, WorkerShardingAndLocalRateLimitPerDownstreamConnection) {
+  const std::string config_yaml = R"(
+stat_prefix: test
+token_bucket:
+  max_tokens: 1
+  tokens_per_fill: 1
+  fill_interval: 1000s
+worker_sharding: {}
+local_rate_limit_per_downstream_connection: true
+)";
+
+  LocalRateLimitFilterConfig factory;
+  ProtobufTypes::MessagePtr proto_config = factory.createEmptyRouteConfigProto();
+  TestUtility::loadFromYaml(config_yaml, *proto_config);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> context;
+
+  EXPECT_THROW_WITH_MESSAGE(
+      factory
+          .createRouteSpecificFilterConfig(*proto_config, context,
+                                           ProtobufMessage::getNullValidationVisitor())
+          .value(),
+      EnvoyException,
+      "worker_sharding is set and local_rate_limit_per_downstream_connection is set to true");
+}
+
 } // namespace LocalRateLimitFilter
 } // namespace HttpFilters
 } // namespace Extensions
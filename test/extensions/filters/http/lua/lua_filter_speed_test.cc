@@ -0,0 +1,72 @@
+// Measures the Lua filter running a typical header rewriting script on requests, with and without
+// reusing the coroutines of previous requests.
+
+#include "source/extensions/filters/http/lua/lua_filter.h"
+
+#include "test/benchmark/main.h"
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Lua {
+
+constexpr absl::string_view HeaderRewriteScript = R"EOF(
+  function envoy_on_request(request_handle)
+    local headers = request_handle:headers()
+    local tenant = headers:get("x-tenant")
+    if tenant ~= nil then
+      headers:replace("x-upstream-tenant", string.lower(tenant))
+      headers:remove("x-tenant")
+    end
+    if headers:get(":path"):sub(1, 5) == "/api/" then
+      headers:add("x-api", "true")
+    end
+  end
+)EOF";
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void decodeHeaders(::benchmark::State& state) {
+  TestScopedRuntime scoped_runtime;
+  scoped_runtime.mergeValues(
+      {{"envoy.reloadable_features.lua_reuse_coroutines", state.range(0) ? "true" : "false"}});
+
+  NiceMock<ThreadLocal::MockInstance> tls;
+  NiceMock<Api::MockApi> api;
+  NiceMock<Upstream::MockClusterManager> cluster_manager;
+  Stats::TestUtil::TestStore stats_store;
+  envoy::extensions::filters::http::lua::v3::Lua proto_config;
+  proto_config.mutable_default_source_code()->set_inline_string(HeaderRewriteScript);
+  const auto config = std::make_shared<FilterConfig>(proto_config, tls, cluster_manager, api,
+                                                     *stats_store.rootScope(), "test.");
+
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks;
+  Event::SimulatedTimeSystem time_system;
+  for (auto _ : state) { // NOLINT
+    Http::TestRequestHeaderMapImpl headers{{":method", "GET"},
+                                           {":path", "/api/users"},
+                                           {":authority", "example.com"},
+                                           {"x-tenant", "Tenant-A"}};
+    Filter filter(config, time_system);
+    filter.setDecoderFilterCallbacks(decoder_callbacks);
+    filter.setEncoderFilterCallbacks(encoder_callbacks);
+    ::benchmark::DoNotOptimize(filter.decodeHeaders(headers, true));
+    filter.onDestroy();
+  }
+}
+BENCHMARK(decodeHeaders)->Arg(false)->Arg(true);
+
+} // namespace Lua
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,146 @@
+// Compares serving a cache hit's body from a FileSystemHttpCache file with async reads into
+// fresh buffers (CacheFileReader) against serving it from a memory mapping of the file
+// (MappedCacheFileReader), for bodies from 1MiB to 100MiB.
+
+#include <fstream>
+
+#include "envoy/extensions/common/async_files/v3/async_file_manager.pb.h"
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/singleton/manager_impl.h"
+#include "source/extensions/common/async_files/async_file_manager.h"
+#include "source/extensions/common/async_files/async_file_manager_factory.h"
+#include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_fixed_block.h"
+#include "source/extensions/http/cache_v2/file_system_http_cache/cache_file_reader.h"
+
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace FileSystemHttpCache {
+namespace {
+
+using Common::AsyncFiles::AsyncFileHandle;
+using Common::AsyncFiles::AsyncFileManager;
+using Common::AsyncFiles::AsyncFileManagerFactory;
+using Common::AsyncFiles::MappedFileRegionSharedPtr;
+
+// The size of the chunks in which the cache filter reads a body.
+constexpr uint64_t ReadChunkSize = 256 * 1024;
+
+class CacheFileReaderBenchmark {
+public:
+  explicit CacheFileReaderBenchmark(uint64_t body_size) : body_size_(body_size) {
+    envoy::extensions::common::async_files::v3::AsyncFileManagerConfig config;
+    config.mutable_thread_pool()->set_thread_count(1);
+    manager_ = factory_->getAsyncFileManager(config);
+    path_ = TestEnvironment::temporaryPath(absl::StrCat("cache_file_reader_speed_", body_size));
+    CacheFileFixedBlock block;
+    block.setBodySize(body_size);
+    Buffer::OwnedImpl header;
+    block.serializeToBuffer(header);
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    file << header.toString() << std::string(body_size, 'x');
+  }
+  ~CacheFileReaderBenchmark() {
+    manager_ = nullptr;
+    TestEnvironment::removePath(path_);
+  }
+
+  // Reads the whole body through reader, chunk by chunk, draining each chunk as a network
+  // write would.
+  void readBody(CacheReader& reader) {
+    for (uint64_t pos = 0; pos < body_size_; pos += ReadChunkSize) {
+      Buffer::InstancePtr chunk;
+      reader.getBody(*dispatcher_,
+                     AdjustedByteRange(pos, std::min(pos + ReadChunkSize, body_size_)),
+                     [&chunk](Buffer::InstancePtr buffer, EndStream) {
+                       chunk = std::move(buffer);
+                     });
+      if (chunk == nullptr) {
+        resolveFileActions();
+      }
+      RELEASE_ASSERT(chunk != nullptr, "body read failed");
+      output_.move(*chunk);
+      output_.drain(output_.length());
+    }
+  }
+
+  AsyncFileHandle openFile() {
+    AsyncFileHandle handle;
+    manager_->openExistingFile(dispatcher_.get(), path_, AsyncFileManager::Mode::ReadOnly,
+                               [&handle](absl::StatusOr<AsyncFileHandle> result) {
+                                 handle = std::move(result.value());
+                               });
+    resolveFileActions();
+    return handle;
+  }
+
+  MappedFileRegionSharedPtr mapBody(AsyncFileHandle& handle) {
+    MappedFileRegionSharedPtr region;
+    auto queued = handle->mmap(dispatcher_.get(), CacheFileFixedBlock::offsetToBody(), body_size_,
+                               [&region](absl::StatusOr<MappedFileRegionSharedPtr> result) {
+                                 region = std::move(result.value());
+                               });
+    RELEASE_ASSERT(queued.ok(), queued.status().ToString());
+    resolveFileActions();
+    auto closed = handle->close(nullptr, [](absl::Status) {});
+    RELEASE_ASSERT(closed.ok(), closed.status().ToString());
+    return region;
+  }
+
+private:
+  void resolveFileActions() {
+    manager_->waitForIdle();
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  const uint64_t body_size_;
+  Singleton::ManagerImpl singleton_manager_;
+  std::shared_ptr<AsyncFileManagerFactory> factory_ =
+      AsyncFileManagerFactory::singleton(&singleton_manager_);
+  std::shared_ptr<AsyncFileManager> manager_;
+  Api::ApiPtr api_ = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher_ = api_->allocateDispatcher("test_thread");
+  std::string path_;
+  Buffer::OwnedImpl output_;
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_AsyncReadHit(benchmark::State& state) {
+  const uint64_t body_size = state.range(0) * 1024 * 1024;
+  CacheFileReaderBenchmark bench(body_size);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    CacheFileReader reader(bench.openFile());
+    bench.readBody(reader);
+  }
+  state.SetBytesProcessed(state.iterations() * body_size);
+}
+BENCHMARK(BM_AsyncReadHit)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_MappedHit(benchmark::State& state) {
+  const uint64_t body_size = state.range(0) * 1024 * 1024;
+  CacheFileReaderBenchmark bench(body_size);
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    AsyncFileHandle handle = bench.openFile();
+    MappedCacheFileReader reader(bench.mapBody(handle));
+    bench.readBody(reader);
+  }
+  state.SetBytesProcessed(state.iterations() * body_size);
+}
+BENCHMARK(BM_MappedHit)->Arg(1)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace FileSystemHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
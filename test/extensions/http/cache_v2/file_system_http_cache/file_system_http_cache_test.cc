@@ -41,6 +41,7 @@ using StatusHelpers::IsOkAndHolds;
 using ::testing::HasSubstr;
 using ::testing::IsNull;
 using ::testing::NiceMock;
+using ::testing::Pointee;
 using ::testing::Return;
 using ::testing::StrictMock;
 
@@ -83,6 +84,7 @@ public:
     ConfigProto cfg;
     EXPECT_TRUE(MessageUtil::unpackTo(cache_config.typed_config(), cfg).ok());
     cfg.set_cache_path(cache_path_);
+    cfg.set_memory_map_reads(memory_map_reads_);
     return cfg;
   }
 
@@ -104,6 +106,7 @@ protected:
   FileSystemHttpCache* cache() { return dynamic_cast<FileSystemHttpCache*>(&cache_->cache()); }
   ::Envoy::TestEnvironment env_;
   std::string cache_path_;
+  bool memory_map_reads_ = false;
   NiceMock<Server::Configuration::MockFactoryContext> context_;
   std::shared_ptr<CacheSessions> cache_;
   HttpCacheFactory* http_cache_factory_;
@@ -570,6 +573,51 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, IncompleteReadOfBodyProvokesReset)
   EXPECT_EQ(got_end_stream, EndStream::Reset);
 }
 
+class FileSystemHttpCacheTestWithMockFilesAndMemoryMapping
+    : public FileSystemHttpCacheTestWithMockFiles {
+public:
+  FileSystemHttpCacheTestWithMockFilesAndMemoryMapping() { memory_map_reads_ = true; }
+};
+
+TEST_F(FileSystemHttpCacheTestWithMockFilesAndMemoryMapping, FailedMmapFallsBackToRead) {
+  setBodySize(10);
+  EXPECT_CALL(*mock_async_file_manager_, openExistingFile);
+  EXPECT_CALL(*mock_async_file_handle_, read(_, 0, CacheFileFixedBlock::size(), _));
+  EXPECT_CALL(*mock_async_file_handle_,
+              read(_, testHeaderBlock().offsetToHeaders(), headers_size_, _));
+  EXPECT_CALL(*mock_async_file_handle_, mmap(_, testHeaderBlock().offsetToBody(), 10, _));
+  absl::StatusOr<LookupResult> lookup_result;
+  testLookup(&lookup_result);
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<AsyncFileHandle>(mock_async_file_handle_));
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(testHeaderBlockBuffer()));
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Buffer::InstancePtr>(testHeaderBuffer()));
+  pumpDispatcher();
+  mock_async_file_manager_->nextActionCompletes(
+      absl::StatusOr<Common::AsyncFiles::MappedFileRegionSharedPtr>(
+          absl::UnknownError("intentional failure to mmap")));
+  pumpDispatcher();
+  ASSERT_THAT(lookup_result, IsOkAndHolds(PopulatedLookup()));
+  // The body is read from the file instead.
+  EXPECT_CALL(*mock_async_file_handle_, read(_, testHeaderBlock().offsetToBody(), 10, _));
+  Buffer::InstancePtr got_body;
+  EndStream got_end_stream = EndStream::Reset;
+  lookup_result.value().cache_reader_->getBody(*dispatcher_, AdjustedByteRange(0, 10),
+                                               [&](Buffer::InstancePtr body, EndStream end_stream) {
+                                                 got_body = std::move(body);
+                                                 got_end_stream = end_stream;
+                                               });
+  mock_async_file_manager_->nextActionCompletes(absl::StatusOr<Buffer::InstancePtr>(
+      std::make_unique<Buffer::OwnedImpl>("0123456789")));
+  pumpDispatcher();
+  EXPECT_THAT(got_body, Pointee(BufferStringEqual("0123456789")));
+  EXPECT_EQ(got_end_stream, EndStream::More);
+}
+
 TEST_F(FileSystemHttpCacheTestWithMockFiles, FailedReadOfTrailersReturnsError) {
   setTrailers({{"fruit", "banana"}});
   EXPECT_CALL(*mock_async_file_manager_, openExistingFile);
@@ -886,7 +934,10 @@ TEST_F(FileSystemHttpCacheTestWithMockFiles, InsertSilentlyAbortsOnFailureToWrit
 class FileSystemHttpCacheTestDelegate : public HttpCacheTestDelegate,
                                         public FileSystemCacheTestContext {
 public:
-  FileSystemHttpCacheTestDelegate() { initCache(); }
+  explicit FileSystemHttpCacheTestDelegate(bool memory_map_reads = false) {
+    memory_map_reads_ = memory_map_reads;
+    initCache();
+  }
   HttpCache& cache() override { return cache_->cache(); }
   void beforePumpingDispatcher() override {
     dynamic_cast<FileSystemHttpCache&>(cache()).drainAsyncFileActionsForTest();
@@ -900,6 +951,19 @@ INSTANTIATE_TEST_SUITE_P(FileSystemHttpCacheTest, HttpCacheImplementationTest,
                            return "FileSystemHttpCache";
                          });
 
+// The same tests, serving bodies from memory-mapped cache files.
+class MemoryMappedFileSystemHttpCacheTestDelegate : public FileSystemHttpCacheTestDelegate {
+public:
+  MemoryMappedFileSystemHttpCacheTestDelegate() : FileSystemHttpCacheTestDelegate(true) {}
+};
+
+INSTANTIATE_TEST_SUITE_P(MemoryMappedFileSystemHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(
+                             std::make_unique<MemoryMappedFileSystemHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "MemoryMappedFileSystemHttpCache";
+                         });
+
 TEST(Registration, GetCacheFromFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
       "envoy.extensions.http.cache_v2.file_system_http_cache.v3.FileSystemHttpCacheV2Config");
@@ -0,0 +1,155 @@
+#include <string>
+
+#include "source/common/buffer/buffer_impl.h"
+#include "source/common/http/header_map_impl.h"
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/entry_store.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+namespace {
+
+class EntryStoreTest : public testing::Test {
+protected:
+  Key key(absl::string_view path) {
+    Key key;
+    key.set_path(path);
+    return key;
+  }
+
+  CacheEntrySharedPtr entry(uint64_t body_size) {
+    auto entry = std::make_shared<CacheEntry>(
+        Http::ResponseHeaderMapImpl::create(), ResponseMetadata{SystemTime()});
+    Buffer::OwnedImpl body(std::string(body_size, 'a'));
+    entry->appendBody(body);
+    return entry;
+  }
+
+  std::unique_ptr<EntryStore> makeStore(uint64_t max_bytes) {
+    return std::make_unique<EntryStore>(max_bytes, max_bytes, 1,
+                                        generateStats(*stats_store_.rootScope(), "cache.memory.test."));
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+};
+
+TEST_F(EntryStoreTest, BodyIsSharedNotCopied) {
+  CacheEntry entry(Http::ResponseHeaderMapImpl::create(), ResponseMetadata{SystemTime()});
+  Buffer::OwnedImpl first("hello ");
+  Buffer::OwnedImpl second("world");
+  entry.appendBody(first);
+  entry.appendBody(second);
+  EXPECT_EQ(11, entry.bodySize());
+
+  Buffer::InstancePtr a = entry.body(AdjustedByteRange(0, 11));
+  Buffer::InstancePtr b = entry.body(AdjustedByteRange(0, 11));
+  EXPECT_EQ("hello world", a->toString());
+  ASSERT_EQ(2, a->getRawSlices().size());
+  ASSERT_EQ(2, b->getRawSlices().size());
+  EXPECT_EQ(a->getRawSlices()[0].mem_, b->getRawSlices()[0].mem_);
+  EXPECT_EQ(a->getRawSlices()[1].mem_, b->getRawSlices()[1].mem_);
+}
+
+TEST_F(EntryStoreTest, BodyRangesSpanningChunks) {
+  CacheEntry entry(Http::ResponseHeaderMapImpl::create(), ResponseMetadata{SystemTime()});
+  for (absl::string_view part : {"abc", "def", "ghi"}) {
+    Buffer::OwnedImpl buffer(part);
+    entry.appendBody(buffer);
+  }
+  EXPECT_EQ("cdefg", entry.body(AdjustedByteRange(2, 7))->toString());
+  EXPECT_EQ("def", entry.body(AdjustedByteRange(3, 6))->toString());
+  EXPECT_EQ("i", entry.body(AdjustedByteRange(8, 9))->toString());
+  EXPECT_EQ("", entry.body(AdjustedByteRange(9, 9))->toString());
+}
+
+TEST_F(EntryStoreTest, BodyOutlivesEntry) {
+  Buffer::InstancePtr body;
+  {
+    CacheEntrySharedPtr e = entry(100);
+    body = e->body(AdjustedByteRange(10, 20));
+  }
+  EXPECT_EQ(std::string(10, 'a'), body->toString());
+}
+
+TEST_F(EntryStoreTest, ReplaceKeepsAccounting) {
+  auto store = makeStore(1024 * 1024);
+  ASSERT_TRUE(store->insert(key("/a"), entry(100)));
+  const uint64_t size = store->stats().size_bytes_.value();
+  ASSERT_TRUE(store->insert(key("/a"), entry(100)));
+  EXPECT_EQ(size, store->stats().size_bytes_.value());
+  EXPECT_EQ(1, store->stats().size_count_.value());
+  store->erase(key("/a"));
+  EXPECT_EQ(0, store->stats().size_bytes_.value());
+  EXPECT_EQ(0, store->stats().size_count_.value());
+  EXPECT_EQ(nullptr, store->lookup(key("/a")));
+}
+
+TEST_F(EntryStoreTest, PeekDoesNotCountAsHit) {
+  auto store = makeStore(1024 * 1024);
+  ASSERT_TRUE(store->insert(key("/a"), entry(100)));
+  EXPECT_NE(nullptr, store->peek(key("/a")));
+  EXPECT_EQ(0, store->stats().lookup_hit_.value());
+  EXPECT_NE(nullptr, store->lookup(key("/a")));
+  EXPECT_EQ(1, store->stats().lookup_hit_.value());
+}
+
+TEST_F(EntryStoreTest, RejectsOversizedEntry) {
+  auto store = makeStore(1024);
+  EXPECT_FALSE(store->insert(key("/a"), entry(2048)));
+  EXPECT_EQ(1, store->stats().insert_rejected_.value());
+  EXPECT_EQ(nullptr, store->peek(key("/a")));
+}
+
+// Entries that are looked up survive a scan of entries that are only ever inserted.
+TEST_F(EntryStoreTest, ScanResistant) {
+  auto store = makeStore(64 * 1024);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_TRUE(store->insert(key(absl::StrCat("/hot", i)), entry(1024)));
+    ASSERT_NE(nullptr, store->lookup(key(absl::StrCat("/hot", i))));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(store->insert(key(absl::StrCat("/scan", i)), entry(1024)));
+    if (i % 20 == 0) {
+      for (int j = 0; j < 8; ++j) {
+        store->lookup(key(absl::StrCat("/hot", j)));
+      }
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_NE(nullptr, store->peek(key(absl::StrCat("/hot", i)))) << i;
+  }
+  EXPECT_LE(store->stats().size_bytes_.value(), 64 * 1024);
+  EXPECT_EQ(nullptr, store->peek(key("/scan0")));
+}
+
+// A key that was recently evicted from the small queue goes straight to the main queue when it is
+// inserted again.
+TEST_F(EntryStoreTest, GhostHitInsertsIntoMain) {
+  auto store = makeStore(16 * 1024);
+  for (int i = 0; i < 32; ++i) {
+    ASSERT_TRUE(store->insert(key(absl::StrCat("/object", i)), entry(1024)));
+  }
+  // Find the most recently evicted key.
+  int evicted = 31;
+  while (evicted >= 0 && store->peek(key(absl::StrCat("/object", evicted))) != nullptr) {
+    --evicted;
+  }
+  ASSERT_GE(evicted, 0);
+  EXPECT_EQ(0, store->stats().ghost_hit_.value());
+  ASSERT_TRUE(store->insert(key(absl::StrCat("/object", evicted)), entry(1024)));
+  EXPECT_EQ(1, store->stats().ghost_hit_.value());
+}
+
+} // namespace
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,153 @@
+#include "envoy/registry/registry.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/http/cache_v2/memory_http_cache/memory_http_cache.h"
+
+#include "test/extensions/filters/http/cache_v2/http_cache_implementation_test_common.h"
+#include "test/extensions/filters/http/cache_v2/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace MemoryHttpCache {
+namespace {
+
+using ::testing::_;
+using ::testing::Eq;
+using ::testing::Optional;
+using ::testing::Pair;
+
+ConfigProto testConfig(uint64_t max_cache_size_bytes = 1024 * 1024) {
+  ConfigProto config;
+  config.set_cache_name("test");
+  config.set_max_cache_size_bytes(max_cache_size_bytes);
+  config.set_shard_count(1);
+  return config;
+}
+
+class MemoryHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  HttpCache& cache() override { return cache_; }
+
+private:
+  Stats::IsolatedStoreImpl stats_store_;
+  MemoryHttpCache cache_{testConfig(), *stats_store_.rootScope()};
+};
+
+INSTANTIATE_TEST_SUITE_P(MemoryHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(std::make_unique<MemoryHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "MemoryHttpCache";
+                         });
+
+class MemoryHttpCacheEvictionTest : public HttpCacheImplementationTest {
+protected:
+  Http::TestResponseHeaderMapImpl responseHeaders() {
+    return {{":status", "200"},
+            {"date", formatter_.fromTime(time_system_.systemTime())},
+            {"cache-control", "public,max-age=3600"}};
+  }
+
+  MemoryHttpCacheStats& stats() { return dynamic_cast<MemoryHttpCache&>(cache()).stats(); }
+};
+
+// A cache small enough that only a few 1KiB responses fit.
+class SmallMemoryHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  HttpCache& cache() override { return cache_; }
+
+private:
+  Stats::IsolatedStoreImpl stats_store_;
+  MemoryHttpCache cache_{testConfig(8 * 1024), *stats_store_.rootScope()};
+};
+
+INSTANTIATE_TEST_SUITE_P(MemoryHttpCacheEvictionTest, MemoryHttpCacheEvictionTest,
+                         testing::Values(std::make_unique<SmallMemoryHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "SmallMemoryHttpCache";
+                         });
+
+TEST_P(MemoryHttpCacheEvictionTest, StaysWithinByteBudget) {
+  const std::string body(1024, 'a');
+  for (int i = 0; i < 32; ++i) {
+    insert(absl::StrCat("/object", i), responseHeaders(), body);
+  }
+  EXPECT_LE(stats().size_bytes_.value(), 8 * 1024);
+  EXPECT_GT(stats().eviction_.value(), 0);
+  EXPECT_EQ(32, stats().insert_.value());
+  // The most recent insert is still present; the first one has been evicted.
+  EXPECT_THAT(lookup("/object31").body_length_, Optional(1024));
+  EXPECT_THAT(lookup("/object0").body_length_, Eq(absl::nullopt));
+  EXPECT_EQ(1, stats().lookup_hit_.value());
+  EXPECT_EQ(1, stats().lookup_miss_.value());
+}
+
+TEST_P(MemoryHttpCacheEvictionTest, OversizedEntryIsDropped) {
+  auto source = std::make_unique<FakeStreamHttpSource>(dispatcher(), nullptr,
+                                                       std::string(16 * 1024, 'a'), nullptr);
+  source->setMaxFragmentSize(4 * 1024);
+  auto progress = std::make_shared<MockCacheProgressReceiver>();
+  CacheReaderPtr reader;
+  EXPECT_CALL(*progress, onHeadersInserted)
+      .WillOnce([&reader](CacheReaderPtr cache_reader, Http::ResponseHeaderMapPtr, bool) {
+        reader = std::move(cache_reader);
+      });
+  // The body stops being kept as soon as it no longer fits in an entry.
+  EXPECT_CALL(*progress, onBodyInserted(_, false));
+  EXPECT_CALL(*progress, onInsertFailed(StatusHelpers::HasStatusCode(
+                             absl::StatusCode::kResourceExhausted)));
+  cache().insert(dispatcher(), simpleKey("/large"),
+                 Http::createHeaderMap<Http::ResponseHeaderMapImpl>(responseHeaders()),
+                 {time_system_.systemTime()}, std::move(source), progress);
+  pumpDispatcher();
+  EXPECT_EQ(1, stats().insert_rejected_.value());
+  EXPECT_EQ(0, stats().insert_.value());
+  EXPECT_THAT(lookup("/large").body_length_, Eq(absl::nullopt));
+}
+
+TEST_P(MemoryHttpCacheEvictionTest, BodyRemainsReadableAfterEviction) {
+  const std::string body(1024, 'b');
+  insert("/name", responseHeaders(), body);
+  LookupResult result = lookup("/name");
+  ASSERT_NE(result.cache_reader_, nullptr);
+  evict("/name");
+  EXPECT_THAT(lookup("/name").body_length_, Eq(absl::nullopt));
+  EXPECT_THAT(getBody(*result.cache_reader_, 1000, 1024),
+              Pair(std::string(24, 'b'), EndStream::More));
+}
+
+TEST(Registration, GetCacheFromFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.memory_http_cache.v3.MemoryHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config cache_config;
+  cache_config.mutable_typed_config()->PackFrom(testConfig());
+  auto cache = factory->getCache(cache_config, factory_context);
+  ASSERT_OK(cache);
+  EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.memory_http_cache");
+
+  // The same name and config refers to the same cache.
+  auto same_cache = factory->getCache(cache_config, factory_context);
+  ASSERT_OK(same_cache);
+  EXPECT_EQ(cache->get(), same_cache->get());
+
+  // The same name with a different config is rejected.
+  cache_config.mutable_typed_config()->PackFrom(testConfig(2048));
+  EXPECT_THAT(factory->getCache(cache_config, factory_context),
+              StatusHelpers::HasStatusCode(absl::StatusCode::kInvalidArgument));
+}
+
+} // namespace
+} // namespace MemoryHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,328 @@
+#include "envoy/extensions/http/cache_v2/simple_http_cache/v3/config.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "source/common/stats/isolated_store_impl.h"
+#include "source/extensions/filters/http/cache_v2/cache_sessions.h"
+#include "source/extensions/http/cache_v2/simple_http_cache/simple_http_cache.h"
+#include "source/extensions/http/cache_v2/tiered_http_cache/tiered_http_cache.h"
+
+#include "test/extensions/filters/http/cache_v2/http_cache_implementation_test_common.h"
+#include "test/extensions/filters/http/cache_v2/mocks.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/status_utility.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace CacheV2 {
+namespace TieredHttpCache {
+namespace {
+
+using ::testing::_;
+using ::testing::Eq;
+using ::testing::Optional;
+using ::testing::Pair;
+
+ConfigProto testConfig(uint64_t max_individual_cache_entry_size_bytes = 1024 * 1024) {
+  ConfigProto config;
+  auto* memory_tier = config.mutable_memory_tier();
+  memory_tier->set_cache_name("test");
+  memory_tier->set_max_cache_size_bytes(1024 * 1024);
+  memory_tier->set_shard_count(1);
+  memory_tier->mutable_max_individual_cache_entry_size_bytes()->set_value(
+      max_individual_cache_entry_size_bytes);
+  config.mutable_lower_tier()->set_name("simple");
+  config.mutable_lower_tier()->mutable_typed_config()->PackFrom(
+      envoy::extensions::http::cache_v2::simple_http_cache::v3::SimpleHttpCacheV2Config());
+  return config;
+}
+
+class TieredHttpCacheTestDelegate : public HttpCacheTestDelegate {
+public:
+  explicit TieredHttpCacheTestDelegate(ConfigProto config = testConfig())
+      : cache_(std::move(config), std::make_shared<SimpleHttpCache>(), *stats_store_.rootScope()) {}
+  HttpCache& cache() override { return cache_; }
+
+private:
+  Stats::IsolatedStoreImpl stats_store_;
+  TieredHttpCache cache_;
+};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheTest, HttpCacheImplementationTest,
+                         testing::Values(std::make_unique<TieredHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "TieredHttpCache";
+                         });
+
+class TieredHttpCachePromotionTest : public HttpCacheImplementationTest {
+protected:
+  Http::TestResponseHeaderMapImpl responseHeaders() {
+    return {{":status", "200"},
+            {"date", formatter_.fromTime(time_system_.systemTime())},
+            {"cache-control", "public,max-age=3600"}};
+  }
+
+  TieredHttpCacheStats& stats() { return dynamic_cast<TieredHttpCache&>(cache()).stats(); }
+
+  // Looks up the path until it has been promoted into the memory tier.
+  void promote(absl::string_view path) {
+    lookup(path);
+    lookup(path);
+    ASSERT_EQ(1, stats().promotion_.value());
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCachePromotionTest, TieredHttpCachePromotionTest,
+                         testing::Values(std::make_unique<TieredHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "TieredHttpCache";
+                         });
+
+TEST_P(TieredHttpCachePromotionTest, PromotesAfterRepeatedLowerTierHits) {
+  const std::string body(2 * 1024 * 1024 / 3, 'a');
+  insert("/name", responseHeaders(), body, Http::TestResponseTrailerMapImpl{{"x", "y"}});
+  EXPECT_THAT(lookup("/name").body_length_, Optional(body.size()));
+  EXPECT_EQ(1, stats().lower_hit_.value());
+  EXPECT_EQ(0, stats().promotion_.value());
+
+  promote("/name");
+  EXPECT_EQ(2, stats().lower_hit_.value());
+
+  LookupResult result = lookup("/name");
+  EXPECT_EQ(1, stats().memory_hit_.value());
+  EXPECT_EQ(2, stats().lower_hit_.value());
+  EXPECT_THAT(result.body_length_, Optional(body.size()));
+  Http::TestResponseTrailerMapImpl trailers{{"x", "y"}};
+  EXPECT_THAT(result.response_trailers_, HeaderMapEqualIgnoreOrder(&trailers));
+  ASSERT_NE(result.cache_reader_, nullptr);
+  EXPECT_THAT(getBody(*result.cache_reader_, body.size() - 4, body.size()),
+              Pair("aaaa", EndStream::More));
+}
+
+TEST_P(TieredHttpCachePromotionTest, MissIsCounted) {
+  EXPECT_THAT(lookup("/name").body_length_, Eq(absl::nullopt));
+  EXPECT_EQ(1, stats().miss_.value());
+  EXPECT_EQ(0, stats().lower_hit_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, InsertReplacesPromotedCopy) {
+  insert("/name", responseHeaders(), "old");
+  promote("/name");
+  insert("/name", responseHeaders(), "newer");
+  LookupResult result = lookup("/name");
+  EXPECT_EQ(0, stats().memory_hit_.value());
+  EXPECT_THAT(result.body_length_, Optional(5));
+  EXPECT_THAT(getBody(*result.cache_reader_, 0, 5), Pair("newer", EndStream::More));
+}
+
+TEST_P(TieredHttpCachePromotionTest, EvictRemovesBothTiers) {
+  insert("/name", responseHeaders(), "body");
+  promote("/name");
+  evict("/name");
+  EXPECT_THAT(lookup("/name").body_length_, Eq(absl::nullopt));
+  EXPECT_EQ(1, stats().miss_.value());
+}
+
+TEST_P(TieredHttpCachePromotionTest, UpdateHeadersAppliesToPromotedCopy) {
+  insert("/name", responseHeaders(), "body");
+  promote("/name");
+  Http::TestResponseHeaderMapImpl updated = responseHeaders();
+  updated.setCopy(Http::LowerCaseString("x-updated"), "yes");
+  updateHeaders("/name", updated, {time_system_.systemTime()});
+  LookupResult result = lookup("/name");
+  EXPECT_EQ(1, stats().memory_hit_.value());
+  EXPECT_THAT(result.response_headers_, HeaderMapEqualIgnoreOrder(&updated));
+}
+
+// The memory tier only accepts entries of up to 100 bytes.
+class SmallEntryTieredHttpCacheTestDelegate : public TieredHttpCacheTestDelegate {
+public:
+  SmallEntryTieredHttpCacheTestDelegate() : TieredHttpCacheTestDelegate(testConfig(100)) {}
+};
+
+class TieredHttpCacheSmallEntryTest : public TieredHttpCachePromotionTest {};
+
+INSTANTIATE_TEST_SUITE_P(TieredHttpCacheSmallEntryTest, TieredHttpCacheSmallEntryTest,
+                         testing::Values(std::make_unique<SmallEntryTieredHttpCacheTestDelegate>),
+                         [](const testing::TestParamInfo<HttpCacheImplementationTest::ParamType>&) {
+                           return "SmallEntryTieredHttpCache";
+                         });
+
+TEST_P(TieredHttpCacheSmallEntryTest, OversizedResponseIsNotPromoted) {
+  insert("/name", responseHeaders(), std::string(1000, 'a'));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_THAT(lookup("/name").body_length_, Optional(1000));
+  }
+  EXPECT_EQ(4, stats().lower_hit_.value());
+  EXPECT_EQ(0, stats().promotion_.value());
+  EXPECT_EQ(0, stats().promotion_failed_.value());
+}
+
+// Holds the lookups of the lower tier, so that the tests can complete them in any order.
+class TieredHttpCacheRaceTest : public testing::Test {
+protected:
+  TieredHttpCacheRaceTest()
+      : lower_(std::make_shared<MockHttpCache>()),
+        cache_(testConfig(), lower_, *stats_store_.rootScope()) {
+    key_.set_host("example.com");
+    key_.set_path("/name");
+    EXPECT_CALL(*lower_, lookup)
+        .WillRepeatedly([this](LookupRequest&&, HttpCache::LookupCallback&& callback) {
+          lookups_.push_back(std::move(callback));
+        });
+  }
+
+  void lookup() {
+    cache_.lookup(LookupRequest(Key(key_), dispatcher_), [](absl::StatusOr<LookupResult>&&) {});
+  }
+
+  static LookupResult populatedResult() {
+    LookupResult result;
+    result.response_headers_ =
+        std::make_unique<Http::TestResponseHeaderMapImpl>(Http::TestResponseHeaderMapImpl{
+            {":status", "200"}, {"cache-control", "public,max-age=3600"}});
+    result.body_length_ = 0;
+    return result;
+  }
+
+  // Completes two lower tier hits, which start a promotion whose lower tier lookup is held.
+  void startPromotion() {
+    lookup();
+    lookup();
+    lookups_[0](populatedResult());
+    lookups_[1](populatedResult());
+    ASSERT_EQ(3, lookups_.size());
+  }
+
+  Stats::IsolatedStoreImpl stats_store_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  const std::shared_ptr<MockHttpCache> lower_;
+  TieredHttpCache cache_;
+  Key key_;
+  std::vector<HttpCache::LookupCallback> lookups_;
+};
+
+TEST_F(TieredHttpCacheRaceTest, EvictDuringPromotionDiscardsIt) {
+  startPromotion();
+  EXPECT_CALL(*lower_, evict(_, _));
+  cache_.evict(dispatcher_, key_);
+  lookups_[2](populatedResult());
+  EXPECT_EQ(0, cache_.stats().promotion_.value());
+  EXPECT_EQ(1, cache_.stats().promotion_failed_.value());
+
+  // The evicted response was not brought back into the memory tier.
+  lookup();
+  EXPECT_EQ(4, lookups_.size());
+  EXPECT_EQ(0, cache_.stats().memory_hit_.value());
+}
+
+TEST_F(TieredHttpCacheRaceTest, PromotionAfterEvictIsNotCancelled) {
+  startPromotion();
+  EXPECT_CALL(*lower_, evict(_, _));
+  cache_.evict(dispatcher_, key_);
+  // A new promotion starts while the cancelled one is still in flight.
+  lookup();
+  lookups_[3](populatedResult());
+  ASSERT_EQ(5, lookups_.size());
+  lookups_[2](populatedResult());
+  lookups_[4](populatedResult());
+  EXPECT_EQ(1, cache_.stats().promotion_.value());
+  EXPECT_EQ(1, cache_.stats().promotion_failed_.value());
+  lookup();
+  EXPECT_EQ(1, cache_.stats().memory_hit_.value());
+}
+
+TEST(TieredHttpCacheStatsTest, MemoryTierStatsAreScopedToTheTieredCache) {
+  Stats::IsolatedStoreImpl stats_store;
+  TieredHttpCache cache(testConfig(), std::make_shared<SimpleHttpCache>(),
+                        *stats_store.rootScope());
+  EXPECT_NE(nullptr,
+            TestUtility::findGauge(stats_store, "cache.tiered.test.memory.size_limit_bytes"));
+  EXPECT_EQ(nullptr, TestUtility::findGauge(stats_store, "cache.memory.test.size_limit_bytes"));
+}
+
+TEST(FrequencySketchTest, CountsAndSaturates) {
+  FrequencySketch sketch(1024);
+  for (uint8_t i = 1; i <= 15; ++i) {
+    EXPECT_EQ(i, sketch.record(42));
+  }
+  EXPECT_EQ(15, sketch.record(42));
+  EXPECT_EQ(1, sketch.record(43));
+}
+
+TEST(FrequencySketchTest, Decays) {
+  FrequencySketch sketch(1024);
+  for (int i = 0; i < 8; ++i) {
+    sketch.record(42);
+  }
+  // Enough accesses to another key to trigger a halving of all counters.
+  for (size_t i = 0; i < 10 * 1024 - 8; ++i) {
+    sketch.record(43);
+  }
+  EXPECT_EQ(5, sketch.record(42));
+}
+
+TEST(Registration, GetCacheFromFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.tiered_http_cache.v3.TieredHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config cache_config;
+  cache_config.mutable_typed_config()->PackFrom(testConfig());
+  auto cache = factory->getCache(cache_config, factory_context);
+  ASSERT_OK(cache);
+  EXPECT_EQ((*cache)->cacheInfo().name_, "envoy.extensions.http.cache_v2.tiered_http_cache");
+
+  // The same name and config refers to the same cache.
+  auto same_cache = factory->getCache(cache_config, factory_context);
+  ASSERT_OK(same_cache);
+  EXPECT_EQ(cache->get(), same_cache->get());
+
+  // The same name with a different config is rejected.
+  cache_config.mutable_typed_config()->PackFrom(testConfig(2048));
+  EXPECT_THAT(factory->getCache(cache_config, factory_context),
+              StatusHelpers::HasStatusCode(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(Registration, RejectsSharedLowerTier) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.tiered_http_cache.v3.TieredHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config cache_config;
+  cache_config.mutable_typed_config()->PackFrom(testConfig());
+  auto cache = factory->getCache(cache_config, factory_context);
+  ASSERT_OK(cache);
+
+  // Another tiered cache over the same simple cache is rejected.
+  ConfigProto config = testConfig();
+  config.mutable_memory_tier()->set_cache_name("other");
+  cache_config.mutable_typed_config()->PackFrom(config);
+  EXPECT_THAT(factory->getCache(cache_config, factory_context),
+              StatusHelpers::HasStatusCode(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(Registration, RejectsTieredLowerTier) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.extensions.http.cache_v2.tiered_http_cache.v3.TieredHttpCacheV2Config");
+  ASSERT_NE(factory, nullptr);
+  testing::NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigProto config = testConfig();
+  config.mutable_memory_tier()->set_cache_name("recursive");
+  config.mutable_lower_tier()->mutable_typed_config()->PackFrom(testConfig());
+  envoy::extensions::filters::http::cache_v2::v3::CacheV2Config cache_config;
+  cache_config.mutable_typed_config()->PackFrom(config);
+  EXPECT_THAT(factory->getCache(cache_config, factory_context),
+              StatusHelpers::HasStatusCode(absl::StatusCode::kInvalidArgument));
+}
+
+} // namespace
+} // namespace TieredHttpCache
+} // namespace CacheV2
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
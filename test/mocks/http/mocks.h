@@ -15,6 +15,7 @@
 #include "envoy/matcher/matcher.h"
 #include "envoy/ssl/connection.h"
 
+#include "source/common/common/arena_impl.h"
 #include "source/common/http/conn_manager_config.h"
 #include "source/common/http/filter_manager.h"
 #include "source/common/http/header_map_impl.h"
@@ -341,6 +342,7 @@ public:
   MOCK_METHOD(absl::optional<Upstream::LoadBalancerContext::OverrideHost>, upstreamOverrideHost, (),
               (const));
   MOCK_METHOD(bool, shouldLoadShed, (), (const));
+  MOCK_METHOD(Arena&, streamArena, ());
 
   Buffer::InstancePtr buffer_;
   std::list<DownstreamWatermarkCallbacks*> callbacks_;
@@ -352,6 +354,7 @@ public:
   bool is_head_request_{false};
   bool stream_destroyed_{};
   NiceMock<Event::MockDispatcher> dispatcher_;
+  ArenaImpl arena_;
 };
 
 class MockStreamEncoderFilterCallbacks : public StreamEncoderFilterCallbacks,
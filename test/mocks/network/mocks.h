@@ -249,6 +249,7 @@ public:
   MOCK_METHOD(uint32_t, workerIndex, (), (const));
   MOCK_METHOD(void, onDataWorker, (Network::UdpRecvData && data));
   MOCK_METHOD(void, post, (Network::UdpRecvData && data));
+  MOCK_METHOD(void, postBatch, (std::vector<Network::UdpRecvData> && data));
   MOCK_METHOD(size_t, numPacketsExpectedPerEventLoop, (), (const));
   MOCK_METHOD(const IoHandle::UdpSaveCmsgConfig&, udpSaveCmsgConfig, (), (const));
 };
@@ -585,6 +586,7 @@ public:
   MOCK_METHOD(void, registerWorkerForListener, (UdpListenerCallbacks & listener));
   MOCK_METHOD(void, unregisterWorkerForListener, (UdpListenerCallbacks & listener));
   MOCK_METHOD(void, deliver, (uint32_t dest_worker_index, UdpRecvData&& data));
+  MOCK_METHOD(void, deliverBatch, (uint32_t dest_worker_index, std::vector<UdpRecvData>&& data));
 };
 
 class MockIp : public Address::Ip {
@@ -8,9 +8,11 @@
 #include "source/common/network/udp_packet_writer_handler_impl.h"
 #include "source/server/active_udp_listener.h"
 
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/network/mocks.h"
 #include "test/test_common/environment.h"
 #include "test/test_common/network_utility.h"
+#include "test/test_common/test_runtime.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -20,6 +22,7 @@ using testing::Invoke;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
+using testing::SizeIs;
 
 namespace Envoy {
 namespace Server {
@@ -96,6 +99,28 @@ public:
         0, concurrency, conn_handler_, listen_socket_, dispatcher_, listener_config_);
   }
 
+  // Registers a mock worker 1 with the router so that datagrams forwarded by the listener under
+  // test, which is worker 0, can be observed.
+  void registerPeerWorker() {
+    ON_CALL(peer_worker_, workerIndex()).WillByDefault(Return(1));
+    udp_listener_config_->udp_listener_worker_router_->registerWorkerForListener(peer_worker_);
+  }
+
+  void unregisterPeerWorker() {
+    udp_listener_config_->udp_listener_worker_router_->unregisterWorkerForListener(peer_worker_);
+  }
+
+  uint64_t counterValue(const std::string& name) {
+    return scope_.counterFromString("udp." + name).value();
+  }
+
+  Network::UdpRecvData datagram() {
+    Network::UdpRecvData data;
+    data.buffer_ = std::make_unique<Buffer::OwnedImpl>("payload");
+    return data;
+  }
+
+  TestScopedRuntime scoped_runtime_;
   std::string listener_stat_prefix_{"listener_stat_prefix"};
   NiceMock<Event::MockDispatcher> dispatcher_{"test"};
   NiceMock<MockUdpConnectionHandler> conn_handler_;
@@ -110,6 +135,7 @@ public:
   Network::MockListenerConfig listener_config_;
   std::unique_ptr<TestActiveRawUdpListener> active_listener_;
   NiceMock<Network::MockUdpReadFilterCallbacks> cb_;
+  NiceMock<Network::MockUdpListenerCallbacks> peer_worker_;
 };
 
 INSTANTIATE_TEST_SUITE_P(ActiveUdpListenerTests, ActiveUdpListenerTest,
@@ -194,6 +220,74 @@ TEST_P(ActiveUdpListenerTest, MultipleFiltersOnReceiveErrorStopIteration) {
   active_listener_->onReceiveError(Api::IoError::IoErrorCode::UnknownError);
 }
 
+// Without batching every datagram owned by another worker is posted to that worker on its own.
+TEST_P(ActiveUdpListenerTest, ForwardToOtherWorker) {
+  setup(2);
+  registerPeerWorker();
+  active_listener_->destination_ = 1;
+
+  EXPECT_CALL(peer_worker_, post(_)).Times(2);
+  EXPECT_CALL(peer_worker_, postBatch(_)).Times(0);
+  active_listener_->onData(datagram());
+  active_listener_->onData(datagram());
+  EXPECT_EQ(2, counterValue("downstream_rx_datagram_forwarded"));
+
+  // Datagrams that stay on this worker are not counted.
+  active_listener_->destination_ = 0;
+  active_listener_->onData(datagram());
+  EXPECT_EQ(2, counterValue("downstream_rx_datagram_forwarded"));
+  unregisterPeerWorker();
+}
+
+// With batching all datagrams forwarded to the same worker during one event loop iteration are
+// handed over together once the iteration's read processing is done.
+TEST_P(ActiveUdpListenerTest, ForwardToOtherWorkerBatched) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.udp_listener_batch_worker_forwarding", "true"}});
+  setup(2);
+  registerPeerWorker();
+  active_listener_->destination_ = 1;
+
+  auto* flush_cb = new Event::MockSchedulableCallback(&dispatcher_);
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  EXPECT_CALL(peer_worker_, post(_)).Times(0);
+  EXPECT_CALL(peer_worker_, postBatch(_)).Times(0);
+  for (int i = 0; i < 3; ++i) {
+    active_listener_->onData(datagram());
+  }
+  EXPECT_EQ(3, counterValue("downstream_rx_datagram_forwarded"));
+  testing::Mock::VerifyAndClearExpectations(&peer_worker_);
+
+  EXPECT_CALL(peer_worker_, postBatch(SizeIs(3)));
+  flush_cb->invokeCallback();
+  testing::Mock::VerifyAndClearExpectations(&peer_worker_);
+
+  // A single queued datagram is delivered through the regular per-datagram post.
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  EXPECT_CALL(peer_worker_, post(_));
+  active_listener_->onData(datagram());
+  flush_cb->invokeCallback();
+  EXPECT_EQ(4, counterValue("downstream_rx_datagram_forwarded"));
+  unregisterPeerWorker();
+}
+
+// Datagrams that are still queued when the listener goes away are handed over rather than lost.
+TEST_P(ActiveUdpListenerTest, ForwardBatchFlushedOnDestruction) {
+  scoped_runtime_.mergeValues(
+      {{"envoy.reloadable_features.udp_listener_batch_worker_forwarding", "true"}});
+  setup(2);
+  registerPeerWorker();
+  active_listener_->destination_ = 1;
+
+  new NiceMock<Event::MockSchedulableCallback>(&dispatcher_);
+  active_listener_->onData(datagram());
+  active_listener_->onData(datagram());
+
+  EXPECT_CALL(peer_worker_, postBatch(SizeIs(2)));
+  active_listener_.reset();
+  unregisterPeerWorker();
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy